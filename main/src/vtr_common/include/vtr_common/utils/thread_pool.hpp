@@ -0,0 +1,119 @@
+// Copyright 2021, Autonomous Space Robotics Lab (ASRL)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+/**
+ * \file thread_pool.hpp
+ * \author Autonomous Space Robotics Lab (ASRL)
+ * \brief A fixed set of persistent worker threads serving a FIFO job queue.
+ */
+#pragma once
+
+#include <condition_variable>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace vtr {
+namespace common {
+
+/////////////////////////////////////////////////////////////////////////////
+/// @brief Runs jobs on worker threads that live as long as the pool, so that
+///        per-frame work does not pay for thread creation.
+/// @note  Jobs must not block on other jobs of the same pool, the pool could
+///        deadlock once all workers are waiting.
+/////////////////////////////////////////////////////////////////////////////
+class thread_pool {
+ public:
+  /////////////////////////////////////////////////////////////////////////////
+  /// @brief Default constructor
+  /// @param num_threads The number of worker threads, at least one
+  /////////////////////////////////////////////////////////////////////////////
+  explicit thread_pool(size_t num_threads = 1) {
+    num_threads = std::max<size_t>(num_threads, 1);
+    workers_.reserve(num_threads);
+    for (size_t i = 0; i < num_threads; ++i)
+      workers_.emplace_back(&thread_pool::doWork, this);
+  }
+
+  /////////////////////////////////////////////////////////////////////////////
+  /// @brief Finishes the queued jobs and joins the workers
+  /////////////////////////////////////////////////////////////////////////////
+  ~thread_pool() {
+    {
+      std::lock_guard<std::mutex> lck(mtx_);
+      stop_ = true;
+    }
+    cv_.notify_all();
+    for (auto &worker : workers_) worker.join();
+  }
+
+  /////////////////////////////////////////////////////////////////////////////
+  /// @brief Queues a job
+  /// @return A future holding the result (or exception) of the job
+  /////////////////////////////////////////////////////////////////////////////
+  template <class Func, class... Args>
+  auto dispatch(Func &&func, Args &&...args)
+      -> std::future<std::invoke_result_t<Func, Args...>> {
+    using Result = std::invoke_result_t<Func, Args...>;
+    auto job = std::make_shared<std::packaged_task<Result()>>(
+        std::bind(std::forward<Func>(func), std::forward<Args>(args)...));
+    auto future = job->get_future();
+    {
+      std::lock_guard<std::mutex> lck(mtx_);
+      jobs_.emplace([job]() { (*job)(); });
+    }
+    cv_.notify_one();
+    return future;
+  }
+
+  /////////////////////////////////////////////////////////////////////////////
+  /// @brief The number of worker threads
+  /////////////////////////////////////////////////////////////////////////////
+  size_t size() const { return workers_.size(); }
+
+  /////////////////////////////////////////////////////////////////////////////
+  /// @brief Mutexes and threads are not copyable, so neither is this.
+  /////////////////////////////////////////////////////////////////////////////
+  thread_pool(const thread_pool &) = delete;
+  thread_pool &operator=(const thread_pool &) = delete;
+
+ private:
+  void doWork() {
+    while (true) {
+      std::function<void()> job;
+      {
+        std::unique_lock<std::mutex> lck(mtx_);
+        cv_.wait(lck, [this] { return stop_ || !jobs_.empty(); });
+        if (jobs_.empty()) return;  // stopped and drained
+        job = std::move(jobs_.front());
+        jobs_.pop();
+      }
+      job();
+    }
+  }
+
+  std::mutex mtx_;
+  std::condition_variable cv_;
+  std::queue<std::function<void()>> jobs_;
+  bool stop_ = false;
+  std::vector<std::thread> workers_;
+};
+
+}  // namespace common
+}  // namespace vtr
@@ -34,6 +34,7 @@ vtr_ui_logger = logging.getLogger('vtr_ui')  # set up in vtr_ui.py
 
 def graph_state_from_ros(ros_graph_state):
   return {
+      'version': ros_graph_state.version,
       'vertices': [{
           'id': v.id,
           'neighbors': [n for n in v.neighbors],
@@ -58,6 +59,7 @@ def graph_update_from_ros(ros_graph_update):
   vf = ros_graph_update.vertex_from
   vt = ros_graph_update.vertex_to
   return {
+      'version': ros_graph_update.version,
       'vertex_from': {
           'id': vf.id,
           'neighbors': [n for n in vf.neighbors],
@@ -79,6 +81,65 @@ def graph_update_from_ros(ros_graph_update):
   }
 
 
+def graph_diff_from_ros(ros_graph_diff):
+  return {
+      'base_version': ros_graph_diff.base_version,
+      'version': ros_graph_diff.version,
+      'vertices': [{
+          'id': v.id,
+          'neighbors': [n for n in v.neighbors],
+          'lng': v.lng,
+          'lat': v.lat,
+          'theta': v.theta,
+          'type': v.type,
+          'name': v.name
+      } for v in ros_graph_diff.vertices],
+      'removed_ids': [id for id in ros_graph_diff.removed_ids],
+      'routes_changed': ros_graph_diff.routes_changed,
+      'fixed_routes': [{
+          'ids': [id for id in r.ids],
+          'type': r.type
+      } for r in ros_graph_diff.fixed_routes],
+      'active_routes': [{
+          'ids': [id for id in r.ids],
+          'type': r.type
+      } for r in ros_graph_diff.active_routes],
+  }
+
+
+def apply_graph_diff(graph_state, graph_diff):
+  """Applies a graph diff to a graph state in place"""
+  removed = set(graph_diff['removed_ids'])
+  changed = {v['id']: v for v in graph_diff['vertices']}
+  vertices = [changed.pop(v['id'], v) for v in graph_state['vertices'] if v['id'] not in removed]
+  vertices.extend(changed.values())
+  graph_state['vertices'] = vertices
+  if graph_diff['routes_changed']:
+    graph_state['fixed_routes'] = graph_diff['fixed_routes']
+    graph_state['active_routes'] = graph_diff['active_routes']
+  graph_state['version'] = graph_diff['version']
+
+
+def apply_graph_update(graph_state, graph_update):
+  """Applies an incremental update (a new temporal edge) to a graph state in place"""
+  vf = graph_update['vertex_from']
+  vt = graph_update['vertex_to']
+  apply_graph_diff(
+      graph_state, {
+          'version': graph_update['version'],
+          'vertices': [vf, vt],
+          'removed_ids': [],
+          'routes_changed': False,
+      })
+  # same as GraphMapServer::updateIncrementally
+  active_routes = graph_state['active_routes']
+  if not active_routes:
+    active_routes.append({'ids': [vf['id']], 'type': vf['type']})
+  active_routes[-1]['ids'].append(vt['id'])
+  if active_routes[-1]['type'] != vt['type']:
+    active_routes.append({'ids': [vt['id']], 'type': vt['type']})
+
+
 def robot_state_from_ros(ros_robot_state):
   return {
       'valid': ros_robot_state.valid,
@@ -186,6 +247,8 @@ class SocketVTRUI(VTRUI):
   """
 
   def __init__(self):
+    # graph state that incremental updates and diffs are applied to
+    self._graph_state = None
     super().__init__()
 
     self._socketio = socketio.Client()
@@ -306,9 +369,23 @@ class SocketVTRUI(VTRUI):
 
   def _notify_hook(self, name, *args, **kwargs):
     if name == 'graph_state':
-      self._send(name, {'graph_state': graph_state_from_ros(kwargs["graph_state"])})
+      self._graph_state = graph_state_from_ros(kwargs["graph_state"])
+      self._send(name, {'graph_state': self._graph_state})
     if name == 'graph_update':
-      self._send(name, {'graph_update': graph_update_from_ros(kwargs["graph_update"])})
+      graph_update = graph_update_from_ros(kwargs["graph_update"])
+      if self._graph_state is not None and self._graph_state['version'] + 1 == graph_update['version']:
+        apply_graph_update(self._graph_state, graph_update)
+      else:
+        self._graph_state = None  # out of sync, reload on the next diff
+      self._send(name, {'graph_update': graph_update})
+    if name == 'graph_diff':
+      graph_diff = graph_diff_from_ros(kwargs["graph_diff"])
+      if self._graph_state is not None and self._graph_state['version'] == graph_diff['base_version']:
+        apply_graph_diff(self._graph_state, graph_diff)
+      else:
+        vtr_ui_logger.info("Graph state out of sync, requesting the full graph state.")
+        self._graph_state = self.get_graph_state()
+      self._send('graph_state', {'graph_state': self._graph_state})
     if name == 'robot_state':
       self._send(name, {'robot_state': robot_state_from_ros(kwargs["robot_state"])})
     if name == 'server_state':
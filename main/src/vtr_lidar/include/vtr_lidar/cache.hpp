@@ -71,11 +71,11 @@ struct LidarQueryCache : virtual public tactic::QueryCache {
 struct LidarOutputCache : virtual public tactic::OutputCache {
   PTR_TYPEDEFS(LidarOutputCache);
 
-  tactic::LockableCache<BaseCostMap> change_detection_costmap;
-  tactic::LockableCache<BaseCostMap> ground_extraction_costmap;
-  tactic::LockableCache<BaseCostMap> obstacle_detection_costmap;
-  tactic::LockableCache<BaseCostMap> terrain_assessment_costmap;
-  tactic::LockableCache<BaseCostMap> safe_corridor_costmap;
+  tactic::AtomicCache<BaseCostMap> change_detection_costmap;
+  tactic::AtomicCache<BaseCostMap> ground_extraction_costmap;
+  tactic::AtomicCache<BaseCostMap> obstacle_detection_costmap;
+  tactic::AtomicCache<BaseCostMap> terrain_assessment_costmap;
+  tactic::AtomicCache<BaseCostMap> safe_corridor_costmap;
 };
 
 }  // namespace lidar
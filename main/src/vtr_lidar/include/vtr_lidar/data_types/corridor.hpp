@@ -0,0 +1,119 @@
+// Copyright 2021, Autonomous Space Robotics Lab (ASRL)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+/**
+ * \file corridor.hpp
+ * \author Autonomous Space Robotics Lab (ASRL)
+ */
+#pragma once
+
+#include <mutex>
+#include <vector>
+
+#include <Eigen/Core>
+
+#include "vtr_common/utils/macros.hpp"
+#include "vtr_tactic/types.hpp"
+
+namespace vtr {
+namespace lidar {
+
+/**
+ * \brief The path ahead of a vertex projected onto its xy plane, with the
+ * distance to the path precomputed at the cell centers of a cost map of the
+ * given geometry. A grid of buckets lists, for every bucket, the only path
+ * segments that can be the closest to a point inside of it, so that each cell
+ * checks a few segments instead of all of them.
+ */
+class Corridor {
+ public:
+  PTR_TYPEDEFS(Corridor);
+
+  /**
+   * \param T_curr_query_vec poses of the path vertices in the frame of the
+   * current vertex, the first one being the current vertex itself
+   * \param dl resolution of the cost map
+   * \param size_x size of the cost map in x, centered at the vertex
+   * \param size_y size of the cost map in y, centered at the vertex
+   * \param bucket_size side length of a bucket
+   */
+  Corridor(const std::vector<Eigen::Matrix4d>& T_curr_query_vec,
+           const float& dl, const float& size_x, const float& size_y,
+           const float& bucket_size = 1.0);
+
+  /**
+   * \brief Distance from q to the closest path segment, a lookup if q is a
+   * cell center of the cost map.
+   * \note infinity if the path is empty
+   */
+  float distance(const Eigen::Vector2f& q) const;
+
+  const std::vector<Eigen::Matrix4d>& T_curr_query_vec() const {
+    return T_curr_query_vec_;
+  }
+
+ private:
+  /** \brief distance from q to the segments listed for its bucket */
+  float search(const Eigen::Vector2f& q) const;
+  /** \brief distance from q to segment (xy_[i], xy_[i + 1]) */
+  float distance(const Eigen::Vector2f& q, const size_t& i) const;
+  /** \brief number of segments, a single vertex is a zero length segment */
+  size_t numSegments() const { return xy_.size() > 1 ? xy_.size() - 1 : 1; }
+
+  std::vector<Eigen::Matrix4d> T_curr_query_vec_;
+  std::vector<Eigen::Vector2f> xy_;
+
+  /** \brief bucket grid, (x, y) covers lower left corner + [x, x+1) * size */
+  const float bucket_size_;
+  Eigen::Vector2f grid_min_;
+  int grid_width_ = 0, grid_height_ = 0;
+  /** \brief candidates of bucket x + y * width in [offsets[k], offsets[k+1]) */
+  std::vector<size_t> offsets_;
+  std::vector<unsigned> candidates_;
+
+  /** \brief cost map geometry, same as BaseCostMap */
+  const float dl_;
+  int width_ = 0, height_ = 0;
+  int origin_x_ = 0, origin_y_ = 0;
+  /** \brief distance at cell (x, y) stored at x + y * width */
+  std::vector<float> distances_;
+};
+
+/**
+ * \brief Keeps the corridor ahead of the last queried vertex. The corridor is
+ * rebuilt, i.e. the privileged poses are rebased to the vertex frame, only
+ * when the vertex or the path ahead of it changes.
+ */
+class CorridorCache {
+ public:
+  CorridorCache(const float& lookahead_distance, const float& dl,
+                const float& size_x, const float& size_y);
+
+  /** \brief Returns the corridor ahead of curr_sid, reusing the last one. */
+  Corridor::ConstPtr get(const tactic::LocalizationChain& chain,
+                         const unsigned& curr_sid);
+
+ private:
+  const float lookahead_distance_;
+  const float dl_, size_x_, size_y_;
+
+  std::mutex mutex_;
+  /** \brief sequence id and privileged poses of the cached corridor */
+  unsigned sid_ = -1;
+  std::vector<Eigen::Matrix4d> T_w_query_vec_;
+  Corridor::ConstPtr corridor_;
+};
+
+}  // namespace lidar
+}  // namespace vtr
@@ -128,13 +128,29 @@ class DenseCostMap : public BaseCostMap {
    */
   template <typename ComputeValueOp>
   void update(const ComputeValueOp& op);
+  /**
+   * \brief Same as above with cells computed by num_threads threads,
+   * ComputeValueOp must be safe to call concurrently.
+   */
+  template <typename ComputeValueOp>
+  void update(const ComputeValueOp& op, const int& num_threads);
+
+  /**
+   * \brief Iterates over all cells in the cost map, calls VisitOp with the
+   * cell position and its (read-only) cost.
+   */
+  template <typename VisitOp>
+  void visit(const VisitOp& op) const;
 
   /** \brief update from a sparse cost map */
   void update(const std::unordered_map<costmap::PixKey, float>& values);
 
   // Modification by Jordy, DEBUG
-  /** \brief update from a standard unordered_map */
-  void update(const std::unordered_map<std::pair<float,float>, float> values);
+  /**
+   * \brief update from a standard unordered_map, positions outside of the
+   * cost map are clamped to its border
+   */
+  void update(const XY2ValueMap& values);
 
   XY2ValueMap filter(const float& threshold) const override;
 
@@ -150,7 +166,13 @@ class DenseCostMap : public BaseCostMap {
   float at(const costmap::PixKey& k) const override;
 
  private:
-  Eigen::MatrixXf values_;
+  /**
+   * \brief cell values indexed by (y, x), row-major so that the memory layout
+   * matches the data of an OccupancyGrid message (index x + y * width)
+   */
+  using Grid =
+      Eigen::Matrix<float, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>;
+  Grid values_;
 };
 
 class SparseCostMap : public BaseCostMap {
@@ -37,9 +37,25 @@ bool BaseCostMap::contains(const PointT& p) const {
 
 template <typename ComputeValueOp>
 void DenseCostMap::update(const ComputeValueOp& op) {
-  for (int i = 0; i < width_; ++i)
-    for (int j = 0; j < height_; ++j)
-      op({(i + origin_.x) * dl_, (j + origin_.y) * dl_}, values_(i, j));
+  for (int j = 0; j < height_; ++j)
+    for (int i = 0; i < width_; ++i)
+      op({(i + origin_.x) * dl_, (j + origin_.y) * dl_}, values_(j, i));
+}
+
+template <typename ComputeValueOp>
+void DenseCostMap::update(const ComputeValueOp& op, const int& num_threads) {
+#pragma omp parallel for schedule(dynamic, 1) num_threads(num_threads)
+  for (int j = 0; j < height_; ++j)
+    for (int i = 0; i < width_; ++i)
+      op({(i + origin_.x) * dl_, (j + origin_.y) * dl_}, values_(j, i));
+}
+
+template <typename VisitOp>
+void DenseCostMap::visit(const VisitOp& op) const {
+  for (int j = 0; j < height_; ++j)
+    for (int i = 0; i < width_; ++i)
+      op(Eigen::Vector2f((i + origin_.x) * dl_, (j + origin_.y) * dl_),
+         values_(j, i));
 }
 
 template <typename PointCloud, typename ReductionOp = SparseCostMap::AvgOp>
@@ -0,0 +1,117 @@
+// Copyright 2021, Autonomous Space Robotics Lab (ASRL)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+/**
+ * \file costmap_history.hpp
+ * \author Autonomous Space Robotics Lab (ASRL)
+ */
+#pragma once
+
+#include "vtr_lidar/data_types/costmap.hpp"
+
+namespace vtr {
+namespace lidar {
+
+/**
+ * \brief Fixed-capacity ring buffer of obstacle grids used for temporal
+ * filtering of cost maps. All grids are expressed in a common reference frame
+ * (e.g. the world frame of the localization chain) and share a dense window
+ * that is only re-centered when the robot gets close to its border. A running
+ * per-cell vote counter is updated incrementally when a grid is added or
+ * evicted, so filtering costs O(cells) regardless of the history length.
+ */
+class CostMapHistory {
+ public:
+  PTR_TYPEDEFS(CostMapHistory);
+
+  /**
+   * \param[in] dl resolution of the grid
+   * \param[in] size_x size of the cost maps to be added in x direction [meter]
+   * \param[in] size_y size of the cost maps to be added in y direction [meter]
+   * \param[in] capacity number of cost maps kept in the history
+   */
+  CostMapHistory(const float& dl, const float& size_x, const float& size_y,
+                 const size_t& capacity);
+
+  /**
+   * \brief Adds cells of the cost map with cost above threshold as obstacles,
+   * evicting the oldest grid if the history is full.
+   * \param[in] costmap the newest cost map, expressed in frame c
+   * \param[in] threshold minimum cost of an obstacle cell
+   * \param[in] T_ref_c transform from the cost map to the reference frame
+   */
+  void push(const DenseCostMap& costmap, const float& threshold,
+            const tactic::EdgeTransform& T_ref_c);
+
+  /**
+   * \brief Fills every cell of the cost map (expressed in frame c) that has
+   * been an obstacle in at least min_votes grids of the history with its most
+   * recent cost. Other cells are left untouched.
+   */
+  void filter(DenseCostMap& costmap, const tactic::EdgeTransform& T_ref_c,
+              const int& min_votes) const;
+
+  /** \brief Drops all grids, e.g. when the reference frame changes. */
+  void clear();
+
+  size_t size() const { return size_; }
+  size_t capacity() const { return capacity_; }
+  bool full() const { return size_ == capacity_; }
+
+  /** \brief number of grids in which the cell containing (x, y) is occupied */
+  int votes(const float& x, const float& y) const;
+
+ private:
+  costmap::PixKey getKey(const float& x, const float& y) const {
+    return costmap::PixKey((int)std::floor(x / dl_),
+                           (int)std::floor(y / dl_));
+  }
+  /** \brief index into the dense window or -1 if out of the window */
+  int index(const costmap::PixKey& k) const {
+    const auto shifted_k = k - origin_;
+    if (shifted_k.x < 0 || shifted_k.x >= width_ || shifted_k.y < 0 ||
+        shifted_k.y >= height_)
+      return -1;
+    return shifted_k.x + shifted_k.y * width_;
+  }
+  /** \brief moves the dense window so that it is centered at the given key */
+  void recenter(const costmap::PixKey& center);
+
+ private:
+  /** \brief grid resolution */
+  const float dl_;
+  /** \brief number of cells of the dense window in x and y direction */
+  const int width_, height_;
+  /** \brief how far the robot may move from the window center [cells] */
+  const int margin_;
+  /** \brief maximum number of grids in the history */
+  const size_t capacity_;
+
+  /** \brief key of the lower left cell of the dense window */
+  costmap::PixKey origin_;
+  bool initialized_ = false;
+
+  /** \brief ring buffer of occupancy grids, oldest at head_ */
+  std::vector<std::vector<uint8_t>> occupancy_;
+  size_t head_ = 0;
+  size_t size_ = 0;
+
+  /** \brief running number of grids each cell is occupied in */
+  std::vector<uint16_t> votes_;
+  /** \brief most recent cost observed in each cell */
+  std::vector<float> values_;
+};
+
+}  // namespace lidar
+}  // namespace vtr
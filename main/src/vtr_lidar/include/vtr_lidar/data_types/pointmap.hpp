@@ -92,6 +92,15 @@ class PointMap : public PointScan<PointT> {
   void update(const PointCloudType& point_cloud,
               const Callback& callback = DefaultUpdateCb());
 
+  /**
+   * \brief Update map with several point clouds, same as calling update() on
+   * each of them in order.
+   * \details Voxels are sharded by key so that each thread inserts the points
+   * of a disjoint set of voxels, keeping the first point of each voxel.
+   */
+  void update(const std::vector<const PointCloudType*>& point_clouds,
+              const int& num_threads);
+
   struct DefaultFilterCb {
     bool operator()(const PointT&) const { return true; }
   };
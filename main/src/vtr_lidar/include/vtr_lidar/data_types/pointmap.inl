@@ -18,6 +18,9 @@
  */
 #pragma once
 
+#include <algorithm>
+#include <unordered_set>
+
 #include "vtr_lidar/data_types/pointmap.hpp"
 
 #include "pcl_conversions/pcl_conversions.h"
@@ -88,6 +91,70 @@ void PointMap<PointT>::update(const PointCloudType& point_cloud,
   }
 }
 
+template <class PointT>
+void PointMap<PointT>::update(
+    const std::vector<const PointCloudType*>& point_clouds,
+    const int& num_threads) {
+  const size_t num_clouds = point_clouds.size();
+  const size_t num_shards = std::max(num_threads, 1);
+
+  // voxel key of every point, and the points of each shard in order
+  std::vector<std::vector<VoxKey>> keys(num_clouds);
+  std::vector<std::vector<size_t>> shard_offsets(num_clouds);
+  std::vector<std::vector<size_t>> shard_points(num_clouds);
+  std::vector<std::vector<char>> keep(num_clouds);
+#pragma omp parallel for schedule(dynamic, 1) num_threads(num_threads)
+  for (size_t c = 0; c < num_clouds; ++c) {
+    const auto& point_cloud = *point_clouds[c];
+    auto& cloud_keys = keys[c];
+    auto& offsets = shard_offsets[c];
+    cloud_keys.resize(point_cloud.size());
+    keep[c].assign(point_cloud.size(), 0);
+    std::vector<size_t> shards(point_cloud.size());
+    offsets.assign(num_shards + 1, 0);
+    for (size_t i = 0; i < point_cloud.size(); ++i) {
+      cloud_keys[i] = getKey(point_cloud[i]);
+      shards[i] = std::hash<VoxKey>()(cloud_keys[i]) % num_shards;
+      ++offsets[shards[i] + 1];
+    }
+    for (size_t s = 0; s < num_shards; ++s) offsets[s + 1] += offsets[s];
+    auto next = offsets;
+    shard_points[c].resize(point_cloud.size());
+    for (size_t i = 0; i < point_cloud.size(); ++i)
+      shard_points[c][next[shards[i]]++] = i;
+  }
+
+  // first point of each new voxel, one shard per thread
+#pragma omp parallel for schedule(static, 1) num_threads(num_threads)
+  for (size_t s = 0; s < num_shards; ++s) {
+    std::unordered_set<VoxKey> shard_samples;
+    for (size_t c = 0; c < num_clouds; ++c) {
+      const auto& offsets = shard_offsets[c];
+      for (size_t j = offsets[s]; j < offsets[s + 1]; ++j) {
+        const auto& i = shard_points[c][j];
+        const auto& key = keys[c][i];
+        if (samples_.count(key) > 0) continue;
+        if (shard_samples.insert(key).second) keep[c][i] = 1;
+      }
+    }
+  }
+
+  // append the kept points in the order they were given
+  size_t num_new_points = 0;
+  for (const auto& cloud_keep : keep)
+    num_new_points += std::count(cloud_keep.begin(), cloud_keep.end(), 1);
+  samples_.reserve(samples_.size() + num_new_points);
+  this->point_cloud_.reserve(this->point_cloud_.size() + num_new_points);
+  for (size_t c = 0; c < num_clouds; ++c) {
+    const auto& point_cloud = *point_clouds[c];
+    for (size_t i = 0; i < point_cloud.size(); ++i) {
+      if (!keep[c][i]) continue;
+      samples_.emplace(keys[c][i], this->point_cloud_.size());
+      this->point_cloud_.push_back(point_cloud[i]);
+    }
+  }
+}
+
 template <class PointT>
 template <class Callback>
 void PointMap<PointT>::filter(const Callback& callback) {
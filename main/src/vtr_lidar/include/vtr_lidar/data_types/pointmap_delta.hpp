@@ -0,0 +1,88 @@
+// Copyright 2021, Autonomous Space Robotics Lab (ASRL)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+/**
+ * \file pointmap_delta.hpp
+ * \author Autonomous Space Robotics Lab (ASRL)
+ */
+#pragma once
+
+#include <cstring>
+
+#include "vtr_lidar/data_types/pointmap.hpp"
+
+#include "vtr_lidar_msgs/msg/point_map_delta.hpp"
+
+namespace vtr {
+namespace lidar {
+
+/**
+ * \brief Submap stored as the voxels added or changed since the submap of a
+ * base vertex, plus the keys of the base voxels removed since. The complete
+ * submap is reconstructed by apply() on the base submap.
+ */
+template <class PointT>
+class PointMapDelta : public PointMap<PointT> {
+ public:
+  using typename PointScan<PointT>::PointCloudType;
+  PTR_TYPEDEFS(PointMapDelta<PointT>);
+
+  using PointMapDeltaMsg = vtr_lidar_msgs::msg::PointMapDelta;
+  /** \brief Static function that constructs this class from ROS2 message */
+  static Ptr fromStorable(const PointMapDeltaMsg& storable);
+  /** \brief Returns the ROS2 message to be stored */
+  PointMapDeltaMsg toStorable() const;
+
+  /** \brief Points in the same voxel are unchanged if all their bytes are */
+  struct DefaultEqualCb {
+    bool operator()(const PointT& base_pt, const PointT& curr_pt) const {
+      return std::memcmp(&base_pt, &curr_pt, sizeof(PointT)) == 0;
+    }
+  };
+  /**
+   * \brief Returns the delta from base, the submap of base_vid, to map.
+   * \details Both maps must have the same voxel size and be expressed in the
+   * same frame, e.g. two snapshots of the odometry sliding map.
+   */
+  template <class Callback = DefaultEqualCb>
+  static Ptr fromMaps(const PointMap<PointT>& base,
+                      const tactic::VertexId& base_vid,
+                      const PointMap<PointT>& map,
+                      const Callback& equal = DefaultEqualCb());
+
+  PointMapDelta(const float& dl, const tactic::VertexId& base_vid,
+                const unsigned& version = PointMap<PointT>::INITIAL)
+      : PointMap<PointT>(dl, version), base_vertex_id_(base_vid) {}
+
+  const tactic::VertexId& base_vertex_id() const { return base_vertex_id_; }
+  const std::vector<pointmap::VoxKey>& removed_voxels() const {
+    return removed_voxels_;
+  }
+
+  /** \brief Reconstructs the complete submap from the base submap. */
+  typename PointMap<PointT>::Ptr apply(const PointMap<PointT>& base) const;
+
+ private:
+  using VoxKey = pointmap::VoxKey;
+
+  /** \brief Vertex of the submap this delta applies to */
+  tactic::VertexId base_vertex_id_;
+  /** \brief Keys of the base voxels removed since */
+  std::vector<VoxKey> removed_voxels_;
+};
+
+}  // namespace lidar
+}  // namespace vtr
+
+#include "vtr_lidar/data_types/pointmap_delta.inl"
@@ -160,13 +160,20 @@ void voxelDownsample(pcl::PointCloud<PointT>& point_cloud,
     i++;
   }
 
-  // Convert hmap to index vector
-  std::vector<int> indices;
-  indices.reserve(samples.size());
-  for (const auto& v : samples) indices.push_back(v.second.idx);
-
-  // Modify the point_cloud
-  point_cloud = pcl::PointCloud<PointT>(point_cloud, indices);
+  // Gather the samples, the scratch cloud is reused across calls but released
+  // when it is far larger than needed, so that it follows the frame size
+  static thread_local std::vector<PointT, Eigen::aligned_allocator<PointT>>
+      sampled;
+  sampled.clear();
+  if (sampled.capacity() > 2 * samples.size())
+    std::vector<PointT, Eigen::aligned_allocator<PointT>>().swap(sampled);
+  sampled.reserve(samples.size());
+  for (const auto& v : samples) sampled.push_back(point_cloud[v.second.idx]);
+
+  // Modify the point_cloud in place so that it keeps its allocated memory
+  point_cloud.points.assign(sampled.begin(), sampled.end());
+  point_cloud.width = point_cloud.points.size();
+  point_cloud.height = 1;
 }
 
 }  // namespace lidar
@@ -24,6 +24,7 @@
 
 #include <pcl/point_cloud.h>
 #include <Eigen/Core>
+#include <Eigen/Geometry>
 
 #include "vtr_common/utils/hash.hpp"
 
@@ -90,6 +91,10 @@ class Mesh2PcdConverter {
     // range
     double range_min = 0.0;
     double range_max = 200.0;
+    // cast every ray against a bounding volume hierarchy of the faces, the
+    // per-face path is kept as reference
+    bool use_bvh = true;
+    int num_threads = 4;
   };
 
   Mesh2PcdConverter(const std::string& filename, const Config& config);
@@ -120,6 +125,21 @@ class Mesh2PcdConverter {
   CandidateRays getCandidateRays(
       const size_t& ind, const std::vector<Eigen::Vector2f>& points) const;
 
+  /** \brief Closest intersection of a ray with the mesh */
+  struct Hit {
+    int theta;  // ray index
+    int phi;    // ray index
+    float rho;
+    Eigen::Vector3f point;
+    Eigen::Vector3f normal;
+  };
+  /**
+   * \brief Returns the closest hit within range of every ray, ordered by
+   * theta then phi, using a bounding volume hierarchy of the faces.
+   */
+  std::vector<Hit> castRays(const std::vector<Eigen::Vector3f>& vertices,
+                            const std::vector<Eigen::Vector3f>& normals) const;
+
  private:
   Config config_;
 
@@ -40,12 +40,6 @@ void Mesh2PcdConverter::addToPcd(pcl::PointCloud<PointT>& pcd,
   for (const auto& n : normals_)
     normals_org.emplace_back((T_pcd_obj * n).head<3>());
 
-  // vertices to polar coordinates
-  std::vector<Eigen::Vector2f> vertices_polar;
-  vertices_polar.reserve(vertices_org.size());
-  for (auto& v : vertices_org)
-    vertices_polar.emplace_back(utils::cart2pol(v).tail<2>());
-
   // construct frustum grid from existing points (assuming from a lidar scan)
   std::unordered_map<Key, std::pair<float, std::vector<size_t>>> key2depthidx;
   for (size_t i = 0; i < pcd.size(); ++i) {
@@ -67,6 +61,48 @@ void Mesh2PcdConverter::addToPcd(pcl::PointCloud<PointT>& pcd,
     if (clear) pcd.at(i).flex24 = 0.0;
   }
 
+  // insert a hit of ray (i, j) into the grid
+  const auto insert = [&](const int& i, const int& j, const float& rho,
+                          const Eigen::Vector3f& q, const Eigen::Vector3f& n) {
+    Key k{i, j};  // theta, phi
+    auto res =
+        key2depthidx.try_emplace(k, rho, std::vector<size_t>{pcd.size()});
+    if (res.second /* insertion is successful */) {
+      PointT pt;
+      pt.getVector3fMap() = q;
+      pt.getNormalVector3fMap() = n.dot(q) > 0 ? -n : n;
+      // distinguish real and fake points
+      pt.flex24 = 1.0;
+      pcd.push_back(pt);
+    } else {
+      auto& depthidx = res.first->second;
+      auto& depth = depthidx.first;
+      auto& idxs = depthidx.second;
+      if (rho < depth) {
+        for (const auto& idx : idxs) {
+          auto& pt = pcd.at(idx);
+          pt.getVector3fMap() = q;
+          pt.getNormalVector3fMap() = n.dot(q) > 0 ? -n : n;
+          // distinguish real and fake points
+          pt.flex24 = 1.0;
+        }
+        depth = rho;
+      }
+    }
+  };
+
+  if (config_.use_bvh) {
+    for (const auto& hit : castRays(vertices_org, normals_org))
+      insert(hit.theta, hit.phi, hit.rho, hit.point, hit.normal);
+    return;
+  }
+
+  // vertices to polar coordinates
+  std::vector<Eigen::Vector2f> vertices_polar;
+  vertices_polar.reserve(vertices_org.size());
+  for (auto& v : vertices_org)
+    vertices_polar.emplace_back(utils::cart2pol(v).tail<2>());
+
   // for each face
   for (size_t ind = 0; ind < faces_.size(); ++ind) {
     const auto& f = faces_.at(ind);
@@ -95,31 +131,7 @@ void Mesh2PcdConverter::addToPcd(pcl::PointCloud<PointT>& pcd,
         if (rho < config_.range_min || rho > config_.range_max) continue;
 
         // insert into the grid
-        Key k{i, j};  // theta, phi
-        auto res =
-            key2depthidx.try_emplace(k, rho, std::vector<size_t>{pcd.size()});
-        if (res.second /* insertion is successful */) {
-          PointT pt;
-          pt.getVector3fMap() = q;
-          pt.getNormalVector3fMap() = n.dot(q) > 0 ? -n : n;
-          // distinguish real and fake points
-          pt.flex24 = 1.0;
-          pcd.push_back(pt);
-        } else {
-          auto& depthidx = res.first->second;
-          auto& depth = depthidx.first;
-          auto& idxs = depthidx.second;
-          if (rho < depth) {
-            for (const auto& idx : idxs) {
-              auto& pt = pcd.at(idx);
-              pt.getVector3fMap() = q;
-              pt.getNormalVector3fMap() = n.dot(q) > 0 ? -n : n;
-              // distinguish real and fake points
-              pt.flex24 = 1.0;
-            }
-            depth = rho;
-          }
-        }
+        insert(i, j, rho, q, n);
       }  // end for each phi
     }    // end for each theta
   }      // end for each face
@@ -73,6 +73,10 @@ class OdometryICPModule : public tactic::BaseModule {
     /// Success criteria
     float min_matched_ratio = 0.4;
 
+    /// per quality level (see tactic::QualityController) scaling of the
+    /// initial and refined iteration caps
+    float quality_iter_scale = 0.7;
+
     bool visualize = false;
 
     static ConstPtr fromROS(const rclcpp::Node::SharedPtr &node,
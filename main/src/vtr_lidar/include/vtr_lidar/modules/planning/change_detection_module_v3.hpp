@@ -25,6 +25,7 @@
 #include "nav_msgs/msg/occupancy_grid.hpp"
 
 #include "vtr_lidar/cache.hpp"
+#include "vtr_lidar/data_types/costmap_history.hpp"
 #include "vtr_tactic/modules/base_module.hpp"
 #include "vtr_tactic/task_queue.hpp"
 
@@ -47,6 +48,11 @@ class ChangeDetectionModuleV3 : public tactic::BaseModule {
     float detection_range = 10.0;
     float search_radius = 1.0;
     float negprob_threshold = 1.0;
+    int num_threads = 4;
+    /// voxel size of the query scan, scaled per quality level (see
+    /// tactic::QualityController)
+    float query_voxel_size = 0.2;
+    float quality_voxel_scale = 1.5;
 
     bool use_prior = false;
     float alpha0 = 1.0;
@@ -59,6 +65,8 @@ class ChangeDetectionModuleV3 : public tactic::BaseModule {
 
     // cost map
     int costmap_history_size = 10;
+    /// minimum number of frames in the history a cell must be an obstacle in
+    int costmap_min_votes = 3;
     float resolution = 1.0;
     float size_x = 20.0;
     float size_y = 20.0;
@@ -76,7 +84,10 @@ class ChangeDetectionModuleV3 : public tactic::BaseModule {
       const Config::ConstPtr &config,
       const std::shared_ptr<tactic::ModuleFactory> &module_factory = nullptr,
       const std::string &name = static_name)
-      : tactic::BaseModule{module_factory, name}, config_(config) {}
+      : tactic::BaseModule{module_factory, name},
+        config_(config),
+        costmap_history_(config->resolution, config->size_x, config->size_y,
+                         config->costmap_history_size) {}
 
  private:
   void run_(tactic::QueryCache &qdata, tactic::OutputCache &output,
@@ -95,9 +106,16 @@ class ChangeDetectionModuleV3 : public tactic::BaseModule {
 
   VTR_REGISTER_MODULE_DEC_TYPE(ChangeDetectionModuleV3);
 
-
-  // Modificatons for Temporal costmap filter
-  std::vector<std::unordered_map<std::pair<float, float>, float>> costmap_history;
+  /** \brief obstacle history for temporal costmap filtering */
+  CostMapHistory costmap_history_;
+  /**
+   * \brief localization vertex, sequence id and chain size of the newest
+   * costmap in the history, which is cleared when the localization run, the
+   * path or the trunk changes since its frame is then no longer the same
+   */
+  tactic::VertexId history_vid_ = tactic::VertexId::Invalid();
+  unsigned history_sid_ = 0;
+  size_t history_chain_size_ = 0;
 };
 
 }  // namespace lidar
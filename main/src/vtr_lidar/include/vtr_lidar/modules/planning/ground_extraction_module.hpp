@@ -61,6 +61,8 @@ class GroundExtractionModule : public tactic::BaseModule {
     size_t num_bins_large = 30;
     float bin_size_large = 3.0;
 
+    int num_threads = 4;
+
     // ogm
     float resolution = 1.0;
     float size_x = 20.0;
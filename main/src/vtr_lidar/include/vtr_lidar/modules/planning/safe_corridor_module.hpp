@@ -26,6 +26,7 @@
 #include "nav_msgs/msg/path.hpp"
 
 #include "vtr_lidar/cache.hpp"
+#include "vtr_lidar/data_types/corridor.hpp"
 #include "vtr_tactic/modules/base_module.hpp"
 #include "vtr_tactic/task_queue.hpp"
 
@@ -74,6 +75,9 @@ class SafeCorridorModule : public tactic::BaseModule {
 
   Config::ConstPtr config_;
 
+  /** \brief corridor ahead of the last localization vertex */
+  CorridorCache corridor_cache_;
+
   /** \brief for visualization only */
   bool publisher_initialized_ = false;
   rclcpp::Publisher<OccupancyGridMsg>::SharedPtr costmap_pub_;
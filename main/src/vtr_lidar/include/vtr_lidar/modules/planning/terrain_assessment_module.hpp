@@ -26,6 +26,7 @@
 #include "nav_msgs/msg/path.hpp"
 
 #include "vtr_lidar/cache.hpp"
+#include "vtr_lidar/data_types/corridor.hpp"
 #include "vtr_tactic/modules/base_module.hpp"
 #include "vtr_tactic/task_queue.hpp"
 
@@ -50,7 +51,9 @@ class TerrainAssessmentModule : public tactic::BaseModule {
     float corridor_width = 1.0;
 
     // terrain assessment
+    bool assess_terrain = false;
     float search_radius = 1.0;
+    int num_threads = 4;
 
     // cost map
     float resolution = 1.0;
@@ -82,8 +85,21 @@ class TerrainAssessmentModule : public tactic::BaseModule {
                  const tactic::Task::Priority &priority,
                  const tactic::Task::DepId &dep_id) override;
 
+  /** \brief localization map in vertex frame with a 2D index over it */
+  struct MapIndex;
+  /** \brief returns the cached index if vid and the map version are unchanged */
+  std::shared_ptr<const MapIndex> getMapIndex(const tactic::VertexId &vid,
+                                              const PointMap<PointWithInfo> &map);
+
   Config::ConstPtr config_;
 
+  /** \brief corridor ahead of the last localization vertex */
+  CorridorCache corridor_cache_;
+
+  /** \brief index of the last assessed localization map */
+  std::mutex index_mutex_;
+  std::shared_ptr<const MapIndex> map_index_;
+
   /** \brief mutex to make publisher thread safe */
   std::mutex mutex_;
 
@@ -18,10 +18,13 @@
  */
 #pragma once
 
+#include <list>
+
 #include "sensor_msgs/msg/point_cloud2.hpp"
 
 #include "vtr_lidar/cache.hpp"
 #include "vtr_lidar/modules/pointmap/intra_exp_merging_module.hpp"
+#include "vtr_lidar/segmentation/ray_tracing.hpp"
 #include "vtr_tactic/modules/base_module.hpp"
 
 namespace vtr {
@@ -53,6 +56,13 @@ class DynamicDetectionModule : public tactic::BaseModule {
     int min_num_observations = 0;
     float dynamic_threshold = 0.5;
 
+    int num_threads = 4;
+    /// use every (1 + level * quality_scan_stride)-th scan at a quality level
+    /// above 0 (see tactic::QualityController)
+    int quality_scan_stride = 1;
+    /// number of rasterized scans kept in memory across calls
+    int frustum_grid_cache_size = 100;
+
     bool visualize = false;
 
     static ConstPtr fromROS(const rclcpp::Node::SharedPtr &node,
@@ -76,8 +86,26 @@ class DynamicDetectionModule : public tactic::BaseModule {
                  const tactic::Task::Priority &priority,
                  const tactic::Task::DepId &dep_id) override;
 
+  /** \brief Rasterized scan of a vertex, reused across map updates */
+  struct CachedScan {
+    PTR_TYPEDEFS(CachedScan);
+    tactic::EdgeTransform T_vertex_this;
+    ray_tracing::FrustumGrid frustum_grid;
+  };
+
+  /** \brief Returns the rasterized scan of a vertex, from cache if possible */
+  CachedScan::ConstPtr getScan(const tactic::Vertex::Ptr &vertex);
+
   Config::ConstPtr config_;
 
+  /** \brief lru cache of rasterized scans */
+  std::mutex scan_cache_mutex_;
+  std::list<tactic::VertexId> scan_cache_lru_;
+  std::unordered_map<
+      tactic::VertexId,
+      std::pair<CachedScan::ConstPtr, std::list<tactic::VertexId>::iterator>>
+      scan_cache_;
+
   /** \brief mutex to make publisher thread safe */
   std::mutex mutex_;
 
@@ -45,6 +45,7 @@ class IntraExpMergingModuleV2 : public tactic::BaseModule {
     float map_voxel_size = 0.2;
     float crop_range_front = 50.0;
     float back_over_front_ratio = 0.5;
+    int num_threads = 4;
 
     // general
     bool visualize = false;
@@ -56,6 +56,10 @@ class PreprocessingModule : public tactic::BaseModule {
     float min_normal_estimate_dist = 2.0;
     float max_normal_estimate_angle = 0.417;  // 5/12 original parameter value
     int cluster_num_sample = 100000;
+    /// per quality level (see tactic::QualityController) scaling of the
+    /// frame voxel size and of the normal score sample budget
+    float quality_voxel_scale = 1.25;
+    float quality_sample_scale = 0.75;
     bool visualize = false;
 
     static ConstPtr fromROS(const rclcpp::Node::SharedPtr &node,
@@ -43,10 +43,16 @@ class LidarPipeline : public tactic::BasePipeline {
     // submap creation thresholds
     double submap_translation_threshold = 0.0;  // in meters
     double submap_rotation_threshold = 0.0;     // in degrees
+    // every n-th submap is stored in full, the ones in between as deltas of
+    // the previous submap (1 stores all of them in full)
+    int full_submap_interval = 10;
 
     bool save_raw_point_cloud = false;
     bool save_nn_point_cloud = false;
 
+    // idle per-frame point clouds kept for reuse by pointCloudPool()
+    int point_cloud_pool_size = 2;
+
     static ConstPtr fromROS(const rclcpp::Node::SharedPtr &node,
                             const std::string &param_prefix);
   };
@@ -102,6 +108,10 @@ class LidarPipeline : public tactic::BasePipeline {
   tactic::VertexId submap_vid_odo_ = tactic::VertexId::Invalid();
   /** \brief transformation from latest submap vertex to robot */
   tactic::EdgeTransform T_sv_m_odo_ = tactic::EdgeTransform(true);
+  /** \brief latest submap, base of the next submap delta */
+  std::shared_ptr<const PointMap<PointWithInfo>> submap_odo_;
+  /** \brief number of submaps stored as deltas since the last full one */
+  int num_submap_deltas_odo_ = 0;
 
   /// localization cached data
   /** \brief Current submap for localization */
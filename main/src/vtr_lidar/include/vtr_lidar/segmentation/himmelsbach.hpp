@@ -18,6 +18,8 @@
  */
 #pragma once
 
+#include <Eigen/Geometry>
+
 #include "pcl/point_cloud.h"
 
 #include "vtr_logging/logging.hpp"
@@ -31,44 +33,53 @@ namespace lidar {
  * since the slope of the first fitted line determines slope of subsequent
  * fitted lines due to its smmooth transition requirement. We partially address
  * this by ignoring the smoothness constraints if the slope is too large.
+ * \note Segments are processed independently, in parallel with num_threads.
  */
 template <class PointT>
 class Himmelsbach {
  public:
   using PointCloud = pcl::PointCloud<PointT>;
-  /** \brief Returns ground point indices computed from Himmelsbach algorithm */
-  std::vector<size_t> operator()(const PointCloud& points) const;
+  /**
+   * \brief Returns ground point indices computed from Himmelsbach algorithm,
+   * in ascending order.
+   * \param T transform applied to the points before segmentation, so that
+   * callers do not have to transform a copy of the point cloud
+   */
+  std::vector<size_t> operator()(
+      const PointCloud& points,
+      const Eigen::Affine3f& T = Eigen::Affine3f::Identity()) const;
 
  private:
   struct Line {
-   public:
-    Line(const PointCloud& points, const std::vector<size_t>& line_pts,
-         const float& m0, const float& b0)
-        : m(m0), b(b0) {
-      const auto ps = points[line_pts.front()];
-      xs = std::sqrt(ps.x * ps.x + ps.y * ps.y);
-      const auto pe = points[line_pts.back()];
-      xe = std::sqrt(pe.x * pe.x + pe.y * pe.y);
-    }
     float m;
     float b;
     float xs;
     float xe;
   };
 
+  /** \brief Running sums of a set of (r, z) points for least squares fits */
+  struct LineFit {
+    void add(const double& r, const double& z) {
+      ++n;
+      sr += r;
+      sz += z;
+      srr += r * r;
+      srz += r * z;
+      szz += z * z;
+    }
+    double n = 0, sr = 0, sz = 0, srr = 0, srz = 0, szz = 0;
+  };
+
  private:
-  /** \brief */
-  std::vector<std::vector<size_t>> sortPointsSegments(
-      const PointCloud& points) const;
-  /** \brief */
-  std::vector<int> sortPointsBins(const PointCloud& points,
-                                  const std::vector<size_t>& segment) const;
+  /** \brief Bins of a segment become their lowest point index, -1 if empty */
+  void sortPointsBins(const std::vector<float>& rs, const std::vector<float>& zs,
+                      const size_t* segment_begin, const size_t* segment_end,
+                      std::vector<int>& bins) const;
   /** \brief */
   using FitLineRval = std::tuple<float, float, float>; /* [m, b, rmse] */
-  FitLineRval fitLine(const PointCloud& points,
-                      const std::vector<size_t>& line_set) const;
+  FitLineRval fitLine(const LineFit& fit) const;
   /** \brief */
-  float distPointLine(const PointT& point, const Line& line) const;
+  float distPointLine(const float& r, const float& z, const Line& line) const;
 
  public:
   float z_offset = 2.13f;
@@ -86,169 +97,180 @@ class Himmelsbach {
   float bin_size_small = 3.0;
   size_t num_bins_large = 30;
   float bin_size_large = 3.0;
+
+  int num_threads = 1;
 };
 
 template <class PointT>
 std::vector<size_t> Himmelsbach<PointT>::operator()(
-    const PointCloud& points) const {
-  std::vector<size_t> ground_idx;
-  // sort points into segments
-  const auto segments = sortPointsSegments(points);
-  // Sort points into bins
-  for (const auto& segment : segments) {
-    if (segment.empty()) continue;
-    //
-    const auto bins = sortPointsBins(points, segment);
-    //
-    std::vector<Line> lines;       // extracted lines
-    std::vector<size_t> line_set;  // current set of point index forming a line
-    size_t i = 0;                  // current bin index
-    while (i < bins.size() - 1) {
-      const auto& idx = bins[i];
-      if (idx < 0) {
-        ++i;
-        continue;
-      } else if (line_set.size() >= 2) {
-        std::vector<size_t> tmp(line_set);
-        tmp.emplace_back(idx);
-        const auto [m, b, rmse] = fitLine(points, tmp);
-        if (std::abs(m) <= Tm &&
-            (std::abs(m) > Tm_small || std::abs(b + z_offset) <= Tb) &&
-            rmse <= Trmse) {
-          line_set.emplace_back(idx);
+    const PointCloud& points, const Eigen::Affine3f& T) const {
+  const size_t num_points = points.size();
+  const auto num_segments =
+      std::max<size_t>(static_cast<size_t>(std::ceil(2 * M_PI / alpha)), 1);
+
+  // range in the xy plane, height and segment of every point
+  std::vector<float> rs(num_points), zs(num_points);
+  std::vector<size_t> segment_ids(num_points);
+#pragma omp parallel for schedule(static) num_threads(num_threads)
+  for (size_t i = 0; i < num_points; ++i) {
+    const Eigen::Vector3f p = T * points[i].getVector3fMap();
+    rs[i] = std::sqrt(p.x() * p.x() + p.y() * p.y());
+    zs[i] = p.z();
+    auto angle = std::atan2(p.y(), p.x());
+    if (angle < 0) angle += 2 * M_PI;
+    segment_ids[i] =
+        std::min<size_t>(std::floor(angle / alpha), num_segments - 1);
+  }
+
+  // sort points into segments, counting sort keeps the point order in each
+  std::vector<size_t> offsets(num_segments + 1, 0);
+  for (const auto& id : segment_ids) ++offsets[id + 1];
+  for (size_t s = 0; s < num_segments; ++s) offsets[s + 1] += offsets[s];
+  std::vector<size_t> segments(num_points);
+  {
+    auto next = offsets;
+    for (size_t i = 0; i < num_points; ++i) segments[next[segment_ids[i]]++] = i;
+  }
+
+  std::vector<char> is_ground(num_points, 0);
+#pragma omp parallel num_threads(num_threads)
+  {
+    std::vector<int> bins;
+    std::vector<Line> lines;  // extracted lines
+#pragma omp for schedule(dynamic, 1)
+    for (size_t s = 0; s < num_segments; ++s) {
+      const auto segment_begin = segments.data() + offsets[s];
+      const auto segment_end = segments.data() + offsets[s + 1];
+      if (segment_begin == segment_end) continue;
+      // sort points into bins
+      sortPointsBins(rs, zs, segment_begin, segment_end, bins);
+      //
+      lines.clear();
+      LineFit line_set;  // current set of points forming a line
+      float line_xs = 0.0;
+      float line_xe = 0.0;
+      const auto close_line = [&]() {
+        const auto [m, b, rmse] = fitLine(line_set);
+        lines.push_back(Line{m, b, line_xs, line_xe});
+        line_set = LineFit();
+      };
+      size_t i = 0;  // current bin index
+      while (i < bins.size() - 1) {
+        const auto& idx = bins[i];
+        if (idx < 0) {
           ++i;
+          continue;
+        } else if (line_set.n >= 2) {
+          auto tmp = line_set;
+          tmp.add(rs[idx], zs[idx]);
+          const auto [m, b, rmse] = fitLine(tmp);
+          if (std::abs(m) <= Tm &&
+              (std::abs(m) > Tm_small || std::abs(b + z_offset) <= Tb) &&
+              rmse <= Trmse) {
+            line_set = tmp;
+            line_xe = rs[idx];
+            ++i;
+          } else {
+            close_line();
+          }
         } else {
-          const auto [m, b, rmse] = fitLine(points, line_set);
-          lines.emplace_back(points, line_set, m, b);
-          line_set.clear();
+          // this mprev condition prevents initialization issues, especially
+          // when first first two representative points are not both on the
+          // ground
+          const auto mprev = lines.empty() ? 0 : std::abs(lines.back().m);
+          const auto dprev = lines.empty()
+                                 ? -1
+                                 : distPointLine(rs[idx], zs[idx], lines.back());
+          if (mprev > Tm || dprev <= Tdprev || lines.empty() || line_set.n > 0) {
+            if (line_set.n == 0) line_xs = rs[idx];
+            line_set.add(rs[idx], zs[idx]);
+            line_xe = rs[idx];
+          }
+          ++i;
         }
-      } else {
-        // this mprev condition prevents initialization issues, especially when
-        // first first two representative points are not both on the ground
-        const auto mprev = lines.empty() ? 0 : std::abs(lines.back().m);
-        const auto dprev =
-            lines.empty() ? -1 : distPointLine(points[idx], lines.back());
-        if (mprev > Tm || dprev <= Tdprev || lines.empty() || !line_set.empty())
-          line_set.emplace_back(idx);
-        ++i;
       }
-    }
-    ///
-    if (line_set.size() >= 2) {
-      const auto [m, b, rmse] = fitLine(points, line_set);
-      lines.emplace_back(points, line_set, m, b);
-      line_set.clear();
-    }
-    // assign points as inliers if they are within a threshold of the ground
-    // model
-    for (const auto& idx : segment) {
-      const auto& point = points[idx];
-      const auto& r = std::sqrt(point.x * point.x + point.y * point.y);
-      // get line that's closest to the candidate point based on distance to
-      // endpoints
-      int closest = -1;
-      float dmin = std::numeric_limits<float>::max();
-      for (size_t i = 0; i < lines.size(); ++i) {
-        const auto& line = lines[i];
-        const auto ds = std::abs(line.xs - r);
-        const auto de = std::abs(line.xe - r);
-        const auto d = std::min(ds, de);
-        if (d < dmin && std::abs(line.m) < Tm) {
-          dmin = d;
-          closest = i;
+      ///
+      if (line_set.n >= 2) close_line();
+      // assign points as inliers if they are within a threshold of the ground
+      // model
+      for (auto it = segment_begin; it != segment_end; ++it) {
+        const auto& r = rs[*it];
+        // get line that's closest to the candidate point based on distance to
+        // endpoints
+        int closest = -1;
+        float dmin = std::numeric_limits<float>::max();
+        for (size_t j = 0; j < lines.size(); ++j) {
+          const auto& line = lines[j];
+          const auto ds = std::abs(line.xs - r);
+          const auto de = std::abs(line.xe - r);
+          const auto d = std::min(ds, de);
+          if (d < dmin && std::abs(line.m) < Tm) {
+            dmin = d;
+            closest = j;
+          }
+        }
+        if (closest >= 0) {
+          const auto e = distPointLine(r, zs[*it], lines[closest]);
+          if (e < tolerance) is_ground[*it] = 1;
         }
-      }
-      if (closest >= 0) {
-        const auto e = distPointLine(point, lines[closest]);
-        if (e < tolerance) ground_idx.emplace_back(idx);
       }
     }
   }
-  return ground_idx;
-}
 
-template <class PointT>
-std::vector<std::vector<size_t>> Himmelsbach<PointT>::sortPointsSegments(
-    const PointCloud& points) const {
-  std::vector<std::vector<size_t>> segments;
-  segments.resize(static_cast<size_t>(std::ceil(2 * M_PI / alpha)));
-  for (size_t i = 0; i < points.size(); ++i) {
-    const auto& point = points[i];
-    auto angle = std::atan2(point.y, point.x);
-    if (angle < 0) angle += 2 * M_PI;
-    size_t idx = std::floor(angle / alpha);
-    segments[idx].push_back(i);
-  }
-  return segments;
+  std::vector<size_t> ground_idx;
+  for (size_t i = 0; i < num_points; ++i)
+    if (is_ground[i]) ground_idx.emplace_back(i);
+  return ground_idx;
 }
 
 template <class PointT>
-std::vector<int> Himmelsbach<PointT>::sortPointsBins(
-    const PointCloud& points, const std::vector<size_t>& segment) const {
+void Himmelsbach<PointT>::sortPointsBins(const std::vector<float>& rs,
+                                         const std::vector<float>& zs,
+                                         const size_t* segment_begin,
+                                         const size_t* segment_end,
+                                         std::vector<int>& bins) const {
   const auto num_bins = num_bins_small + num_bins_large;
   const auto rsmall = rmin + bin_size_small * num_bins_small;
   const auto rlarge = rsmall + bin_size_large * num_bins_large;
-  //
-  std::vector<std::vector<size_t>> bins;
-  bins.resize(num_bins);
-  for (const auto& idx : segment) {
-    const auto& point = points[idx];
-    const auto& r = std::sqrt(point.x * point.x + point.y * point.y);
+  // The point with the lowest z-coordinate in each bin becomes the
+  // representative point
+  bins.assign(num_bins, -1);
+  for (auto it = segment_begin; it != segment_end; ++it) {
+    const auto& r = rs[*it];
     int bin = -1;
     if (rmin <= r && r < rsmall)
       bin = (r - rmin) / bin_size_small;
     else if (rsmall <= r && r < rlarge)
       bin = num_bins_small + (r - rsmall) / bin_size_large;
     //
-    if (bin >= 0) bins[(size_t)bin].push_back(idx);
+    if (bin < 0 || bin >= (int)num_bins) continue;
+    auto& lowest = bins[(size_t)bin];
+    if (lowest < 0 || zs[*it] < zs[lowest]) lowest = (int)*it;
   }
-  // The point with the lowest z-coordinate in each bin becomes the
-  // representative point
-  std::vector<int> bins_out;
-  bins_out.resize(num_bins, -1);
-  for (size_t i = 0; i < num_bins; ++i) {
-    const auto& bin_pts = bins[i];
-    float zmin = std::numeric_limits<float>::max();
-    int lowest = -1;
-    for (const auto& idx : bin_pts) {
-      const auto& point = points[idx];
-      if (point.z < zmin) {
-        zmin = point.z;
-        lowest = idx;
-      }
-    }
-    bins_out[i] = lowest;
-  }
-
-  return bins_out;
 }
 
 template <class PointT>
-auto Himmelsbach<PointT>::fitLine(const PointCloud& points,
-                                  const std::vector<size_t>& line_set) const
-    -> FitLineRval {
-  Eigen::MatrixXf A(line_set.size(), 2);
-  Eigen::VectorXf b(line_set.size());
-  for (size_t i = 0; i < line_set.size(); ++i) {
-    const auto& point = points[line_set[i]];
-    A(i, 0) = std::sqrt(point.x * point.x + point.y * point.y);
-    A(i, 1) = 1;
-    b(i) = point.z;
-  }
-  const auto soln = (A.transpose() * A).ldlt().solve(A.transpose() * b).eval();
-  const auto err = A * soln - b;
-  const auto mse = ((err.transpose() * err) / (float)line_set.size()).value();
-  const auto rmse = std::sqrt(mse);
-  return std::make_tuple(soln(0), soln(1), rmse);
+auto Himmelsbach<PointT>::fitLine(const LineFit& fit) const -> FitLineRval {
+  // closed form least squares of z = m * r + b from the running sums
+  const auto& n = fit.n;
+  const auto det = n * fit.srr - fit.sr * fit.sr;
+  double m = 0.0;
+  if (std::abs(det) > std::numeric_limits<double>::epsilon() * n * fit.srr)
+    m = (n * fit.srz - fit.sr * fit.sz) / det;
+  const double b = (fit.sz - m * fit.sr) / n;
+  // sum of squared residuals expanded in terms of the sums
+  const auto sse = fit.szz + m * m * fit.srr + n * b * b -
+                   2.0 * m * fit.srz - 2.0 * b * fit.sz + 2.0 * m * b * fit.sr;
+  const auto rmse = std::sqrt(std::max(sse, 0.0) / n);
+  return std::make_tuple((float)m, (float)b, (float)rmse);
 }
 
 template <class PointT>
-float Himmelsbach<PointT>::distPointLine(const PointT& point,
+float Himmelsbach<PointT>::distPointLine(const float& r, const float& z,
                                          const Line& line) const {
-  const auto r = std::sqrt(point.x * point.x + point.y * point.y);
   const auto line_z = line.m * r + line.b;
-  return std::abs(line_z - point.z) / std::sqrt(line.m * line.m + 1);
+  return std::abs(line_z - z) / std::sqrt(line.m * line.m + 1);
 }
 
 }  // namespace lidar
-}  // namespace vtr
\ No newline at end of file
+}  // namespace vtr
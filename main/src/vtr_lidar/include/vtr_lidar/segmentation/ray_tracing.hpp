@@ -80,100 +80,109 @@ inline ray_tracing::PixKey getKey(const PointT& p, const float& phi_res,
                              (int)std::floor(p.phi / phi_res));
 }
 
+namespace ray_tracing {
+
+/**
+ * \brief Range image of a scan: closest range observed in each pixel, in the
+ * frame of the scan. Only depends on the scan and the resolution, so it can be
+ * built once and reused for every query map.
+ */
+class FrustumGrid {
+ public:
+  using Ptr = std::shared_ptr<FrustumGrid>;
+  using ConstPtr = std::shared_ptr<const FrustumGrid>;
+
+  template <class PointT>
+  FrustumGrid(const pcl::PointCloud<PointT>& reference, const float& phi_res,
+              const float& theta_res)
+      : phi_res_(phi_res), theta_res_(theta_res) {
+    grid_.reserve(reference.size());
+    for (const auto& p : reference) {
+      const auto k = getKey(p, phi_res, theta_res);
+      /// always choose the closer point
+      const auto res = grid_.try_emplace(k, p.rho);
+      if (!res.second) res.first->second = std::min(p.rho, res.first->second);
+    }
+  }
+
+  /** \brief Returns the closest range in the pixel, or nullptr if empty */
+  const float* find(const PixKey& k) const {
+    const auto it = grid_.find(k);
+    return it == grid_.end() ? nullptr : &it->second;
+  }
+
+  float phi_res() const { return phi_res_; }
+  float theta_res() const { return theta_res_; }
+  size_t size() const { return grid_.size(); }
+
+ private:
+  float phi_res_;
+  float theta_res_;
+  std::unordered_map<PixKey, float> grid_;
+};
+
+}  // namespace ray_tracing
+
+/**
+ * \brief Ray-traces the query map against one reference scan and accumulates
+ * the number of (dynamic) observations of each query point into the given
+ * buffers, so that several scans can be processed concurrently and reduced
+ * afterwards. The query map is left untouched.
+ * \param[in] frustum_grid range image of the reference scan
+ * \param[in] query point map whose points are being observed
+ * \param[in] T_ref_qry transform from query map to reference scan frame
+ * \param[in,out] total_obs per query point total observation count
+ * \param[in,out] dynamic_obs per query point dynamic observation count
+ */
 template <class PointT>
-void detectDynamicObjects(
-    const pcl::PointCloud<PointT>& /* point scan */ reference,
-    pcl::PointCloud<PointT>& /* point map */ query,
-    const lgmath::se3::TransformationWithCovariance& T_ref_qry,
-    const float& phi_res, const float& theta_res, const float& max_num_obs,
-    const float& min_num_obs, const float& /* dynamic_threshold */) {
+void accumulateDynamicObservations(
+    const ray_tracing::FrustumGrid& frustum_grid,
+    const pcl::PointCloud<PointT>& /* point map */ query,
+    const lgmath::se3::Transformation& T_ref_qry, float* total_obs,
+    float* dynamic_obs) {
+  const auto phi_res = frustum_grid.phi_res();
+  const auto theta_res = frustum_grid.theta_res();
   // Parameters
   const auto inner_ratio = 1 - std::max(phi_res, theta_res) / 2;
-  (void)inner_ratio;
   const auto outer_ratio = 1 + std::max(phi_res, theta_res) / 2;
-  // this takes into account surface orientation
-#if false
-  const auto tighter_inner_ratio =
-      1 - (std::max(phi_res, theta_res) / 2) / std::tan(M_PI / 12);
-#endif
-
-  // Create and fill in the frustum grid
-  std::unordered_map<ray_tracing::PixKey, float> frustum_grid;
-  for (const auto& p : reference) {
-    const auto k = getKey(p, phi_res, theta_res);
-    if (frustum_grid.count(k) == 0)
-      frustum_grid[k] = p.rho;
-    else
-      /// // always choose the further point
-      // frustum_grid.at(k) = std::max(p.x, frustum_grid.at(k));
-      /// always choose the closer point
-      frustum_grid.at(k) = std::min(p.rho, frustum_grid.at(k));
-  }
 
-  // Perform a transformation in to the frame of the reference point cloud
-  auto query_tmp = query;  // copy
-  const auto T_ref_qry_mat = T_ref_qry.matrix().cast<float>();
-  // eigen mapping
-  auto points_mat =
-      query_tmp.getMatrixXfMap(4, PointT::size(), PointT::cartesian_offset());
-  auto normal_mat =
-      query_tmp.getMatrixXfMap(4, PointT::size(), PointT::normal_offset());
-  // transform to the local frame of this vertex
-  points_mat = T_ref_qry_mat * points_mat;
-  normal_mat = T_ref_qry_mat * normal_mat;
-  ray_tracing::cart2pol(query_tmp);
-
-  // for honeycomb fov specifically
-#if false
-  float theta_min = 7 * M_PI / 18;
-  float theta_max = 15 * M_PI / 18;
-  float phi_min = -M_PI / 2;
-  float phi_max = M_PI / 2;
-#endif
-  float rho_max = 50.0f;
-
-  //
+  const Eigen::Matrix4f T_ref_qry_mat = T_ref_qry.matrix().cast<float>();
+  const Eigen::Matrix3f C_ref_qry = T_ref_qry_mat.topLeftCorner<3, 3>();
+  const Eigen::Vector3f r_qry_ref_in_ref = T_ref_qry_mat.topRightCorner<3, 1>();
+
   for (size_t i = 0; i < query.size(); i++) {
-    auto& qp = query[i];           // point with dynamic obs to be updated
-    const auto& p = query_tmp[i];  // expressed in the reference scan frame
+    // expressed in the reference scan frame, without copying the query map
+    const Eigen::Vector3f p =
+        C_ref_qry * query[i].getVector3fMap() + r_qry_ref_in_ref;
 
     // compute polar coordinates and key
-    const auto k = getKey(p, phi_res, theta_res);
+    const float rho = p.norm();
+    const float theta = std::atan2(p.head<2>().norm(), p.z());
+    const float phi = std::atan2(p.y(), p.x());
+    const ray_tracing::PixKey k((int)std::floor(theta / theta_res),
+                                (int)std::floor(phi / phi_res));
 
-    if (!frustum_grid.count(k)) continue;
-    // if ((!frustum_grid.count(k)) &&
-    //     (p.phi < phi_min || p.phi > phi_max || p.theta < theta_min ||
-    //      p.theta > theta_max))
-    //   continue;
-    const float rho_ref = frustum_grid.count(k) ? frustum_grid.at(k) : rho_max;
+    const float* rho_ref = frustum_grid.find(k);
+    if (rho_ref == nullptr) continue;
 
     // the current point is occluded in the current observation
-    if (p.rho > (rho_ref * outer_ratio)) continue;
+    if (rho > (*rho_ref * outer_ratio)) continue;
 
     // update this point only when we have a good normal
-    float angle = std::acos(std::min(
-        std::abs(p.getVector3fMap().dot(p.getNormalVector3fMap()) / p.rho),
-        1.0f));
+    const Eigen::Vector3f n = C_ref_qry * query[i].getNormalVector3fMap();
+    float angle = std::acos(std::min(std::abs(p.dot(n) / rho), 1.0f));
     if (angle > 5 * M_PI / 12) continue;
 
-#if true
-    qp.total_obs++;
-    if (p.rho < (rho_ref * inner_ratio)) qp.dynamic_obs++;
-#else
-    if (qp.total_obs < max_num_obs) {
-      qp.dynamic_obs += (p.rho < (rho_ref * inner_ratio));
-      qp.total_obs++;
-    } else {
-      if (p.rho < (rho_ref * inner_ratio))
-        qp.dynamic_obs = std::min(max_num_obs, qp.dynamic_obs + 1);
-      else
-        qp.dynamic_obs = std::max(0.f, qp.dynamic_obs - 1);
-    }
-#endif
+    total_obs[i]++;
+    if (rho < (*rho_ref * inner_ratio)) dynamic_obs[i]++;
   }
+}
 
-  for (size_t i = 0; i < query.size(); i++) {
-    auto& qp = query[i];  // point with dynamic obs to be updated
+/** \brief Converts accumulated observation counts into static scores */
+template <class PointT>
+void updateStaticScores(pcl::PointCloud<PointT>& query,
+                        const float& max_num_obs, const float& min_num_obs) {
+  for (auto& qp : query) {
     // update the scores
     if (qp.total_obs < min_num_obs)
       qp.static_score = 0.0;
@@ -184,5 +193,26 @@ void detectDynamicObjects(
   }
 }
 
+template <class PointT>
+void detectDynamicObjects(
+    const pcl::PointCloud<PointT>& /* point scan */ reference,
+    pcl::PointCloud<PointT>& /* point map */ query,
+    const lgmath::se3::TransformationWithCovariance& T_ref_qry,
+    const float& phi_res, const float& theta_res, const float& max_num_obs,
+    const float& min_num_obs, const float& /* dynamic_threshold */) {
+  const ray_tracing::FrustumGrid frustum_grid(reference, phi_res, theta_res);
+
+  std::vector<float> total_obs(query.size(), 0.f);
+  std::vector<float> dynamic_obs(query.size(), 0.f);
+  accumulateDynamicObservations(frustum_grid, query, T_ref_qry,
+                                total_obs.data(), dynamic_obs.data());
+
+  for (size_t i = 0; i < query.size(); i++) {
+    query[i].total_obs += total_obs[i];
+    query[i].dynamic_obs += dynamic_obs[i];
+  }
+  updateStaticScores(query, max_num_obs, min_num_obs);
+}
+
 }  // namespace lidar
 }  // namespace vtr
\ No newline at end of file
@@ -0,0 +1,91 @@
+// Copyright 2021, Autonomous Space Robotics Lab (ASRL)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+/**
+ * \file point_cloud_pool.hpp
+ * \brief Pool of the per-frame point clouds and helpers filling them.
+ * \details Point clouds stored in LidarQueryCache should be acquired from
+ * pointCloudPool() so that their memory is reused by the following frames.
+ *
+ * \author Autonomous Space Robotics Lab (ASRL)
+ */
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+
+#include "vtr_lidar/data_types/point.hpp"
+#include "vtr_tactic/object_pool.hpp"
+
+namespace vtr {
+namespace lidar {
+
+using PointCloudPool = tactic::ObjectPool<pcl::PointCloud<PointWithInfo>>;
+
+/**
+ * \brief Process-wide pool of point clouds, a released point cloud is cleared
+ * but keeps its capacity, unless the capacity is far above the size of the
+ * recently released clouds (e.g. after an unusually large frame).
+ * \note Keeps 2 idle clouds by default, LidarPipeline sets the bound from its
+ * point_cloud_pool_size parameter.
+ */
+inline PointCloudPool &pointCloudPool() {
+  // largest recently released size, decays by 1/8 per release
+  static std::atomic<size_t> recent_size = 0;
+  static const auto pool = PointCloudPool::MakeShared(
+      2, [](pcl::PointCloud<PointWithInfo> &point_cloud) {
+        const size_t prev_size = recent_size.load();
+        const size_t size =
+            std::max(point_cloud.size(), prev_size - prev_size / 8);
+        recent_size.store(size);
+        point_cloud.clear();
+        point_cloud.header = pcl::PCLHeader();
+        if (point_cloud.points.capacity() > 2 * size) {
+          decltype(point_cloud.points) points;
+          points.reserve(size);
+          point_cloud.points.swap(points);
+        }
+      });
+  return *pool;
+}
+
+/**
+ * \brief Copies the points of src for which pred(point, index) is true into
+ * dst, replacing its content. Avoids the index vector and the temporary cloud
+ * of pcl::PointCloud(src, indices).
+ */
+template <class PointT, class Predicate>
+void copyPointsIf(const pcl::PointCloud<PointT> &src,
+                  pcl::PointCloud<PointT> &dst, const Predicate &pred) {
+  dst.clear();
+  dst.header = src.header;
+  dst.reserve(src.size());
+  for (size_t i = 0; i < src.size(); ++i)
+    if (pred(src[i], i)) dst.push_back(src[i]);
+}
+
+/** \brief Keeps only the points for which pred(point, index) is true. */
+template <class PointT, class Predicate>
+void keepPointsIf(pcl::PointCloud<PointT> &point_cloud, const Predicate &pred) {
+  size_t num_kept = 0;
+  for (size_t i = 0; i < point_cloud.size(); ++i) {
+    if (!pred(point_cloud[i], i)) continue;
+    if (num_kept != i) point_cloud[num_kept] = point_cloud[i];
+    ++num_kept;
+  }
+  point_cloud.resize(num_kept);
+}
+
+}  // namespace lidar
+}  // namespace vtr
@@ -0,0 +1,550 @@
+// Copyright 2021, Autonomous Space Robotics Lab (ASRL)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+/**
+ * \file replay_benchmark.cpp
+ * \brief Offline teach and repeat benchmark of the lidar pipeline.
+ * \details Replays a recorded point cloud stream, or synthetic point clouds,
+ * through Tactic into a temporary pose graph without spinning the node, then
+ * writes per-module latency percentiles, peak memory and the number of bytes
+ * written to the graph to a json file. The node is only used for parameters;
+ * every visualization is disabled so that no publisher is ever created.
+ *
+ * Usage:
+ *   ros2 run vtr_lidar vtr_lidar_replay_benchmark --ros-args
+ *     --params-file <pipeline config> --params-file config/lidar_benchmark.yaml
+ *
+ * \author Autonomous Space Robotics Lab (ASRL)
+ */
+#include <sys/resource.h>
+#include <unistd.h>
+
+#include <cmath>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <random>
+#include <thread>
+
+#include "rclcpp/rclcpp.hpp"
+#include "sensor_msgs/point_cloud2_iterator.hpp"
+
+#include "vtr_common/timing/stopwatch.hpp"
+#include "vtr_common/utils/filesystem.hpp"
+#include "vtr_lidar/cache.hpp"
+#include "vtr_lidar/pipeline.hpp"
+#include "vtr_logging/logging_init.hpp"
+#include "vtr_storage/stream/data_stream_accessor.hpp"
+#include "vtr_tactic/modules/module_profiler.hpp"
+#include "vtr_tactic/pipelines/factory.hpp"
+#include "vtr_tactic/tactic.hpp"
+
+namespace fs = std::filesystem;
+using namespace vtr;
+using namespace vtr::common;
+using namespace vtr::logging;
+using namespace vtr::tactic;
+
+namespace {
+
+using PointCloudMsg = sensor_msgs::msg::PointCloud2;
+
+struct BenchmarkConfig {
+  /** \brief json file the results are written to */
+  std::string output_file = "lidar_benchmark.json";
+  /** \brief where the temporary graph is created, empty for the system tmp */
+  std::string data_dir = "";
+  bool keep_graph = false;
+
+  /** \brief vtr_storage directory of the recorded streams, empty: synthetic */
+  std::string input_dir = "";
+  std::string teach_stream = "lidar";
+  /** \brief stream to repeat, empty to repeat the teach stream */
+  std::string repeat_stream = "";
+  /** \brief frames per run, -1 for all frames of the stream */
+  int max_frames = -1;
+
+  /** \brief xi of the transform from robot to lidar */
+  std::vector<double> T_lidar_robot = std::vector<double>(6, 0.0);
+
+  /** \brief synthetic point clouds, a robot driving down a corridor of poles */
+  struct {
+    int num_frames = 200;
+    double period = 0.1;
+    double speed = 1.0;
+    int num_rings = 64;
+    int num_azimuths = 1024;
+    double lateral_offset = 0.2;
+  } synthetic;
+
+  static BenchmarkConfig fromROS(const rclcpp::Node::SharedPtr &node,
+                                 const std::string &prefix = "benchmark") {
+    BenchmarkConfig config;
+    // clang-format off
+    config.output_file = node->declare_parameter<std::string>(prefix + ".output_file", config.output_file);
+    config.data_dir = node->declare_parameter<std::string>(prefix + ".data_dir", config.data_dir);
+    config.keep_graph = node->declare_parameter<bool>(prefix + ".keep_graph", config.keep_graph);
+    config.input_dir = node->declare_parameter<std::string>(prefix + ".input_dir", config.input_dir);
+    config.teach_stream = node->declare_parameter<std::string>(prefix + ".teach_stream", config.teach_stream);
+    config.repeat_stream = node->declare_parameter<std::string>(prefix + ".repeat_stream", config.repeat_stream);
+    config.max_frames = node->declare_parameter<int>(prefix + ".max_frames", config.max_frames);
+    config.T_lidar_robot = node->declare_parameter<std::vector<double>>(prefix + ".T_lidar_robot", config.T_lidar_robot);
+    config.synthetic.num_frames = node->declare_parameter<int>(prefix + ".synthetic.num_frames", config.synthetic.num_frames);
+    config.synthetic.period = node->declare_parameter<double>(prefix + ".synthetic.period", config.synthetic.period);
+    config.synthetic.speed = node->declare_parameter<double>(prefix + ".synthetic.speed", config.synthetic.speed);
+    config.synthetic.num_rings = node->declare_parameter<int>(prefix + ".synthetic.num_rings", config.synthetic.num_rings);
+    config.synthetic.num_azimuths = node->declare_parameter<int>(prefix + ".synthetic.num_azimuths", config.synthetic.num_azimuths);
+    config.synthetic.lateral_offset = node->declare_parameter<double>(prefix + ".synthetic.lateral_offset", config.synthetic.lateral_offset);
+    // clang-format on
+    if (config.T_lidar_robot.size() != 6)
+      throw std::invalid_argument("benchmark.T_lidar_robot must have 6 entries");
+    return config;
+  }
+};
+
+/** \brief source of the point clouds of one run */
+class FrameSource {
+ public:
+  virtual ~FrameSource() = default;
+  /** \return nullptr when the run is over */
+  virtual PointCloudMsg::SharedPtr next() = 0;
+};
+
+/** \brief point clouds recorded by vtr_storage, read one at a time */
+class StreamSource : public FrameSource {
+ public:
+  StreamSource(const std::string &input_dir, const std::string &stream,
+               const int &max_frames)
+      : accessor_(input_dir, stream, "sensor_msgs/msg/PointCloud2"),
+        max_frames_(max_frames) {}
+
+  PointCloudMsg::SharedPtr next() override {
+    if (max_frames_ >= 0 && index_ > max_frames_) return nullptr;
+    const auto msg = accessor_.readAtIndex(index_++);  // index starts at 1
+    if (msg == nullptr) return nullptr;
+    return std::make_shared<PointCloudMsg>(msg->sharedLocked().get().getData());
+  }
+
+ private:
+  storage::DataStreamAccessor<PointCloudMsg> accessor_;
+  const int max_frames_;
+  int index_ = 1;
+};
+
+/**
+ * \brief Velodyne-like scans of a straight corridor with walls on both sides
+ * and a row of poles along each wall, the poles constrain the motion along the
+ * corridor. Generated deterministically so that results are comparable.
+ */
+class SyntheticSource : public FrameSource {
+ public:
+  SyntheticSource(const BenchmarkConfig &config, const Timestamp &start,
+                  const double &lateral_offset)
+      : config_(config),
+        num_frames_(config.max_frames >= 0
+                        ? std::min(config.max_frames,
+                                   config.synthetic.num_frames)
+                        : config.synthetic.num_frames),
+        start_(start),
+        lateral_offset_(lateral_offset) {}
+
+  PointCloudMsg::SharedPtr next() override {
+    if (frame_ >= num_frames_) return nullptr;
+    return scan(frame_++);
+  }
+
+ private:
+  static constexpr double sensor_height = 1.8;
+  static constexpr double half_width = 10.0;
+  static constexpr double pole_spacing = 6.0;
+  static constexpr double pole_radius = 0.3;
+  static constexpr double min_range = 1.0;
+  static constexpr double max_range = 80.0;
+
+  PointCloudMsg::SharedPtr scan(const int &frame) {
+    const auto &cfg = config_.synthetic;
+    const Timestamp stamp_ns =
+        start_ + (Timestamp)std::llround(frame * cfg.period * 1e9);
+    const double stamp = (double)stamp_ns * 1e-9;
+    const double px = frame * cfg.period * cfg.speed;
+    const double py = lateral_offset_;
+
+    auto msg = std::make_shared<PointCloudMsg>();
+    msg->header.stamp.sec = (int32_t)(stamp_ns / 1000000000);
+    msg->header.stamp.nanosec = (uint32_t)(stamp_ns % 1000000000);
+    msg->header.frame_id = "lidar";
+
+    sensor_msgs::PointCloud2Modifier modifier(*msg);
+    // clang-format off
+    modifier.setPointCloud2Fields(5,
+        "x", 1, sensor_msgs::msg::PointField::FLOAT32,
+        "y", 1, sensor_msgs::msg::PointField::FLOAT32,
+        "z", 1, sensor_msgs::msg::PointField::FLOAT32,
+        "intensity", 1, sensor_msgs::msg::PointField::FLOAT32,
+        "t", 1, sensor_msgs::msg::PointField::FLOAT64);
+    // clang-format on
+    modifier.resize(cfg.num_rings * cfg.num_azimuths);
+
+    sensor_msgs::PointCloud2Iterator<float> iter_x(*msg, "x"),
+        iter_y(*msg, "y"), iter_z(*msg, "z"), iter_i(*msg, "intensity");
+    sensor_msgs::PointCloud2Iterator<double> iter_t(*msg, "t");
+
+    // poles that may be hit from this position
+    const int first_pole = (int)std::floor((px - max_range) / pole_spacing);
+    const int last_pole = (int)std::ceil((px + max_range) / pole_spacing);
+    const double pole_y = half_width - 2.0;
+
+    size_t num_points = 0;
+    for (int a = 0; a < cfg.num_azimuths; ++a) {
+      const double azimuth = 2.0 * M_PI * a / cfg.num_azimuths;
+      const double point_time = stamp + cfg.period * a / cfg.num_azimuths;
+      for (int r = 0; r < cfg.num_rings; ++r) {
+        // hdl64 vertical field of view
+        const double elevation =
+            (2.0 - 26.9 * r / std::max(cfg.num_rings - 1, 1)) * M_PI / 180.0;
+        const double dx = std::cos(elevation) * std::cos(azimuth);
+        const double dy = std::cos(elevation) * std::sin(azimuth);
+        const double dz = std::sin(elevation);
+
+        double range = max_range;
+        float intensity = 0.f;
+        const auto hit = [&](const double &t, const float &i) {
+          if (t < min_range || t >= range) return;
+          range = t;
+          intensity = i;
+        };
+        if (dz < 0) hit(-sensor_height / dz, 20.f);  // ground
+        if (dy > 0) hit((half_width - py) / dy, 80.f);  // walls
+        if (dy < 0) hit((-half_width - py) / dy, 80.f);
+        const double dxy2 = dx * dx + dy * dy;
+        for (int k = first_pole; k <= last_pole; ++k) {
+          for (const double cy : {-pole_y, pole_y}) {
+            // 2d ray-circle intersection, nearest root
+            const double ox = px - k * pole_spacing, oy = py - cy;
+            const double b = ox * dx + oy * dy;
+            const double c = ox * ox + oy * oy - pole_radius * pole_radius;
+            const double disc = b * b - dxy2 * c;
+            if (disc >= 0) hit((-b - std::sqrt(disc)) / dxy2, 150.f);
+          }
+        }
+        if (range >= max_range) continue;
+
+        range += noise_(rng_);
+        *iter_x = (float)(range * dx);
+        *iter_y = (float)(range * dy);
+        *iter_z = (float)(range * dz);
+        *iter_i = intensity;
+        *iter_t = point_time;
+        ++iter_x, ++iter_y, ++iter_z, ++iter_i, ++iter_t, ++num_points;
+      }
+    }
+    modifier.resize(num_points);
+    return msg;
+  }
+
+  const BenchmarkConfig &config_;
+  const int num_frames_;
+  const Timestamp start_;
+  const double lateral_offset_;
+  int frame_ = 0;
+
+  std::mt19937 rng_{42};
+  std::normal_distribution<double> noise_{0.0, 0.01};
+};
+
+/** \brief peak resident set size of this process [bytes] */
+size_t peakRSS() {
+  struct rusage usage;
+  getrusage(RUSAGE_SELF, &usage);
+  return (size_t)usage.ru_maxrss * 1024;  // kilobytes on linux
+}
+
+/** \brief total size of all files under path [bytes] */
+size_t directorySize(const fs::path &path) {
+  size_t size = 0;
+  std::error_code ec;
+  for (const auto &entry : fs::recursive_directory_iterator(path, ec))
+    if (entry.is_regular_file(ec)) size += entry.file_size(ec);
+  return size;
+}
+
+/**
+ * \brief Parameters of the command line for this node with every
+ * visualization turned off, so that modules never create publishers.
+ */
+std::vector<rclcpp::Parameter> parameterOverrides(const std::string &name) {
+  auto node = rclcpp::Node::make_shared(name);
+  std::vector<rclcpp::Parameter> parameters;
+  for (const auto &[param_name, value] :
+       node->get_node_parameters_interface()->get_parameter_overrides()) {
+    const bool visualize =
+        param_name.size() >= 9 &&
+        param_name.compare(param_name.size() - 9, 9, "visualize") == 0;
+    if (visualize && value.get_type() == rclcpp::ParameterType::PARAMETER_BOOL)
+      parameters.emplace_back(param_name, false);
+    else
+      parameters.emplace_back(param_name, value);
+  }
+  parameters.emplace_back("tactic.visualize", false);
+  return parameters;
+}
+
+struct PhaseResult {
+  std::string name;
+  int frames = 0;
+  /** \brief time spent in the pipeline, excluding reading the input [s] */
+  double pipeline_time = 0.0;
+  size_t peak_rss = 0;
+  size_t storage_bytes = 0;
+  bool localized = false;
+  std::vector<ModuleProfiler::Summary> modules;
+};
+
+/** \brief escapes a string for a json string literal */
+std::string jsonEscape(const std::string &str) {
+  std::string escaped;
+  escaped.reserve(str.size());
+  for (const char c : str) {
+    switch (c) {
+      case '"':
+        escaped += "\\\"";
+        break;
+      case '\\':
+        escaped += "\\\\";
+        break;
+      case '\n':
+        escaped += "\\n";
+        break;
+      case '\t':
+        escaped += "\\t";
+        break;
+      default:
+        if (static_cast<unsigned char>(c) < 0x20) {
+          char buf[8];
+          std::snprintf(buf, sizeof(buf), "\\u%04x", (unsigned)c);
+          escaped += buf;
+        } else {
+          escaped += c;
+        }
+    }
+  }
+  return escaped;
+}
+
+void writeResults(const std::string &filename, const BenchmarkConfig &config,
+                  const std::vector<PhaseResult> &phases,
+                  const size_t &storage_bytes) {
+  std::ofstream ofs(filename);
+  if (!ofs.is_open())
+    throw std::runtime_error("Could not open the output file " + filename);
+  ofs << "{\n";
+  const auto input =
+      config.input_dir.empty() ? "synthetic" : jsonEscape(config.input_dir);
+  ofs << "  \"input\": \"" << input << "\",\n";
+  ofs << "  \"hardware_concurrency\": " << std::thread::hardware_concurrency()
+      << ",\n";
+  ofs << "  \"phases\": [\n";
+  for (size_t i = 0; i < phases.size(); ++i) {
+    const auto &phase = phases[i];
+    ofs << "    {\n";
+    ofs << "      \"name\": \"" << jsonEscape(phase.name) << "\",\n";
+    ofs << "      \"frames\": " << phase.frames << ",\n";
+    ofs << "      \"pipeline_time_s\": " << phase.pipeline_time << ",\n";
+    ofs << "      \"frame_rate_hz\": "
+        << (phase.pipeline_time > 0 ? phase.frames / phase.pipeline_time : 0)
+        << ",\n";
+    ofs << "      \"peak_rss_bytes\": " << phase.peak_rss << ",\n";
+    ofs << "      \"storage_bytes\": " << phase.storage_bytes << ",\n";
+    ofs << "      \"localized\": " << std::boolalpha << phase.localized
+        << ",\n";
+    ofs << "      \"modules\": [\n";
+    for (size_t j = 0; j < phase.modules.size(); ++j) {
+      const auto &module = phase.modules[j];
+      ofs << "        {\"name\": \"" << jsonEscape(module.name)
+          << "\", \"count\": " << module.count
+          << ", \"mean_ms\": " << module.mean << ", \"p50_ms\": " << module.p50
+          << ", \"p99_ms\": " << module.p99 << ", \"max_ms\": " << module.max
+          << "}" << (j + 1 < phase.modules.size() ? "," : "") << "\n";
+    }
+    ofs << "      ]\n";
+    ofs << "    }" << (i + 1 < phases.size() ? "," : "") << "\n";
+  }
+  ofs << "  ],\n";
+  ofs << "  \"peak_rss_bytes\": " << peakRSS() << ",\n";
+  ofs << "  \"storage_bytes\": " << storage_bytes << "\n";
+  ofs << "}\n";
+}
+
+}  // namespace
+
+int main(int argc, char **argv) {
+  rclcpp::init(argc, argv);
+  const std::string node_name = "replay_benchmark";
+  auto node = rclcpp::Node::make_shared(
+      node_name, rclcpp::NodeOptions()
+                     .use_global_arguments(false)
+                     .parameter_overrides(parameterOverrides(node_name)));
+
+  /// Setup logging, debug logs would dominate the measured latencies
+  const auto log_enabled = node->declare_parameter<std::vector<std::string>>(
+      "log_enabled", std::vector<std::string>{});
+  configureLogging("", false, log_enabled);
+
+  // disable eigen multi-threading
+  Eigen::setNbThreads(1);
+
+  const auto config = BenchmarkConfig::fromROS(node);
+
+  /// Temporary graph
+  const auto data_dir =
+      config.data_dir.empty()
+          ? fs::temp_directory_path()
+          : fs::path{utils::expand_user(utils::expand_env(config.data_dir))};
+  fs::create_directories(data_dir);
+  std::string graph_dir_template = data_dir / "vtr_benchmark_XXXXXX";
+  if (mkdtemp(graph_dir_template.data()) == nullptr)
+    throw std::runtime_error("Could not create a graph directory in " +
+                             data_dir.string());
+  const fs::path graph_dir{graph_dir_template};
+  CLOG(INFO, "benchmark") << "Writing the benchmark graph to " << graph_dir;
+
+  Eigen::Matrix<double, 6, 1> xi_lidar_robot(config.T_lidar_robot.data());
+  EdgeTransform T_lidar_robot(lgmath::se3::vec2tran(xi_lidar_robot));
+  T_lidar_robot.setCovariance(Eigen::Matrix<double, 6, 6>::Zero());
+
+  std::vector<PhaseResult> phases;
+  {
+    auto graph = Graph::MakeShared((graph_dir / "graph").string(), false);
+    auto pipeline_factory = std::make_shared<ROSPipelineFactory>(node);
+    auto pipeline = pipeline_factory->get("pipeline");
+    auto output = pipeline->createOutputCache();
+    output->node = node;
+    auto tactic = std::make_shared<Tactic>(Tactic::Config::fromROS(node),
+                                           pipeline, output, graph);
+
+    const auto run_phase = [&](const std::string &name, FrameSource &source,
+                               const std::function<void()> &on_frame) {
+      PhaseResult result;
+      result.name = name;
+      const auto storage_before = directorySize(graph_dir);
+      ModuleProfiler::reset();
+      ModuleProfiler::enable();
+
+      common::timing::Stopwatch<> timer(false);
+      while (const auto msg = source.next()) {
+        auto qdata = std::make_shared<lidar::LidarQueryCache>();
+        qdata->node = node;
+        qdata->stamp.emplace((Timestamp)msg->header.stamp.sec * 1000000000 +
+                             msg->header.stamp.nanosec);
+        qdata->env_info.emplace(EnvInfo());
+        qdata->pointcloud_msg = msg;
+        qdata->T_s_r.emplace(T_lidar_robot);
+
+        timer.start();
+        tactic->input(qdata);
+        timer.stop();
+        ++result.frames;
+        if (on_frame) on_frame();
+      }
+      // wait for the pipeline and the async tasks to finish
+      timer.start();
+      { auto lock = tactic->lockPipeline(); }
+      timer.stop();
+
+      ModuleProfiler::enable(false);
+      result.pipeline_time = timer.count<std::chrono::microseconds>() * 1e-6;
+      result.modules = ModuleProfiler::summarize();
+      result.localized = tactic->isLocalized();
+      {
+        auto lock = tactic->lockPipeline();
+        tactic->setPipeline(PipelineMode::Idle);
+        tactic->finishRun();
+      }
+      result.storage_bytes = directorySize(graph_dir) - storage_before;
+      result.peak_rss = peakRSS();
+      CLOG(INFO, "benchmark")
+          << name << ": " << result.frames << " frames in "
+          << result.pipeline_time << "s, peak rss " << result.peak_rss
+          << " bytes, " << result.storage_bytes << " bytes written";
+      return result;
+    };
+
+    const auto make_source = [&](const std::string &stream,
+                                 const Timestamp &start,
+                                 const double &lateral_offset)
+        -> std::unique_ptr<FrameSource> {
+      if (config.input_dir.empty())
+        return std::make_unique<SyntheticSource>(config, start,
+                                                 lateral_offset);
+      return std::make_unique<StreamSource>(
+          utils::expand_user(utils::expand_env(config.input_dir)), stream,
+          config.max_frames);
+    };
+
+    /// Teach
+    const Timestamp teach_start = 1600000000 * (Timestamp)1e9;
+    {
+      auto lock = tactic->lockPipeline();
+      tactic->setPipeline(PipelineMode::TeachBranch);
+      tactic->addRun(true);
+    }
+    auto teach_source = make_source(config.teach_stream, teach_start, 0.0);
+    phases.push_back(run_phase("teach", *teach_source, nullptr));
+
+    /// Repeat along the taught path
+    VertexId::Vector path;
+    for (VertexId vid(0, 0); graph->contains(vid);
+         vid = VertexId(0, vid.minorId() + 1))
+      path.push_back(vid);
+    if (path.empty()) {
+      CLOG(ERROR, "benchmark") << "No vertex was created during teach.";
+    } else {
+      {
+        auto lock = tactic->lockPipeline();
+        tactic->setPipeline(PipelineMode::RepeatMetricLoc);
+        tactic->addRun(false);
+        tactic->setTrunk(path.front());
+        tactic->setPath(path, 0, EdgeTransform(true), false);
+      }
+      // follow the path once localized, as the state machine does
+      bool following = false;
+      const auto on_frame = [&] {
+        if (following || !tactic->isLocalized()) return;
+        auto lock = tactic->lockPipeline();
+        tactic->setPipeline(PipelineMode::RepeatFollow);
+        following = true;
+      };
+      const Timestamp repeat_start =
+          teach_start + (Timestamp)(phases.front().frames *
+                                    config.synthetic.period * 1e9) +
+          (Timestamp)60e9;
+      auto repeat_source = make_source(
+          config.repeat_stream.empty() ? config.teach_stream
+                                       : config.repeat_stream,
+          repeat_start, config.synthetic.lateral_offset);
+      phases.push_back(run_phase("repeat", *repeat_source, on_frame));
+      {
+        auto lock = tactic->lockPipeline();
+        tactic->setPath(VertexId::Vector(), 0, EdgeTransform(true), false);
+      }
+    }
+  }  // tactic and graph are destroyed here, which saves the graph
+
+  writeResults(config.output_file, config, phases, directorySize(graph_dir));
+  CLOG(INFO, "benchmark") << "Results written to " << config.output_file;
+
+  if (!config.keep_graph) fs::remove_all(graph_dir);
+  rclcpp::shutdown();
+  return 0;
+}
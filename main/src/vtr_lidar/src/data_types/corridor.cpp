@@ -0,0 +1,177 @@
+// Copyright 2021, Autonomous Space Robotics Lab (ASRL)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+/**
+ * \file corridor.cpp
+ * \author Autonomous Space Robotics Lab (ASRL)
+ */
+#include "vtr_lidar/data_types/corridor.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace vtr {
+namespace lidar {
+
+Corridor::Corridor(const std::vector<Eigen::Matrix4d>& T_curr_query_vec,
+                   const float& dl, const float& size_x, const float& size_y,
+                   const float& bucket_size)
+    : T_curr_query_vec_(T_curr_query_vec),
+      bucket_size_(bucket_size),
+      dl_(dl) {
+  xy_.reserve(T_curr_query_vec_.size());
+  for (const auto& T_curr_query : T_curr_query_vec_)
+    xy_.emplace_back(T_curr_query.block<2, 1>(0, 3).cast<float>());
+  if (xy_.empty()) return;
+
+  // one bucket of margin so that cell centers on the border are covered
+  grid_min_ = -Eigen::Vector2f(std::abs(size_x), std::abs(size_y)) / 2.0f -
+              Eigen::Vector2f::Constant(bucket_size_);
+  grid_width_ = (int)std::ceil(std::abs(size_x) / bucket_size_) + 2;
+  grid_height_ = (int)std::ceil(std::abs(size_y) / bucket_size_) + 2;
+
+  // A segment can only be the closest to a point in the bucket if its lower
+  // bound distance to the bucket is not larger than the smallest upper bound
+  // over all segments. The upper bound is exact (distance to a segment is
+  // convex, so its maximum over the bucket is at a corner), the lower bound
+  // is the distance to the bucket center minus the half diagonal.
+  const float half_diagonal = bucket_size_ * std::sqrt(2.0f) / 2.0f;
+  const size_t num_segments = numSegments();
+  std::vector<float> lower(num_segments);
+  offsets_.reserve(grid_width_ * grid_height_ + 1);
+  offsets_.emplace_back(0);
+  for (int y = 0; y < grid_height_; ++y) {
+    for (int x = 0; x < grid_width_; ++x) {
+      const Eigen::Vector2f corner =
+          grid_min_ + Eigen::Vector2f(x, y) * bucket_size_;
+      const Eigen::Vector2f center =
+          corner + Eigen::Vector2f::Constant(bucket_size_ / 2.0f);
+      float min_upper = std::numeric_limits<float>::max();
+      for (size_t i = 0; i < num_segments; ++i) {
+        lower[i] = distance(center, i) - half_diagonal;
+        float upper = 0.0f;
+        for (int c = 0; c < 4; ++c) {
+          const Eigen::Vector2f p =
+              corner + Eigen::Vector2f(c & 1, c >> 1) * bucket_size_;
+          upper = std::max(upper, distance(p, i));
+        }
+        min_upper = std::min(min_upper, upper);
+      }
+      for (size_t i = 0; i < num_segments; ++i)
+        if (lower[i] <= min_upper) candidates_.emplace_back(i);
+      offsets_.emplace_back(candidates_.size());
+    }
+  }
+
+  // distance at the cell centers, same layout as DenseCostMap
+  width_ = 2 * std::round(std::abs(size_x) / 2.0f / dl_) + 1;
+  height_ = 2 * std::round(std::abs(size_y) / 2.0f / dl_) + 1;
+  origin_x_ = -std::round(std::abs(size_x) / 2.0f / dl_);
+  origin_y_ = -std::round(std::abs(size_y) / 2.0f / dl_);
+  distances_.resize(width_ * height_);
+  for (int y = 0; y < height_; ++y)
+    for (int x = 0; x < width_; ++x)
+      distances_[x + y * width_] =
+          search({(x + origin_x_) * dl_, (y + origin_y_) * dl_});
+}
+
+float Corridor::distance(const Eigen::Vector2f& q) const {
+  if (xy_.empty()) return std::numeric_limits<float>::infinity();
+
+  const int x = (int)std::round(q(0) / dl_) - origin_x_;
+  const int y = (int)std::round(q(1) / dl_) - origin_y_;
+  if (x >= 0 && x < width_ && y >= 0 && y < height_ &&
+      q(0) == (x + origin_x_) * dl_ && q(1) == (y + origin_y_) * dl_)
+    return distances_[x + y * width_];
+  return search(q);
+}
+
+float Corridor::search(const Eigen::Vector2f& q) const {
+  float min_dist = std::numeric_limits<float>::max();
+  const Eigen::Vector2f b = (q - grid_min_) / bucket_size_;
+  const int x = (int)std::floor(b(0));
+  const int y = (int)std::floor(b(1));
+  if (x >= 0 && x < grid_width_ && y >= 0 && y < grid_height_) {
+    const auto k = x + y * grid_width_;
+    for (size_t c = offsets_[k]; c < offsets_[k + 1]; ++c)
+      min_dist = std::min(min_dist, distance(q, candidates_[c]));
+  } else {
+    for (size_t i = 0; i < numSegments(); ++i)
+      min_dist = std::min(min_dist, distance(q, i));
+  }
+  return min_dist;
+}
+
+float Corridor::distance(const Eigen::Vector2f& q, const size_t& i) const {
+  // use the following convention (all points are (x, y)):
+  //   q  - query point (center of the cell)
+  //   p  - projected point on to the line segment
+  //   xs - start point of the line segment
+  //   xe - end point of the line segment
+  const auto& xs = xy_[i];
+  const auto& xe = xy_[std::min(i + 1, xy_.size() - 1)];
+  const float sq_length = (xe - xs).squaredNorm();
+  if (sq_length == 0.0f) return (q - xs).norm();
+  const float alpha =
+      std::clamp((q - xs).dot(xe - xs) / sq_length, 0.0f, 1.0f);
+  return (q - (xs + alpha * (xe - xs))).norm();
+}
+
+CorridorCache::CorridorCache(const float& lookahead_distance,
+                             const float& dl, const float& size_x,
+                             const float& size_y)
+    : lookahead_distance_(lookahead_distance),
+      dl_(dl),
+      size_x_(size_x),
+      size_y_(size_y) {}
+
+Corridor::ConstPtr CorridorCache::get(const tactic::LocalizationChain& chain,
+                                      const unsigned& curr_sid) {
+  // privileged poses of the vertices within the lookahead distance
+  std::vector<Eigen::Matrix4d> T_w_query_vec;
+  {
+    auto lock = chain.guard();
+    const auto distance = chain.dist(curr_sid);
+    for (auto query_sid = curr_sid;
+         query_sid < chain.size() &&
+         (chain.dist(query_sid) - distance) < lookahead_distance_;
+         ++query_sid)
+      T_w_query_vec.emplace_back(chain.pose(query_sid).matrix());
+  }
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (corridor_ != nullptr && sid_ == curr_sid &&
+      T_w_query_vec_ == T_w_query_vec)
+    return corridor_;
+
+  CLOG(DEBUG, "lidar.corridor")
+      << "Rebuilding the corridor ahead of sequence id " << curr_sid;
+  // rebase the path onto the current vertex
+  std::vector<Eigen::Matrix4d> T_curr_query_vec;
+  T_curr_query_vec.reserve(T_w_query_vec.size());
+  if (!T_w_query_vec.empty()) {
+    const Eigen::Matrix4d T_curr_w = T_w_query_vec.front().inverse();
+    for (const auto& T_w_query : T_w_query_vec)
+      T_curr_query_vec.emplace_back(T_curr_w * T_w_query);
+  }
+  sid_ = curr_sid;
+  T_w_query_vec_ = std::move(T_w_query_vec);
+  corridor_ = std::make_shared<const Corridor>(T_curr_query_vec, dl_,
+                                               size_x_, size_y_);
+  return corridor_;
+}
+
+}  // namespace lidar
+}  // namespace vtr
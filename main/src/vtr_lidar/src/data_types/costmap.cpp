@@ -18,7 +18,7 @@
  */
 #include "vtr_lidar/data_types/costmap.hpp"
 
-#include "pcl_conversions/pcl_conversions.h"
+#include "sensor_msgs/point_cloud2_iterator.hpp"
 
 namespace vtr {
 namespace lidar {
@@ -50,7 +50,7 @@ bool BaseCostMap::contains(const costmap::PixKey& k) const {
 DenseCostMap::DenseCostMap(const float& dl, const float& size_x,
                            const float& size_y, const float& default_value)
     : BaseCostMap(dl, size_x, size_y, default_value),
-      values_(Eigen::MatrixXf::Constant(width_, height_, default_value_)) {}
+      values_(Grid::Constant(height_, width_, default_value_)) {}
 
 auto DenseCostMap::toCostMapMsg() const -> CostMapMsg {
   CostMapMsg costmap_msg;
@@ -61,36 +61,48 @@ auto DenseCostMap::toCostMapMsg() const -> CostMapMsg {
   T_this_ros_mat(1, 3) = origin_.y * dl_ - dl_ / 2.0;
   tactic::EdgeTransform T_this_ros(T_this_ros_mat);
 
-  // clamp and fill in data
-  std::vector<int8_t> data(width_ * height_, default_value_);
-  for (int x = 0; x < width_; ++x)
-    for (int y = 0; y < height_; ++y)
-      data[x + y * width_] =
-          (int8_t)(std::clamp(values_(x, y), 0.f, 1.f) * 100);
-
   costmap_msg.info.resolution = dl_;
   costmap_msg.info.width = width_;
   costmap_msg.info.height = height_;
   costmap_msg.info.origin = common::conversions::toPoseMessage(T_this_ros);
-  costmap_msg.data = data;
+
+  // clamp and fill in data, same memory layout so done in one pass
+  costmap_msg.data.resize(values_.size());
+  Eigen::Map<Eigen::Array<int8_t, Eigen::Dynamic, 1>> data(
+      costmap_msg.data.data(), values_.size());
+  const Eigen::Map<const Eigen::ArrayXf> values(values_.data(),
+                                                values_.size());
+  data = (values.max(0.f).min(1.f) * 100.f).cast<int8_t>();
 
   return costmap_msg;
 }
 
 auto DenseCostMap::toPointCloudMsg() const -> PointCloudMsg {
-  pcl::PointCloud<pcl::PointXYZI> pointcloud;
-  for (int x = 0; x < width_; ++x)
-    for (int y = 0; y < height_; ++y) {
-      pcl::PointXYZI point;
-      point.x = (x + origin_.x) * dl_;
-      point.y = (y + origin_.y) * dl_;
-      point.z = 0.0f;
-      point.intensity = values_(x, y);
-      pointcloud.emplace_back(point);
-    }
-
   PointCloudMsg pointcloud_msg;
-  pcl::toROSMsg(pointcloud, pointcloud_msg);
+
+  // write x, y, z, intensity directly into the message buffer
+  sensor_msgs::PointCloud2Modifier modifier(pointcloud_msg);
+  modifier.setPointCloud2Fields(
+      4, "x", 1, sensor_msgs::msg::PointField::FLOAT32,  //
+      "y", 1, sensor_msgs::msg::PointField::FLOAT32,     //
+      "z", 1, sensor_msgs::msg::PointField::FLOAT32,     //
+      "intensity", 1, sensor_msgs::msg::PointField::FLOAT32);
+  modifier.resize(values_.size());
+  pointcloud_msg.is_dense = true;
+
+  Eigen::Map<Eigen::Matrix4Xf> points(
+      reinterpret_cast<float*>(pointcloud_msg.data.data()), 4, values_.size());
+  for (int y = 0; y < height_; ++y) {
+    auto row = points.middleCols(y * width_, width_);
+    row.row(0) =
+        (Eigen::RowVectorXf::LinSpaced(width_, 0, width_ - 1).array() +
+         origin_.x) *
+        dl_;
+    row.row(1).setConstant((y + origin_.y) * dl_);
+    row.row(2).setZero();
+    row.row(3) = values_.row(y);
+  }
+
   return pointcloud_msg;
 }
 
@@ -98,54 +110,43 @@ void DenseCostMap::update(
     const std::unordered_map<costmap::PixKey, float>& values) {
   for (const auto& val : values) {
     const auto shifted_k = val.first - origin_;
-    values_(shifted_k.x, shifted_k.y) = val.second;
+    values_(shifted_k.y, shifted_k.x) = val.second;
   }
 }
 
 // Modification by Jordy for updating dense maps from unordered maps with pairs of points ()
-void DenseCostMap::update(
-    const std::unordered_map<std::pair<float,float>, float> values) {    
-    
-  for (const auto val : values) {
-    auto shifted_k = costmap::PixKey(val.first.first / dl_, val.first.second / dl_) - origin_;
-
-    //const auto shifted_k_x = val.first.first;// - origin_.x;
-    //const auto shifted_k_y = val.first.second;// - origin_.y;
-
+void DenseCostMap::update(const XY2ValueMap& values) {
+  if (values.empty()) return;
 
-    // Handling an error where after transformations the shifted key could fall outside the costmap area resulting in an eigen indexing error
-    if (shifted_k.x >= size_x_ / dl_)
-    {
-      shifted_k.x = size_x_ / dl_;
-    }
-    if (shifted_k.x <= -1)
-    {
-      shifted_k.x = 0;
-    }
-    if (shifted_k.y >= size_y_ / dl_)
-    {
-      shifted_k.y = size_y_ / dl_;
-    }
-    if (shifted_k.y <= -1)
-    {
-      shifted_k.y = 0;
-    }
+  // gather positions so that the keys are computed and clamped in one batch
+  Eigen::Array2Xf xy(2, values.size());
+  Eigen::ArrayXf vals(values.size());
+  Eigen::Index n = 0;
+  for (const auto& val : values) {
+    xy(0, n) = val.first.first;
+    xy(1, n) = val.first.second;
+    vals(n++) = val.second;
+  }
 
-    values_(shifted_k.x, shifted_k.y) = val.second;
+  // Handling an error where after transformations the shifted key could fall
+  // outside the costmap area resulting in an eigen indexing error
+  Eigen::Array2Xi keys = (xy / dl_).cast<int>();
+  keys.row(0) = (keys.row(0) - origin_.x).max(0).min(width_ - 1);
+  keys.row(1) = (keys.row(1) - origin_.y).max(0).min(height_ - 1);
 
-  }
+  for (Eigen::Index i = 0; i < n; ++i) values_(keys(1, i), keys(0, i)) = vals(i);
 }
 
 auto DenseCostMap::filter(const float& threshold) const -> XY2ValueMap {
   XY2ValueMap filtered;
   filtered.reserve(values_.size());
-  for (int x = 0; x < width_; ++x)
-    for (int y = 0; y < height_; ++y) {
-      if (values_(x, y) < threshold) continue;
+  for (int y = 0; y < height_; ++y)
+    for (int x = 0; x < width_; ++x) {
+      if (values_(y, x) < threshold) continue;
       const auto key = costmap::PixKey(x, y) + origin_;
       filtered.emplace(
           std::make_pair((float)(key.x * dl_), (float)(key.y * dl_)),
-          values_(x, y));
+          values_(y, x));
     }
   return filtered;
 }
@@ -153,7 +154,7 @@ auto DenseCostMap::filter(const float& threshold) const -> XY2ValueMap {
 float DenseCostMap::at(const costmap::PixKey& k) const {
   if (!contains(k)) return default_value_;
   const auto shifted_k = k - origin_;
-  return values_(shifted_k.x, shifted_k.y);
+  return values_(shifted_k.y, shifted_k.x);
 }
 
 SparseCostMap::SparseCostMap(const float& dl, const float& size_x,
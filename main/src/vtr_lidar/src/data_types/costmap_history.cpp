@@ -0,0 +1,158 @@
+// Copyright 2021, Autonomous Space Robotics Lab (ASRL)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+/**
+ * \file costmap_history.cpp
+ * \author Autonomous Space Robotics Lab (ASRL)
+ */
+#include "vtr_lidar/data_types/costmap_history.hpp"
+
+namespace vtr {
+namespace lidar {
+
+namespace {
+
+/// half extent of a (possibly rotated) cost map in cells
+int halfDiagonal(const float& dl, const float& size_x, const float& size_y) {
+  return (int)std::ceil(std::hypot(size_x, size_y) / 2.0f / dl);
+}
+
+/// 2D part of a 3D transform, applied to points in the z=0 plane
+struct Transform2D {
+  Transform2D(const tactic::EdgeTransform& T) {
+    const Eigen::Matrix4f T_mat = T.matrix().cast<float>();
+    C = T_mat.topLeftCorner<2, 2>();
+    r = T_mat.block<2, 1>(0, 3);
+  }
+  Eigen::Vector2f operator()(const Eigen::Vector2f& p) const {
+    return C * p + r;
+  }
+  Eigen::Matrix2f C;
+  Eigen::Vector2f r;
+};
+
+}  // namespace
+
+CostMapHistory::CostMapHistory(const float& dl, const float& size_x,
+                               const float& size_y, const size_t& capacity)
+    : dl_(dl),
+      width_(2 * (halfDiagonal(dl, size_x, size_y) +
+                  halfDiagonal(dl, size_x, size_y) / 2 + 1) +
+             1),
+      height_(width_),
+      margin_(halfDiagonal(dl, size_x, size_y) / 2 + 1),
+      capacity_(std::max<size_t>(capacity, 1)),
+      occupancy_(capacity_, std::vector<uint8_t>(width_ * height_, 0)),
+      votes_(width_ * height_, 0),
+      values_(width_ * height_, 0.0f) {}
+
+void CostMapHistory::push(const DenseCostMap& costmap, const float& threshold,
+                          const tactic::EdgeTransform& T_ref_c) {
+  const Transform2D T(T_ref_c);
+
+  // keep the cost map origin (the robot) within the margin of the window
+  const auto center = getKey(T.r(0), T.r(1));
+  if (!initialized_) {
+    origin_ = center - costmap::PixKey(width_ / 2, height_ / 2);
+    initialized_ = true;
+  } else {
+    const auto offset = center - origin_ - costmap::PixKey(width_ / 2, height_ / 2);
+    if (std::abs(offset.x) > margin_ || std::abs(offset.y) > margin_)
+      recenter(center);
+  }
+
+  // pick the slot of the newest grid, evicting the oldest one if full
+  size_t slot;
+  if (size_ < capacity_) {
+    slot = (head_ + size_) % capacity_;
+    ++size_;
+  } else {
+    slot = head_;
+    head_ = (head_ + 1) % capacity_;
+    auto& evicted = occupancy_[slot];
+    for (size_t i = 0; i < evicted.size(); ++i) votes_[i] -= evicted[i];
+    std::fill(evicted.begin(), evicted.end(), 0);
+  }
+
+  // add the obstacle cells of the newest cost map
+  auto& occupancy = occupancy_[slot];
+  costmap.visit([&](const Eigen::Vector2f& p, const float& value) {
+    if (value < threshold) return;
+    const Eigen::Vector2f p_ref = T(p + Eigen::Vector2f::Constant(dl_ / 2));
+    const auto idx = index(getKey(p_ref(0), p_ref(1)));
+    if (idx < 0) return;
+    if (occupancy[idx] == 0) {
+      occupancy[idx] = 1;
+      ++votes_[idx];
+    }
+    values_[idx] = value;
+  });
+}
+
+void CostMapHistory::filter(DenseCostMap& costmap,
+                            const tactic::EdgeTransform& T_ref_c,
+                            const int& min_votes) const {
+  if (!initialized_) return;
+  const Transform2D T(T_ref_c);
+  costmap.update([&](const Eigen::Vector2f& p, float& value) {
+    const Eigen::Vector2f p_ref = T(p + Eigen::Vector2f::Constant(dl_ / 2));
+    const auto idx = index(getKey(p_ref(0), p_ref(1)));
+    if (idx < 0 || votes_[idx] < min_votes) return;
+    value = values_[idx];
+  });
+}
+
+void CostMapHistory::clear() {
+  for (auto& occupancy : occupancy_)
+    std::fill(occupancy.begin(), occupancy.end(), 0);
+  std::fill(votes_.begin(), votes_.end(), 0);
+  std::fill(values_.begin(), values_.end(), 0.0f);
+  head_ = 0;
+  size_ = 0;
+  initialized_ = false;
+}
+
+int CostMapHistory::votes(const float& x, const float& y) const {
+  if (!initialized_) return 0;
+  const auto idx = index(getKey(x, y));
+  return idx < 0 ? 0 : votes_[idx];
+}
+
+void CostMapHistory::recenter(const costmap::PixKey& center) {
+  const auto new_origin = center - costmap::PixKey(width_ / 2, height_ / 2);
+  const auto d = new_origin - origin_;
+
+  const auto shift = [&](auto& grid) {
+    using T = typename std::decay_t<decltype(grid)>::value_type;
+    std::decay_t<decltype(grid)> shifted(grid.size(), T(0));
+    for (int y = 0; y < height_; ++y) {
+      const int old_y = y + d.y;
+      if (old_y < 0 || old_y >= height_) continue;
+      for (int x = 0; x < width_; ++x) {
+        const int old_x = x + d.x;
+        if (old_x < 0 || old_x >= width_) continue;
+        shifted[x + y * width_] = grid[old_x + old_y * width_];
+      }
+    }
+    grid.swap(shifted);
+  };
+
+  for (auto& occupancy : occupancy_) shift(occupancy);
+  shift(votes_);
+  shift(values_);
+  origin_ = new_origin;
+}
+
+}  // namespace lidar
+}  // namespace vtr
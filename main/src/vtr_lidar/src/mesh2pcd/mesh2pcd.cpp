@@ -18,7 +18,11 @@
  */
 #include "vtr_lidar/mesh2pcd/mesh2pcd.hpp"
 
+#include <algorithm>
 #include <fstream>
+#include <numeric>
+
+#include <Eigen/Geometry>
 
 #include "vtr_logging/logging.hpp"
 
@@ -26,6 +30,133 @@ namespace vtr {
 namespace lidar {
 namespace mesh2pcd {
 
+namespace {
+
+/** \brief Bounding volume hierarchy over triangular faces */
+class FaceBVH {
+ public:
+  FaceBVH(const std::vector<Eigen::Vector3f>& vertices,
+          const std::vector<std::array<int, 4>>& faces)
+      : vertices_(vertices), faces_(faces) {
+    order_.resize(faces_.size());
+    std::iota(order_.begin(), order_.end(), 0);
+    centroids_.reserve(faces_.size());
+    for (const auto& f : faces_)
+      centroids_.emplace_back(
+          (vertices_[f[0]] + vertices_[f[1]] + vertices_[f[2]]) / 3.0f);
+    nodes_.reserve(2 * faces_.size() / leaf_size + 1);
+    if (!faces_.empty()) build(0, faces_.size());
+  }
+
+  /**
+   * \brief Calls leaf(face index) for the faces of every node intersected by
+   * the ray from the origin along dir, nearest nodes first. leaf returns the
+   * current closest distance, nodes beyond it are skipped.
+   */
+  template <class Func>
+  void traverse(const Eigen::Vector3f& dir, float tmax, Func&& leaf) const {
+    if (nodes_.empty()) return;
+    int stack[64];
+    int top = 0;
+    stack[top++] = 0;
+    while (top > 0) {
+      const auto& node = nodes_[stack[--top]];
+      float tnear = 0;
+      if (!intersect(node.box, dir, tmax, tnear)) continue;
+      if (node.left < 0) {
+        for (int k = node.begin; k < node.end; ++k)
+          tmax = std::min(tmax, leaf(order_[k]));
+        continue;
+      }
+      // visit the nearer child first
+      float tl = 0, tr = 0;
+      const bool hl = intersect(nodes_[node.left].box, dir, tmax, tl);
+      const bool hr = intersect(nodes_[node.right].box, dir, tmax, tr);
+      if (hl && hr) {
+        stack[top++] = tl < tr ? node.right : node.left;
+        stack[top++] = tl < tr ? node.left : node.right;
+      } else if (hl) {
+        stack[top++] = node.left;
+      } else if (hr) {
+        stack[top++] = node.right;
+      }
+    }
+  }
+
+ private:
+  static constexpr int leaf_size = 4;
+  /// boxes are padded so that rounding in the hit point never misses a face
+  static constexpr float padding = 1e-3;
+
+  struct Node {
+    Eigen::AlignedBox3f box;
+    int left = -1;  // leaf if negative
+    int right = -1;
+    int begin = 0;
+    int end = 0;
+  };
+
+  int build(const int begin, const int end) {
+    const int id = nodes_.size();
+    nodes_.emplace_back();
+    Eigen::AlignedBox3f box, centroid_box;
+    for (int k = begin; k < end; ++k) {
+      const auto& f = faces_[order_[k]];
+      for (int v = 0; v < 3; ++v) box.extend(vertices_[f[v]]);
+      centroid_box.extend(centroids_[order_[k]]);
+    }
+    box.min().array() -= padding;
+    box.max().array() += padding;
+    nodes_[id].box = box;
+    nodes_[id].begin = begin;
+    nodes_[id].end = end;
+    if (end - begin <= leaf_size) return id;
+
+    // median split along the longest axis of the centroids
+    int axis;
+    centroid_box.sizes().maxCoeff(&axis);
+    const int mid = begin + (end - begin) / 2;
+    std::nth_element(order_.begin() + begin, order_.begin() + mid,
+                     order_.begin() + end, [&](const int& a, const int& b) {
+                       return centroids_[a][axis] < centroids_[b][axis];
+                     });
+    const int left = build(begin, mid);
+    const int right = build(mid, end);
+    nodes_[id].left = left;
+    nodes_[id].right = right;
+    return id;
+  }
+
+  /** \brief slab test of the ray from the origin along dir within [0, tmax] */
+  static bool intersect(const Eigen::AlignedBox3f& box,
+                        const Eigen::Vector3f& dir, const float& tmax,
+                        float& tnear) {
+    float t0 = 0, t1 = tmax;
+    for (int a = 0; a < 3; ++a) {
+      if (dir[a] == 0.0f) {
+        if (box.min()[a] > 0 || box.max()[a] < 0) return false;
+        continue;
+      }
+      float ta = box.min()[a] / dir[a];
+      float tb = box.max()[a] / dir[a];
+      if (ta > tb) std::swap(ta, tb);
+      t0 = std::max(t0, ta);
+      t1 = std::min(t1, tb);
+      if (t0 > t1) return false;
+    }
+    tnear = t0;
+    return true;
+  }
+
+  const std::vector<Eigen::Vector3f>& vertices_;
+  const std::vector<std::array<int, 4>>& faces_;
+  std::vector<Eigen::Vector3f> centroids_;
+  std::vector<int> order_;
+  std::vector<Node> nodes_;
+};
+
+}  // namespace
+
 Mesh2PcdConverter::Mesh2PcdConverter(const std::string& filename,
                                      const Config& config)
     : config_(config) {
@@ -140,6 +271,62 @@ auto Mesh2PcdConverter::getCandidateRays(
   return rays;
 }
 
+auto Mesh2PcdConverter::castRays(
+    const std::vector<Eigen::Vector3f>& vertices,
+    const std::vector<Eigen::Vector3f>& normals) const -> std::vector<Hit> {
+  const FaceBVH bvh(vertices, faces_);
+
+  // same rays as the per-face path
+  const int theta_lb = std::ceil(config_.theta_min / config_.theta_res);
+  const int theta_ub = std::floor(config_.theta_max / config_.theta_res);
+  const int phi_lb = std::ceil(config_.phi_min / config_.phi_res);
+  const int phi_ub = std::floor(config_.phi_max / config_.phi_res);
+  const int num_thetas = std::max(theta_ub - theta_lb + 1, 0);
+
+  std::vector<std::vector<Hit>> hits(num_thetas);
+#pragma omp parallel for schedule(dynamic, 1) num_threads(config_.num_threads)
+  for (int ti = 0; ti < num_thetas; ++ti) {
+    const int i = theta_lb + ti;
+    for (int j = phi_lb; j <= phi_ub; ++j) {
+      const auto theta = i * config_.theta_res;
+      const auto phi = j * config_.phi_res;
+      const auto l = utils::pol2cart(Eigen::Vector3f(1.0, theta, phi));
+
+      // closest face, ties go to the first face as in the per-face path
+      int closest = -1;
+      float rho_min = std::numeric_limits<float>::max();
+      Eigen::Vector3f q_min;
+      bvh.traverse(l, config_.range_max + 1.0f, [&](const int& ind) {
+        const auto& f = faces_[ind];
+        const auto& p1 = vertices[f[0]];
+        const auto& p2 = vertices[f[1]];
+        const auto& p3 = vertices[f[2]];
+        const auto& n = normals[f[3]];
+        // only in front of the sensor
+        const auto q = utils::intersection(l, p1, n);
+        if (!(q.dot(l) > 0)) return rho_min;
+        if (!utils::inside(q, p1, p2, p3, n)) return rho_min;
+        const auto rho = q.norm();
+        if (rho < config_.range_min || rho > config_.range_max) return rho_min;
+        if (rho < rho_min || (rho == rho_min && ind < closest)) {
+          closest = ind;
+          rho_min = rho;
+          q_min = q;
+        }
+        return rho_min;
+      });
+      if (closest < 0) continue;
+      hits[ti].push_back(
+          Hit{i, j, rho_min, q_min, normals[faces_[closest][3]]});
+    }
+  }
+
+  std::vector<Hit> all_hits;
+  for (const auto& row : hits)
+    all_hits.insert(all_hits.end(), row.begin(), row.end());
+  return all_hits;
+}
+
 }  // namespace mesh2pcd
 }  // namespace lidar
 }  // namespace vtr
\ No newline at end of file
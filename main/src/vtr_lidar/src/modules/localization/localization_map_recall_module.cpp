@@ -21,6 +21,7 @@
 #include "pcl_conversions/pcl_conversions.h"
 
 #include "vtr_lidar/data_types/pointmap_pointer.hpp"
+#include "vtr_lidar/data_types/pointmap_versions.hpp"
 
 namespace vtr {
 namespace lidar {
@@ -87,18 +88,33 @@ void LocalizationMapRecallModule::run_(QueryCache &qdata0, OutputCache &,
     auto vertex = graph->at(pointmap_ptr.map_vid);
     CLOG(INFO, "lidar.localization_map_recall")
         << "Loading map " << config_->map_version << " from vertex " << vid_loc;
-    const auto specified_map_msg = vertex->retrieve<PointMap<PointWithInfo>>(
-        config_->map_version, "vtr_lidar_msgs/msg/PointMap");
-    if (specified_map_msg == nullptr) {
+    // "pointmap_v<N>" is only stored once version N has been replaced and
+    // "pointmap" may be stored as a delta, so both are looked up through
+    // pointmap_versions.hpp
+    const std::string version_prefix = "pointmap_v";
+    PointMap<PointWithInfo>::Ptr submap_loc = nullptr;
+    if (config_->map_version == "pointmap") {
+      submap_loc = retrievePointMap<PointWithInfo>(graph, vertex);
+    } else if (config_->map_version.rfind(version_prefix, 0) == 0) {
+      const auto version = std::stoul(
+          config_->map_version.substr(version_prefix.size()));
+      submap_loc =
+          retrievePointMapVersion<PointWithInfo>(graph, vertex, version);
+    } else if (const auto specified_map_msg =
+                   vertex->retrieve<PointMap<PointWithInfo>>(
+                       config_->map_version, "vtr_lidar_msgs/msg/PointMap")) {
+      auto locked_specified_map_msg = specified_map_msg->sharedLocked();
+      submap_loc = std::make_shared<PointMap<PointWithInfo>>(
+          locked_specified_map_msg.get().getData());
+    }
+    if (submap_loc == nullptr) {
       CLOG(ERROR, "lidar.localization_map_recall")
           << "Could not find map " << config_->map_version << " at vertex "
           << vid_loc;
       throw std::runtime_error("Could not find map " + config_->map_version +
                                " at vertex " + std::to_string(vid_loc));
     }
-    auto locked_specified_map_msg = specified_map_msg->sharedLocked();
-    qdata.submap_loc = std::make_shared<PointMap<PointWithInfo>>(
-        locked_specified_map_msg.get().getData());
+    qdata.submap_loc = submap_loc;
     // signal that loc map did change
     qdata.submap_loc_changed.emplace(true);
   }
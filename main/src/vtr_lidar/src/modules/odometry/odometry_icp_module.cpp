@@ -19,6 +19,8 @@
 #include "vtr_lidar/modules/odometry/odometry_icp_module.hpp"
 
 #include "vtr_lidar/utils/nanoflann_utils.hpp"
+#include "vtr_lidar/utils/point_cloud_pool.hpp"
+#include "vtr_tactic/quality_controller.hpp"
 
 namespace vtr {
 namespace lidar {
@@ -76,6 +78,7 @@ auto OdometryICPModule::Config::fromROS(const rclcpp::Node::SharedPtr &node,
   config->max_iterations = (unsigned int)node->declare_parameter<int>(param_prefix + ".max_iterations", 1);
 
   config->min_matched_ratio = node->declare_parameter<float>(param_prefix + ".min_matched_ratio", config->min_matched_ratio);
+  config->quality_iter_scale = node->declare_parameter<float>(param_prefix + ".quality_iter_scale", config->quality_iter_scale);
 
   config->visualize = node->declare_parameter<bool>(param_prefix + ".visualize", config->visualize);
   // clang-format on
@@ -96,7 +99,8 @@ void OdometryICPModule::run_(QueryCache &qdata0, OutputCache &,
     qdata.undistorted_raw_point_cloud = undistorted_raw_point_cloud;
 #endif
     // undistorted preprocessed point cloud
-    auto undistorted_point_cloud = std::make_shared<pcl::PointCloud<PointWithInfo>>(*qdata.preprocessed_point_cloud);
+    auto undistorted_point_cloud = pointCloudPool().acquire();
+    *undistorted_point_cloud = *qdata.preprocessed_point_cloud;
     cart2pol(*undistorted_point_cloud);
     qdata.undistorted_point_cloud = undistorted_point_cloud;
     //
@@ -123,8 +127,12 @@ void OdometryICPModule::run_(QueryCache &qdata0, OutputCache &,
   auto &point_map = sliding_map_odo.point_cloud();
 
   /// Parameters
+  // fewer iterations when the pipeline is behind
+  const double iter_scale = qualityScale(qdata, config_->quality_iter_scale);
+  const int refined_max_iter =
+      std::max<int>(1, config_->refined_max_iter * iter_scale);
   int first_steps = config_->first_num_steps;
-  int max_it = config_->initial_max_iter;
+  int max_it = std::max<int>(1, config_->initial_max_iter * iter_scale);
   float max_pair_d = config_->initial_max_pairing_dist;
   float max_planar_d = config_->initial_max_planar_dist;
   float max_pair_d2 = max_pair_d * max_pair_d;
@@ -197,8 +205,11 @@ void OdometryICPModule::run_(QueryCache &qdata0, OutputCache &,
   /// compound transform for alignment (sensor to point map transform)
   const auto T_m_s_eval = inverse(compose(T_s_r_var, T_r_m_eval));
 
-  /// Initialize aligned points for matching (Deep copy of targets)
-  pcl::PointCloud<PointWithInfo> aligned_points(query_points);
+  /// Initialize aligned points for matching (Deep copy of targets), becomes
+  /// the undistorted point cloud of this frame
+  const auto aligned_point_cloud = pointCloudPool().acquire();
+  *aligned_point_cloud = query_points;
+  auto &aligned_points = *aligned_point_cloud;
 
   /// Eigen matrix of original data (only shallow copy of ref clouds)
   const auto map_mat = point_map.getMatrixXfMap(4, PointWithInfo::size(), PointWithInfo::cartesian_offset());
@@ -262,11 +273,15 @@ void OdometryICPModule::run_(QueryCache &qdata0, OutputCache &,
   bool refinement_stage = false;
   int refinement_step = 0;
 
+  // index buffers, reused by all iterations
+  std::vector<std::pair<size_t, size_t>> sample_inds;
+  std::vector<float> nn_dists;
+  std::vector<std::pair<size_t, size_t>> filtered_sample_inds;
+
   CLOG(DEBUG, "lidar.odometry_icp") << "Start the ICP optimization loop.";
   for (int step = 0;; step++) {
     /// sample points
     timer[0]->start();
-    std::vector<std::pair<size_t, size_t>> sample_inds;
     sample_inds.resize(query_points.size());
     // pick queries (for now just use all of them)
     for (size_t i = 0; i < query_points.size(); i++) sample_inds[i].first = i;
@@ -274,7 +289,7 @@ void OdometryICPModule::run_(QueryCache &qdata0, OutputCache &,
 
     /// find nearest neigbors and distances
     timer[1]->start();
-    std::vector<float> nn_dists(sample_inds.size());
+    nn_dists.resize(sample_inds.size());
 #pragma omp parallel for schedule(dynamic, 10) num_threads(config_->num_threads)
     for (size_t i = 0; i < sample_inds.size(); i++) {
       KDTreeResultSet result_set(1);
@@ -285,7 +300,7 @@ void OdometryICPModule::run_(QueryCache &qdata0, OutputCache &,
 
     /// filtering based on distances metrics
     timer[2]->start();
-    std::vector<std::pair<size_t, size_t>> filtered_sample_inds;
+    filtered_sample_inds.clear();
     filtered_sample_inds.reserve(sample_inds.size());
     for (size_t i = 0; i < sample_inds.size(); i++) {
       if (nn_dists[i] < max_pair_d2) {
@@ -423,7 +438,7 @@ void OdometryICPModule::run_(QueryCache &qdata0, OutputCache &,
         // enter the second refine stage
         refinement_stage = true;
 
-        max_it = step + config_->refined_max_iter;
+        max_it = step + refined_max_iter;
 
         // reduce the max distance
         max_pair_d = config_->refined_max_pairing_dist;
@@ -479,7 +494,7 @@ void OdometryICPModule::run_(QueryCache &qdata0, OutputCache &,
     aligned_mat = T_s_m * aligned_mat;
     aligned_norms_mat = T_s_m * aligned_norms_mat;
 
-    auto undistorted_point_cloud = std::make_shared<pcl::PointCloud<PointWithInfo>>(aligned_points);
+    const auto &undistorted_point_cloud = aligned_point_cloud;
     cart2pol(*undistorted_point_cloud);  // correct polar coordinates.
     qdata.undistorted_point_cloud = undistorted_point_cloud;
 #if false
@@ -522,7 +537,8 @@ void OdometryICPModule::run_(QueryCache &qdata0, OutputCache &,
         << "Matched points ratio " << matched_points_ratio
         << " is below the threshold. ICP is considered failed.";
     // do not undistort the pointcloud
-    auto undistorted_point_cloud = std::make_shared<pcl::PointCloud<PointWithInfo>>(query_points);
+    const auto &undistorted_point_cloud = aligned_point_cloud;
+    *undistorted_point_cloud = query_points;
     cart2pol(*undistorted_point_cloud);
     qdata.undistorted_point_cloud = undistorted_point_cloud;
 #if false
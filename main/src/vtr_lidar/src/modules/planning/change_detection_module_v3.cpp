@@ -18,43 +18,98 @@
  */
 #include "vtr_lidar/modules/planning/change_detection_module_v3.hpp"
 
-#include "pcl/features/normal_3d.h"
-
 #include "vtr_lidar/data_types/costmap.hpp"
+#include "vtr_lidar/data_types/pointmap.hpp"
 #include "vtr_lidar/filters/voxel_downsample.hpp"
 
 #include "vtr_lidar/utils/nanoflann_utils.hpp"
+#include "vtr_tactic/quality_controller.hpp"
 
 namespace vtr {
 namespace lidar {
 
 namespace {
 
+/**
+ * \brief Computes centroid, normal and roughness of the subset of points given
+ * by indices, in place (without copying them into a new point cloud).
+ * \note roughness is the smallest eigenvalue of the unnormalized scatter
+ * matrix, same as pcl::computeCovarianceMatrix
+ */
 template <class PointT>
 void computeCentroidAndNormal(const pcl::PointCloud<PointT> &points,
+                              const std::vector<int> &indices,
                               Eigen::Vector3f &centroid,
                               Eigen::Vector3f &normal, float &roughness) {
-  // 16-bytes aligned placeholder for the XYZ centroid of a surface patch
-  Eigen::Vector4f centroid_homo;
-  // Placeholder for the 3x3 covariance matrix at each surface patch
-  Eigen::Matrix3f cov;
-
   // Estimate the XYZ centroid
-  pcl::compute3DCentroid(points, centroid_homo);
-
-  // Compute the 3x3 covariance matrix
-  pcl::computeCovarianceMatrix(points, centroid_homo, cov);
+  centroid.setZero();
+  for (const auto &i : indices) centroid += points[i].getVector3fMap();
+  centroid /= static_cast<float>(indices.size());
+
+  // Compute the 3x3 scatter matrix
+  Eigen::Matrix3f cov = Eigen::Matrix3f::Zero();
+  for (const auto &i : indices) {
+    const Eigen::Vector3f diff = points[i].getVector3fMap() - centroid;
+    cov.selfadjointView<Eigen::Lower>().rankUpdate(diff);
+  }
 
   // Compute pca
   Eigen::SelfAdjointEigenSolver<Eigen::Matrix3f> es;
   es.compute(cov);
 
   // save results
-  centroid = centroid_homo.head<3>();
   normal = es.eigenvectors().col(0);
   roughness = es.eigenvalues()(0);  // variance
 }
 
+/**
+ * \brief Points bucketed into voxels of the size of the search radius, so that
+ * all neighbors within the radius lie in the 27 adjacent voxels. Cheaper to
+ * build than a kd-tree for a one-off radius search over sparse points.
+ */
+template <class PointT>
+class VoxelNeighborTable {
+ public:
+  VoxelNeighborTable(const pcl::PointCloud<PointT> &points, const float &radius)
+      : points_(points), radius_(radius) {
+    if (!(radius_ > 0))
+      throw std::invalid_argument("VoxelNeighborTable radius must be positive.");
+    voxels_.reserve(points.size());
+    for (size_t i = 0; i < points.size(); ++i)
+      voxels_[getKey(points[i])].emplace_back(i);
+  }
+
+  /** \brief Calls op(index, squared distance) for each neighbor of p */
+  template <typename NeighborOp>
+  void radiusSearch(const PointT &p, const NeighborOp &op) const {
+    const float sq_radius = radius_ * radius_;
+    const auto k = getKey(p);
+    for (int dx = -1; dx <= 1; ++dx)
+      for (int dy = -1; dy <= 1; ++dy)
+        for (int dz = -1; dz <= 1; ++dz) {
+          const auto it = voxels_.find(k + pointmap::VoxKey(dx, dy, dz));
+          if (it == voxels_.end()) continue;
+          for (const auto &j : it->second) {
+            const float sq_dist =
+                (points_[j].getVector3fMap() - p.getVector3fMap())
+                    .squaredNorm();
+            if (sq_dist < sq_radius) op(j, sq_dist);
+          }
+        }
+  }
+
+ private:
+  pointmap::VoxKey getKey(const PointT &p) const {
+    return pointmap::VoxKey((int)std::floor(p.x / radius_),
+                            (int)std::floor(p.y / radius_),
+                            (int)std::floor(p.z / radius_));
+  }
+
+  const pcl::PointCloud<PointT> &points_;
+  const float radius_;
+  std::unordered_map<pointmap::VoxKey, std::vector<size_t>> voxels_;
+};
+
 template <typename PointT>
 class DetectChangeOp {
  public:
@@ -104,6 +159,9 @@ auto ChangeDetectionModuleV3::Config::fromROS(
   config->detection_range = node->declare_parameter<float>(param_prefix + ".detection_range", config->detection_range);
   config->search_radius = node->declare_parameter<float>(param_prefix + ".search_radius", config->search_radius);
   config->negprob_threshold = node->declare_parameter<float>(param_prefix + ".negprob_threshold", config->negprob_threshold);
+  config->num_threads = node->declare_parameter<int>(param_prefix + ".num_threads", config->num_threads);
+  config->query_voxel_size = node->declare_parameter<float>(param_prefix + ".query_voxel_size", config->query_voxel_size);
+  config->quality_voxel_scale = node->declare_parameter<float>(param_prefix + ".quality_voxel_scale", config->quality_voxel_scale);
   // prior on roughness
   config->use_prior = node->declare_parameter<bool>(param_prefix + ".use_prior", config->use_prior);
   config->alpha0 = node->declare_parameter<float>(param_prefix + ".alpha0", config->alpha0);
@@ -113,8 +171,14 @@ auto ChangeDetectionModuleV3::Config::fromROS(
   config->support_radius = node->declare_parameter<float>(param_prefix + ".support_radius", config->support_radius);
   config->support_variance = node->declare_parameter<float>(param_prefix + ".support_variance", config->support_variance);
   config->support_threshold = node->declare_parameter<float>(param_prefix + ".support_threshold", config->support_threshold);
+  if (config->use_support_filtering && !(config->support_radius > 0)) {
+    std::string err{"Support radius must be positive."};
+    CLOG(ERROR, "lidar.change_detection") << err;
+    throw std::invalid_argument{err};
+  }
   // cost map
   config->costmap_history_size = node->declare_parameter<int>(param_prefix + ".costmap_history_size", config->costmap_history_size);
+  config->costmap_min_votes = node->declare_parameter<int>(param_prefix + ".costmap_min_votes", config->costmap_min_votes);
   config->resolution = node->declare_parameter<float>(param_prefix + ".resolution", config->resolution);
   config->size_x = node->declare_parameter<float>(param_prefix + ".size_x", config->size_x);
   config->size_y = node->declare_parameter<float>(param_prefix + ".size_y", config->size_y);
@@ -177,7 +241,8 @@ void ChangeDetectionModuleV3::run_(QueryCache &qdata0, OutputCache &output0,
     CLOG(WARNING, "lidar.change_detection") << "No points were valid to detect changes";
     return;
   }
-  voxelDownsample(query_points, 0.2);
+  // coarser query when the pipeline is behind
+  voxelDownsample(query_points, config_->query_voxel_size * qualityScale(qdata, config_->quality_voxel_scale));
 
   // Eigen matrix of original data (only shallow copy of ref clouds)
   const auto query_mat = query_points.getMatrixXfMap(4, PointWithInfo::size(), PointWithInfo::cartesian_offset());
@@ -201,35 +266,38 @@ void ChangeDetectionModuleV3::run_(QueryCache &qdata0, OutputCache &output0,
 
   std::vector<long unsigned> nn_inds(aligned_points.size());
   std::vector<float> nn_dists(aligned_points.size(), -1.0f);
-  // compute nearest neighbors and point to point distances
-  for (size_t i = 0; i < aligned_points.size(); i++) {
-    KDTreeResultSet result_set(1);
-    result_set.init(&nn_inds[i], &nn_dists[i]);
-    kdtree->findNeighbors(result_set, aligned_points[i].data, search_params);
-  }
-  // compute point to plane distance
-  const auto sq_search_radius = config_->search_radius * config_->search_radius;
   std::vector<float> roughnesses(aligned_points.size(), 0.0f);
   std::vector<float> num_measurements(aligned_points.size(), 0.0f);
-  for (size_t i = 0; i < aligned_points.size(); i++) {
-    // radius search of the closest point
+  const auto sq_search_radius = config_->search_radius * config_->search_radius;
+#pragma omp parallel num_threads(config_->num_threads)
+  {
+    // per-thread buffers reused across points
     std::vector<float> dists;
     std::vector<int> indices;
-    NanoFLANNRadiusResultSet<float, int> result(sq_search_radius, dists, indices);
-    kdtree->radiusSearchCustomCallback(map_point_cloud[nn_inds[i]].data, result, search_params);
+#pragma omp for schedule(dynamic, 10)
+    for (size_t i = 0; i < aligned_points.size(); i++) {
+      // compute nearest neighbors and point to point distances
+      KDTreeResultSet result_set(1);
+      result_set.init(&nn_inds[i], &nn_dists[i]);
+      kdtree->findNeighbors(result_set, aligned_points[i].data, search_params);
 
-    // filter based on neighbors in map /// \todo parameters
-    if (indices.size() < 10) continue;
+      // radius search of the closest point
+      NanoFLANNRadiusResultSet<float, int> result(sq_search_radius, dists, indices);
+      kdtree->radiusSearchCustomCallback(map_point_cloud[nn_inds[i]].data, result, search_params);
 
-    //
-    num_measurements[i] = static_cast<float>(indices.size());
+      // filter based on neighbors in map /// \todo parameters
+      if (indices.size() < 10) continue;
 
-    // compute the planar distance
-    Eigen::Vector3f centroid, normal;
-    computeCentroidAndNormal(pcl::PointCloud<PointWithInfo>(map_point_cloud, indices), centroid, normal, roughnesses[i]);
+      //
+      num_measurements[i] = static_cast<float>(indices.size());
+
+      // compute point to plane distance
+      Eigen::Vector3f centroid, normal;
+      computeCentroidAndNormal(map_point_cloud, indices, centroid, normal, roughnesses[i]);
 
-    const auto diff = aligned_points[i].getVector3fMap() - centroid;
-    nn_dists[i] = std::abs(diff.dot(normal));
+      const auto diff = aligned_points[i].getVector3fMap() - centroid;
+      nn_dists[i] = std::abs(diff.dot(normal));
+    }
   }
 
   for (size_t i = 0; i < aligned_points.size(); i++) {
@@ -259,38 +327,27 @@ void ChangeDetectionModuleV3::run_(QueryCache &qdata0, OutputCache &output0,
 
   // add support region
   if (config_->use_support_filtering) {
-    // create kd-tree of the aligned points
-    NanoFLANNAdapter<PointWithInfo> query_adapter(aligned_points);
-    KDTreeSearchParams search_params;
-    KDTreeParams tree_params(/* max leaf */ 10);
-    auto query_kdtree =
-        std::make_unique<KDTree<PointWithInfo>>(3, query_adapter, tree_params);
-    query_kdtree->buildIndex();
+    // voxel neighbor table of the aligned points
+    VoxelNeighborTable<PointWithInfo> neighbor_table(aligned_points, config_->support_radius);
     //
-    std::vector<size_t> toremove;
-    toremove.reserve(100);
-    const float sq_support_radius = std::pow(config_->support_radius, 2);
+    std::vector<uint8_t> toremove(aligned_points.size(), 0);
+#pragma omp parallel for schedule(dynamic, 10) num_threads(config_->num_threads)
     for (size_t i = 0; i < aligned_points.size(); i++) {
       // ignore non-change points
       if (aligned_points[i].flex23 == 0.0f) continue;
 
-      //
-      std::vector<std::pair<size_t, float>> inds_dists;
-      inds_dists.reserve(10);
-      query_kdtree->radiusSearch(aligned_points[i].data, sq_support_radius,
-                                 inds_dists, search_params);
       //
       float support = 0.0f;
-      for (const auto &ind_dist : inds_dists) {
-        if (ind_dist.first == i) continue;
-        support += aligned_points[ind_dist.first].flex23 *
-                   std::exp(-ind_dist.second / (2 * config_->support_variance));
-      }
+      neighbor_table.radiusSearch(aligned_points[i], [&](const size_t &j, const float &sq_dist) {
+        if (j == i) return;
+        support += aligned_points[j].flex23 * std::exp(-sq_dist / (2 * config_->support_variance));
+      });
       //
-      if (support < config_->support_threshold) toremove.push_back(i);
+      if (support < config_->support_threshold) toremove[i] = 1;
     }
     // change back to non-change points
-    for (const auto &i : toremove) aligned_points[i].flex23 = 0.0f;
+    for (size_t i = 0; i < aligned_points.size(); i++)
+      if (toremove[i]) aligned_points[i].flex23 = 0.0f;
   }
 
   // retrieve the pre-processed scan and convert it to the vertex frame
@@ -325,187 +382,39 @@ void ChangeDetectionModuleV3::run_(QueryCache &qdata0, OutputCache &output0,
   costmap->vertex_id() = vid_loc;
   costmap->vertex_sid() = sid_loc;
 
-  // Jordy Modifications for temporal costmap filtering (UNDER DEVELOPMENT)
-  
+  // Temporal costmap filtering: obstacle cells are accumulated in the world
+  // frame of the localization chain and only kept if they have been observed
+  // in enough frames of the history.
+  auto& chain = *output.chain;
+  const auto chain_size = chain.size();
+  // the history frame is only kept while repeating the same path in the same
+  // localization run and while the trunk moves forward continuously
+  const bool same_frame =
+      history_vid_.isValid() && vid_loc.majorId() == history_vid_.majorId() &&
+      chain_size == history_chain_size_ && sid_loc >= history_sid_ &&
+      chain.dist(sid_loc) - chain.dist(history_sid_) <=
+          std::max(config_->size_x, config_->size_y);
+  if (!same_frame && costmap_history_.size() > 0) {
+    CLOG(INFO, "lidar.change_detection")
+        << "Localization changed from " << history_vid_ << " to " << vid_loc
+        << ", clearing the costmap history.";
+    costmap_history_.clear();
+  }
+  history_vid_ = vid_loc;
+  history_sid_ = sid_loc;
+  history_chain_size_ = chain_size;
+
+  const auto T_w_c = chain.pose(sid_loc);
+  costmap_history_.push(*costmap, 0.01, T_w_c);
 
-  
   // declaration of the final costmap which we are outputting
   auto dense_costmap = std::make_shared<DenseCostMap>(config_->resolution, config_->size_x, config_->size_y);
   dense_costmap->T_vertex_this() = tactic::EdgeTransform(true);
   dense_costmap->vertex_id() = vid_loc;
   dense_costmap->vertex_sid() = sid_loc;
-  
-  // Create a sparse costmap and store it in a sliding window history
-  const auto sparse_costmap = std::make_shared<DenseCostMap>(config_->resolution, config_->size_x, config_->size_y);
-  sparse_costmap->update(detect_change_op);
-  // add transform to the localization vertex
-  sparse_costmap->T_vertex_this() = tactic::EdgeTransform(true);
-  sparse_costmap->vertex_id() = vid_loc;
-  sparse_costmap->vertex_sid() = sid_loc;
-
-  // Get the localization chain transform (lets us transform from costmap frame to world frame):
-  auto& chain = *output.chain;
-  auto T_w_c  = chain.pose(sid_loc);
-  auto T_c_w  = T_w_c.inverse();
-  //CLOG(WARNING, "obstacle_detection.cbit") << "T_w_c: " << T_w_c; // debug
-
-  // Initialize an unordered map to store the sparse world obstacle representations
-  std::unordered_map<std::pair<float, float>, float>  sparse_world_map;
-
-  // Filter non-obstacles
-  vtr::lidar::BaseCostMap::XY2ValueMap sparse_obs_map = sparse_costmap->filter(0.01);
-
-  // Iterate through the key value pairs, convert to a world frame unordered_map
-  std::vector<std::pair<float, float>> keys;
-  keys.reserve(sparse_obs_map.size());
-  std::vector<float> vals;
-  vals.reserve(sparse_obs_map.size());
-  for(auto kv : sparse_obs_map) 
-  {
-    float key_x = kv.first.first;
-    float key_y = kv.first.second;
-    // Convert the centre of each obstacle key value pair into the world frame
-    Eigen::Matrix<double, 4, 1> grid_pt({key_x+(config_->resolution/2), key_y+(config_->resolution/2), 0.0, 1});
-    auto collision_pt = T_w_c * grid_pt;
-
-    //CLOG(DEBUG, "obstacle_detection.cbit") << "Displaying Transform: " << (sparse_costmap->T_vertex_this().inverse());
 
-    float world_key_x = floor(collision_pt[0] / config_->resolution) * config_->resolution;
-    float world_key_y = floor(collision_pt[1] / config_->resolution) * config_->resolution;
-
-    // Experimental debug! Im thinking that perhaps here these keys could be outside the legal area
-
-
-
-    float world_value = kv.second;
-    std::pair<float, float> world_keys(world_key_x, world_key_y);
-    sparse_world_map.insert(std::make_pair(world_keys,world_value));
-
-    //CLOG(DEBUG, "obstacle_detection.cbit") << "Displaying Key X: " << key_x;
-    //CLOG(DEBUG, "obstacle_detection.cbit") << "Displaying Key Y: " << key_y;
-    //CLOG(DEBUG, "obstacle_detection.cbit") << "Displaying World Key X: " << world_key_x;
-    //CLOG(DEBUG, "obstacle_detection.cbit") << "Displaying World Key Y: " << world_key_y;
-
-    
-    keys.push_back(kv.first);
-    vals.push_back(kv.second);  
-  } 
-  //CLOG(ERROR, "obstacle_detection.cbit") << "The size of each map is" << sparse_obs_map.size();
-  //CLOG(ERROR, "obstacle_detection.cbit") << "Displaying all Keys: " << keys;
-  //CLOG(ERROR, "obstacle_detection.cbit") << "Displaying all Values: " << vals;
-  
-  //CLOG(WARNING, "obstacle_detection.cbit") << "T_c_w " << T_c_w;
-  //CLOG(WARNING, "obstacle_detection.cbit") << "T_m_s: " << T_m_s;
-  //CLOG(WARNING, "obstacle_detection.cbit") << "T_s_r_inv: " << T_s_r.inverse();
-
-
-
-  // if the costmap_history is smaller then some minimum value, just tack it on the end
-  // TODO need to get rid of these magic numbers
-  // TODO A linked list would make more sense here
-
-  if (costmap_history.size() < config_->costmap_history_size)
-  {
-    costmap_history.push_back(sparse_world_map);
-  }
-  // After that point, we then do a sliding window using shift operations, moving out the oldest map and appending the newest one
-  else
-  {
-    for (unsigned int i = 0; i < (config_->costmap_history_size-1); i++)
-    {
-      costmap_history[i] = costmap_history[i + 1];
-    }
-    costmap_history[(config_->costmap_history_size-1)] = sparse_world_map;
-  
-
-    //CLOG(WARNING, "obstacle_detection.cbit") << "costmap_history size " <<costmap_history.size();
-    // Iterate through the stored costmaps and build a merged world frame obstacle costmap
-    std::unordered_map<std::pair<float, float>, float>  merged_world_map = costmap_history[(config_->costmap_history_size-1)];
-    //CLOG(WARNING, "obstacle_detection.cbit") << "merged world map size " <<merged_world_map.size();
-    std::unordered_map<std::pair<float, float>, float>  filtered_world_map;
-    for (unsigned int i = 0; i < (costmap_history.size()-1); i++)
-    {
-      merged_world_map.merge(costmap_history[i]);
-      //CLOG(WARNING, "obstacle_detection.cbit") << "merged world map size " <<merged_world_map.size();
-    }
-
-  
-    // For each key in this merged costmap, check how many of that key exist in the individual costmaps
-    //std::vector<std::pair<float, float>> world_keys;
-    //world_keys.reserve(merged_world_map.size());
-    //std::vector<float> world_vals;
-    //world_vals.reserve(merged_world_map.size());
-    for(auto kv : merged_world_map) 
-    {   
-      //world_keys.push_back(kv.first);
-      //world_vals.push_back(kv.second);  
-
-      int key_vote_counter = 0;
-      for (int i = 0; i < costmap_history.size(); i++)
-      {
-        if ((costmap_history[i]).find(kv.first) != (costmap_history[i]).end())
-        {
-          key_vote_counter = key_vote_counter + 1;
-        }
-      }
-      
-      // Store the filtered (both temporal and transient) points in a sparse filtered unordered_map
-      if (key_vote_counter >= 3)
-      {
-        filtered_world_map.insert(std::make_pair(kv.first,kv.second));
-      }
-    }
-  
-    // Convert the filtered world map back to the current costmap frame (note, might actually just store the sparse world map, its more useful for me anyways)
-    // Probably still want to convert back so we can republish it though
-    // Iterate through the key value pairs, convert to a world frame unordered_map
-    std::unordered_map<std::pair<float, float>, float>  filtered_loc_map;
-    std::vector<std::pair<float, float>> filtered_keys;
-    filtered_keys.reserve(filtered_world_map.size());
-    std::vector<float> filtered_vals;
-    filtered_vals.reserve(filtered_world_map.size());
-
-    for(auto kv : filtered_world_map) 
-    {
-      float key_x = kv.first.first;
-      float key_y = kv.first.second;
-      // Convert the centre of each obstacle key value pair into the world frame
-      Eigen::Matrix<double, 4, 1> grid_pt({key_x+(config_->resolution/2), key_y+(config_->resolution/2), 0.0, 1});
-      auto collision_pt = T_c_w * grid_pt;
-
-      //CLOG(DEBUG, "obstacle_detection.cbit") << "Displaying Transform: " << (sparse_costmap->T_vertex_this().inverse());
-
-      float loc_key_x = floor(collision_pt[0] / config_->resolution) * config_->resolution;
-      float loc_key_y = floor(collision_pt[1] / config_->resolution) * config_->resolution;
-
-
-      // debug to check loc_key is in a valid range:
-
-
-      float loc_value = kv.second;
-      std::pair<float, float> loc_keys(loc_key_x, loc_key_y);
-      filtered_loc_map.insert(std::make_pair(loc_keys,loc_value));
-    }
- 
-    // Build the dense map, publish and save the results so the planner can access it
-    //const auto dense_costmap = std::make_shared<DenseCostMap>(config_->resolution, config_->size_x, config_->size_y); // need to declare this earlier
-
-    dense_costmap->update(filtered_loc_map);
-    
-    
-    // add transform to the localization vertex
-    //dense_costmap->T_vertex_this() = tactic::EdgeTransform(true);
-    //dense_costmap->vertex_id() = vid_loc;
-    //dense_costmap->vertex_sid() = sid_loc;
-
-    // debug, temporarily using my filtered costmap as the main costmap
-    //auto costmap_msg = dense_costmap->toCostMapMsg();
-    //costmap_msg.header.frame_id = "loc vertex frame";
-    // costmap_msg.header.stamp = rclcpp::Time(*qdata.stamp);
-    //costmap_pub_->publish(costmap_msg);
-
-    //CLOG(WARNING, "obstacle_detection.cbit") << "Successfully update the dense costmap"; 
-  
+  if (costmap_history_.full()) {
+    costmap_history_.filter(*dense_costmap, T_w_c, config_->costmap_min_votes);
 
     if (config_->visualize) {
       // publish the filtered occupancy grid
@@ -514,24 +423,8 @@ void ChangeDetectionModuleV3::run_(QueryCache &qdata0, OutputCache &output0,
       // costmap_msg.header.stamp = rclcpp::Time(*qdata.stamp);
       filtered_costmap_pub_->publish(filtered_costmap_msg);
     }
-    
-
-    // Debug check that the filtered maps look okay
-    vtr::lidar::BaseCostMap::XY2ValueMap dense_map = dense_costmap->filter(0.01);
-    std::vector<std::pair<float, float>> keys2;
-    keys2.reserve(dense_map.size());
-    std::vector<float> vals2;
-    vals2.reserve(dense_map.size());
-    for(auto kv : dense_map) {   
-      keys2.push_back(kv.first);
-      vals2.push_back(kv.second);  
-    } 
-    //CLOG(ERROR, "obstacle_detection.cbit") << "The size of the dense map is" << dense_map.size();
-    //CLOG(ERROR, "obstacle_detection.cbit") << "Displaying all Keys: " << keys2;
-    //CLOG(ERROR, "obstacle_detection.cbit") << "Displaying all Values: " << vals2;
 
     // Update the output cache
-    // Define a mutex to protect access to output.obs_map
     {
         // Lock the mutex before modifying output.obs_map
         std::lock_guard<std::mutex> lock(output.obsMapMutex);
@@ -540,13 +433,6 @@ void ChangeDetectionModuleV3::run_(QueryCache &qdata0, OutputCache &output0,
         output.grid_resolution = config_->resolution;
     } 
   }
-  
-
-  // End of Jordy's temporal filter changes
-
-
-
-
 
   /// publish the transformed pointcloud
   if (config_->visualize) {
@@ -577,19 +463,11 @@ void ChangeDetectionModuleV3::run_(QueryCache &qdata0, OutputCache &output0,
   }
 
   /// output
-  auto change_detection_costmap_ref = output.change_detection_costmap.locked();
-  auto &change_detection_costmap = change_detection_costmap_ref.get();
-  //change_detection_costmap = costmap;
-
-  //Jordy debug, using experimental new costmaps instead
-  if (costmap_history.size() < 10.0)
-  {
-    change_detection_costmap = costmap;
-  }
+  // use the temporally filtered costmap once the history is filled up
+  if (costmap_history_.full())
+    output.change_detection_costmap.publish(dense_costmap);
   else
-  {
-    change_detection_costmap = dense_costmap; 
-  }
+    output.change_detection_costmap.publish(costmap);
 
   CLOG(INFO, "lidar.change_detection")
       << "Change detection for lidar scan at stamp: " << stamp << " - DONE";
@@ -42,6 +42,7 @@ auto GroundExtractionModule::Config::fromROS(
   config->bin_size_small = node->declare_parameter<float>(param_prefix + ".bin_size_small", config->bin_size_small);
   config->num_bins_large = (size_t)node->declare_parameter<int>(param_prefix + ".num_bins_large", config->num_bins_large);
   config->bin_size_large = node->declare_parameter<float>(param_prefix + ".bin_size_large", config->bin_size_large);
+  config->num_threads = node->declare_parameter<int>(param_prefix + ".num_threads", config->num_threads);
   // occupancy grid
   config->resolution = node->declare_parameter<float>(param_prefix + ".resolution", config->resolution);
   config->size_x = node->declare_parameter<float>(param_prefix + ".size_x", config->size_x);
@@ -72,6 +73,7 @@ GroundExtractionModule::GroundExtractionModule(
   himmelsbach_.bin_size_small = config_->bin_size_small;
   himmelsbach_.num_bins_large = config_->num_bins_large;
   himmelsbach_.bin_size_large = config_->bin_size_large;
+  himmelsbach_.num_threads = config_->num_threads;
 }
 
 void GroundExtractionModule::run_(QueryCache &qdata0, OutputCache &output0,
@@ -127,24 +129,16 @@ void GroundExtractionModule::runAsync_(QueryCache &qdata0, OutputCache &output0,
   const auto &loc_vid = *qdata.vid_loc;
   const auto &loc_sid = *qdata.sid_loc;
   const auto &point_map = *qdata.submap_loc;
-  const auto &T_lv_pm = point_map.T_vertex_this().matrix();
-  auto point_cloud = point_map.point_cloud();  // copy for changing
+  const auto &point_cloud = point_map.point_cloud();
+  const Eigen::Affine3f T_lv_pm(
+      point_map.T_vertex_this().matrix().cast<float>());
 
   CLOG(INFO, "lidar.ground_extraction")
       << "Ground Extraction for vertex: " << loc_vid;
 
-  // transform into vertex frame
-  // clang-format off
-  auto points_mat = point_cloud.getMatrixXfMap(3, PointWithInfo::size(), PointWithInfo::cartesian_offset());
-  auto normal_mat = point_cloud.getMatrixXfMap(3, PointWithInfo::size(), PointWithInfo::normal_offset());
-  // clang-format on
-  Eigen::Matrix3f C_lv_pm = (T_lv_pm.block<3, 3>(0, 0)).cast<float>();
-  Eigen::Vector3f r_lv_pm = (T_lv_pm.block<3, 1>(0, 3)).cast<float>();
-  points_mat = ((C_lv_pm * points_mat).colwise() + r_lv_pm).eval();
-  normal_mat = (C_lv_pm * normal_mat).eval();
-
-  // ground extraction
-  const auto ground_idx = himmelsbach_(point_cloud);
+  // ground extraction in the vertex frame, only the ground points are
+  // transformed afterwards
+  const auto ground_idx = himmelsbach_(point_cloud, T_lv_pm);
 
   // construct occupancy grid map
   std::vector<PointWithInfo> ground_points;
@@ -152,12 +146,14 @@ void GroundExtractionModule::runAsync_(QueryCache &qdata0, OutputCache &output0,
   std::vector<float> scores;
   scores.reserve(ground_idx.size());
   for (const auto &idx : ground_idx) {
-    ground_points.emplace_back(point_cloud[idx]);
+    auto &point = ground_points.emplace_back(point_cloud[idx]);
+    point.getVector3fMap() = T_lv_pm * point.getVector3fMap();
+    point.getNormalVector3fMap() =
+        T_lv_pm.linear() * point.getNormalVector3fMap();
     /// \note use a range of 0.05 to 1.0 for visualization
     /// normal of 1 maps to 0.05, 0.95- maps to 1.0
     scores.emplace_back(
-        0.05 +
-        0.95 * std::clamp((20.0 * (1.0 - point_cloud[idx].normal_z)), 0., 1.));
+        0.05 + 0.95 * std::clamp((20.0 * (1.0 - point.normal_z)), 0., 1.));
   }
   // project to 2d and construct the grid map
   const auto ogm = std::make_shared<SparseCostMap>(
@@ -187,12 +183,18 @@ void GroundExtractionModule::runAsync_(QueryCache &qdata0, OutputCache &output0,
     tf_bc_->sendTransform(msg);
 
     if (!(output.chain.valid() && qdata.sid_loc.valid())) {
-      // color the points for visualization
-      for (auto &&point : point_cloud) point.flex11 = 0;
-      for (const auto &idx : ground_idx) point_cloud[idx].flex11 = 1;
+      auto colored_cloud = point_cloud;
+      for (auto &point : colored_cloud) point.flex11 = 0.0f;
+      for (const auto &idx : ground_idx) colored_cloud[idx].flex11 = 1.0f;
+      // clang-format off
+      auto points_mat = colored_cloud.getMatrixXfMap(3, PointWithInfo::size(), PointWithInfo::cartesian_offset());
+      // clang-format on
+      points_mat = ((T_lv_pm.linear() * points_mat).colwise() +
+                    T_lv_pm.translation())
+                       .eval();
       // publish the transformed map (now in vertex frame)
       PointCloudMsg pc2_msg;
-      pcl::toROSMsg(point_cloud, pc2_msg);
+      pcl::toROSMsg(colored_cloud, pc2_msg);
       pc2_msg.header.frame_id = "world (offset)";
       // pc2_msg.header.stamp = rclcpp::Time(*qdata.stamp);
       map_pub_->publish(pc2_msg);
@@ -206,10 +208,7 @@ void GroundExtractionModule::runAsync_(QueryCache &qdata0, OutputCache &output0,
   }
 
   /// output
-  auto ground_extraction_costmap_ref =
-      output.ground_extraction_costmap.locked();
-  auto &ground_extraction_costmap = ground_extraction_costmap_ref.get();
-  ground_extraction_costmap = dense_ogm;
+  output.ground_extraction_costmap.publish(dense_ogm);
 
   CLOG(INFO, "lidar.ground_extraction")
       << "Ground Extraction for vertex: " << loc_vid << " - DONE!";
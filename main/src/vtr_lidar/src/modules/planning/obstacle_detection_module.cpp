@@ -98,37 +98,33 @@ void ObstacleDetectionModule::runAsync_(
   // input
   const auto &loc_vid = *qdata.vid_loc;
   const auto &point_map = *qdata.submap_loc;
-  const auto &T_lv_pm = point_map.T_vertex_this().matrix();
-  auto point_cloud = point_map.point_cloud();  // copy for changing
+  const auto &point_cloud = point_map.point_cloud();
+  const Eigen::Affine3f T_lv_pm(
+      point_map.T_vertex_this().matrix().cast<float>());
 
   CLOG(INFO, "lidar.obstacle_detection")
       << "Obstacle Detection for vertex: " << loc_vid;
 
-  // transform into vertex frame
-  // clang-format off
-  auto points_mat = point_cloud.getMatrixXfMap(3, PointWithInfo::size(), PointWithInfo::cartesian_offset());
-  auto normal_mat = point_cloud.getMatrixXfMap(3, PointWithInfo::size(), PointWithInfo::normal_offset());
-  // clang-format on
-  Eigen::Matrix3f C_lv_pm = (T_lv_pm.block<3, 3>(0, 0)).cast<float>();
-  Eigen::Vector3f r_lv_pm = (T_lv_pm.block<3, 1>(0, 3)).cast<float>();
-  points_mat = ((C_lv_pm * points_mat).colwise() + r_lv_pm).eval();
-  normal_mat = (C_lv_pm * normal_mat).eval();
-
-  // obstacle detection
+  // obstacle detection on the height in vertex frame, the map is read only
+  const Eigen::RowVector3f z_lv_pm = T_lv_pm.linear().row(2);
+  const float z_offset = T_lv_pm.translation()(2);
   std::vector<size_t> obstacle_idx;
   obstacle_idx.reserve(point_cloud.size());
   for (size_t i = 0; i < point_cloud.size(); ++i) {
-    if (point_cloud[i].z > config_->z_min && point_cloud[i].z < config_->z_max)
-      obstacle_idx.emplace_back(i);
+    const float z = z_lv_pm.dot(point_cloud[i].getVector3fMap()) + z_offset;
+    if (z > config_->z_min && z < config_->z_max) obstacle_idx.emplace_back(i);
   }
 
-  // construct occupancy grid map
+  // construct occupancy grid map, only the obstacle points are transformed
   std::vector<PointWithInfo> obstacle_points;
   obstacle_points.reserve(obstacle_idx.size());
   std::vector<float> scores;
   scores.reserve(obstacle_idx.size());
   for (const auto &idx : obstacle_idx) {
-    obstacle_points.emplace_back(point_cloud[idx]);
+    auto &point = obstacle_points.emplace_back(point_cloud[idx]);
+    point.getVector3fMap() = T_lv_pm * point.getVector3fMap();
+    point.getNormalVector3fMap() =
+        T_lv_pm.linear() * point.getNormalVector3fMap();
     scores.emplace_back(1.0f);
   }
   // project to 2d and construct the grid map
@@ -155,12 +151,18 @@ void ObstacleDetectionModule::runAsync_(
     tf_bc_->sendTransform(msg);
 
     if (!(output.chain.valid() && qdata.sid_loc.valid())) {
-      // color the points for visualization
-      for (auto &&point : point_cloud) point.flex11 = 0;
-      for (const auto &idx : obstacle_idx) point_cloud[idx].flex11 = 1;
+      auto colored_cloud = point_cloud;
+      for (auto &point : colored_cloud) point.flex11 = 0.0f;
+      for (const auto &idx : obstacle_idx) colored_cloud[idx].flex11 = 1.0f;
+      // clang-format off
+      auto points_mat = colored_cloud.getMatrixXfMap(3, PointWithInfo::size(), PointWithInfo::cartesian_offset());
+      // clang-format on
+      points_mat = ((T_lv_pm.linear() * points_mat).colwise() +
+                    T_lv_pm.translation())
+                       .eval();
       // publish the transformed map (now in vertex frame)
       PointCloudMsg pc2_msg;
-      pcl::toROSMsg(point_cloud, pc2_msg);
+      pcl::toROSMsg(colored_cloud, pc2_msg);
       pc2_msg.header.frame_id = "world (offset)";
       // pc2_msg.header.stamp = rclcpp::Time(*qdata.stamp);
       map_pub_->publish(pc2_msg);
@@ -174,10 +176,7 @@ void ObstacleDetectionModule::runAsync_(
   }
 
   /// output
-  auto obstacle_detection_costmap_ref =
-      output.obstacle_detection_costmap.locked();
-  auto &obstacle_detection_costmap = obstacle_detection_costmap_ref.get();
-  obstacle_detection_costmap = ogm;
+  output.obstacle_detection_costmap.publish(ogm);
 
   CLOG(INFO, "lidar.obstacle_detection")
       << "Obstacle Detection for vertex: " << loc_vid << " - DONE!";
@@ -27,72 +27,23 @@ namespace {
 
 class ComputeCorridorOp {
  public:
-  ComputeCorridorOp(const unsigned &curr_sid,
-                    const tactic::LocalizationChain &chain,
-                    const float &lookahead_distance, const float &width,
+  ComputeCorridorOp(const Corridor &corridor, const float &width,
                     const float &d0)
-      : lookahead_distance_(lookahead_distance), width_(width), d0_(d0) {
-    auto lock = chain.guard();
-    // compute vertex lookahead
-    const auto distance = chain.dist(curr_sid);
-    const auto T_w_curr = chain.pose(curr_sid);
-    // forwards
-    for (auto query_sid = curr_sid;
-         query_sid < chain.size() &&
-         (chain.dist(query_sid) - distance) < lookahead_distance_;
-         ++query_sid) {
-      const auto T_curr_query = T_w_curr.inverse() * chain.pose(query_sid);
-      T_curr_query_vec.emplace_back(T_curr_query.matrix());
-      T_curr_query_xy_vec.emplace_back(
-          T_curr_query.matrix().block<2, 1>(0, 3).cast<float>());
-#if false
-      CLOG(DEBUG, "lidar.safe_corridor")
-          << "query sequence id: " << query_sid
-          << ", T_curr_query: " << T_curr_query.vec().transpose();
-#endif
-    }
-  }
+      : corridor_(corridor), width_(width), d0_(d0) {}
 
   void operator()(const Eigen::Vector2f &q, float &v) const {
-    // use the following convention (all points are (x, y)):
-    //   q  - query point (center of the cell)
-    //   p  - projected point on to the line segment
-    //   xs - start point of the line segment
-    //   xe - end point of the line segment
-    std::vector<float> distances;
-    distances.reserve(T_curr_query_xy_vec.size() + 1);
-
-    // distance to the first vertex along the map
-    distances.emplace_back((q - T_curr_query_xy_vec.front()).norm());
-    // distance to intermediate line segments
-    if (T_curr_query_xy_vec.size() > 1) {
-      for (size_t i = 0; i < T_curr_query_xy_vec.size() - 1; ++i) {
-        const auto &xs = T_curr_query_xy_vec[i];
-        const auto &xe = T_curr_query_xy_vec[i + 1];
-        float alpha = (q - xs).dot(xe - xs) / (xe - xs).squaredNorm();
-        alpha = std::clamp(alpha, 0.0f, 1.0f);
-        const auto p = xs + alpha * (xe - xs);
-        distances.emplace_back((q - p).norm());
-      }
-    }
-    // distance to the last vertex along the path
-    distances.emplace_back((q - T_curr_query_xy_vec.back()).norm());
-
-    // find the minimum distance
-    const auto min_dist = *std::min_element(distances.begin(), distances.end());
+    // distance to the closest segment of the path ahead
+    const auto min_dist = corridor_.distance(q);
 #if false
     CLOG(DEBUG, "lidar.safe_corridor")
-        << "distances of: <" << q(0) << "," << q(1) << ">: " << distances;
+        << "min distance of: <" << q(0) << "," << q(1) << ">: " << min_dist;
 #endif
     // update the value of v
     v = std::max(1 - (width_ - min_dist) / d0_, 0.0f);
   }
 
-  std::vector<Eigen::Matrix4d> T_curr_query_vec;
-  std::vector<Eigen::Vector2f> T_curr_query_xy_vec;
-
  private:
-  const float lookahead_distance_;
+  const Corridor &corridor_;
   const float width_;
   const float d0_;
 };
@@ -124,7 +75,10 @@ SafeCorridorModule::SafeCorridorModule(
     const Config::ConstPtr &config,
     const std::shared_ptr<tactic::ModuleFactory> &module_factory,
     const std::string &name)
-    : tactic::BaseModule{module_factory, name}, config_(config) {}
+    : tactic::BaseModule{module_factory, name},
+      config_(config),
+      corridor_cache_(config->corridor_lookahead_distance, config->resolution,
+                      config->size_x, config->size_y) {}
 
 void SafeCorridorModule::run_(QueryCache &qdata0, OutputCache &output0,
                               const Graph::Ptr & /* graph */,
@@ -149,10 +103,11 @@ void SafeCorridorModule::run_(QueryCache &qdata0, OutputCache &output0,
   const auto costmap = std::make_shared<DenseCostMap>(
       config_->resolution, config_->size_x, config_->size_y);
 
-  // mask out the robot footprint during teach pass
-  ComputeCorridorOp compute_corridor_op(
-      loc_sid, chain, config_->corridor_lookahead_distance,
-      config_->corridor_width, config_->influence_distance);
+  // mask out the robot footprint during teach pass, the corridor is only
+  // rebuilt when the localization vertex or the path ahead changes
+  const auto corridor = corridor_cache_.get(chain, loc_sid);
+  ComputeCorridorOp compute_corridor_op(*corridor, config_->corridor_width,
+                                        config_->influence_distance);
   costmap->update(compute_corridor_op);
   // add transform to the localization vertex
   costmap->T_vertex_this() = tactic::EdgeTransform(true);
@@ -175,9 +130,7 @@ void SafeCorridorModule::run_(QueryCache &qdata0, OutputCache &output0,
   }
 
   /// output
-  auto safe_corridor_costmap_ref = output.safe_corridor_costmap.locked();
-  auto &safe_corridor_costmap = safe_corridor_costmap_ref.get();
-  safe_corridor_costmap = costmap;
+  output.safe_corridor_costmap.publish(costmap);
 }
 
 }  // namespace lidar
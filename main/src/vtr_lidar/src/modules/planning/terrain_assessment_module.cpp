@@ -18,8 +18,6 @@
  */
 #include "vtr_lidar/modules/planning/terrain_assessment_module.hpp"
 
-#include "pcl/features/normal_3d.h"
-
 #include "vtr_lidar/utils/nanoflann_utils.hpp"
 
 namespace vtr {
@@ -29,70 +27,22 @@ namespace {
 
 class ComputeCorridorOp {
  public:
-  ComputeCorridorOp(const unsigned &curr_sid,
-                    const tactic::LocalizationChain &chain,
-                    const float &lookahead_distance, const float &width)
-      : lookahead_distance_(lookahead_distance), width_(width) {
-    auto lock = chain.guard();
-    // compute vertex lookahead
-    const auto distance = chain.dist(curr_sid);
-    const auto T_w_curr = chain.pose(curr_sid);
-    for (auto query_sid = curr_sid;
-         query_sid < chain.size() &&
-         (chain.dist(query_sid) - distance) < lookahead_distance_;
-         ++query_sid) {
-      const auto T_curr_query = T_w_curr.inverse() * chain.pose(query_sid);
-      T_curr_query_vec.emplace_back(T_curr_query.matrix());
-      T_curr_query_xy_vec.emplace_back(
-          T_curr_query.matrix().block<2, 1>(0, 3).cast<float>());
-#if false
-      CLOG(DEBUG, "lidar.terrain_assessment")
-          << "query sequence id: " << query_sid
-          << ", T_curr_query: " << T_curr_query.vec().transpose();
-#endif
-    }
-  }
+  ComputeCorridorOp(const Corridor &corridor, const float &width)
+      : corridor_(corridor), width_(width) {}
 
   void operator()(const Eigen::Vector2f &q, float &v) const {
-    // use the following convention (all points are (x, y)):
-    //   q  - query point (center of the cell)
-    //   p  - projected point on to the line segment
-    //   xs - start point of the line segment
-    //   xe - end point of the line segment
-    std::vector<float> distances;
-    distances.reserve(T_curr_query_xy_vec.size() + 1);
-
-    // distance to the first vertex along the map
-    distances.emplace_back((q - T_curr_query_xy_vec.front()).norm());
-    // distance to intermediate line segments
-    if (T_curr_query_xy_vec.size() > 1) {
-      for (size_t i = 0; i < T_curr_query_xy_vec.size() - 1; ++i) {
-        const auto &xs = T_curr_query_xy_vec[i];
-        const auto &xe = T_curr_query_xy_vec[i + 1];
-        float alpha = (q - xs).dot(xe - xs) / (xe - xs).squaredNorm();
-        alpha = std::clamp(alpha, 0.0f, 1.0f);
-        const auto p = xs + alpha * (xe - xs);
-        distances.emplace_back((q - p).norm());
-      }
-    }
-    // distance to the last vertex along the path
-    distances.emplace_back((q - T_curr_query_xy_vec.back()).norm());
-
-    // find the minimum distance
-    const auto min_dist = *std::min_element(distances.begin(), distances.end());
+    // distance to the closest segment of the path ahead
+    const auto min_dist = corridor_.distance(q);
 #if false
     CLOG(DEBUG, "lidar.terrain_assessment")
-        << "distances of: <" << q(0) << "," << q(1) << ">: " << distances;
+        << "min distance of: <" << q(0) << "," << q(1) << ">: " << min_dist;
 #endif
     // update the value of v
     v = min_dist > width_ ? v : 1;
   }
 
-  std::vector<Eigen::Matrix4d> T_curr_query_vec;
-  std::vector<Eigen::Vector2f> T_curr_query_xy_vec;
-
  private:
-  const float lookahead_distance_;
+  const Corridor &corridor_;
   const float width_;
 };
 
@@ -100,23 +50,23 @@ template <typename PointT>
 class AssessTerrainOp {
  public:
   AssessTerrainOp(const pcl::PointCloud<PointT> &points,
-                  const float &search_radius)
+                  const KDTree<PointT> &kdtree, const float &search_radius)
       : points_(points),
-        sq_search_radius_(search_radius * search_radius),
-        adapter_(points) {
-    /// create kd-tree of the point cloud for radius search
-    kdtree_ = std::make_unique<KDTree<PointT>>(2, adapter_,
-                                               KDTreeParams(10 /* max leaf */));
-    kdtree_->buildIndex();
+        kdtree_(kdtree),
+        sq_search_radius_(search_radius * search_radius) {
     // search params setup
     search_params_.sorted = false;
   }
 
+  /// \note called concurrently for different cells
   void operator()(const Eigen::Vector2f &point, float &value) const {
     /// find the nearest neighbors
-    std::vector<std::pair<size_t, float>> inds_dists;
-    size_t num_neighbors = kdtree_->radiusSearch(
-        point.data(), sq_search_radius_, inds_dists, search_params_);
+    std::vector<float> dists;
+    std::vector<int> indices;
+    NanoFLANNRadiusResultSet<float, int> result(sq_search_radius_, dists,
+                                                indices);
+    kdtree_.radiusSearchCustomCallback(point.data(), result, search_params_);
+    const auto num_neighbors = indices.size();
 
     if (num_neighbors < 5) {
 #if false
@@ -129,39 +79,24 @@ class AssessTerrainOp {
       return;
     }
 
-    std::vector<int> indices(num_neighbors);
-    for (size_t i = 0; i < num_neighbors; i++) indices[i] = inds_dists[i].first;
-
-    /// apply pca to compute the roughness
-    // get points for computation
-    const pcl::PointCloud<PointT> query_points(points_, indices);
+    /// apply pca to compute the roughness, directly on the neighbors (same
+    /// as pcl::compute3DCentroid + pcl::computeCovarianceMatrix)
+    Eigen::Vector3f centroid = Eigen::Vector3f::Zero();
+    for (const auto &i : indices) centroid += points_[i].getVector3fMap();
+    centroid /= static_cast<float>(num_neighbors);
 
-    // Placeholder for the 3x3 covariance matrix at each surface patch
-    Eigen::Matrix3f covariance_matrix;
-    // 16-bytes aligned placeholder for the XYZ centroid of a surface patch
-    Eigen::Vector4f xyz_centroid;
-
-    // Estimate the XYZ centroid
-    pcl::compute3DCentroid(query_points, xyz_centroid);
-    // Compute the 3x3 covariance matrix
-    pcl::computeCovarianceMatrix(query_points, xyz_centroid, covariance_matrix);
+    Eigen::Matrix3f covariance_matrix = Eigen::Matrix3f::Zero();
+    for (const auto &i : indices) {
+      const Eigen::Vector3f diff = points_[i].getVector3fMap() - centroid;
+      covariance_matrix.selfadjointView<Eigen::Lower>().rankUpdate(diff);
+    }
 
-    // Compute pca
+    // Compute pca, only the eigenvalues are needed
     Eigen::SelfAdjointEigenSolver<Eigen::Matrix3f> es;
-    es.compute(covariance_matrix);
+    es.compute(covariance_matrix, Eigen::EigenvaluesOnly);
 
     // compute the roughness (smallest eigenvalue)
     float roughness = std::abs(es.eigenvalues()(0));
-#if false
-    // compute the slope of the surface (1 is vertical, 0 is horizontal)
-    float slope = std::abs(es.eigenvectors()(0, 2));
-    // compute the step height (max difference between points)
-    std::vector<float> z_values(num_neighbors);
-    for (size_t i = 0; i < num_neighbors; i++) z_values[i] = query_points[i].z;
-    std::sort(z_values.begin(), z_values.end());
-    // \todo consider using the 90 percentile
-    float step_height = z_values[num_neighbors - 1] - z_values[0];
-#endif
 #if false
     CLOG(DEBUG, "lidar.terrain_assessment")
         << "looking at point: <" << x << "," << y
@@ -173,19 +108,50 @@ class AssessTerrainOp {
  private:
   /** \brief reference to the point cloud */
   const pcl::PointCloud<PointT> &points_;
+  /** \brief 2D kd-tree of the point cloud */
+  const KDTree<PointT> &kdtree_;
 
   /** \brief squared search radius */
   const float sq_search_radius_;
 
   KDTreeSearchParams search_params_;
-  NanoFLANNAdapter<PointT> adapter_;
-  std::unique_ptr<KDTree<PointT>> kdtree_;
 };
 
 }  // namespace
 
 using namespace tactic;
 
+struct TerrainAssessmentModule::MapIndex {
+  MapIndex(const VertexId &vid0, const PointMap<PointWithInfo> &map)
+      : vid(vid0),
+        version(map.version()),
+        points(map.point_cloud()),
+        adapter(points) {
+    // transform into vertex frame
+    // clang-format off
+    const auto &T_lv_pm = map.T_vertex_this().matrix();
+    auto points_mat = points.getMatrixXfMap(3, PointWithInfo::size(), PointWithInfo::cartesian_offset());
+    auto normal_mat = points.getMatrixXfMap(3, PointWithInfo::size(), PointWithInfo::normal_offset());
+    // clang-format on
+    Eigen::Matrix3f C_lv_pm = (T_lv_pm.block<3, 3>(0, 0)).cast<float>();
+    Eigen::Vector3f r_lv_pm = (T_lv_pm.block<3, 1>(0, 3)).cast<float>();
+    points_mat = ((C_lv_pm * points_mat).colwise() + r_lv_pm).eval();
+    normal_mat = (C_lv_pm * normal_mat).eval();
+
+    /// create 2D kd-tree of the point cloud for radius search
+    kdtree = std::make_unique<KDTree<PointWithInfo>>(
+        2, adapter, KDTreeParams(10 /* max leaf */));
+    kdtree->buildIndex();
+  }
+
+  const VertexId vid;
+  const unsigned version;
+  /** \brief map points in vertex frame */
+  pcl::PointCloud<PointWithInfo> points;
+  NanoFLANNAdapter<PointWithInfo> adapter;
+  std::unique_ptr<KDTree<PointWithInfo>> kdtree;
+};
+
 auto TerrainAssessmentModule::Config::fromROS(
     const rclcpp::Node::SharedPtr &node, const std::string &param_prefix)
     -> ConstPtr {
@@ -195,7 +161,9 @@ auto TerrainAssessmentModule::Config::fromROS(
   config->corridor_lookahead_distance = node->declare_parameter<float>(param_prefix + ".corridor_lookahead_distance", config->corridor_lookahead_distance);
   config->corridor_width = node->declare_parameter<float>(param_prefix + ".corridor_width", config->corridor_width);
   // terrain assessment
+  config->assess_terrain = node->declare_parameter<bool>(param_prefix + ".assess_terrain", config->assess_terrain);
   config->search_radius = node->declare_parameter<float>(param_prefix + ".search_radius", config->search_radius);
+  config->num_threads = node->declare_parameter<int>(param_prefix + ".num_threads", config->num_threads);
   // cost map
   config->resolution = node->declare_parameter<float>(param_prefix + ".resolution", config->resolution);
   config->size_x = node->declare_parameter<float>(param_prefix + ".size_x", config->size_x);
@@ -212,7 +180,10 @@ TerrainAssessmentModule::TerrainAssessmentModule(
     const Config::ConstPtr &config,
     const std::shared_ptr<tactic::ModuleFactory> &module_factory,
     const std::string &name)
-    : tactic::BaseModule{module_factory, name}, config_(config) {}
+    : tactic::BaseModule{module_factory, name},
+      config_(config),
+      corridor_cache_(config->corridor_lookahead_distance, config->resolution,
+                      config->size_x, config->size_y) {}
 
 void TerrainAssessmentModule::run_(QueryCache &qdata0, OutputCache &output0,
                                    const Graph::Ptr &graph,
@@ -268,34 +239,30 @@ void TerrainAssessmentModule::runAsync_(
   const auto &loc_vid = *qdata.vid_loc;
   const auto &loc_sid = *qdata.sid_loc;
   const auto &point_map = *qdata.submap_loc;
-  const auto &T_lv_pm = point_map.T_vertex_this().matrix();
-  auto point_cloud = point_map.point_cloud();  // copy for changing
 
   CLOG(INFO, "lidar.terrain_assessment")
       << "Terrain Assessment for vertex: " << loc_vid;
 
-  // transform into vertex frame
-  // clang-format off
-  auto points_mat = point_cloud.getMatrixXfMap(3, PointWithInfo::size(), PointWithInfo::cartesian_offset());
-  auto normal_mat = point_cloud.getMatrixXfMap(3, PointWithInfo::size(), PointWithInfo::normal_offset());
-  // clang-format on
-  Eigen::Matrix3f C_lv_pm = (T_lv_pm.block<3, 3>(0, 0)).cast<float>();
-  Eigen::Vector3f r_lv_pm = (T_lv_pm.block<3, 1>(0, 3)).cast<float>();
-  points_mat = ((C_lv_pm * points_mat).colwise() + r_lv_pm).eval();
-  normal_mat = (C_lv_pm * normal_mat).eval();
+  // map in vertex frame and its 2D index, only rebuilt if the map changed
+  const auto map_index =
+      (config_->assess_terrain || config_->visualize)
+          ? getMapIndex(loc_vid, point_map)
+          : nullptr;
 
   // construct the cost map
   const auto costmap = std::make_shared<DenseCostMap>(
       config_->resolution, config_->size_x, config_->size_y);
-  // // update cost map based on terrain assessment result
-  // AssessTerrainOp<PointWithInfo> assess_terrain_op(point_cloud,
-  //                                                  config_->search_radius);
-  // costmap->update(assess_terrain_op);
-  // mask out the robot footprint during teach pass
-  ComputeCorridorOp compute_corridor_op(loc_sid, chain,
-                                        config_->corridor_lookahead_distance,
-                                        config_->corridor_width);
-  costmap->update(compute_corridor_op);
+  // update cost map based on terrain assessment result
+  if (config_->assess_terrain) {
+    AssessTerrainOp<PointWithInfo> assess_terrain_op(
+        map_index->points, *map_index->kdtree, config_->search_radius);
+    costmap->update(assess_terrain_op, config_->num_threads);
+  }
+  // mask out the robot footprint during teach pass, the corridor is only
+  // rebuilt when the localization vertex or the path ahead changes
+  const auto corridor = corridor_cache_.get(chain, loc_sid);
+  ComputeCorridorOp compute_corridor_op(*corridor, config_->corridor_width);
+  costmap->update(compute_corridor_op, config_->num_threads);
   // add transform to the localization vertex
   costmap->T_vertex_this() = tactic::EdgeTransform(true);
   costmap->vertex_id() = loc_vid;
@@ -320,7 +287,7 @@ void TerrainAssessmentModule::runAsync_(
     if (!config_->run_online) {
       // publish the transformed map (now in vertex frame)
       PointCloudMsg pc2_msg;
-      pcl::toROSMsg(point_cloud, pc2_msg);
+      pcl::toROSMsg(map_index->points, pc2_msg);
       pc2_msg.header.frame_id = "world (offset)";
       // pc2_msg.header.stamp = rclcpp::Time(*qdata.stamp);
       map_pub_->publish(pc2_msg);
@@ -328,11 +295,9 @@ void TerrainAssessmentModule::runAsync_(
       // publish the teach path
       PathMsg path_msg;
       path_msg.header.frame_id = "terrain assessment";
-      for (unsigned i = 0; i < compute_corridor_op.T_curr_query_vec.size();
-           ++i) {
+      for (const auto &T_curr_query : corridor->T_curr_query_vec()) {
         auto &pose = path_msg.poses.emplace_back();
-        pose.pose = tf2::toMsg(
-            Eigen::Affine3d(compute_corridor_op.T_curr_query_vec[i]));
+        pose.pose = tf2::toMsg(Eigen::Affine3d(T_curr_query));
       }
       path_pub_->publish(path_msg);
     }
@@ -351,14 +316,25 @@ void TerrainAssessmentModule::runAsync_(
   }
 
   /// output
-  auto terrain_assessment_costmap_ref =
-      output.terrain_assessment_costmap.locked();
-  auto &terrain_assessment_costmap = terrain_assessment_costmap_ref.get();
-  terrain_assessment_costmap = costmap;
+  output.terrain_assessment_costmap.publish(costmap);
 
   CLOG(INFO, "lidar.terrain_assessment")
       << "Terrain Assessment for vertex: " << loc_vid << " - DONE!";
 }
 
+auto TerrainAssessmentModule::getMapIndex(const VertexId &vid,
+                                          const PointMap<PointWithInfo> &map)
+    -> std::shared_ptr<const MapIndex> {
+  std::lock_guard<std::mutex> lock(index_mutex_);
+  if (map_index_ == nullptr || map_index_->vid != vid ||
+      map_index_->version != map.version() ||
+      map_index_->points.size() != map.size()) {
+    CLOG(DEBUG, "lidar.terrain_assessment")
+        << "Building the map index for vertex " << vid;
+    map_index_ = std::make_shared<const MapIndex>(vid, map);
+  }
+  return map_index_;
+}
+
 }  // namespace lidar
 }  // namespace vtr
\ No newline at end of file
@@ -23,8 +23,10 @@
 
 #include "vtr_lidar/data_types/pointmap.hpp"
 #include "vtr_lidar/data_types/pointmap_pointer.hpp"
+#include "vtr_lidar/data_types/pointmap_versions.hpp"
 #include "vtr_lidar/segmentation/ray_tracing.hpp"
 #include "vtr_pose_graph/path/pose_cache.hpp"
+#include "vtr_tactic/quality_controller.hpp"
 
 namespace vtr {
 namespace lidar {
@@ -45,12 +47,56 @@ auto DynamicDetectionModule::Config::fromROS(
   config->max_num_observations = node->declare_parameter<int>(param_prefix + ".max_num_observations", config->max_num_observations);
   config->min_num_observations = node->declare_parameter<int>(param_prefix + ".min_num_observations", config->min_num_observations);
   config->dynamic_threshold = node->declare_parameter<float>(param_prefix + ".dynamic_threshold", config->dynamic_threshold);
+  config->num_threads = node->declare_parameter<int>(param_prefix + ".num_threads", config->num_threads);
+  config->quality_scan_stride = node->declare_parameter<int>(param_prefix + ".quality_scan_stride", config->quality_scan_stride);
+  config->frustum_grid_cache_size = node->declare_parameter<int>(param_prefix + ".frustum_grid_cache_size", config->frustum_grid_cache_size);
   // general
   config->visualize = node->declare_parameter<bool>(param_prefix + ".visualize", config->visualize);
   // clang-format on
   return config;
 }
 
+auto DynamicDetectionModule::getScan(const Vertex::Ptr &vertex)
+    -> CachedScan::ConstPtr {
+  {
+    std::lock_guard<std::mutex> lock(scan_cache_mutex_);
+    const auto it = scan_cache_.find(vertex->id());
+    if (it != scan_cache_.end()) {
+      // move to the front of the lru list
+      scan_cache_lru_.splice(scan_cache_lru_.begin(), scan_cache_lru_,
+                             it->second.second);
+      return it->second.first;
+    }
+  }
+
+  // retrieve point scan from this vertex and rasterize it, without the lock
+  const auto scan_msg = vertex->retrieve<PointScan<PointWithInfo>>(
+      "filtered_point_cloud", "vtr_lidar_msgs/msg/PointScan");
+  CachedScan::Ptr scan;
+  {
+    /// \note follow the convention to lock point map first then these scans.
+    auto locked_scan_msg = scan_msg->sharedLocked();
+    const auto &pointscan = locked_scan_msg.get().getData();
+    scan = std::make_shared<CachedScan>(CachedScan{
+        pointscan.T_vertex_this(),
+        ray_tracing::FrustumGrid(pointscan.point_cloud(),
+                                 config_->horizontal_resolution,
+                                 config_->vertical_resolution)});
+  }
+
+  std::lock_guard<std::mutex> lock(scan_cache_mutex_);
+  if (scan_cache_.count(vertex->id()) == 0) {
+    scan_cache_lru_.push_front(vertex->id());
+    scan_cache_.emplace(vertex->id(),
+                        std::make_pair(scan, scan_cache_lru_.begin()));
+    while (scan_cache_.size() > (size_t)config_->frustum_grid_cache_size) {
+      scan_cache_.erase(scan_cache_lru_.back());
+      scan_cache_lru_.pop_back();
+    }
+  }
+  return scan;
+}
+
 void DynamicDetectionModule::run_(QueryCache &qdata0, OutputCache &,
                                   const Graph::Ptr &,
                                   const TaskExecutor::Ptr &executor) {
@@ -114,11 +160,12 @@ void DynamicDetectionModule::runAsync_(QueryCache &qdata0, OutputCache &,
   {
     const auto map_msg = target_vertex->retrieve<PointMap<PointWithInfo>>(
         "pointmap", "vtr_lidar_msgs/msg/PointMap");
-    auto locked_map_msg_ref = map_msg->sharedLocked();  // lock the msg
-    auto &locked_map_msg = locked_map_msg_ref.get();
 
-    // check if this map has been updated already
-    const auto curr_map_version = locked_map_msg.getData().version();
+    // check if this map has been updated already, the initial version may
+    // only be stored as a delta (see pointmap_versions.hpp)
+    const auto curr_map_version =
+        map_msg == nullptr ? PointMap<PointWithInfo>::INITIAL
+                           : map_msg->sharedLocked().get().getData().version();
     if (curr_map_version >= PointMap<PointWithInfo>::DYNAMIC_REMOVED) {
       CLOG(WARNING, "lidar.dynamic_detection")
           << "Dynamic Obstacle Detection for vertex: " << target_vid
@@ -150,9 +197,7 @@ void DynamicDetectionModule::runAsync_(QueryCache &qdata0, OutputCache &,
   /// Perform the map update
 
   // get a copy of the current map for updating
-  const auto map_msg = target_vertex->retrieve<PointMap<PointWithInfo>>(
-      "pointmap", "vtr_lidar_msgs/msg/PointMap");
-  auto updated_map = map_msg->sharedLocked().get().getData();
+  auto updated_map = *retrievePointMap<PointWithInfo>(graph, target_vertex);
 
   // initialize dynamic observation
   updated_map.point_cloud()
@@ -185,85 +230,69 @@ void DynamicDetectionModule::runAsync_(QueryCache &qdata0, OutputCache &,
   // cache all the transforms so we only calculate them once
   pose_graph::PoseCache<GraphBase> pose_cache(subgraph, target_vid);
 
-  size_t num_scan_used = 0;
-  auto itr = subgraph->begin(target_vid);
-  for (; itr != subgraph->end(); itr++) {
-    //
-    const auto vertex = itr->v();
+  // ray-trace fewer scans when the pipeline is behind
+  const size_t scan_stride =
+      1 + qualityLevel(qdata) * std::max(config_->quality_scan_stride, 0);
 
+  std::vector<Vertex::Ptr> vertices;
+  std::vector<EdgeTransform> T_target_currs;
+  size_t scan_idx = 0;
+  for (auto itr = subgraph->begin(target_vid); itr != subgraph->end(); itr++) {
+    if (scan_idx++ % scan_stride != 0) continue;
+    vertices.emplace_back(itr->v());
     // get target vertex to current vertex transformation
-    auto T_target_curr = pose_cache.T_root_query(vertex->id());
+    T_target_currs.emplace_back(pose_cache.T_root_query(itr->v()->id()));
     CLOG(DEBUG, "lidar.dynamic_detection")
-        << "T_target_curr is " << T_target_curr.vec().transpose();
-
-    // retrieve point scan from this vertex
-    const auto scan_msg = vertex->retrieve<PointScan<PointWithInfo>>(
-        "filtered_point_cloud", "vtr_lidar_msgs/msg/PointScan");
+        << "T_target_curr is " << T_target_currs.back().vec().transpose();
+  }
 
-    /// \note follow the convention to lock point map first then these scans.
-    auto pointscan = scan_msg->sharedLocked().get().getData();
+  // ray-trace the map against every scan in parallel, each thread accumulates
+  // observations into its own buffer which are then reduced into the map
+  const auto &query = updated_map.point_cloud();
+  const auto T_vertex_qry = updated_map.T_vertex_this();
+  std::vector<float> total_obs(query.size(), 0.f);
+  std::vector<float> dynamic_obs(query.size(), 0.f);
 
-    //
-    const auto &reference = pointscan.point_cloud();
-    auto &query = updated_map.point_cloud();
-    const auto T_ref_qry =
-        (T_target_curr * pointscan.T_vertex_this()).inverse() *
-        updated_map.T_vertex_this();
+#pragma omp parallel num_threads(config_->num_threads)
+  {
+    std::vector<float> total_obs_local(query.size(), 0.f);
+    std::vector<float> dynamic_obs_local(query.size(), 0.f);
+
+#pragma omp for schedule(dynamic, 1)
+    for (size_t j = 0; j < vertices.size(); j++) {
+      const auto scan = getScan(vertices[j]);
+      const auto T_ref_qry =
+          (T_target_currs[j] * scan->T_vertex_this).inverse() * T_vertex_qry;
+      accumulateDynamicObservations(scan->frustum_grid, query, T_ref_qry,
+                                    total_obs_local.data(),
+                                    dynamic_obs_local.data());
+    }
 
-    //
-    detectDynamicObjects(
-        reference, query, T_ref_qry, config_->horizontal_resolution,
-        config_->vertical_resolution, config_->max_num_observations,
-        config_->min_num_observations, config_->dynamic_threshold);
-
-#if false  // debugging
-    if (config_->visualize) {
-      const auto T_qry_ref = T_ref_qry.inverse().matrix().cast<float>();
-      auto reference_tmp = reference;
-      auto reference_mat = reference_tmp.getMatrixXfMap(
-          4, PointWithInfo::size(), PointWithInfo::cartesian_offset());
-      reference_mat = T_qry_ref * reference_mat;
-
-      std::unique_lock<std::mutex> lock(mutex_);
-      {
-        PointCloudMsg pc2_msg;
-        pcl::toROSMsg(reference_tmp, pc2_msg);
-        pc2_msg.header.frame_id = "world";
-        // pc2_msg.header.stamp = 0;
-        scan_pub_->publish(pc2_msg);
-      }
-      std::this_thread::sleep_for(std::chrono::milliseconds(500));
+#pragma omp critical
+    for (size_t i = 0; i < query.size(); i++) {
+      total_obs[i] += total_obs_local[i];
+      dynamic_obs[i] += dynamic_obs_local[i];
     }
-#endif
-    //
-    ++num_scan_used;
   }
+
+  auto &updated_point_cloud = updated_map.point_cloud();
+  for (size_t i = 0; i < updated_point_cloud.size(); i++) {
+    updated_point_cloud[i].total_obs = total_obs[i];
+    updated_point_cloud[i].dynamic_obs = dynamic_obs[i];
+  }
+  updateStaticScores(updated_point_cloud,
+                     (float)config_->max_num_observations,
+                     (float)config_->min_num_observations);
+
   CLOG(DEBUG, "lidar.dynamic_detection")
-      << "Number of scan used: " << num_scan_used;
+      << "Number of scan used: " << vertices.size();
 
   // update version
   updated_map.version() = PointMap<PointWithInfo>::DYNAMIC_REMOVED;
 
-  // update the point map of this vertex
-  {
-    const auto map_msg = target_vertex->retrieve<PointMap<PointWithInfo>>(
-        "pointmap", "vtr_lidar_msgs/msg/PointMap");
-    auto locked_map_msg_ref = map_msg->locked();  // lock the msg
-    auto &locked_map_msg = locked_map_msg_ref.get();
-    locked_map_msg.setData(updated_map);
-  }
-
-  // store a copy of the updated map for debugging
-  {
-    using PointMapLM = storage::LockableMessage<PointMap<PointWithInfo>>;
-    auto updated_map_copy =
-        std::make_shared<PointMap<PointWithInfo>>(updated_map);
-    auto updated_map_copy_msg = std::make_shared<PointMapLM>(
-        updated_map_copy, target_vertex->vertexTime());
-    target_vertex->insert<PointMap<PointWithInfo>>(
-        "pointmap_v" + std::to_string(updated_map_copy->version()),
-        "vtr_lidar_msgs/msg/PointMap", updated_map_copy_msg);
-  }
+  // update the point map of this vertex, the previous version is kept for
+  // debugging
+  replacePointMap(target_vertex, updated_map);
 
   /// publish the transformed pointcloud
   if (config_->visualize) {
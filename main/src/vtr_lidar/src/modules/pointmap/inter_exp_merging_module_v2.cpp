@@ -21,6 +21,7 @@
 #include "vtr_lidar/data_types/multi_exp_pointmap.hpp"
 #include "vtr_lidar/data_types/pointmap.hpp"
 #include "vtr_lidar/data_types/pointmap_pointer.hpp"
+#include "vtr_lidar/data_types/pointmap_versions.hpp"
 #include "vtr_lidar/utils/nanoflann_utils.hpp"
 #include "vtr_pose_graph/path/pose_cache.hpp"
 
@@ -100,14 +101,13 @@ void InterExpMergingModuleV2::runAsync_(QueryCache &qdata0, OutputCache &,
   }
 
   /// retrieve the map for the curr vertex
-  const auto curr_map_msg = curr_vertex->retrieve<PointMap<PointWithInfo>>(
-      "pointmap", "vtr_lidar_msgs/msg/PointMap");
-  if (curr_map_msg == nullptr) { 
+  const auto curr_map = retrievePointMap<PointWithInfo>(graph, curr_vertex);
+  if (curr_map == nullptr) { 
       CLOG(WARNING, "lidar.inter_exp_merging")
           << "Pointmap pointer, skipped.";
       return;
     }
-  auto pointmap = curr_map_msg->sharedLocked().get().getData();
+  auto &pointmap = *curr_map;
   auto &pointcloud = pointmap.point_cloud();
 
 #if true
@@ -20,6 +20,7 @@
 
 #include "vtr_lidar/data_types/pointmap.hpp"
 #include "vtr_lidar/data_types/pointmap_pointer.hpp"
+#include "vtr_lidar/data_types/pointmap_versions.hpp"
 #include "vtr_pose_graph/path/pose_cache.hpp"
 
 namespace vtr {
@@ -38,6 +39,7 @@ auto IntraExpMergingModuleV2::Config::fromROS(
   config->map_voxel_size = node->declare_parameter<float>(param_prefix + ".map_voxel_size", config->map_voxel_size);
   config->crop_range_front = node->declare_parameter<float>(param_prefix + ".crop_range_front", config->crop_range_front);
   config->back_over_front_ratio = node->declare_parameter<float>(param_prefix + ".back_over_front_ratio", config->back_over_front_ratio);
+  config->num_threads = node->declare_parameter<int>(param_prefix + ".num_threads", config->num_threads);
   // general
   config->visualize = node->declare_parameter<bool>(param_prefix + ".visualize", config->visualize);
   // clang-format on
@@ -111,16 +113,19 @@ void IntraExpMergingModuleV2::runAsync_(QueryCache &qdata0, OutputCache &,
   {
     const auto map_msg = target_vertex->retrieve<PointMap<PointWithInfo>>(
         "pointmap", "vtr_lidar_msgs/msg/PointMap");
-    if (map_msg == nullptr) { 
+    // the initial version may only be stored as a delta
+    if (map_msg == nullptr &&
+        target_vertex->retrieve<PointMapDelta<PointWithInfo>>(
+            "pointmap_delta", "vtr_lidar_msgs/msg/PointMapDelta") == nullptr) {
       CLOG(WARNING, "lidar.inter_exp_merging")
           << "No pointmap pointer, skipped.";
       return;
     }
-    auto locked_map_msg_ref = map_msg->sharedLocked();  // lock the msg
-    auto &locked_map_msg = locked_map_msg_ref.get();
 
     // check if this map has been updated already
-    const auto curr_map_version = locked_map_msg.getData().version();
+    const auto curr_map_version =
+        map_msg == nullptr ? PointMap<PointWithInfo>::INITIAL
+                           : map_msg->sharedLocked().get().getData().version();
     if (curr_map_version >= PointMap<PointWithInfo>::INTRA_EXP_MERGED) {
       CLOG(WARNING, "lidar.intra_exp_merging")
           << "Intra-Experience Merging for vertex: " << target_vid
@@ -143,31 +148,45 @@ void IntraExpMergingModuleV2::runAsync_(QueryCache &qdata0, OutputCache &,
   // cache all the transforms so we only calculate them once
   pose_graph::PoseCache<GraphBase> pose_cache(subgraph, target_vid);
 
-  size_t num_map_merged = 0;
-  auto itr = subgraph->begin(target_vid);
-  for (; itr != subgraph->end(); itr++) {
-    //
-    const auto vertex = itr->v();
+  // vertices in traversal order, with their transformation to the target
+  std::vector<Vertex::Ptr> vertices;
+  std::vector<EdgeTransform> T_target_currs;
+  for (auto itr = subgraph->begin(target_vid); itr != subgraph->end(); itr++) {
+    vertices.emplace_back(itr->v());
+    T_target_currs.emplace_back(pose_cache.T_root_query(itr->v()->id()));
+  }
+
+  // fetch and transform the initial maps concurrently
+  std::vector<std::shared_ptr<PointMap<PointWithInfo>>> pointmaps(
+      vertices.size());
+#pragma omp parallel for schedule(dynamic, 1) num_threads(config_->num_threads)
+  for (size_t i = 0; i < vertices.size(); ++i) {
+    const auto &vertex = vertices[i];
 
     // check if this vertex has a map
     {
       const auto msg = vertex->retrieve<PointMapPointer>(
           "pointmap_ptr", "vtr_lidar_msgs/msg/PointMapPointer");
+      if (msg == nullptr) continue;
       auto locked_msg = msg->sharedLocked();
       const auto &pointmap_ptr = locked_msg.get().getData();
       if (pointmap_ptr.map_vid != vertex->id()) continue;
     }
 
     // get target vertex to current vertex transformation
-    auto T_target_curr = pose_cache.T_root_query(vertex->id());
+    const auto &T_target_curr = T_target_currs[i];
     CLOG(DEBUG, "lidar.intra_exp_merging")
         << "T_target_curr is " << T_target_curr.vec().transpose();
 
     // retrieve point map v0 (initial map) from this vertex
-    const auto map_msg = vertex->retrieve<PointMap<PointWithInfo>>(
-        "pointmap_v0", "vtr_lidar_msgs/msg/PointMap");
-
-    auto pointmap = map_msg->sharedLocked().get().getData();
+    const auto pointmap_v0 = retrievePointMapVersion<PointWithInfo>(
+        graph, vertex, PointMap<PointWithInfo>::INITIAL);
+    if (pointmap_v0 == nullptr) {
+      CLOG(WARNING, "lidar.intra_exp_merging")
+          << "No initial map at vertex " << vertex->id() << ", skipped.";
+      continue;
+    }
+    auto &pointmap = *pointmap_v0;
     const auto &T_v_m = (T_target_curr * pointmap.T_vertex_this()).matrix();
     auto &point_cloud = pointmap.point_cloud();
 
@@ -179,12 +198,17 @@ void IntraExpMergingModuleV2::runAsync_(QueryCache &qdata0, OutputCache &,
     scan_mat = T_v_m.cast<float>() * scan_mat;
     scan_normal_mat = T_v_m.cast<float>() * scan_normal_mat;
 
-    // store this scan into the updatd map;
-    updated_map.update(point_cloud);
+    pointmaps[i] = pointmap_v0;
+  }
 
-    //
-    ++num_map_merged;
+  // store the scans into the updated map, in traversal order
+  std::vector<const PointMap<PointWithInfo>::PointCloudType *> point_clouds;
+  for (const auto &pointmap : pointmaps) {
+    if (pointmap == nullptr) continue;
+    point_clouds.emplace_back(&pointmap->point_cloud());
   }
+  updated_map.update(point_clouds, config_->num_threads);
+  const size_t num_map_merged = point_clouds.size();
   CLOG(DEBUG, "lidar.intra_exp_merging")
       << "Number of map merged: " << num_map_merged;
 
@@ -213,40 +237,19 @@ void IntraExpMergingModuleV2::runAsync_(QueryCache &qdata0, OutputCache &,
   // update version
   updated_map.version() = PointMap<PointWithInfo>::INTRA_EXP_MERGED;
 
-  // update the point map of this vertex
-  {
-    const auto map_msg = target_vertex->retrieve<PointMap<PointWithInfo>>(
-        "pointmap", "vtr_lidar_msgs/msg/PointMap");
-    auto locked_map_msg_ref = map_msg->locked();  // lock the msg
-    auto &locked_map_msg = locked_map_msg_ref.get();
-    locked_map_msg.setData(updated_map);
-  }
-
-  // store a copy of the updated map for debugging
-  {
-    using PointMapLM = storage::LockableMessage<PointMap<PointWithInfo>>;
-    auto updated_map_copy =
-        std::make_shared<PointMap<PointWithInfo>>(updated_map);
-    auto updated_map_copy_msg = std::make_shared<PointMapLM>(
-        updated_map_copy, target_vertex->vertexTime());
-    target_vertex->insert<PointMap<PointWithInfo>>(
-        "pointmap_v" + std::to_string(updated_map_copy->version()),
-        "vtr_lidar_msgs/msg/PointMap", updated_map_copy_msg);
-  }
+  // update the point map of this vertex, the previous version is kept for
+  // debugging
+  replacePointMap(target_vertex, updated_map);
 
   /// publish the transformed pointcloud
   if (config_->visualize) {
     std::unique_lock<std::mutex> lock(mutex_);
 
     // publish the old map
-    {
-      // load old map for reference
-      const auto map_msg = target_vertex->retrieve<PointMap<PointWithInfo>>(
-          "pointmap_v0", "vtr_lidar_msgs/msg/PointMap");
-      auto locked_map_msg_ref = map_msg->sharedLocked();  // lock the msg
-      auto &locked_map_msg = locked_map_msg_ref.get();
-      auto pointmap = locked_map_msg.getData();
-
+    // load old map for reference
+    if (const auto pointmap_v0 = retrievePointMapVersion<PointWithInfo>(
+            graph, target_vertex, PointMap<PointWithInfo>::INITIAL)) {
+      const auto &pointmap = *pointmap_v0;
       auto point_cloud = pointmap.point_cloud();  // COPY!
       const auto &T_v_m = pointmap.T_vertex_this().matrix();
 
@@ -21,6 +21,8 @@
 #include "pcl_conversions/pcl_conversions.h"
 #include "sensor_msgs/point_cloud2_iterator.hpp"
 
+#include "vtr_lidar/utils/point_cloud_pool.hpp"
+
 namespace vtr {
 namespace lidar {
 
@@ -51,8 +53,8 @@ void AevaConversionModule::run_(QueryCache &qdata0, OutputCache &,
   // Input
   const auto &points = *qdata.points;
 
-  auto point_cloud =
-      std::make_shared<pcl::PointCloud<PointWithInfo>>(points.rows(), 1);
+  auto point_cloud = pointCloudPool().acquire();
+  point_cloud->resize(points.rows());
 
   for (size_t idx = 0; idx < (size_t)points.rows(); idx++) {
     // cartesian coordinates
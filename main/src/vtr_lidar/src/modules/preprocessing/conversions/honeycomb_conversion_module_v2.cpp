@@ -21,6 +21,8 @@
 #include "pcl_conversions/pcl_conversions.h"
 #include "sensor_msgs/point_cloud2_iterator.hpp"
 
+#include "vtr_lidar/utils/point_cloud_pool.hpp"
+
 namespace vtr {
 namespace lidar {
 
@@ -69,8 +71,8 @@ void HoneycombConversionModuleV2::run_(QueryCache &qdata0, OutputCache &,
   /// center of spin, where beam side 0 is 0 degree and beam side 1 is +-180
   /// degree.
 
-  auto point_cloud = std::make_shared<pcl::PointCloud<PointWithInfo>>(
-      msg->width * msg->height, 1);
+  auto point_cloud = pointCloudPool().acquire();
+  point_cloud->resize(msg->width * msg->height);
 
   // time stamp at the center of the spin
   const int64_t center_time =
@@ -21,6 +21,8 @@
 #include "pcl_conversions/pcl_conversions.h"
 #include "sensor_msgs/point_cloud2_iterator.hpp"
 
+#include "vtr_lidar/utils/point_cloud_pool.hpp"
+
 namespace vtr {
 namespace lidar {
 
@@ -81,8 +83,8 @@ void OusterConversionModule::run_(QueryCache &qdata0, OutputCache &,
   // Input
   const auto &msg = qdata.pointcloud_msg.ptr();
 
-  auto point_cloud = std::make_shared<pcl::PointCloud<PointWithInfo>>(
-      msg->width * msg->height, 1);
+  auto point_cloud = pointCloudPool().acquire();
+  point_cloud->resize(msg->width * msg->height);
 
   // iterators
   // clang-format off
@@ -111,20 +113,15 @@ void OusterConversionModule::run_(QueryCache &qdata0, OutputCache &,
     //CLOG(DEBUG, "lidar.ouster_converter") << "Second point info - x: " << *iter_x << " y: " << *iter_y << " z: " << *iter_z << " timestamp: " << static_cast<int64_t>(*iter_time);
   }
 
-  auto filtered_point_cloud =
-      std::make_shared<pcl::PointCloud<PointWithInfo>>(*point_cloud);
+  auto filtered_point_cloud = point_cloud;
 
   /// Range cropping
   if (config_->filter_warthog_points){
-    std::vector<int> indices;
-    indices.reserve(filtered_point_cloud->size());
-    for (size_t i = 0; i < filtered_point_cloud->size(); ++i) {
-      auto& p = (*filtered_point_cloud)[i];
-      if (p.x*p.x + p.y*p.y > config_->filter_radius_sq || (p.z > config_->filter_z_max || p.z < config_->filter_z_min))
-        indices.emplace_back(i);
-    }
-    *filtered_point_cloud =
-        pcl::PointCloud<PointWithInfo>(*filtered_point_cloud, indices);
+    filtered_point_cloud = pointCloudPool().acquire();
+    copyPointsIf(*point_cloud, *filtered_point_cloud,
+                 [&](const PointWithInfo &p, const size_t &) {
+                   return p.x*p.x + p.y*p.y > config_->filter_radius_sq || (p.z > config_->filter_z_max || p.z < config_->filter_z_min);
+                 });
   }
 
 
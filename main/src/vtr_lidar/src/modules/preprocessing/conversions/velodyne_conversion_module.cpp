@@ -21,6 +21,8 @@
 #include "pcl_conversions/pcl_conversions.h"
 #include "sensor_msgs/point_cloud2_iterator.hpp"
 
+#include "vtr_lidar/utils/point_cloud_pool.hpp"
+
 namespace vtr {
 namespace lidar {
 
@@ -76,8 +78,8 @@ void VelodyneConversionModule::run_(QueryCache &qdata0, OutputCache &,
   const auto &stamp = *qdata.stamp; 
   const auto &points = *qdata.points;
 
-  auto point_cloud =
-      std::make_shared<pcl::PointCloud<PointWithInfo>>(points.rows(), 1);
+  auto point_cloud = pointCloudPool().acquire();
+  point_cloud->resize(points.rows());
 
     
     CLOG(INFO, "lidar.velodyne_converter") << "Made PCL";
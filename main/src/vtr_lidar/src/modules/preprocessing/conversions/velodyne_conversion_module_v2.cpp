@@ -21,6 +21,8 @@
 #include "pcl_conversions/pcl_conversions.h"
 #include "sensor_msgs/point_cloud2_iterator.hpp"
 
+#include "vtr_lidar/utils/point_cloud_pool.hpp"
+
 namespace vtr {
 namespace lidar {
 
@@ -84,8 +86,8 @@ void VelodyneConversionModuleV2::run_(QueryCache &qdata0, OutputCache &,
   // Input
   const auto &msg = qdata.pointcloud_msg.ptr();
 
-  auto point_cloud = std::make_shared<pcl::PointCloud<PointWithInfo>>(
-      msg->width * msg->height, 1);
+  auto point_cloud = pointCloudPool().acquire();
+  point_cloud->resize(msg->width * msg->height);
 
   // iterators
   // clang-format off
@@ -143,20 +145,15 @@ void VelodyneConversionModuleV2::run_(QueryCache &qdata0, OutputCache &,
   //If a lower horizontal resolution is acceptable, then set the horizontal downsample > 1.
   //A value of 2 will leave 1/2 the points, in general 1/n points will be retained.
 
-  auto filtered_point_cloud =
-    std::make_shared<pcl::PointCloud<PointWithInfo>>(*point_cloud);
+  auto filtered_point_cloud = point_cloud;
   CLOG(DEBUG, "lidar.velodyne_converter_v2") << "Reducing the point cloud density by " << config_->horizontal_downsample
       << "original size was " << point_cloud->size();
   if (config_->horizontal_downsample > 1) {  
-    std::vector<int> indices;
-    indices.reserve(filtered_point_cloud->size());
-    for (size_t i = 0; i < filtered_point_cloud->size(); ++i) {
-      if (i % config_->horizontal_downsample == 0 )//&& (*point_cloud)[i].phi < -M_PI)
-        indices.emplace_back(i);
-    }
-    *filtered_point_cloud =
-        pcl::PointCloud<PointWithInfo>(*filtered_point_cloud, indices);
-  
+    filtered_point_cloud = pointCloudPool().acquire();
+    copyPointsIf(*point_cloud, *filtered_point_cloud,
+                 [&](const PointWithInfo &, const size_t &i) {
+                   return i % config_->horizontal_downsample == 0;
+                 });
   }
 
 
@@ -23,6 +23,8 @@
 #include "vtr_lidar/features/normal.hpp"
 #include "vtr_lidar/filters/voxel_downsample.hpp"
 #include "vtr_lidar/utils/nanoflann_utils.hpp"
+#include "vtr_lidar/utils/point_cloud_pool.hpp"
+#include "vtr_tactic/quality_controller.hpp"
 
 namespace vtr {
 namespace lidar {
@@ -90,6 +92,9 @@ auto PreprocessingModule::Config::fromROS(const rclcpp::Node::SharedPtr &node,
 
   config->cluster_num_sample = node->declare_parameter<int>(param_prefix + ".cluster_num_sample", config->cluster_num_sample);
 
+  config->quality_voxel_scale = node->declare_parameter<float>(param_prefix + ".quality_voxel_scale", config->quality_voxel_scale);
+  config->quality_sample_scale = node->declare_parameter<float>(param_prefix + ".quality_sample_scale", config->quality_sample_scale);
+
   config->visualize = node->declare_parameter<bool>(param_prefix + ".visualize", config->visualize);
   // clang-format on
   return config;
@@ -119,20 +124,24 @@ void PreprocessingModule::run_(QueryCache &qdata0, OutputCache &,
   CLOG(DEBUG, "lidar.preprocessing")
       << "raw point cloud size: " << point_cloud->size();
 
-  auto filtered_point_cloud =
-      std::make_shared<pcl::PointCloud<PointWithInfo>>(*point_cloud);
+  // cheaper settings when the pipeline is behind
+  const float frame_voxel_size =
+      config_->frame_voxel_size *
+      qualityScale(qdata, config_->quality_voxel_scale);
+  const int num_sample1 = std::max<int>(
+      1, config_->num_sample1 *
+             qualityScale(qdata, config_->quality_sample_scale));
+  CLOG_IF(qualityLevel(qdata) > 0, DEBUG, "lidar.preprocessing")
+      << "quality level " << qualityLevel(qdata)
+      << ", frame voxel size: " << frame_voxel_size
+      << ", num_sample1: " << num_sample1;
 
   /// Range cropping
-  {
-    std::vector<int> indices;
-    indices.reserve(filtered_point_cloud->size());
-    for (size_t i = 0; i < filtered_point_cloud->size(); ++i) {
-      if ((*filtered_point_cloud)[i].rho < config_->crop_range)
-        indices.emplace_back(i);
-    }
-    *filtered_point_cloud =
-        pcl::PointCloud<PointWithInfo>(*filtered_point_cloud, indices);
-  }
+  auto filtered_point_cloud = pointCloudPool().acquire();
+  copyPointsIf(*point_cloud, *filtered_point_cloud,
+               [&](const PointWithInfo &p, const size_t &) {
+                 return p.rho < config_->crop_range;
+               });
 
   CLOG(DEBUG, "lidar.preprocessing")
       << "range cropped point cloud size: " << filtered_point_cloud->size();
@@ -140,12 +149,12 @@ void PreprocessingModule::run_(QueryCache &qdata0, OutputCache &,
   /// Grid subsampling
 
   // Get subsampling of the frame in carthesian coordinates
-  voxelDownsample(*filtered_point_cloud, config_->frame_voxel_size);
+  voxelDownsample(*filtered_point_cloud, frame_voxel_size);
 
   //Secondary input for change detection
   if (config_->nn_voxel_size > 0) {
-    auto nn_downsampled_cloud = 
-        std::make_shared<pcl::PointCloud<PointWithInfo>>(*point_cloud);
+    auto nn_downsampled_cloud = pointCloudPool().acquire();
+    *nn_downsampled_cloud = *point_cloud;
     voxelDownsample(*nn_downsampled_cloud, config_->nn_voxel_size);
     qdata.nn_point_cloud = nn_downsampled_cloud;
   }
@@ -170,30 +179,17 @@ void PreprocessingModule::run_(QueryCache &qdata0, OutputCache &,
     auto sorted_norm_scores = norm_scores;
     std::sort(sorted_norm_scores.begin(), sorted_norm_scores.end());
     float min_score = sorted_norm_scores[std::max(
-        0, (int)sorted_norm_scores.size() - config_->num_sample1)];
+        0, (int)sorted_norm_scores.size() - num_sample1)];
     min_score = std::max(config_->min_norm_score1, min_score);
     if (min_score >= 0) {
-      std::vector<int> indices;
-      indices.reserve(filtered_point_cloud->size());
-      int i = 0;
-      for (const auto &point : *filtered_point_cloud) {
-        if (point.normal_score >= min_score) indices.emplace_back(i);
-        i++;
-      }
-      *filtered_point_cloud =
-          pcl::PointCloud<PointWithInfo>(*filtered_point_cloud, indices);
+      keepPointsIf(*filtered_point_cloud,
+                   [&](const PointWithInfo &p, const size_t &) {
+                     return p.normal_score >= min_score;
+                   });
     }
   } else {
-    std::vector<int> indices;
-    indices.reserve(filtered_point_cloud->size());
-    int i = 0;
-    for (const auto &point : *filtered_point_cloud) {
-      if (i < config_->num_sample1) indices.emplace_back(i);
-      i++;
-    }
-    *filtered_point_cloud =
-          pcl::PointCloud<PointWithInfo>(*filtered_point_cloud, indices);
-
+    if (filtered_point_cloud->size() > (size_t)num_sample1)
+      filtered_point_cloud->resize(num_sample1);
   }
   
   
@@ -229,7 +225,7 @@ void PreprocessingModule::run_(QueryCache &qdata0, OutputCache &,
 
   /// Remove isolated points (mostly points on trees)
 
-  const float search_radius = 2 * config_->frame_voxel_size;
+  const float search_radius = 2 * frame_voxel_size;
   auto cluster_scores =
       getNumberOfNeighbors(*filtered_point_cloud, search_radius);
 
@@ -23,6 +23,7 @@
 #include "vtr_lidar/features/normal.hpp"
 #include "vtr_lidar/filters/voxel_downsample.hpp"
 #include "vtr_lidar/utils/nanoflann_utils.hpp"
+#include "vtr_lidar/utils/point_cloud_pool.hpp"
 
 namespace vtr {
 namespace lidar {
@@ -70,20 +71,12 @@ void PreprocessingModuleV2::run_(QueryCache &qdata0, OutputCache &,
   CLOG(DEBUG, "lidar.preprocessing")
       << "raw point cloud size: " << point_cloud->size();
 
-  auto filtered_point_cloud =
-      std::make_shared<pcl::PointCloud<PointWithInfo>>(*point_cloud);
-
   /// Range cropping
-  {
-    std::vector<int> indices;
-    indices.reserve(filtered_point_cloud->size());
-    for (size_t i = 0; i < filtered_point_cloud->size(); ++i) {
-      if ((*filtered_point_cloud)[i].rho < config_->crop_range)
-        indices.emplace_back(i);
-    }
-    *filtered_point_cloud =
-        pcl::PointCloud<PointWithInfo>(*filtered_point_cloud, indices);
-  }
+  auto filtered_point_cloud = pointCloudPool().acquire();
+  copyPointsIf(*point_cloud, *filtered_point_cloud,
+               [&](const PointWithInfo &p, const size_t &) {
+                 return p.rho < config_->crop_range;
+               });
 
   CLOG(DEBUG, "lidar.preprocessing")
       << "range cropped point cloud size: " << filtered_point_cloud->size();
@@ -18,7 +18,11 @@
  */
 #include "vtr_lidar/pipeline.hpp"
 
+#include <algorithm>
+
+#include "vtr_lidar/data_types/pointmap_delta.hpp"
 #include "vtr_lidar/data_types/pointmap_pointer.hpp"
+#include "vtr_lidar/utils/point_cloud_pool.hpp"
 #include "vtr_tactic/modules/factory.hpp"
 
 namespace vtr {
@@ -38,9 +42,12 @@ auto LidarPipeline::Config::fromROS(const rclcpp::Node::SharedPtr &node,
   // submap creation thresholds
   config->submap_translation_threshold = node->declare_parameter<double>(param_prefix + ".submap_translation_threshold", config->submap_translation_threshold);
   config->submap_rotation_threshold = node->declare_parameter<double>(param_prefix + ".submap_rotation_threshold", config->submap_rotation_threshold);
+  config->full_submap_interval = node->declare_parameter<int>(param_prefix + ".full_submap_interval", config->full_submap_interval);
   
   config->save_raw_point_cloud = node->declare_parameter<bool>(param_prefix + ".save_raw_point_cloud", config->save_raw_point_cloud);
   config->save_nn_point_cloud = node->declare_parameter<bool>(param_prefix + ".save_nn_point_cloud", config->save_nn_point_cloud);
+
+  config->point_cloud_pool_size = node->declare_parameter<int>(param_prefix + ".point_cloud_pool_size", config->point_cloud_pool_size);
   // clang-format on
   return config;
 }
@@ -50,6 +57,7 @@ LidarPipeline::LidarPipeline(
     const std::shared_ptr<ModuleFactory> &module_factory,
     const std::string &name)
     : BasePipeline(module_factory, name), config_(config) {
+  pointCloudPool().setMaxSize(std::max(config_->point_cloud_pool_size, 0));
   // preprocessing
   for (auto module : config_->preprocessing)
     preprocessing_.push_back(factory()->get("preprocessing." + module));
@@ -77,6 +85,8 @@ void LidarPipeline::reset() {
   w_m_r_in_r_odo_ = nullptr;
   submap_vid_odo_ = tactic::VertexId::Invalid();
   T_sv_m_odo_ = tactic::EdgeTransform(true);
+  submap_odo_ = nullptr;
+  num_submap_deltas_odo_ = 0;
   // localization cached data
   submap_loc_ = nullptr;
 }
@@ -215,16 +225,53 @@ void LidarPipeline::onVertexCreation_(const QueryCache::Ptr &qdata0,
     // copy the current sliding map
     auto submap_odo =
         std::make_shared<PointMap<PointWithInfo>>(*sliding_map_odo_);
-    // save the submap
-    using PointMapLM = storage::LockableMessage<PointMap<PointWithInfo>>;
-    auto submap_msg = std::make_shared<PointMapLM>(submap_odo, *qdata->stamp);
-    vertex->insert<PointMap<PointWithInfo>>(
-        "pointmap", "vtr_lidar_msgs/msg/PointMap", submap_msg);
-    // save a copy
-    auto submap2_msg = std::make_shared<PointMapLM>(submap_odo, *qdata->stamp);
-    vertex->insert<PointMap<PointWithInfo>>(
-        "pointmap_v" + std::to_string(submap_odo->version()),
-        "vtr_lidar_msgs/msg/PointMap", submap2_msg);
+    // store it as a delta of the previous submap if that is smaller, the
+    // complete submap is reconstructed when loaded (see pointmap_versions.hpp)
+    const auto submap_delta = [&]() -> PointMapDelta<PointWithInfo>::Ptr {
+      if (submap_odo_ == nullptr || submap_odo_->dl() != submap_odo->dl() ||
+          num_submap_deltas_odo_ + 1 >= config_->full_submap_interval)
+        return nullptr;
+      // life time only matters to the sliding map, not to the stored submap
+      const auto equal_cb = [](const PointWithInfo &base_pt,
+                               const PointWithInfo &curr_pt) {
+        return std::equal(base_pt.data, base_pt.data + 4, curr_pt.data) &&
+               std::equal(base_pt.data_n, base_pt.data_n + 4, curr_pt.data_n) &&
+               base_pt.dynamic_obs == curr_pt.dynamic_obs &&
+               base_pt.total_obs == curr_pt.total_obs &&
+               base_pt.static_score == curr_pt.static_score &&
+               base_pt.raw_flex2 == curr_pt.raw_flex2;
+      };
+      auto delta = PointMapDelta<PointWithInfo>::fromMaps(
+          *submap_odo_, submap_vid_odo_, *submap_odo, equal_cb);
+      if (delta->size() + delta->removed_voxels().size() >= submap_odo->size())
+        return nullptr;
+      return delta;
+    }();
+    if (submap_delta != nullptr) {
+      CLOG(DEBUG, "lidar.pipeline")
+          << "Saving submap as a delta of vertex " << submap_vid_odo_ << ": "
+          << submap_delta->size() << " of " << submap_odo->size()
+          << " voxels changed, " << submap_delta->removed_voxels().size()
+          << " removed";
+      using PointMapDeltaLM =
+          storage::LockableMessage<PointMapDelta<PointWithInfo>>;
+      auto submap_msg =
+          std::make_shared<PointMapDeltaLM>(submap_delta, *qdata->stamp);
+      vertex->insert<PointMapDelta<PointWithInfo>>(
+          "pointmap_delta", "vtr_lidar_msgs/msg/PointMapDelta", submap_msg);
+      ++num_submap_deltas_odo_;
+      submap_odo_ = submap_odo;
+    } else {
+      // save the submap, "pointmap_v0" is only stored once this version gets
+      // replaced (see pointmap_versions.hpp)
+      using PointMapLM = storage::LockableMessage<PointMap<PointWithInfo>>;
+      auto submap_msg = std::make_shared<PointMapLM>(submap_odo, *qdata->stamp);
+      vertex->insert<PointMap<PointWithInfo>>(
+          "pointmap", "vtr_lidar_msgs/msg/PointMap", submap_msg);
+      num_submap_deltas_odo_ = 0;
+      // newer versions replace the stored submap in place, so keep a copy
+      submap_odo_ = std::make_shared<PointMap<PointWithInfo>>(*submap_odo);
+    }
 
     // save the submap vertex id and transform
     submap_vid_odo_ = *qdata->vid_odo;
@@ -0,0 +1,100 @@
+// Copyright 2021, Autonomous Space Robotics Lab (ASRL)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+/**
+ * \file test_mesh2pcd.cpp
+ * \author Autonomous Space Robotics Lab (ASRL)
+ */
+#include <gmock/gmock.h>
+
+#include <algorithm>
+#include <fstream>
+#include <random>
+#include <tuple>
+
+#include "vtr_lidar/data_types/point.hpp"
+#include "vtr_lidar/mesh2pcd/mesh2pcd.hpp"
+
+using namespace ::testing;  // NOLINT
+using namespace vtr::lidar;
+using namespace vtr::lidar::mesh2pcd;
+
+namespace {
+
+/// random triangles scattered around the sensor, one normal per face
+std::string makeMesh(const int& num_clusters) {
+  const std::string filename = "test_mesh2pcd.obj";
+  std::ofstream file(filename);
+  std::mt19937 gen(7);
+  std::uniform_real_distribution<float> dist(-1.0, 1.0);
+  int num_vertices = 0;
+  for (int c = 0; c < num_clusters; ++c) {
+    const Eigen::Vector3f center(30 * dist(gen), 30 * dist(gen), dist(gen));
+    if (center.head<2>().norm() < 5.0) continue;
+    for (int t = 0; t < 20; ++t) {
+      Eigen::Vector3f v[3];
+      for (auto& vi : v)
+        vi = center + 2.0 * Eigen::Vector3f(dist(gen), dist(gen), dist(gen));
+      const Eigen::Vector3f n = (v[1] - v[0]).cross(v[2] - v[0]).normalized();
+      for (const auto& vi : v)
+        file << "v " << vi.x() << " " << vi.y() << " " << vi.z() << "\n";
+      file << "vn " << n.x() << " " << n.y() << " " << n.z() << "\n";
+      const int face = num_vertices / 3 + 1;
+      file << "f " << num_vertices + 1 << "//" << face << " "
+           << num_vertices + 2 << "//" << face << " " << num_vertices + 3
+           << "//" << face << "\n";
+      num_vertices += 3;
+    }
+  }
+  return filename;
+}
+
+std::vector<std::tuple<float, float, float>> sorted(
+    const pcl::PointCloud<PointWithInfo>& points) {
+  std::vector<std::tuple<float, float, float>> result;
+  for (const auto& p : points) result.emplace_back(p.x, p.y, p.z);
+  std::sort(result.begin(), result.end());
+  return result;
+}
+
+}  // namespace
+
+TEST(Mesh2Pcd, bvh_matches_reference) {
+  const auto filename = makeMesh(50);
+
+  Mesh2PcdConverter::Config config;
+  config.theta_min = 1.2;
+  config.theta_max = 1.9;
+  config.theta_res = 0.01;
+  config.phi_res = 0.01;
+  config.range_max = 40.0;
+  auto reference_config = config;
+  reference_config.use_bvh = false;
+
+  Eigen::Matrix4f T_pcd_obj = Eigen::Matrix4f::Identity();
+  T_pcd_obj(0, 3) = 0.3;
+
+  pcl::PointCloud<PointWithInfo> reference, bvh;
+  Mesh2PcdConverter(filename, reference_config).addToPcd(reference, T_pcd_obj);
+  Mesh2PcdConverter(filename, config).addToPcd(bvh, T_pcd_obj);
+
+  EXPECT_GT(reference.size(), (size_t)0);
+  // the bvh path emits points ray by ray instead of face by face
+  EXPECT_EQ(sorted(reference), sorted(bvh));
+}
+
+int main(int argc, char** argv) {
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
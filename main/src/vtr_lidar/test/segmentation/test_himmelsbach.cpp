@@ -0,0 +1,81 @@
+// Copyright 2021, Autonomous Space Robotics Lab (ASRL)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+/**
+ * \file test_himmelsbach.cpp
+ * \author Autonomous Space Robotics Lab (ASRL)
+ */
+#include <gmock/gmock.h>
+
+#include "vtr_lidar/data_types/point.hpp"
+#include "vtr_lidar/segmentation/himmelsbach.hpp"
+
+using namespace ::testing;  // NOLINT
+using namespace vtr::lidar;
+
+namespace {
+
+/// flat ground at z = -2.13 with a 1m tall wall at x in [10, 11]
+pcl::PointCloud<PointWithInfo> makeScene(std::vector<bool> &is_ground) {
+  pcl::PointCloud<PointWithInfo> points;
+  for (int a = 0; a < 360; ++a) {
+    const float theta = a * M_PI / 180.0;
+    for (float r = 3.5; r < 60.0; r += 0.5) {
+      PointWithInfo p;
+      p.x = r * std::cos(theta);
+      p.y = r * std::sin(theta);
+      p.z = -2.13;
+      points.push_back(p);
+      is_ground.push_back(true);
+    }
+  }
+  for (float y = -2.0; y <= 2.0; y += 0.1) {
+    for (float z = -1.5; z < -0.5; z += 0.1) {
+      PointWithInfo p;
+      p.x = 10.5;
+      p.y = y;
+      p.z = z;
+      points.push_back(p);
+      is_ground.push_back(false);
+    }
+  }
+  return points;
+}
+
+}  // namespace
+
+TEST(LIDAR, himmelsbach_ground_extraction) {
+  std::vector<bool> is_ground;
+  const auto points = makeScene(is_ground);
+
+  Himmelsbach<PointWithInfo> himmelsbach;
+  const auto ground_idx = himmelsbach(points);
+
+  size_t num_ground = 0;
+  for (const auto &idx : ground_idx) EXPECT_TRUE(is_ground[idx]);
+  for (const auto &g : is_ground) num_ground += g;
+  EXPECT_GT(ground_idx.size(), num_ground * 9 / 10);
+  EXPECT_TRUE(std::is_sorted(ground_idx.begin(), ground_idx.end()));
+
+  // same result with multiple threads
+  himmelsbach.num_threads = 4;
+  EXPECT_THAT(himmelsbach(points), ContainerEq(ground_idx));
+
+  // same result when the transform is passed instead of applied
+  Eigen::Affine3f T = Eigen::Affine3f::Identity();
+  T.translation() << 0, 0, 1;
+  auto shifted = points;
+  for (auto &p : shifted) p.z -= 1;
+  EXPECT_THAT(himmelsbach(shifted, T), ContainerEq(ground_idx));
+}
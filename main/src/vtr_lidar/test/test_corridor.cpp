@@ -0,0 +1,108 @@
+// Copyright 2021, Autonomous Space Robotics Lab (ASRL)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+/**
+ * \file test_corridor.cpp
+ * \author Autonomous Space Robotics Lab (ASRL)
+ */
+#include <gmock/gmock.h>
+
+#include <algorithm>
+#include <limits>
+#include <random>
+
+#include "vtr_lidar/data_types/corridor.hpp"
+#include "vtr_logging/logging_init.hpp"
+
+using namespace ::testing;  // NOLINT
+using namespace vtr::logging;
+using namespace vtr::lidar;
+
+namespace {
+
+/// distance to every segment of the path, as computed before the corridor
+float bruteForceDistance(const std::vector<Eigen::Matrix4d> &T_curr_query_vec,
+                         const Eigen::Vector2f &q) {
+  std::vector<Eigen::Vector2f> xy;
+  for (const auto &T : T_curr_query_vec)
+    xy.emplace_back(T.block<2, 1>(0, 3).cast<float>());
+  float min_dist = (q - xy.front()).norm();
+  for (size_t i = 0; i + 1 < xy.size(); ++i) {
+    const auto &xs = xy[i];
+    const auto &xe = xy[i + 1];
+    float alpha = (q - xs).dot(xe - xs) / (xe - xs).squaredNorm();
+    alpha = std::clamp(alpha, 0.0f, 1.0f);
+    min_dist = std::min(min_dist, (q - (xs + alpha * (xe - xs))).norm());
+  }
+  return min_dist;
+}
+
+/// a random walk starting at the origin
+std::vector<Eigen::Matrix4d> makePath(const size_t &num_vertices) {
+  std::mt19937 gen(3);
+  std::uniform_real_distribution<double> dist(-1.0, 1.0);
+  std::vector<Eigen::Matrix4d> T_curr_query_vec;
+  Eigen::Matrix4d T = Eigen::Matrix4d::Identity();
+  for (size_t i = 0; i < num_vertices; ++i) {
+    T_curr_query_vec.emplace_back(T);
+    const double yaw = 0.2 * dist(gen);
+    Eigen::Matrix4d T_step = Eigen::Matrix4d::Identity();
+    T_step.block<2, 2>(0, 0) << std::cos(yaw), -std::sin(yaw), std::sin(yaw),
+        std::cos(yaw);
+    T_step(0, 3) = 0.3 + 0.2 * std::abs(dist(gen));
+    T = T * T_step;
+  }
+  return T_curr_query_vec;
+}
+
+}  // namespace
+
+TEST(Corridor, distance_matches_brute_force) {
+  const float dl = 0.1;
+  const auto T_curr_query_vec = makePath(40);
+  Corridor corridor(T_curr_query_vec, dl, 40.0, 20.0);
+
+  // cell centers (precomputed)
+  for (int i = -200; i <= 200; ++i)
+    for (int j = -100; j <= 100; ++j) {
+      const Eigen::Vector2f q(i * dl, j * dl);
+      EXPECT_NEAR(corridor.distance(q), bruteForceDistance(T_curr_query_vec, q),
+                  1e-5);
+    }
+  // arbitrary points, including outside of the cost map
+  for (float x = -22.5; x <= 22.5; x += 0.37)
+    for (float y = -12.5; y <= 12.5; y += 0.37) {
+      const Eigen::Vector2f q(x, y);
+      EXPECT_NEAR(corridor.distance(q), bruteForceDistance(T_curr_query_vec, q),
+                  1e-5);
+    }
+}
+
+TEST(Corridor, single_vertex) {
+  const auto T_curr_query_vec = makePath(1);
+  Corridor corridor(T_curr_query_vec, 0.5, 10.0, 10.0);
+  EXPECT_FLOAT_EQ(corridor.distance(Eigen::Vector2f(3.0, 4.0)), 5.0);
+}
+
+TEST(Corridor, empty_path) {
+  Corridor corridor({}, 0.5, 10.0, 10.0);
+  EXPECT_EQ(corridor.distance(Eigen::Vector2f(0.0, 0.0)),
+            std::numeric_limits<float>::infinity());
+}
+
+int main(int argc, char **argv) {
+  configureLogging("", true);
+  InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
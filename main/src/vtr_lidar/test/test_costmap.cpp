@@ -0,0 +1,79 @@
+// Copyright 2021, Autonomous Space Robotics Lab (ASRL)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+/**
+ * \file test_costmap.cpp
+ * \author Autonomous Space Robotics Lab (ASRL)
+ */
+#include <gmock/gmock.h>
+
+#include "sensor_msgs/point_cloud2_iterator.hpp"
+
+#include "vtr_lidar/data_types/costmap.hpp"
+#include "vtr_logging/logging_init.hpp"
+
+using namespace ::testing;  // NOLINT
+using namespace vtr::logging;
+using namespace vtr::lidar;
+
+TEST(LIDAR, dense_costmap_to_msgs) {
+  // 5 x 3 cells, origin at (-2, -1)
+  DenseCostMap costmap(0.5, 2.0, 1.0);
+  costmap.update([](const Eigen::Vector2f& p, float& v) {
+    v = p(0) + 2.0f * p(1);  // unique value per cell, some out of [0, 1]
+  });
+
+  const auto costmap_msg = costmap.toCostMapMsg();
+  ASSERT_EQ(costmap_msg.info.width, 5u);
+  ASSERT_EQ(costmap_msg.info.height, 3u);
+  ASSERT_EQ(costmap_msg.data.size(), 15u);
+  for (int y = 0; y < 3; ++y)
+    for (int x = 0; x < 5; ++x) {
+      const float v = (x - 2) * 0.5f + 2.0f * (y - 1) * 0.5f;
+      EXPECT_EQ(costmap_msg.data[x + y * 5],
+                (int8_t)(std::clamp(v, 0.f, 1.f) * 100));
+    }
+
+  const auto pointcloud_msg = costmap.toPointCloudMsg();
+  ASSERT_EQ(pointcloud_msg.width * pointcloud_msg.height, 15u);
+  sensor_msgs::PointCloud2ConstIterator<float> iter_x(pointcloud_msg, "x"),
+      iter_y(pointcloud_msg, "y"), iter_z(pointcloud_msg, "z"),
+      iter_intensity(pointcloud_msg, "intensity");
+  size_t count = 0;
+  for (; iter_x != iter_x.end();
+       ++iter_x, ++iter_y, ++iter_z, ++iter_intensity, ++count) {
+    EXPECT_FLOAT_EQ(*iter_intensity, *iter_x + 2.0f * *iter_y);
+    EXPECT_FLOAT_EQ(*iter_z, 0.0f);
+  }
+  EXPECT_EQ(count, 15u);
+}
+
+TEST(LIDAR, dense_costmap_update_from_xy) {
+  DenseCostMap costmap(0.5, 2.0, 1.0);
+  DenseCostMap::XY2ValueMap values;
+  values[{0.5f, 0.0f}] = 0.3f;
+  values[{100.0f, -100.0f}] = 0.7f;  // clamped to the lower right corner
+  costmap.update(values);
+
+  const auto filtered = costmap.filter(0.01);
+  ASSERT_EQ(filtered.size(), 2u);
+  EXPECT_FLOAT_EQ(filtered.at({0.5f, 0.0f}), 0.3f);
+  EXPECT_FLOAT_EQ(filtered.at({1.0f, -0.5f}), 0.7f);
+}
+
+int main(int argc, char** argv) {
+  configureLogging("", true);
+  InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
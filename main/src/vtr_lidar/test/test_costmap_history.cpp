@@ -0,0 +1,120 @@
+// Copyright 2021, Autonomous Space Robotics Lab (ASRL)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+/**
+ * \file test_costmap_history.cpp
+ * \author Autonomous Space Robotics Lab (ASRL)
+ */
+#include <gmock/gmock.h>
+
+#include "vtr_lidar/data_types/costmap_history.hpp"
+#include "vtr_logging/logging_init.hpp"
+
+using namespace ::testing;  // NOLINT
+using namespace vtr::logging;
+using namespace vtr::tactic;
+using namespace vtr::lidar;
+
+namespace {
+
+EdgeTransform translation(const double& x, const double& y) {
+  Eigen::Matrix4d T = Eigen::Matrix4d::Identity();
+  T(0, 3) = x;
+  T(1, 3) = y;
+  return EdgeTransform(T);
+}
+
+/// cost map with a single obstacle at (x, y) of the cost map frame
+DenseCostMap obstacleAt(const float& x, const float& y) {
+  DenseCostMap costmap(0.5, 10.0, 10.0);
+  costmap.update([&](const Eigen::Vector2f& p, float& v) {
+    if (std::abs(p(0) - x) < 0.1 && std::abs(p(1) - y) < 0.1) v = 0.8;
+  });
+  return costmap;
+}
+
+float valueAt(const DenseCostMap& costmap, const float& x, const float& y) {
+  float value = -1.0;
+  costmap.visit([&](const Eigen::Vector2f& p, const float& v) {
+    if (std::abs(p(0) - x) < 0.1 && std::abs(p(1) - y) < 0.1) value = v;
+  });
+  return value;
+}
+
+}  // namespace
+
+TEST(LIDAR, costmap_history_votes) {
+  CostMapHistory history(0.5, 10.0, 10.0, 3);
+
+  // a static obstacle at world (1, 0) observed while the robot moves forward
+  for (int i = 0; i < 3; ++i) {
+    const auto T_w_c = translation(0.5 * i, 0.0);
+    history.push(obstacleAt(1.0 - 0.5 * i, 0.0), 0.01, T_w_c);
+    EXPECT_EQ(history.size(), (size_t)(i + 1));
+    EXPECT_EQ(history.votes(1.1, 0.1), i + 1);
+  }
+  EXPECT_TRUE(history.full());
+
+  // filtered cost map in the frame of the last robot pose
+  const auto T_w_c = translation(1.0, 0.0);
+  DenseCostMap filtered(0.5, 10.0, 10.0);
+  history.filter(filtered, T_w_c, 3);
+  EXPECT_FLOAT_EQ(valueAt(filtered, 0.0, 0.0), 0.8);
+  EXPECT_FLOAT_EQ(valueAt(filtered, 1.0, 0.0), 0.0);
+
+  // evicting the observations one by one removes the votes
+  for (int i = 0; i < 3; ++i) {
+    history.push(DenseCostMap(0.5, 10.0, 10.0), 0.01, T_w_c);
+    EXPECT_EQ(history.size(), (size_t)3);
+    EXPECT_EQ(history.votes(1.1, 0.1), 2 - i);
+  }
+}
+
+TEST(LIDAR, costmap_history_recenter) {
+  CostMapHistory history(0.5, 10.0, 10.0, 5);
+
+  history.push(obstacleAt(1.0, 0.0), 0.01, translation(0.0, 0.0));
+  // move far enough for the window to be re-centered a few times, the
+  // obstacle stays as long as it is within the window
+  for (int i = 1; i < 4; ++i) {
+    history.push(DenseCostMap(0.5, 10.0, 10.0), 0.01, translation(3.0 * i, 0.0));
+    EXPECT_EQ(history.votes(1.1, 0.1), 1);
+  }
+  EXPECT_EQ(history.votes(-100.0, 0.0), 0);
+}
+
+TEST(LIDAR, costmap_history_clear) {
+  CostMapHistory history(0.5, 10.0, 10.0, 2);
+
+  history.push(obstacleAt(1.0, 0.0), 0.01, translation(0.0, 0.0));
+  history.push(obstacleAt(1.0, 0.0), 0.01, translation(0.0, 0.0));
+  EXPECT_TRUE(history.full());
+  EXPECT_EQ(history.votes(1.1, 0.1), 2);
+
+  history.clear();
+  EXPECT_EQ(history.size(), (size_t)0);
+  EXPECT_EQ(history.votes(1.1, 0.1), 0);
+
+  // the window is re-initialized around the next pose
+  history.push(obstacleAt(1.0, 0.0), 0.01, translation(100.0, 0.0));
+  EXPECT_EQ(history.size(), (size_t)1);
+  EXPECT_EQ(history.votes(101.1, 0.1), 1);
+  EXPECT_EQ(history.votes(1.1, 0.1), 0);
+}
+
+int main(int argc, char** argv) {
+  configureLogging("", true);
+  InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
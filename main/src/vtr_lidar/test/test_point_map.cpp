@@ -101,6 +101,49 @@ TEST(LIDAR, point_map_update) {
   }
 }
 
+TEST(LIDAR, point_map_parallel_update) {
+  // overlapping point clouds, some points fall into the same voxel
+  std::vector<pcl::PointCloud<PointWithInfo>> point_clouds(4);
+  for (size_t c = 0; c < point_clouds.size(); c++) {
+    for (int i = 0; i < 1000; i++) {
+      PointWithInfo p;
+      // clang-format off
+      p.x = 0.05 * (i % 50) + 0.3 * c; p.y = 0.05 * (i / 50); p.z = 0.05;
+      p.normal_score = c;
+      // clang-format on
+      point_clouds[c].push_back(p);
+    }
+  }
+
+  PointMap<PointWithInfo> sequential_map(0.1), parallel_map(0.1);
+  sequential_map.update(point_clouds[0]);
+  parallel_map.update(point_clouds[0]);
+  std::vector<const pcl::PointCloud<PointWithInfo> *> remaining;
+  for (size_t c = 1; c < point_clouds.size(); c++) {
+    sequential_map.update(point_clouds[c]);
+    remaining.push_back(&point_clouds[c]);
+  }
+  parallel_map.update(remaining, 4);
+
+  // the clouds share voxels, so the map has fewer voxels than all of them
+  size_t num_cloud_voxels = 0;
+  for (const auto &point_cloud : point_clouds) {
+    PointMap<PointWithInfo> cloud_map(0.1);
+    cloud_map.update(point_cloud);
+    num_cloud_voxels += cloud_map.size();
+  }
+  EXPECT_LT(sequential_map.size(), num_cloud_voxels);
+
+  // same points, in the same order
+  ASSERT_EQ(parallel_map.size(), sequential_map.size());
+  for (size_t i = 0; i < sequential_map.size(); i++) {
+    const auto &p1 = sequential_map.point_cloud()[i];
+    const auto &p2 = parallel_map.point_cloud()[i];
+    EXPECT_EQ(p1.getVector3fMap(), p2.getVector3fMap());
+    EXPECT_EQ(p1.normal_score, p2.normal_score);
+  }
+}
+
 TEST(LIDAR, point_map_read_write) {
   auto point_map = std::make_shared<PointMap<PointWithInfo>>(0.1);
   // create a test point cloud
@@ -0,0 +1,144 @@
+// Copyright 2021, Autonomous Space Robotics Lab (ASRL)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+/**
+ * \file test_point_map_delta.cpp
+ * \author Autonomous Space Robotics Lab (ASRL)
+ */
+#include <gmock/gmock.h>
+
+#include <map>
+
+#include "vtr_lidar/data_types/point.hpp"
+#include "vtr_lidar/data_types/pointmap_delta.hpp"
+#include "vtr_logging/logging_init.hpp"
+
+using namespace ::testing;  // NOLINT
+using namespace vtr;
+using namespace vtr::logging;
+using namespace vtr::lidar;
+
+namespace {
+
+PointWithInfo point(const int &i, const float &normal_score = 0) {
+  PointWithInfo p;
+  // clang-format off
+  p.x = 0.1 * i + 0.05; p.y = 0.05; p.z = 0.05;
+  p.normal_x = 0; p.normal_y = 0; p.normal_z = 1;
+  p.normal_score = normal_score;
+  // clang-format on
+  return p;
+}
+
+/** \brief expects both maps to have the same voxels with the same points */
+void expectSameMap(const PointMap<PointWithInfo> &map1,
+                   const PointMap<PointWithInfo> &map2) {
+  ASSERT_EQ(map1.size(), map2.size());
+  std::map<float, float> points1, points2;
+  for (const auto &p : map1.point_cloud()) points1[p.x] = p.normal_score;
+  for (const auto &p : map2.point_cloud()) points2[p.x] = p.normal_score;
+  EXPECT_EQ(points1, points2);
+}
+
+}  // namespace
+
+TEST(LIDAR, point_map_delta_apply) {
+  // base map with voxels 0 to 9
+  PointMap<PointWithInfo> base(0.1);
+  pcl::PointCloud<PointWithInfo> base_cloud;
+  for (int i = 0; i < 10; i++) base_cloud.push_back(point(i));
+  base.update(base_cloud);
+
+  // voxels 0 and 1 removed, 5 changed, 10 and 11 added
+  PointMap<PointWithInfo> map(0.1);
+  pcl::PointCloud<PointWithInfo> map_cloud;
+  for (int i = 2; i < 12; i++) map_cloud.push_back(point(i, i == 5 ? 1 : 0));
+  map.update(map_cloud);
+  map.vertex_id() = tactic::VertexId(0, 5);
+
+  const auto delta = PointMapDelta<PointWithInfo>::fromMaps(
+      base, tactic::VertexId(0, 1), map);
+  EXPECT_EQ(delta->size(), (size_t)3);
+  EXPECT_EQ(delta->removed_voxels().size(), (size_t)2);
+  EXPECT_EQ(delta->base_vertex_id(), tactic::VertexId(0, 1));
+
+  const auto reconstructed = delta->apply(base);
+  expectSameMap(*reconstructed, map);
+  EXPECT_EQ(reconstructed->vertex_id(), tactic::VertexId(0, 5));
+  EXPECT_EQ(reconstructed->version(), PointMap<PointWithInfo>::INITIAL);
+
+  // the reconstructed map is complete, it can be updated like any other
+  pcl::PointCloud<PointWithInfo> new_cloud;
+  new_cloud.push_back(point(5, 2));
+  new_cloud.push_back(point(12));
+  reconstructed->update(new_cloud);
+  EXPECT_EQ(reconstructed->size(), (size_t)11);
+}
+
+TEST(LIDAR, point_map_delta_equal_callback) {
+  PointMap<PointWithInfo> base(0.1);
+  pcl::PointCloud<PointWithInfo> cloud;
+  for (int i = 0; i < 10; i++) cloud.push_back(point(i));
+  base.update(cloud);
+
+  // only the life time of every point changes
+  PointMap<PointWithInfo> map(base);
+  for (auto &p : map.point_cloud()) p.life_time -= 1.0;
+
+  const auto delta = PointMapDelta<PointWithInfo>::fromMaps(
+      base, tactic::VertexId(0, 1), map);
+  EXPECT_EQ(delta->size(), (size_t)10);
+
+  const auto equal_cb = [](const PointWithInfo &base_pt,
+                           const PointWithInfo &curr_pt) {
+    return base_pt.getVector3fMap() == curr_pt.getVector3fMap() &&
+           base_pt.normal_score == curr_pt.normal_score;
+  };
+  const auto delta2 = PointMapDelta<PointWithInfo>::fromMaps(
+      base, tactic::VertexId(0, 1), map, equal_cb);
+  EXPECT_EQ(delta2->size(), (size_t)0);
+  EXPECT_EQ(delta2->removed_voxels().size(), (size_t)0);
+  expectSameMap(*delta2->apply(base), map);
+}
+
+TEST(LIDAR, point_map_delta_read_write) {
+  PointMap<PointWithInfo> base(0.1);
+  pcl::PointCloud<PointWithInfo> base_cloud;
+  for (int i = 0; i < 10; i++) base_cloud.push_back(point(i));
+  base.update(base_cloud);
+
+  PointMap<PointWithInfo> map(0.1);
+  pcl::PointCloud<PointWithInfo> map_cloud;
+  for (int i = 3; i < 15; i++) map_cloud.push_back(point(i, i % 2));
+  map.update(map_cloud);
+  map.vertex_id() = tactic::VertexId(1, 2);
+
+  const auto delta = PointMapDelta<PointWithInfo>::fromMaps(
+      base, tactic::VertexId(1, 1), map);
+  const auto msg = delta->toStorable();
+  const auto delta2 = PointMapDelta<PointWithInfo>::fromStorable(msg);
+
+  EXPECT_EQ(delta2->size(), delta->size());
+  EXPECT_EQ(delta2->removed_voxels().size(), (size_t)3);
+  EXPECT_EQ(delta2->base_vertex_id(), tactic::VertexId(1, 1));
+  EXPECT_EQ(delta2->vertex_id(), tactic::VertexId(1, 2));
+  EXPECT_EQ(delta2->dl(), delta->dl());
+  expectSameMap(*delta2->apply(base), map);
+}
+
+int main(int argc, char** argv) {
+  configureLogging("", true);
+  InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
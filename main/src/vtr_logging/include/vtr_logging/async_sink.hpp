@@ -0,0 +1,124 @@
+// Copyright 2021, Autonomous Space Robotics Lab (ASRL)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+/**
+ * \file async_sink.hpp
+ * \brief Asynchronous log dispatching for easylogging++.
+ * \details The calling thread only formats the log line and hands it to a
+ * bounded queue; a single background thread writes queued lines to terminal
+ * and files in batches.
+ *
+ * \author Autonomous Space Robotics Lab (ASRL)
+ */
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+
+#include "vtr_logging/easylogging++.h"
+
+namespace vtr {
+namespace logging {
+
+/** \brief What to do with a DEBUG/INFO/TRACE line when the queue is full */
+enum class DropPolicy {
+  BLOCK,        // wait for the writer to make room, nothing is lost
+  DROP_NEWEST,  // discard the incoming line
+  DROP_OLDEST,  // discard the oldest queued DEBUG/INFO/TRACE line
+};
+
+/** \brief "block", "drop_newest" or "drop_oldest" */
+DropPolicy dropPolicyFromString(const std::string& policy);
+
+struct AsyncOptions {
+  /** \brief write logs from a background thread instead of the caller */
+  bool enabled = false;
+  /** \brief maximum number of lines waiting to be written */
+  size_t queue_size = 8192;
+  /** \brief warnings and errors are never dropped regardless of policy */
+  DropPolicy drop_policy = DropPolicy::DROP_OLDEST;
+};
+
+class AsyncLogWriter {
+ public:
+  struct Line {
+    std::string text;
+    el::Level level;
+    bool to_stdout;
+    /** \brief empty if the line should not go to a file */
+    std::string filename;
+  };
+
+  AsyncLogWriter(const size_t& queue_size, const DropPolicy& drop_policy);
+  /** \brief writes all queued lines before returning */
+  ~AsyncLogWriter();
+
+  void push(Line&& line);
+  /** \brief blocks until every line pushed so far has been written */
+  void flush();
+
+ private:
+  static bool droppable(const el::Level& level) {
+    return level == el::Level::Debug || level == el::Level::Info ||
+           level == el::Level::Trace || level == el::Level::Verbose;
+  }
+
+  void process();
+  void write(std::deque<Line>& batch, const size_t& dropped);
+
+  const size_t queue_size_;
+  const DropPolicy drop_policy_;
+  const bool colored_;
+
+  std::mutex mutex_;
+  std::condition_variable cv_pushed_;
+  std::condition_variable cv_written_;
+  std::deque<Line> queue_;
+  /** \brief number of lines pushed/written/dropped so far */
+  size_t pushed_ = 0;
+  size_t written_ = 0;
+  size_t dropped_ = 0;
+  bool stop_ = false;
+
+  /** \brief output files, only accessed by the writer thread */
+  std::unordered_map<std::string, std::ofstream> files_;
+
+  std::thread thread_;
+};
+
+/**
+ * \brief Replaces easylogging++'s default dispatch callback; forwards every
+ * formatted line to an AsyncLogWriter.
+ */
+class AsyncLogDispatchCallback : public el::LogDispatchCallback {
+ public:
+  void setWriter(const std::shared_ptr<AsyncLogWriter>& writer) {
+    writer_ = writer;
+  }
+  const std::shared_ptr<AsyncLogWriter>& writer() const { return writer_; }
+
+ protected:
+  void handle(const el::LogDispatchData* data) override;
+
+ private:
+  std::shared_ptr<AsyncLogWriter> writer_;
+};
+
+}  // namespace logging
+}  // namespace vtr
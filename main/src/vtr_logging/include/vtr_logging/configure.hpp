@@ -21,6 +21,7 @@
  */
 #pragma once
 
+#include "vtr_logging/async_sink.hpp"
 #include "vtr_logging/easylogging++.h"
 
 namespace vtr {
@@ -32,9 +33,12 @@ namespace logging {
  * \param[in] debug enable debug logs
  * \param[in] enabled vector of loggers (string). If not empty then only the
  * specified loggers will be enabled; otherwise all loggers will be enabled
+ * \param[in] async options of the background writer; when enabled, callers
+ * only format the log line and file/terminal output happens asynchronously
  */
 void configureLogging(const std::string& log_filename = "", bool debug = false,
-                      const std::vector<std::string>& enabled = {});
+                      const std::vector<std::string>& enabled = {},
+                      const AsyncOptions& async = AsyncOptions());
 
 }  // namespace logging
 }  // namespace vtr
@@ -0,0 +1,186 @@
+// Copyright 2021, Autonomous Space Robotics Lab (ASRL)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+/**
+ * \file async_sink.cpp
+ * \brief
+ * \details
+ *
+ * \author Autonomous Space Robotics Lab (ASRL)
+ */
+#include "vtr_logging/async_sink.hpp"
+
+#include <algorithm>
+#include <iostream>
+
+namespace vtr {
+namespace logging {
+
+namespace {
+
+const char* color(const el::Level& level) {
+  switch (level) {
+    case el::Level::Error:
+    case el::Level::Fatal:
+      return "\x1b[31m";
+    case el::Level::Warning:
+      return "\x1b[33m";
+    case el::Level::Debug:
+      return "\x1b[32m";
+    case el::Level::Info:
+      return "\x1b[36m";
+    case el::Level::Trace:
+      return "\x1b[35m";
+    default:
+      return nullptr;
+  }
+}
+
+}  // namespace
+
+DropPolicy dropPolicyFromString(const std::string& policy) {
+  if (policy == "block") return DropPolicy::BLOCK;
+  if (policy == "drop_newest") return DropPolicy::DROP_NEWEST;
+  if (policy == "drop_oldest") return DropPolicy::DROP_OLDEST;
+  throw std::invalid_argument("Unknown log drop policy: " + policy);
+}
+
+AsyncLogWriter::AsyncLogWriter(const size_t& queue_size,
+                               const DropPolicy& drop_policy)
+    : queue_size_(std::max<size_t>(queue_size, 1)),
+      drop_policy_(drop_policy),
+      colored_(el::Loggers::hasFlag(el::LoggingFlag::ColoredTerminalOutput) &&
+               el::base::utils::OS::termSupportsColor()) {
+  thread_ = std::thread(&AsyncLogWriter::process, this);
+}
+
+AsyncLogWriter::~AsyncLogWriter() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stop_ = true;
+  }
+  cv_pushed_.notify_one();
+  if (thread_.joinable()) thread_.join();
+}
+
+void AsyncLogWriter::push(Line&& line) {
+  std::unique_lock<std::mutex> lock(mutex_);
+  if (queue_.size() >= queue_size_) {
+    if (drop_policy_ == DropPolicy::DROP_NEWEST && droppable(line.level)) {
+      ++dropped_;
+      return;
+    }
+    if (drop_policy_ == DropPolicy::DROP_OLDEST) {
+      const auto it =
+          std::find_if(queue_.begin(), queue_.end(),
+                       [](const Line& l) { return droppable(l.level); });
+      if (it != queue_.end()) {
+        queue_.erase(it);
+        ++dropped_;
+        ++written_;
+      }
+    }
+    // warnings and errors, or nothing left to drop
+    cv_written_.wait(lock, [this] { return queue_.size() < queue_size_; });
+  }
+  queue_.push_back(std::move(line));
+  ++pushed_;
+  lock.unlock();
+  cv_pushed_.notify_one();
+}
+
+void AsyncLogWriter::flush() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  const auto target = pushed_;
+  cv_written_.wait(lock, [&] { return written_ >= target; });
+}
+
+void AsyncLogWriter::process() {
+  std::deque<Line> batch;
+  while (true) {
+    size_t dropped = 0;
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      cv_pushed_.wait(lock, [this] { return stop_ || !queue_.empty(); });
+      if (queue_.empty() && dropped_ == 0) return;  // stopped and drained
+      batch.swap(queue_);
+      std::swap(dropped, dropped_);
+    }
+    // the queue is empty again, let blocked callers continue
+    cv_written_.notify_all();
+
+    write(batch, dropped);
+
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      written_ += batch.size();
+    }
+    cv_written_.notify_all();
+    batch.clear();
+  }
+}
+
+void AsyncLogWriter::write(std::deque<Line>& batch, const size_t& dropped) {
+  std::string terminal;
+  for (auto& line : batch) {
+    if (!line.filename.empty()) {
+      auto& file = files_[line.filename];
+      if (!file.is_open())
+        file.open(line.filename, std::ios::out | std::ios::app);
+      file.write(line.text.data(), line.text.size());
+    }
+    if (line.to_stdout) {
+      const auto c = colored_ ? color(line.level) : nullptr;
+      if (c != nullptr) terminal += c;
+      terminal += line.text;
+      if (c != nullptr) terminal += "\x1b[0m";
+    }
+  }
+
+  if (dropped > 0) {
+    const auto msg = "[vtr_logging] " + std::to_string(dropped) +
+                     " log lines dropped because the log queue was full.\n";
+    for (auto& file : files_) file.second << msg;
+    terminal += msg;
+  }
+
+  // one flush per batch instead of per line
+  for (auto& file : files_) file.second.flush();
+  if (!terminal.empty()) {
+    std::cout.write(terminal.data(), terminal.size());
+    std::cout.flush();
+  }
+}
+
+void AsyncLogDispatchCallback::handle(const el::LogDispatchData* data) {
+  if (writer_ == nullptr) return;
+  if (data->dispatchAction() != el::base::DispatchAction::NormalLog) return;
+
+  const auto msg = data->logMessage();
+  const auto level = msg->level();
+  const auto tc = msg->logger()->typedConfigurations();
+
+  AsyncLogWriter::Line line;
+  line.text = msg->logger()->logBuilder()->build(msg, true);
+  line.level = level;
+  line.to_stdout = tc->toStandardOutput(level);
+  if (tc->toFile(level)) line.filename = tc->filename(level);
+  writer_->push(std::move(line));
+
+  // the application aborts right after a fatal log
+  if (level == el::Level::Fatal) writer_->flush();
+}
+
+}  // namespace logging
+}  // namespace vtr
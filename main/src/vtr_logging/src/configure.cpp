@@ -25,7 +25,8 @@ namespace vtr {
 namespace logging {
 
 void configureLogging(const std::string& log_filename, const bool debug,
-                      const std::vector<std::string>& enabled) {
+                      const std::vector<std::string>& enabled,
+                      const AsyncOptions& async) {
   // Logging flags
   el::Loggers::addFlag(el::LoggingFlag::ColoredTerminalOutput);
   el::Loggers::addFlag(el::LoggingFlag::LogDetailedCrashReason);
@@ -44,6 +45,24 @@ void configureLogging(const std::string& log_filename, const bool debug,
   }
 
   el::Loggers::setDefaultConfigurations(config, true);
+
+  // Replace the default (synchronous) dispatcher with the background writer
+  if (async.enabled) {
+    el::Helpers::installLogDispatchCallback<AsyncLogDispatchCallback>(
+        "vtr::logging::AsyncLogDispatchCallback");
+    el::Helpers::logDispatchCallback<AsyncLogDispatchCallback>(
+        "vtr::logging::AsyncLogDispatchCallback")
+        ->setWriter(std::make_shared<AsyncLogWriter>(async.queue_size,
+                                                     async.drop_policy));
+    el::Helpers::uninstallLogDispatchCallback<
+        el::base::DefaultLogDispatchCallback>("DefaultLogDispatchCallback");
+  } else {
+    el::Helpers::installLogDispatchCallback<
+        el::base::DefaultLogDispatchCallback>("DefaultLogDispatchCallback");
+    el::Helpers::uninstallLogDispatchCallback<AsyncLogDispatchCallback>(
+        "vtr::logging::AsyncLogDispatchCallback");
+  }
+
   LOG_IF(!log_filename.empty(), INFO) << "Logging to: " << log_filename;
   LOG_IF(log_filename.empty(), WARNING) << "NOT LOGGING TO A FILE.";
   LOG_IF(!enabled.empty(), INFO) << "Enabled loggers: " << enabled;
@@ -0,0 +1,144 @@
+// Copyright 2021, Autonomous Space Robotics Lab (ASRL)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+/**
+ * \file test_async_sink.cpp
+ * \author Autonomous Space Robotics Lab (ASRL)
+ */
+#include <gtest/gtest.h>
+
+#include <cstdio>
+#include <fstream>
+#include <regex>
+
+#include "vtr_logging/async_sink.hpp"
+#include "vtr_logging/logging_init.hpp"
+
+using namespace ::testing;
+using namespace vtr::logging;
+
+namespace {
+
+class AsyncSinkTest : public Test {
+ protected:
+  void SetUp() override {
+    const auto test_name = UnitTest::GetInstance()->current_test_info()->name();
+    filename_ = "/tmp/vtr_logging_test_" + std::string(test_name) + ".log";
+    std::remove(filename_.c_str());
+  }
+  void TearDown() override { std::remove(filename_.c_str()); }
+
+  AsyncLogWriter::Line line(const el::Level& level, const int& id) const {
+    AsyncLogWriter::Line line;
+    line.text = std::to_string(id) + "\n";
+    line.level = level;
+    line.to_stdout = false;
+    line.filename = filename_;
+    return line;
+  }
+
+  /** \brief ids of the lines in the file and the number of dropped lines */
+  std::pair<std::vector<int>, size_t> read() const {
+    std::vector<int> ids;
+    size_t dropped = 0;
+    std::ifstream file(filename_);
+    const std::regex dropped_regex(R"(\[vtr_logging\] (\d+) log lines .*)");
+    std::smatch match;
+    for (std::string text; std::getline(file, text);) {
+      if (std::regex_match(text, match, dropped_regex))
+        dropped += std::stoul(match[1]);
+      else
+        ids.push_back(std::stoi(text));
+    }
+    return {ids, dropped};
+  }
+
+  std::string filename_;
+};
+
+}  // namespace
+
+TEST_F(AsyncSinkTest, lines_are_written_in_order) {
+  const int num_lines = 10000;
+  AsyncLogWriter writer(16, DropPolicy::BLOCK);
+  for (int i = 0; i < num_lines; ++i) writer.push(line(el::Level::Info, i));
+  // everything pushed so far is in the file once flush returns
+  writer.flush();
+  const auto [ids, dropped] = read();
+  ASSERT_EQ(ids.size(), (size_t)num_lines);
+  for (int i = 0; i < num_lines; ++i) EXPECT_EQ(ids[i], i);
+  EXPECT_EQ(dropped, (size_t)0);
+}
+
+TEST_F(AsyncSinkTest, queued_lines_are_written_on_shutdown) {
+  const int num_lines = 1000;
+  {
+    AsyncLogWriter writer(num_lines, DropPolicy::BLOCK);
+    for (int i = 0; i < num_lines; ++i)
+      writer.push(line(el::Level::Info, i));
+    // no flush, the destructor drains the queue
+  }
+  const auto [ids, dropped] = read();
+  ASSERT_EQ(ids.size(), (size_t)num_lines);
+  for (int i = 0; i < num_lines; ++i) EXPECT_EQ(ids[i], i);
+}
+
+TEST_F(AsyncSinkTest, full_queue_drops_info_but_not_warnings) {
+  for (const auto policy : {DropPolicy::DROP_NEWEST, DropPolicy::DROP_OLDEST}) {
+    std::remove(filename_.c_str());
+    const int num_lines = 10000;
+    {
+      // a queue of one line makes the producer outrun the writer
+      AsyncLogWriter writer(1, policy);
+      for (int i = 0; i < num_lines; ++i) {
+        const auto level = i % 10 == 0 ? el::Level::Warning : el::Level::Info;
+        writer.push(line(level, i));
+      }
+    }
+    const auto [ids, dropped] = read();
+    // every line is either written or counted as dropped
+    EXPECT_EQ(ids.size() + dropped, (size_t)num_lines);
+    // written lines keep their order and warnings are never dropped
+    std::vector<int> warnings;
+    for (size_t i = 0; i < ids.size(); ++i) {
+      if (i > 0) {
+        EXPECT_LT(ids[i - 1], ids[i]);
+      }
+      if (ids[i] % 10 == 0) warnings.push_back(ids[i]);
+    }
+    ASSERT_EQ(warnings.size(), (size_t)num_lines / 10);
+    for (size_t i = 0; i < warnings.size(); ++i)
+      EXPECT_EQ(warnings[i], (int)(10 * i));
+  }
+}
+
+TEST_F(AsyncSinkTest, full_queue_blocks_without_dropping) {
+  const int num_lines = 10000;
+  {
+    AsyncLogWriter writer(1, DropPolicy::BLOCK);
+    for (int i = 0; i < num_lines; ++i)
+      writer.push(line(el::Level::Debug, i));
+  }
+  const auto [ids, dropped] = read();
+  EXPECT_EQ(dropped, (size_t)0);
+  ASSERT_EQ(ids.size(), (size_t)num_lines);
+  for (int i = 0; i < num_lines; ++i) EXPECT_EQ(ids[i], i);
+}
+
+TEST(AsyncSink, drop_policy_from_string) {
+  EXPECT_EQ(dropPolicyFromString("block"), DropPolicy::BLOCK);
+  EXPECT_EQ(dropPolicyFromString("drop_newest"), DropPolicy::DROP_NEWEST);
+  EXPECT_EQ(dropPolicyFromString("drop_oldest"), DropPolicy::DROP_OLDEST);
+  EXPECT_THROW(dropPolicyFromString("unknown"), std::invalid_argument);
+}
@@ -20,6 +20,8 @@
 
 #include <proj.h>
 
+#include <unordered_set>
+
 #include "rclcpp/rclcpp.hpp"
 
 #include "vtr_tactic/rviz_tactic_callback.hpp"
@@ -28,6 +30,7 @@
 
 #include "vtr_navigation_msgs/msg/annotate_route.hpp"
 #include "vtr_navigation_msgs/msg/update_waypoint.hpp"
+#include "vtr_navigation_msgs/msg/graph_diff.hpp"
 #include "vtr_navigation_msgs/msg/graph_route.hpp"
 #include "vtr_navigation_msgs/msg/graph_state.hpp"
 #include "vtr_navigation_msgs/msg/graph_update.hpp"
@@ -51,6 +54,7 @@ class GraphMapServer : public tactic::Graph::Callback,
   using GraphVertex = vtr_navigation_msgs::msg::GraphVertex;
   using GraphState = vtr_navigation_msgs::msg::GraphState;
   using GraphUpdate = vtr_navigation_msgs::msg::GraphUpdate;
+  using GraphDiff = vtr_navigation_msgs::msg::GraphDiff;
   using GraphStateSrv = vtr_navigation_msgs::srv::GraphState;
 
   using RobotState = vtr_navigation_msgs::msg::RobotState;
@@ -78,6 +82,8 @@ class GraphMapServer : public tactic::Graph::Callback,
 
   using VertexId2TransformMap = std::unordered_map<VertexId, Transform>;
   using VertexId2IdxMap = std::unordered_map<VertexId, size_t>;
+  using VertexId2TypeMap = std::unordered_map<VertexId, int8_t>;
+  using VertexId2NameMap = std::unordered_map<VertexId, std::string>;
   using ProjectVertex =
       std::function<std::tuple<double, double, double>(const VertexId&)>;
   using ProjectRobot = std::function<std::tuple<double, double, double>(
@@ -124,14 +130,36 @@ class GraphMapServer : public tactic::Graph::Callback,
   GraphPtr getGraph() const;
   /** \brief Returns a privileged graph (only contains teach routes) */
   GraphBasePtr getPrivilegedGraph() const;
-  /** \brief Compute graph in a privileged frame, changes vid2tf_map_ */
+  /**
+   * \brief Compute graph in a privileged frame, changes vid2tf_map_. Vertices
+   * that moved or changed neighbors are marked as changed, cached projections,
+   * types and names of other vertices are kept.
+   */
   void optimizeGraph(const GraphBasePtr& priv_graph);
+  /** \brief Rebuild projection functions and project all vertices */
   void updateVertexProjection();
+  /** \brief Project vertices marked as changed only */
+  void updateChangedVertexProjection();
   void updateVertexType();
   void updateVertexName();
+  /** \brief Terrain type of a vertex, loaded from the graph once and cached */
+  int8_t getVertexType(const VertexId& vid);
+  /** \brief Waypoint name of a vertex, loaded from the graph once and cached */
+  std::string getVertexName(const VertexId& vid);
   void computeRoutes(const GraphBasePtr& priv_graph);
   /** \brief Update the graph incrementally when no optimization is needed */
   bool updateIncrementally(const EdgePtr& e);
+  /**
+   * \brief Update the graph for a spatial edge by only relaxing the region
+   * around it (loop closure) or attaching a new vertex (start of a branch).
+   * \return false if a complete update is required
+   */
+  bool updateLocally(const EdgePtr& e);
+
+  /** \brief Publish vertices changed since the last publication as a diff */
+  void publishGraphDiff(const bool routes_changed);
+  /** \brief Publish the whole graph state */
+  void publishGraphState();
 
   void updateRobotProjection();
 
@@ -148,6 +176,14 @@ class GraphMapServer : public tactic::Graph::Callback,
   VertexId2IdxMap vid2idx_map_;
   /** \brief Vertices and routes */
   GraphState graph_state_;
+  /** \brief Vertices changed/removed since the last published diff */
+  std::unordered_set<VertexId> changed_vids_;
+  std::unordered_set<VertexId> removed_vids_;
+  /** \brief Cached terrain types and waypoint names */
+  VertexId2TypeMap vid2type_map_;
+  VertexId2NameMap vid2name_map_;
+  /** \brief Depth (number of edges) of the region relaxed on loop closure */
+  int local_relaxation_depth_ = 100;
 
   /**
    * \brief Cached robot persistent & target localization used after graph
@@ -170,6 +206,8 @@ class GraphMapServer : public tactic::Graph::Callback,
   rclcpp::CallbackGroup::SharedPtr callback_group_;
   /** \brief Publishes updates to the relaxed graph */
   rclcpp::Publisher<GraphUpdate>::SharedPtr graph_update_pub_;
+  /** \brief Publishes changes to the relaxed graph */
+  rclcpp::Publisher<GraphDiff>::SharedPtr graph_diff_pub_;
   /** \brief Publishes updates to the relaxed graph */
   rclcpp::Publisher<GraphState>::SharedPtr graph_state_pub_;
   /** \brief Service to request a relaxed version of the graph */
@@ -18,6 +18,8 @@
  */
 #include "vtr_navigation/graph_map_server.hpp"
 
+#include <algorithm>
+
 #include "vtr_pose_graph/optimization/pose_graph_optimizer.hpp"
 #include "vtr_pose_graph/optimization/pose_graph_relaxation.hpp"
 
@@ -54,6 +56,25 @@ Eigen::Matrix4d fromLngLatTheta(const double lng, const double lat,
   T_map_root.topRightCorner<2, 1>() << res.uv.u, res.uv.v;
   return T_map_root;
 }
+
+void relaxGraph(pose_graph::PoseGraphOptimizer<tactic::GraphBase>& optimizer) {
+  // add pose graph relaxation factors
+  // default covariance to use
+  Eigen::Matrix<double, 6, 6> cov(Eigen::Matrix<double, 6, 6>::Identity());
+  cov.topLeftCorner<3, 3>() *= LINEAR_NOISE * LINEAR_NOISE;
+  cov.bottomRightCorner<3, 3>() *= ANGLE_NOISE * ANGLE_NOISE;
+  auto relaxation_factor =
+      std::make_shared<pose_graph::PoseGraphRelaxation<tactic::GraphBase>>(cov);
+  optimizer.addFactor(relaxation_factor);
+
+  try {
+    // udpates the tf map
+    using SolverType = steam::DoglegGaussNewtonSolver;
+    optimizer.optimize<SolverType>();
+  } catch (steam::unsuccessful_step &e) {
+    CLOG(WARNING, "navigation.graph_map_server") << "Pose graph relaxation for visualization failed. Falling back back to initial config.";
+  }
+}
 }  // namespace
 
 void GraphMapServer::start(const rclcpp::Node::SharedPtr& node,
@@ -66,11 +87,13 @@ void GraphMapServer::start(const rclcpp::Node::SharedPtr& node,
   const auto lng = node->declare_parameter<double>("graph_projection.origin_lng", -79.466092);
   const auto theta = node->declare_parameter<double>("graph_projection.origin_theta", 0.);
   const auto scale = node->declare_parameter<double>("graph_projection.scale", 1.);
+  local_relaxation_depth_ = node->declare_parameter<int>("graph_map_server.local_relaxation_depth", local_relaxation_depth_);
 
   /// Publishers and services
   callback_group_ = node->create_callback_group(rclcpp::CallbackGroupType::MutuallyExclusive);
   // graph state
   graph_update_pub_ = node->create_publisher<GraphUpdate>("graph_update", 10);
+  graph_diff_pub_ = node->create_publisher<GraphDiff>("graph_diff", 10);
   graph_state_pub_ = node->create_publisher<GraphState>("graph_state", 10);
   graph_state_srv_ = node->create_service<GraphStateSrv>("graph_state_srv", std::bind(&GraphMapServer::graphStateSrvCallback, this, std::placeholders::_1, std::placeholders::_2), rmw_qos_profile_services_default, callback_group_);
   // robot state
@@ -114,6 +137,8 @@ void GraphMapServer::start(const rclcpp::Node::SharedPtr& node,
   updateVertexType();
   updateVertexName();
   computeRoutes(priv_graph);
+  changed_vids_.clear();
+  removed_vids_.clear();
 }
 
 void GraphMapServer::graphStateSrvCallback(
@@ -176,11 +201,15 @@ void GraphMapServer::annotateRouteCallback(
   //
   auto graph_lock = graph->guard();  // lock graph then internal lock
   UniqueLock lock(mutex_);
+  for (const auto& id : msg->ids) {
+    vid2type_map_[VertexId(id)] = msg->type;
+    graph->at(VertexId(id))->SetTerrainType(msg->type);
+  }
   const auto priv_graph = getPrivilegedGraph();
   updateVertexType();
   computeRoutes(priv_graph);
   //
-  graph_state_pub_->publish(graph_state_);
+  publishGraphDiff(true);
 }
 
 void GraphMapServer::moveGraphCallback(const MoveGraphMsg::ConstSharedPtr msg) {
@@ -203,7 +232,7 @@ void GraphMapServer::moveGraphCallback(const MoveGraphMsg::ConstSharedPtr msg) {
   updateVertexProjection();
   updateRobotProjection();
   //
-  graph_state_pub_->publish(graph_state_);
+  publishGraphState();
 }
 
 void GraphMapServer::updateWaypointCallback(
@@ -214,6 +243,7 @@ void GraphMapServer::updateWaypointCallback(
 
   
   const auto graph = getGraph();
+  std::string name;
   {
   const auto waypoint_name_msg =
       graph->at(VertexId(msg->vertex_id))
@@ -241,13 +271,18 @@ void GraphMapServer::updateWaypointCallback(
   }
 
   locked_waypoint_name_msg.setData(waypoint_name);
+  name = waypoint_name.name;
   }
 
   auto graph_lock = graph->guard();  // lock graph then internal lock
   UniqueLock lock(mutex_);
-  updateVertexName();
-  graph_state_pub_->publish(graph_state_);
-
+  const auto vid = VertexId(msg->vertex_id);
+  vid2name_map_[vid] = name;
+  if (vid2idx_map_.count(vid) != 0) {
+    graph_state_.vertices[vid2idx_map_.at(vid)].name = name;
+    changed_vids_.insert(vid);
+  }
+  publishGraphDiff(false);
 }
 
 void GraphMapServer::vertexAdded(const VertexPtr& v) {
@@ -277,15 +312,16 @@ void GraphMapServer::vertexAdded(const VertexPtr& v) {
 void GraphMapServer::edgeAdded(const EdgePtr& e) {
   UniqueLock lock(mutex_);
   if (updateIncrementally(e)) return;
+  if (updateLocally(e)) return;
   //
   const auto priv_graph = getPrivilegedGraph();
   optimizeGraph(priv_graph);
-  updateVertexProjection();
   updateVertexType();
   updateVertexName();
+  updateChangedVertexProjection();
   computeRoutes(priv_graph);
   //
-  graph_state_pub_->publish(graph_state_);
+  publishGraphDiff(true);
 }
 
 void GraphMapServer::endRun() {
@@ -294,13 +330,17 @@ void GraphMapServer::endRun() {
   if (getGraph()->numberOfVertices() <= 1) return;
 
   const auto priv_graph = getPrivilegedGraph();
-  optimizeGraph(priv_graph);
-  updateVertexProjection();
-  updateVertexType();
-  updateVertexName();
+  // vertices and loop closures of this run have been added incrementally, so
+  // only relax the whole graph if some privileged vertices are still missing
+  if (priv_graph->numberOfVertices() != vid2idx_map_.size()) {
+    optimizeGraph(priv_graph);
+    updateVertexType();
+    updateVertexName();
+    updateChangedVertexProjection();
+  }
   computeRoutes(priv_graph);
   //
-  graph_state_pub_->publish(graph_state_);
+  publishGraphDiff(true);
 }
 
 void GraphMapServer::robotStateUpdated(const tactic::Localization& persistent,
@@ -377,27 +417,14 @@ void GraphMapServer::optimizeGraph(const tactic::GraphBase::Ptr& priv_graph) {
   const auto map_info = getGraph()->getMapInfo();
   const auto root_vid = VertexId(map_info.root_vid);
 
+  const auto prev_vid2tf_map = vid2tf_map_;
   pose_graph::PoseGraphOptimizer<tactic::GraphBase> optimizer(
       priv_graph, root_vid, vid2tf_map_);
-
-  // add pose graph relaxation factors
-  // default covariance to use
-  Eigen::Matrix<double, 6, 6> cov(Eigen::Matrix<double, 6, 6>::Identity());
-  cov.topLeftCorner<3, 3>() *= LINEAR_NOISE * LINEAR_NOISE;
-  cov.bottomRightCorner<3, 3>() *= ANGLE_NOISE * ANGLE_NOISE;
-  auto relaxation_factor =
-      std::make_shared<pose_graph::PoseGraphRelaxation<tactic::GraphBase>>(cov);
-  optimizer.addFactor(relaxation_factor);
-
-  try {
-    // udpates the tf map
-    using SolverType = steam::DoglegGaussNewtonSolver;
-    optimizer.optimize<SolverType>();
-  } catch (steam::unsuccessful_step &e) {
-    CLOG(WARNING, "navigation.graph_map_server") << "Pose graph relaxation for visualization failed. Falling back back to initial config.";
-  }
+  relaxGraph(optimizer);
 
   // update the graph state vertices and idx map
+  auto prev_vertices = std::move(graph_state_.vertices);
+  auto prev_vid2idx_map = std::move(vid2idx_map_);
   auto& vertices = graph_state_.vertices;
   vertices.clear();
   vid2idx_map_.clear();
@@ -409,6 +436,33 @@ void GraphMapServer::optimizeGraph(const tactic::GraphBase::Ptr& priv_graph) {
       vertex.neighbors.push_back(jt);
     //
     vid2idx_map_[it->id()] = vertices.size() - 1;
+
+    // reuse projection, type and name of vertices that did not move
+    const auto prev_idx = prev_vid2idx_map.find(it->id());
+    const auto prev_tf = prev_vid2tf_map.find(it->id());
+    if (prev_idx == prev_vid2idx_map.end() ||
+        prev_tf == prev_vid2tf_map.end()) {
+      changed_vids_.insert(it->id());
+      continue;
+    }
+    const auto& prev_vertex = prev_vertices[prev_idx->second];
+    vertex.lng = prev_vertex.lng;
+    vertex.lat = prev_vertex.lat;
+    vertex.theta = prev_vertex.theta;
+    vertex.type = prev_vertex.type;
+    vertex.name = prev_vertex.name;
+    const bool moved = !prev_tf->second.matrix().isApprox(
+        vid2tf_map_.at(it->id()).matrix(), 1e-9);
+    const bool neighbors_changed =
+        prev_vertex.neighbors.size() != vertex.neighbors.size() ||
+        !std::is_permutation(vertex.neighbors.begin(), vertex.neighbors.end(),
+                             prev_vertex.neighbors.begin());
+    if (moved || neighbors_changed) changed_vids_.insert(it->id());
+  }
+  for (const auto& prev_vertex : prev_vertices) {
+    if (vid2idx_map_.count(VertexId(prev_vertex.id)) != 0) continue;
+    changed_vids_.erase(VertexId(prev_vertex.id));
+    removed_vids_.insert(VertexId(prev_vertex.id));
   }
 }
 
@@ -503,33 +557,75 @@ void GraphMapServer::updateVertexProjection() {
   }
 }
 
+void GraphMapServer::updateChangedVertexProjection() {
+  if (project_vertex_ == nullptr) return updateVertexProjection();
+  auto& vertices = graph_state_.vertices;
+  for (const auto& vid : changed_vids_) {
+    auto& vertex = vertices[vid2idx_map_.at(vid)];
+    const auto [lng, lat, theta] = project_vertex_(vid);
+    vertex.lng = lng;
+    vertex.lat = lat;
+    vertex.theta = theta;
+  }
+}
+
 void GraphMapServer::updateVertexType() {
-  const auto graph = getGraph();
   auto& vertices = graph_state_.vertices;
   for (auto&& vertex : vertices) {
-    const auto env_info_msg =
-        graph->at(vertex.id)
-            ->retrieve<tactic::EnvInfo>("env_info",
-                                        "vtr_tactic_msgs/msg/EnvInfo");
-    vertex.type = env_info_msg->sharedLocked().get().getData().terrain_type;
-    graph->at(vertex.id)->SetTerrainType(vertex.type);
-    int vertex_type = vertex.type;
-    CLOG(DEBUG, "navigation.graph_map_server") << "Updating Graph Vertex Type: " << vertex_type;
+    const auto type = getVertexType(VertexId(vertex.id));
+    if (vertex.type == type) continue;
+    vertex.type = type;
+    changed_vids_.insert(VertexId(vertex.id));
   }
 }
 
 void GraphMapServer::updateVertexName() {
-  const auto graph = getGraph();
   auto& vertices = graph_state_.vertices;
   for (auto&& vertex : vertices) {
-    const auto waypoint_name_msg =
-        graph->at(VertexId(vertex.id))
-            ->retrieve<tactic::WaypointName>("waypoint_name",
-                                        "vtr_tactic_msgs/msg/WaypointName");
-    vertex.name = waypoint_name_msg->sharedLocked().get().getData().name;
+    auto name = getVertexName(VertexId(vertex.id));
+    if (vertex.name == name) continue;
+    vertex.name = std::move(name);
+    changed_vids_.insert(VertexId(vertex.id));
   }
 }
 
+int8_t GraphMapServer::getVertexType(const VertexId& vid) {
+  const auto it = vid2type_map_.find(vid);
+  if (it != vid2type_map_.end()) return it->second;
+
+  const auto graph = getGraph();
+  const auto env_info_msg = graph->at(vid)->retrieve<tactic::EnvInfo>(
+      "env_info", "vtr_tactic_msgs/msg/EnvInfo");
+  if (env_info_msg == nullptr) {
+    std::stringstream ss;
+    ss << "Cannot find env_info for vertex " << vid;
+    CLOG(ERROR, "navigation.graph_map_server") << ss.str();
+    throw std::runtime_error{ss.str()};
+  }
+  const int8_t type =
+      env_info_msg->sharedLocked().get().getData().terrain_type;
+  graph->at(vid)->SetTerrainType(type);
+  CLOG(DEBUG, "navigation.graph_map_server")
+      << "Loaded vertex " << vid << " type: " << (int)type;
+  vid2type_map_.emplace(vid, type);
+  return type;
+}
+
+std::string GraphMapServer::getVertexName(const VertexId& vid) {
+  const auto it = vid2name_map_.find(vid);
+  if (it != vid2name_map_.end()) return it->second;
+
+  const auto waypoint_name_msg =
+      getGraph()->at(vid)->retrieve<tactic::WaypointName>(
+          "waypoint_name", "vtr_tactic_msgs/msg/WaypointName");
+  const auto name =
+      waypoint_name_msg == nullptr
+          ? std::string()
+          : waypoint_name_msg->sharedLocked().get().getData().name;
+  vid2name_map_.emplace(vid, name);
+  return name;
+}
+
 void GraphMapServer::computeRoutes(const tactic::GraphBase::Ptr& priv_graph) {
   /// \note for now we do not use junctions in the GUI, which is the return
   /// value from this function, we also do note distinguis between path and
@@ -625,29 +721,9 @@ bool GraphMapServer::updateIncrementally(const EdgePtr& e) {
   vertex.theta = theta;
 
   // vertex type
-  if (vertices[vid2idx_map_.at(from)].type == -1) {
-    const auto env_info_msg = getGraph()->at(from)->retrieve<tactic::EnvInfo>(
-        "env_info", "vtr_tactic_msgs/msg/EnvInfo");
-    if (env_info_msg == nullptr) {
-      std::stringstream ss;
-      ss << "Cannot find env_info for vertex " << from
-         << ", which is assumed added at this moment.";
-      CLOG(ERROR, "navigation.graph_map_server") << ss.str();
-      throw std::runtime_error{ss.str()};
-    }
-    vertices[vid2idx_map_.at(from)].type =
-        env_info_msg->sharedLocked().get().getData().terrain_type;
-  }
-  const auto env_info_msg = getGraph()->at(to)->retrieve<tactic::EnvInfo>(
-      "env_info", "vtr_tactic_msgs/msg/EnvInfo");
-  if (env_info_msg == nullptr) {
-    std::stringstream ss;
-    ss << "Cannot find env_info for vertex " << to
-       << ", which is assumed added at this moment.";
-    CLOG(ERROR, "navigation.graph_map_server") << ss.str();
-    throw std::runtime_error{ss.str()};
-  }
-  vertex.type = env_info_msg->sharedLocked().get().getData().terrain_type;
+  if (vertices[vid2idx_map_.at(from)].type == -1)
+    vertices[vid2idx_map_.at(from)].type = getVertexType(from);
+  vertex.type = getVertexType(to);
 
   // add to active route
   auto& active_routes = graph_state_.active_routes;
@@ -667,6 +743,7 @@ bool GraphMapServer::updateIncrementally(const EdgePtr& e) {
 
   // compute and publish the update message
   GraphUpdate graph_update;
+  graph_update.version = ++graph_state_.version;
   graph_update.vertex_from = vertices[vid2idx_map_.at(from)];
   graph_update.vertex_to = vertices[vid2idx_map_.at(to)];
   graph_update_pub_->publish(graph_update);
@@ -675,5 +752,131 @@ bool GraphMapServer::updateIncrementally(const EdgePtr& e) {
   return true;
 }
 
+bool GraphMapServer::updateLocally(const EdgePtr& e) {
+  if (!e->isSpatial()) return false;
+
+  const auto graph = getGraph();
+  const auto from = e->from();
+  const auto to = e->to();
+  const bool from_in_map = vid2idx_map_.count(from) != 0;
+  const bool to_in_map = vid2idx_map_.count(to) != 0;
+  auto& vertices = graph_state_.vertices;
+
+  // a new vertex connected to the map by this edge only, e.g. start of a branch
+  if (from_in_map != to_in_map) {
+    const auto known = from_in_map ? from : to;
+    const auto added = from_in_map ? to : from;
+    if (graph->neighbors(added).size() != 1) return false;
+
+    const auto T_added_known = added == to ? e->T() : e->T().inverse();
+    vid2tf_map_[added] = T_added_known * vid2tf_map_.at(known);
+
+    vertices[vid2idx_map_.at(known)].neighbors.push_back(added);
+    auto& vertex = vertices.emplace_back();
+    vertex.id = added;
+    vertex.neighbors.push_back(known);
+    vertex.type = getVertexType(added);
+    vertex.name = getVertexName(added);
+    vid2idx_map_[added] = vertices.size() - 1;
+    changed_vids_.insert(known);
+    changed_vids_.insert(added);
+    updateChangedVertexProjection();
+
+    // the new vertex starts a new active route from the map
+    auto& active_route = graph_state_.active_routes.emplace_back();
+    active_route.type = vertex.type;
+    active_route.ids.emplace_back(known);
+    active_route.ids.emplace_back(added);
+
+    publishGraphDiff(true);
+    CLOG(DEBUG, "navigation.graph_map_server")
+        << "Attached vertex " << added << " to " << known;
+    return true;
+  }
+
+  // loop closure within the map, relax the region around the new edge only
+  if (!from_in_map || local_relaxation_depth_ <= 0) return false;
+
+  using PrivEval = tactic::PrivilegedEvaluator<tactic::GraphBase>;
+  auto priv_eval = std::make_shared<PrivEval>(*graph);
+  std::unordered_set<VertexId> region;
+  for (const auto& root : {from, to}) {
+    const auto subgraph =
+        graph->getSubgraph(root, local_relaxation_depth_, priv_eval);
+    for (auto it = subgraph->beginVertex(), ite = subgraph->endVertex();
+         it != ite; ++it)
+      region.insert(it->id());
+  }
+  for (const auto& vid : region)
+    if (vid2idx_map_.count(vid) == 0) return false;
+
+  const auto local_graph =
+      graph->getSubgraph(VertexId::Vector(region.begin(), region.end()));
+  VertexId2TransformMap local_vid2tf_map;
+  for (const auto& vid : region)
+    local_vid2tf_map.emplace(vid, vid2tf_map_.at(vid));
+
+  const auto root_vid = VertexId(graph->getMapInfo().root_vid);
+  pose_graph::PoseGraphOptimizer<tactic::GraphBase> optimizer(
+      local_graph, region.count(root_vid) ? root_vid : from, local_vid2tf_map);
+  // vertices connecting the region to the rest of the map stay fixed
+  for (const auto& vid : region) {
+    for (const auto& nb : graph->neighbors(vid)) {
+      if (region.count(nb) || vid2idx_map_.count(nb) == 0) continue;
+      optimizer.lockVertex(vid);
+      break;
+    }
+  }
+  relaxGraph(optimizer);
+
+  for (const auto& [vid, T_vertex_root] : local_vid2tf_map) {
+    vid2tf_map_[vid] = T_vertex_root;
+    changed_vids_.insert(vid);
+  }
+  vertices[vid2idx_map_.at(from)].neighbors.push_back(to);
+  vertices[vid2idx_map_.at(to)].neighbors.push_back(from);
+  updateChangedVertexProjection();
+
+  // the new edge is shown as its own route until routes are recomputed
+  auto& fixed_route = graph_state_.fixed_routes.emplace_back();
+  fixed_route.type = vertices[vid2idx_map_.at(from)].type;
+  fixed_route.ids.emplace_back(from);
+  fixed_route.ids.emplace_back(to);
+
+  publishGraphDiff(true);
+  CLOG(DEBUG, "navigation.graph_map_server")
+      << "Relaxed " << region.size() << " vertices around edge " << e->id();
+  return true;
+}
+
+void GraphMapServer::publishGraphDiff(const bool routes_changed) {
+  if (changed_vids_.empty() && removed_vids_.empty() && !routes_changed)
+    return;
+
+  GraphDiff graph_diff;
+  graph_diff.base_version = graph_state_.version;
+  graph_diff.version = ++graph_state_.version;
+  graph_diff.vertices.reserve(changed_vids_.size());
+  for (const auto& vid : changed_vids_)
+    graph_diff.vertices.push_back(graph_state_.vertices[vid2idx_map_.at(vid)]);
+  for (const auto& vid : removed_vids_) graph_diff.removed_ids.push_back(vid);
+  graph_diff.routes_changed = routes_changed;
+  if (routes_changed) {
+    graph_diff.fixed_routes = graph_state_.fixed_routes;
+    graph_diff.active_routes = graph_state_.active_routes;
+  }
+  changed_vids_.clear();
+  removed_vids_.clear();
+
+  graph_diff_pub_->publish(graph_diff);
+}
+
+void GraphMapServer::publishGraphState() {
+  ++graph_state_.version;
+  changed_vids_.clear();
+  removed_vids_.clear();
+  graph_state_pub_->publish(graph_state_);
+}
+
 }  // namespace navigation
 }  // namespace vtr
@@ -41,13 +41,18 @@ int main(int argc, char** argv) {
   const auto log_debug = node->declare_parameter<bool>("log_debug", false);
   const auto log_enabled = node->declare_parameter<std::vector<std::string>>(
       "log_enabled", std::vector<std::string>{});
+  AsyncOptions log_async;
+  log_async.enabled = node->declare_parameter<bool>("log_async", false);
+  log_async.queue_size = node->declare_parameter<int>("log_queue_size", 8192);
+  log_async.drop_policy = dropPolicyFromString(
+      node->declare_parameter<std::string>("log_drop_policy", "drop_oldest"));
   std::string log_filename;
   if (log_to_file) {
     // Log into a subfolder of the data directory (if requested to log)
     auto log_name = "vtr-" + timing::toIsoFilename(timing::clock::now());
     log_filename = data_dir / (log_name + ".log");
   }
-  configureLogging(log_filename, log_debug, log_enabled);
+  configureLogging(log_filename, log_debug, log_enabled, log_async);
 
   // disable eigen multi-threading
   Eigen::setNbThreads(1);
@@ -87,10 +87,12 @@ Navigator::Navigator(const rclcpp::Node::SharedPtr& node) : node_(node) {
   // graph_map_server_ = std::make_shared<GraphMapServer>();
   graph_map_server_ = std::make_shared<RvizGraphMapServer>(node_);
 
-  /// pose graph
+  /// pose graph (callbacks go to the graph map server and the route planner)
+  auto graph_callback = std::make_shared<tactic::Graph::CallbackGroup>();
+  graph_callback->add(graph_map_server_);
   auto new_graph = node_->declare_parameter<bool>("start_new_graph", false);
   graph_ = tactic::Graph::MakeShared(data_dir + "/graph", !new_graph,
-                                     graph_map_server_);
+                                     graph_callback);
   graph_map_server_->start(node_, graph_);
 
   /// tactic
@@ -110,7 +112,9 @@ Navigator::Navigator(const rclcpp::Node::SharedPtr& node) : node_(node) {
                            std::make_shared<CommandPublisher>(node_));
 
   /// route planner
-  route_planner_ = std::make_shared<BFSPlanner>(graph_);
+  auto route_planner = std::make_shared<BFSPlanner>(graph_);
+  graph_callback->add(route_planner);
+  route_planner_ = route_planner;
 
   /// mission server
   mission_server_ = std::make_shared<ROSMissionServer>();
@@ -22,7 +22,7 @@ from vtr_navigation_msgs.srv import RobotState as RobotStateSrv
 from vtr_navigation_msgs.srv import ServerState as ServerStateSrv
 from vtr_navigation_msgs.srv import FollowingRoute as FollowingRouteSrv
 from vtr_navigation_msgs.srv import TaskQueueState as TaskQueueStateSrv
-from vtr_navigation_msgs.msg import GraphState, GraphUpdate, RobotState, GraphRoute
+from vtr_navigation_msgs.msg import GraphState, GraphUpdate, GraphDiff, RobotState, GraphRoute
 from vtr_navigation_msgs.msg import MoveGraph, AnnotateRoute, UpdateWaypoint
 from vtr_navigation_msgs.msg import MissionCommand, ServerState
 from vtr_navigation_msgs.msg import TaskQueueUpdate
@@ -55,6 +55,7 @@ class VTRUI(ROSManager):
       vtr_ui_logger.info("Waiting for graph_state_srv service...")
     self._graph_state_sub = self.create_subscription(GraphState, 'graph_state', self.graph_state_callback, 10)
     self._graph_update_sub = self.create_subscription(GraphUpdate, 'graph_update', self.graph_update_callback, 10)
+    self._graph_diff_sub = self.create_subscription(GraphDiff, 'graph_diff', self.graph_diff_callback, 10)
 
     # robot state
     self._robot_state_cli = self.create_client(RobotStateSrv, "robot_state_srv")
@@ -108,6 +109,10 @@ class VTRUI(ROSManager):
   def graph_update_callback(self, graph_update):
     self.notify("graph_update", graph_update=graph_update)
 
+  @ROSManager.on_ros
+  def graph_diff_callback(self, graph_diff):
+    self.notify("graph_diff", graph_diff=graph_diff)
+
   @ROSManager.on_ros
   def get_robot_state(self):
     return self._robot_state_cli.call(RobotStateSrv.Request()).robot_state
@@ -107,6 +107,7 @@ class CBIT : public BasePathPlanner {
     bool obstacle_avoidance = false;
     bool extrapolate_robot_pose = true;
     bool mpc_verbosity = false;
+    bool mpc_warm_start_multipliers = false;
     double forward_vel = 0.75;
     double max_lin_vel = 1.25;
     double max_ang_vel = 0.75;
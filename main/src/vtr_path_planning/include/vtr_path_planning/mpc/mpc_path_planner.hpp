@@ -44,20 +44,52 @@ public:
     DM vel_max{nControl, 1};
   };
 
+  /** \brief Timing and convergence information of the most recent solve */
+  struct SolveStats {
+    bool success = false;
+    bool warm_started = false;
+    std::string return_status;
+    int iter_count = 0;
+    /// wall time reported by casadi for the nlp solve [s]
+    double t_wall_solver = 0.0;
+    /// wall time spent updating the solver arguments [s]
+    double t_wall_setup = 0.0;
+  };
+
 
   CasadiUnicycleMPC(bool verbose=false, casadi::Dict iopt_config={ 
     { "max_iter", 2000 }, 
     { "acceptable_tol", 1e-8 } ,
     {"acceptable_obj_change_tol", 1e-6}
-  });
+  }, bool warm_start_multipliers=false);
 
   std::map<std::string, casadi::DM> solve(const Config& mpcConf);
 
+  /** \brief Drops the previous solution so that the next solve cold starts */
+  void reset();
+
+  const SolveStats& lastStats() const { return stats_; }
+
 
 private:
+  /** \brief Builds the constant parts of the bounds, only when vel_max changes */
+  void updateBounds(const Config& mpcConf);
+  /** \brief Seeds x0 with the previous solution shifted forward by one step */
+  bool shiftPreviousSolution(const Config& mpcConf);
+
   casadi::Function solve_mpc;
   std::map<std::string, casadi::DM> arg_;
 
+  bool warm_start_multipliers_ = false;
+  bool has_prev_solution_ = false;
+  bool barrier_active_ = false;
+  std::vector<double> vel_max_;
+  DM prev_x_;
+  DM prev_lam_x_;
+  DM prev_lam_g_;
+
+  SolveStats stats_;
+
 };
 
 } //namespace vtr::path_planning
\ No newline at end of file
@@ -75,6 +75,7 @@ auto CBIT::Config::fromROS(const rclcpp::Node::SharedPtr& node, const std::strin
   // CONTROLLER PARAMS
   config->extrapolate_robot_pose = node->declare_parameter<bool>(prefix + ".mpc.extrapolate_robot_pose", config->extrapolate_robot_pose);
   config->mpc_verbosity = node->declare_parameter<bool>(prefix + ".mpc.mpc_verbosity", config->mpc_verbosity);
+  config->mpc_warm_start_multipliers = node->declare_parameter<bool>(prefix + ".mpc.warm_start_multipliers", config->mpc_warm_start_multipliers);
   config->forward_vel = node->declare_parameter<double>(prefix + ".mpc.forward_vel", config->forward_vel);
   config->max_lin_vel = node->declare_parameter<double>(prefix + ".mpc.max_lin_vel", config->max_lin_vel);
   config->max_ang_vel = node->declare_parameter<double>(prefix + ".mpc.max_ang_vel", config->max_ang_vel);
@@ -98,7 +99,11 @@ auto CBIT::Config::fromROS(const rclcpp::Node::SharedPtr& node, const std::strin
 CBIT::CBIT(const Config::ConstPtr& config,
                                const RobotState::Ptr& robot_state,
                                const Callback::Ptr& callback)
-    : BasePathPlanner(config, robot_state, callback), config_(config), solver_{config_->mpc_verbosity} {
+    : BasePathPlanner(config, robot_state, callback), config_(config), solver_{config_->mpc_verbosity, {
+        { "max_iter", 2000 },
+        { "acceptable_tol", 1e-8 },
+        { "acceptable_obj_change_tol", 1e-6 }
+      }, config_->mpc_warm_start_multipliers} {
   CLOG(INFO, "cbit.path_planning") << "Constructing the CBIT Class";
   robot_state_ = robot_state;
   const auto node = robot_state->node.ptr();
@@ -147,6 +152,7 @@ void CBIT::setRunning(const bool running) {
     if (process_thread_cbit_.joinable()) process_thread_cbit_.join();
     thread_count_--;
     planner_ptr_->resetPlanner();
+    solver_.reset();
     // planner_ptr_.reset();
     CLOG(INFO, "cbit.path_planning") << "Stopped CBIT Planning";
   }
@@ -353,6 +359,7 @@ auto CBIT::computeCommand_(RobotState& robot_state) -> Command {
   if (*valid_solution_ptr == false)
   {
     CLOG(INFO, "cbit.control") << "There is Currently No Valid Solution, Disabling MPC";
+    solver_.reset();
     return Command();
   }
 
@@ -430,7 +437,7 @@ auto CBIT::computeCommand_(RobotState& robot_state) -> Command {
         mpc_poses.push_back(T_w_p * tf_from_global(pose_i[0], pose_i[1], pose_i[2]));
       }
 
-      CLOG(INFO, "cbit.control") << "Successfully solved MPC problem";
+      CLOG(INFO, "cbit.control") << "Successfully solved MPC problem in " << solver_.lastStats().t_wall_solver << "s";
       const auto& mpc_vel_vec = mpc_res["vel"](casadi::Slice(), 0).get_elements();
 
       command.linear.x = mpc_vel_vec[0];
@@ -444,6 +451,7 @@ auto CBIT::computeCommand_(RobotState& robot_state) -> Command {
 
     } catch(std::exception &e) {
       CLOG(WARNING, "cbit.control") << "casadi failed! " << e.what() << " Commanding to Stop the Vehicle";
+      solver_.reset();
       return Command();
     }
 
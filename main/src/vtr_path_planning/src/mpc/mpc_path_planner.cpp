@@ -17,69 +17,173 @@
  * \author Jordy Sehn, Autonomous Space Robotics Lab (ASRL)
  */
 
+#include <chrono>
 #include <ranges>
 
 #include "vtr_path_planning/mpc/mpc_path_planner.hpp"
 
 
 namespace vtr::path_planning {
-CasadiUnicycleMPC::CasadiUnicycleMPC( bool verbose, casadi::Dict ipopt_opts){
+
+namespace {
+using Config = CasadiUnicycleMPC::Config;
+constexpr int nX = Config::nStates * (Config::N + 1);
+constexpr int nU = Config::nControl * Config::N;
+constexpr int nG = Config::nStates * (Config::N + 1) + Config::N;
+constexpr int nP = Config::nStates * (Config::N + 1) + Config::nControl;
+
+/// Shifts the per-step blocks of a stacked [states; controls] vector forward
+/// by one step, repeating the last block.
+std::vector<double> shiftByOneStep(const std::vector<double>& v) {
+  std::vector<double> out(v.size());
+  for (int k = 0; k <= Config::N; ++k) {
+    const int src = std::min(k + 1, Config::N);
+    for (int i = 0; i < Config::nStates; ++i)
+      out[k * Config::nStates + i] = v[src * Config::nStates + i];
+  }
+  for (int k = 0; k < Config::N; ++k) {
+    const int src = std::min(k + 1, Config::N - 1);
+    for (int i = 0; i < Config::nControl; ++i)
+      out[nX + k * Config::nControl + i] = v[nX + src * Config::nControl + i];
+  }
+  return out;
+}
+}  // namespace
+
+CasadiUnicycleMPC::CasadiUnicycleMPC( bool verbose, casadi::Dict ipopt_opts, bool warm_start_multipliers)
+    : warm_start_multipliers_(warm_start_multipliers) {
   casadi::Dict opts;
   if (!verbose) { 
     opts["print_time"] = 0;
     ipopt_opts["print_level"] = 0;
   }
+  if (warm_start_multipliers_) {
+    ipopt_opts["warm_start_init_point"] = "yes";
+  }
   opts["ipopt"] = ipopt_opts;
   solve_mpc = nlpsol("solver", "ipopt", "libsolve_unicycle_mpc.so", opts);
 }
 
-std::map<std::string, casadi::DM> CasadiUnicycleMPC::solve(const Config& mpcConf) {
+void CasadiUnicycleMPC::reset() {
+  has_prev_solution_ = false;
+  arg_.erase("lam_x0");
+  arg_.erase("lam_g0");
+}
+
+void CasadiUnicycleMPC::updateBounds(const Config& mpcConf) {
   using namespace casadi;
-  std::map<std::string, DM> arg;
+  const auto vel_max = mpcConf.vel_max.get_elements();
+  if (arg_.count("lbx") && vel_max == vel_max_) return;
+  vel_max_ = vel_max;
+
+  arg_["lbx"] = DM::zeros(nX + nU, 1);
+  arg_["ubx"] = DM::zeros(nX + nU, 1);
+  arg_["lbx"].set(-DM::inf(), true, Slice(0, nX));
+  arg_["ubx"].set(DM::inf(), true, Slice(0, nX));
 
-  arg["lbx"] = DM::zeros(mpcConf.nStates*(mpcConf.N+1) + mpcConf.nControl*mpcConf.N, 1);
-  arg["ubx"] = DM::zeros(mpcConf.nStates*(mpcConf.N+1) + mpcConf.nControl*mpcConf.N, 1);
-  arg["lbx"].set(-DM::inf(), true, Slice(0, mpcConf.nStates*(mpcConf.N+1)));
-  arg["ubx"].set(DM::inf(), true, Slice(0, mpcConf.nStates*(mpcConf.N+1)));
-  
   // Velocity constraints
-  arg["ubx"].set(mpcConf.vel_max(Slice(0)), true, Slice(mpcConf.nStates*(mpcConf.N+1), mpcConf.nStates*(mpcConf.N+1) + mpcConf.nControl*mpcConf.N, 2));
-  arg["ubx"].set(mpcConf.vel_max(Slice(1)), true, Slice(mpcConf.nStates*(mpcConf.N+1)+1, mpcConf.nStates*(mpcConf.N+1) + mpcConf.nControl*mpcConf.N, 2));
-  arg["lbx"].set(-mpcConf.vel_max(Slice(0)), true, Slice(mpcConf.nStates*(mpcConf.N+1), mpcConf.nStates*(mpcConf.N+1) + mpcConf.nControl*mpcConf.N, 2));
-  arg["lbx"].set(-mpcConf.vel_max(Slice(1)), true, Slice(mpcConf.nStates*(mpcConf.N+1)+1, mpcConf.nStates*(mpcConf.N+1) + mpcConf.nControl*mpcConf.N, 2));
+  arg_["ubx"].set(mpcConf.vel_max(Slice(0)), true, Slice(nX, nX + nU, 2));
+  arg_["ubx"].set(mpcConf.vel_max(Slice(1)), true, Slice(nX + 1, nX + nU, 2));
+  arg_["lbx"].set(-mpcConf.vel_max(Slice(0)), true, Slice(nX, nX + nU, 2));
+  arg_["lbx"].set(-mpcConf.vel_max(Slice(1)), true, Slice(nX + 1, nX + nU, 2));
+
+  // Dynamics constraints are equalities, barrier constraints are patched per solve
+  if (!arg_.count("lbg")) {
+    arg_["lbg"] = DM::zeros(nG, 1);
+    arg_["ubg"] = DM::zeros(nG, 1);
+    arg_["ubg"].set(DM::inf(), true, Slice(nX, nG));
+    arg_["lbg"].set(-DM::inf(), true, Slice(nX, nG));
+    barrier_active_ = false;
+  }
 
-  arg["lbg"] = DM::zeros(mpcConf.nStates*(mpcConf.N+1) + mpcConf.N, 1);
-  arg["ubg"] = DM::zeros(mpcConf.nStates*(mpcConf.N+1) + mpcConf.N, 1);
+  if (!arg_.count("p")) arg_["p"] = DM::zeros(nP, 1);
+}
+
+bool CasadiUnicycleMPC::shiftPreviousSolution(const Config& mpcConf) {
+  if (!has_prev_solution_) return false;
+
+  auto x = shiftByOneStep(prev_x_.get_elements());
+  const auto T0 = mpcConf.T0.get_elements();
+
+  // The previous solution is expressed in the frame of the previous tick,
+  // rigidly re-anchor it so that its first state coincides with T0.
+  const double dth = T0[2] - x[2];
+  const double c = std::cos(dth), s = std::sin(dth);
+  const double x1 = x[0], y1 = x[1];
+  for (int k = 0; k <= Config::N; ++k) {
+    auto* st = &x[k * Config::nStates];
+    const double dx = st[0] - x1, dy = st[1] - y1;
+    st[0] = c * dx - s * dy + T0[0];
+    st[1] = s * dx + c * dy + T0[1];
+    st[2] += dth;
+  }
+  arg_["x0"] = DM(x);
+
+  if (warm_start_multipliers_) {
+    arg_["lam_x0"] = DM(shiftByOneStep(prev_lam_x_.get_elements()));
+    arg_["lam_g0"] = prev_lam_g_;
+  }
+  return true;
+}
+
+std::map<std::string, casadi::DM> CasadiUnicycleMPC::solve(const Config& mpcConf) {
+  using namespace casadi;
+  const auto setup_start = std::chrono::steady_clock::now();
+
+  updateBounds(mpcConf);
 
   if (mpcConf.up_barrier_q.size() > 0 && mpcConf.low_barrier_q.size() > 0) {
-    arg["ubg"].set(DM(mpcConf.up_barrier_q), true, Slice(mpcConf.nStates*(mpcConf.N+1), mpcConf.nStates*(mpcConf.N+1) + mpcConf.N));
-    arg["lbg"].set(DM(mpcConf.low_barrier_q), true, Slice(mpcConf.nStates*(mpcConf.N+1), mpcConf.nStates*(mpcConf.N+1) + mpcConf.N));
-  } else {
-    arg["ubg"].set(DM::inf(), true, Slice(mpcConf.nStates*(mpcConf.N+1), mpcConf.nStates*(mpcConf.N+1) + mpcConf.N));
-    arg["lbg"].set(-DM::inf(), true, Slice(mpcConf.nStates*(mpcConf.N+1), mpcConf.nStates*(mpcConf.N+1) + mpcConf.N));
+    arg_["ubg"].set(DM(mpcConf.up_barrier_q), true, Slice(nX, nG));
+    arg_["lbg"].set(DM(mpcConf.low_barrier_q), true, Slice(nX, nG));
+    barrier_active_ = true;
+  } else if (barrier_active_) {
+    arg_["ubg"].set(DM::inf(), true, Slice(nX, nG));
+    arg_["lbg"].set(-DM::inf(), true, Slice(nX, nG));
+    barrier_active_ = false;
   }
-  arg["x0"] = reshape(repmat(mpcConf.T0, 1, mpcConf.N+1), mpcConf.nStates*(mpcConf.N+1), 1);
-  arg["x0"] = vertcat(arg["x0"], DM::zeros(mpcConf.nControl* mpcConf.N, 1));
 
-  arg["p"] = mpcConf.T0;
+  stats_.warm_started = shiftPreviousSolution(mpcConf);
+  if (!stats_.warm_started) {
+    arg_["x0"] = vertcat(reshape(repmat(mpcConf.T0, 1, mpcConf.N+1), nX, 1), DM::zeros(nU, 1));
+  }
 
+  auto& p = arg_["p"];
+  p.set(mpcConf.T0, true, Slice(0, mpcConf.nStates));
   for(int i = 0; i < mpcConf.N; i++) {
-      arg["p"] = vertcat(arg["p"],
-          mpcConf.reference_poses.at(i));
+    p.set(mpcConf.reference_poses.at(i), true,
+          Slice(mpcConf.nStates * (i + 1), mpcConf.nStates * (i + 2)));
   }
-  arg["p"] = vertcat(arg["p"], mpcConf.previous_vel);
+  p.set(mpcConf.previous_vel, true, Slice(nX, nP));
 
-  auto res = solve_mpc(arg);
+  stats_.t_wall_setup = std::chrono::duration<double>(
+      std::chrono::steady_clock::now() - setup_start).count();
+
+  auto res = solve_mpc(arg_);
   auto stats = solve_mpc.stats();
 
-  if(stats["success"].as_bool() == false) { 
-    CLOG(WARNING, "mpc.solver") << "Casadi error: " << stats["return_status"];
+  stats_.success = stats["success"].as_bool();
+  stats_.return_status = stats["return_status"].as_string();
+  stats_.iter_count = stats.count("iter_count") ? stats["iter_count"].as_int() : 0;
+  stats_.t_wall_solver = stats.count("t_wall_total") ? stats["t_wall_total"].as_double() : 0.0;
+  CLOG(DEBUG, "mpc.solver") << "Solved in " << stats_.iter_count << " iterations, "
+                            << stats_.t_wall_solver << "s (setup " << stats_.t_wall_setup
+                            << "s, warm start: " << stats_.warm_started << ")";
+
+  if(stats_.success == false) { 
+    CLOG(WARNING, "mpc.solver") << "Casadi error: " << stats_.return_status;
     // throw std::logic_error("Casadi was unable to find a feasible solution. Barrier constraint likely violated");
+    // do not propagate a failed solution into the next initial guess
+    reset();
+  } else {
+    prev_x_ = res["x"];
+    prev_lam_x_ = res["lam_x"];
+    prev_lam_g_ = res["lam_g"];
+    has_prev_solution_ = true;
   }
   
   std::map<std::string, DM> output;
-  output["pose"] = reshape(res["x"](Slice(0, mpcConf.nStates * (mpcConf.N + 1))), mpcConf.nStates,  mpcConf.N + 1);
-  output["vel"] = reshape(res["x"](Slice(mpcConf.nStates * (mpcConf.N + 1), mpcConf.nStates * (mpcConf.N + 1) + mpcConf.nControl * mpcConf.N)), mpcConf.nControl,  mpcConf.N);
+  output["pose"] = reshape(res["x"](Slice(0, nX)), mpcConf.nStates,  mpcConf.N + 1);
+  output["vel"] = reshape(res["x"](Slice(nX, nX + nU)), mpcConf.nControl,  mpcConf.N);
 
   return output;
 }
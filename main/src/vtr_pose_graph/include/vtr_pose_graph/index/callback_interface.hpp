@@ -18,6 +18,9 @@
  */
 #pragma once
 
+#include <mutex>
+#include <vector>
+
 #include "vtr_common/utils/macros.hpp"
 
 namespace vtr {
@@ -35,5 +38,44 @@ class GraphCallbackInterface {
   virtual void edgeAdded(const EdgePtr&) {}
 };
 
+/**
+ * \brief Forwards graph callbacks to multiple listeners (e.g. the graph map
+ * server and the route planner) in the order they were added.
+ */
+template <class V, class E>
+class GraphCallbackGroup : public GraphCallbackInterface<V, E> {
+ public:
+  PTR_TYPEDEFS(GraphCallbackGroup);
+
+  using Base = GraphCallbackInterface<V, E>;
+  using EdgePtr = typename Base::EdgePtr;
+  using VertexPtr = typename Base::VertexPtr;
+
+  GraphCallbackGroup(const std::vector<typename Base::Ptr>& callbacks = {})
+      : callbacks_(callbacks) {}
+
+  void add(const typename Base::Ptr& callback) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    callbacks_.push_back(callback);
+  }
+
+  void vertexAdded(const VertexPtr& v) override {
+    for (const auto& callback : getCallbacks()) callback->vertexAdded(v);
+  }
+
+  void edgeAdded(const EdgePtr& e) override {
+    for (const auto& callback : getCallbacks()) callback->edgeAdded(e);
+  }
+
+ private:
+  std::vector<typename Base::Ptr> getCallbacks() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return callbacks_;
+  }
+
+  mutable std::mutex mutex_;
+  std::vector<typename Base::Ptr> callbacks_;
+};
+
 }  // namespace pose_graph
 }  // namespace vtr
@@ -43,6 +43,7 @@ class Graph : public GraphBase<V, E> {
 
   using Callback = GraphCallbackInterface<V, E>;
   using CallbackPtr = typename Callback::Ptr;
+  using CallbackGroup = GraphCallbackGroup<V, E>;
 
   using ChangeMutex = std::recursive_mutex;
   using ChangeLock = std::unique_lock<ChangeMutex>;
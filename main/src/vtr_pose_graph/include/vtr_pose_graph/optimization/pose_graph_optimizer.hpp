@@ -60,6 +60,9 @@ class PoseGraphOptimizer {
   PoseGraphOptimizer(const GraphPtr& graph, const VertexId& root,
                      VertexId2TransformMap& vid2tf_map);
 
+  /** \brief keeps the pose of a vertex fixed during optimization */
+  void lockVertex(const VertexId& v) { state_map_.at(v)->locked() = true; }
+
   /** \brief adds factors to the optimization problem */
   void addFactor(const typename PGOFactorInterface<Graph>::Ptr& factor);
 
@@ -216,6 +216,22 @@ class LocalizationChain : public Path<Graph> {
   /** \brief Update the Trunk to the closest vertex. */
   void searchClosestTrunk(bool look_backwards);
 
+  /**
+   * \brief Composes edge transforms along the sequence, T_{from_sid}_{to_sid}
+   * \note only touches edges between the two sequence ids, so it is cheap for
+   * nearby vertices (e.g. branch and trunk) regardless of the graph size.
+   */
+  EdgeTransform composeAlongSequence(unsigned from_sid, unsigned to_sid) const;
+
+  /**
+   * \brief Whether no privileged path between the two vertices is shorter
+   * (in edges) than the sequence segment, i.e. whether composeAlongSequence
+   * gives what the privileged Dijkstra search would. False when the segment
+   * goes around a loop or past a privileged loop closure.
+   * \note searches only up to the segment length around from_sid
+   */
+  bool isShortestAlongSequence(unsigned from_sid, unsigned to_sid) const;
+
   /** \brief important indices */
   unsigned trunk_sid_ = (unsigned)-1;
   unsigned branch_sid_ = (unsigned)-1;
@@ -195,6 +195,12 @@ void LocalizationChain<Graph>::updateBranchToTwigTransform(
       return EdgeTransform(true);
     } else if (branch_vid == trunk_vid_) {
       return T_branch_trunk_;
+    } else if (branch_sid_ < this->sequence_.size() &&
+               this->sequence_[branch_sid_] == branch_vid_ &&
+               branch_sid < this->sequence_.size() &&
+               this->sequence_[branch_sid] == branch_vid &&
+               isShortestAlongSequence(branch_sid_, branch_sid)) {
+      return composeAlongSequence(branch_sid_, branch_sid);
     } else {
       auto eval =
           std::make_shared<eval::mask::privileged::Eval<Graph>>(*this->graph_);
@@ -242,17 +248,30 @@ void LocalizationChain<Graph>::searchClosestTrunk(bool search_backwards) {
            ? unsigned(std::max(int(trunk_sid_) - config_.search_back_depth, 0))
            : trunk_sid_);
 
-  EdgeTransform T_trunk_root = this->pose(trunk_sid_).inverse();
-  EdgeTransform T_leaf_root = T_leaf_trunk() * T_trunk_root;
+  // the distance scan only needs the mean, so work with the cached sequence
+  // poses as plain matrices instead of composing covariances
+  const auto inverse = [](const Eigen::Matrix4d &T) {
+    Eigen::Matrix4d T_inv = Eigen::Matrix4d::Identity();
+    T_inv.topLeftCorner<3, 3>() = T.topLeftCorner<3, 3>().transpose();
+    T_inv.topRightCorner<3, 1>() =
+        -T_inv.topLeftCorner<3, 3>() * T.topRightCorner<3, 1>();
+    return T_inv;
+  };
+  const Eigen::Matrix4d T_leaf_root =
+      T_leaf_trunk().matrix() * inverse(this->poseMatrix(trunk_sid_));
 
   // Find the closest vertex (updating Trunk) now that VO has updated the leaf
+  Eigen::Matrix4d T_root_prev, T_root_curr, T_root_next;
   for (auto path_it = this->begin(begin_sid); unsigned(path_it) < end_sid;
        ++path_it) {
-    EdgeTransform T_root_new = this->pose(path_it);
-    EdgeTransform T_leaf_new = T_leaf_root * T_root_new;
+    const auto sid = unsigned(path_it);
+    T_root_prev = T_root_curr;
+    T_root_curr = sid == begin_sid ? this->poseMatrix(sid) : T_root_next;
+    if (sid + 1 < end_sid) T_root_next = this->poseMatrix(sid + 1);
+    const Eigen::Matrix4d T_leaf_new = T_leaf_root * T_root_curr;
 
     // Calculate the "distance"
-    Eigen::Matrix<double, 6, 1> se3_leaf_new = T_leaf_new.vec();
+    Eigen::Matrix<double, 6, 1> se3_leaf_new = lgmath::se3::tran2vec(T_leaf_new);
     double distance = se3_leaf_new.head<3>().norm() +
                       config_.angle_weight * se3_leaf_new.tail<3>().norm();
 
@@ -273,8 +292,10 @@ void LocalizationChain<Graph>::searchClosestTrunk(bool search_backwards) {
     // position
     if (search_backwards == false && max_distance > config_.min_cusp_distance &&
         unsigned(path_it) > begin_sid && unsigned(path_it) + 1 < end_sid) {
-      Eigen::Matrix<double, 6, 1> vec_prev_cur = path_it->T().vec();
-      Eigen::Matrix<double, 6, 1> vec_cur_next = (path_it + 1)->T().vec();
+      Eigen::Matrix<double, 6, 1> vec_prev_cur =
+          lgmath::se3::tran2vec(inverse(T_root_prev) * T_root_curr);
+      Eigen::Matrix<double, 6, 1> vec_cur_next =
+          lgmath::se3::tran2vec(inverse(T_root_curr) * T_root_next);
       // + means they are in the same direction (note the negative at the front
       // to invert one of them)
       double r_dot = vec_prev_cur.head<3>().dot(vec_cur_next.head<3>());
@@ -309,13 +330,22 @@ void LocalizationChain<Graph>::searchClosestTrunk(bool search_backwards) {
     trunk_sid_ = best_sid;
     trunk_vid_ = this->sequence_[trunk_sid_];
 
-    auto priv_eval =
-        std::make_shared<eval::mask::privileged::Eval<Graph>>(*this->graph_);
-    auto delta = this->graph_->dijkstraSearch(
-        branch_vid_, trunk_vid_,
-        std::make_shared<eval::weight::ConstEval>(1, 1), priv_eval);
-    T_branch_trunk_ = eval::ComposeTfAccumulator(
-        delta->begin(branch_vid_), delta->end(), EdgeTransform(true));
+    // the branch is on the path in most cases, so the transform can be
+    // composed from the edges between branch and trunk along the sequence,
+    // unless the search below would take a shorter privileged path
+    if (branch_sid_ < this->sequence_.size() &&
+        this->sequence_[branch_sid_] == branch_vid_ &&
+        isShortestAlongSequence(branch_sid_, trunk_sid_)) {
+      T_branch_trunk_ = composeAlongSequence(branch_sid_, trunk_sid_);
+    } else {
+      auto priv_eval =
+          std::make_shared<eval::mask::privileged::Eval<Graph>>(*this->graph_);
+      auto delta = this->graph_->dijkstraSearch(
+          branch_vid_, trunk_vid_,
+          std::make_shared<eval::weight::ConstEval>(1, 1), priv_eval);
+      T_branch_trunk_ = eval::ComposeTfAccumulator(
+          delta->begin(branch_vid_), delta->end(), EdgeTransform(true));
+    }
   }
 
   CLOG(DEBUG, "pose_graph")
@@ -323,5 +353,31 @@ void LocalizationChain<Graph>::searchClosestTrunk(bool search_backwards) {
       << ", first seq: " << begin_sid << ", last seq: " << end_sid;
 }
 
+template <class Graph>
+EdgeTransform LocalizationChain<Graph>::composeAlongSequence(
+    unsigned from_sid, unsigned to_sid) const {
+  if (from_sid > to_sid) return composeAlongSequence(to_sid, from_sid).inverse();
+  // the iterator at sid holds the edge from sid - 1 to sid
+  return eval::ComposeTfAccumulator(this->begin(from_sid + 1),
+                                    this->begin(to_sid + 1),
+                                    EdgeTransform(true));
+}
+
+template <class Graph>
+bool LocalizationChain<Graph>::isShortestAlongSequence(unsigned from_sid,
+                                                       unsigned to_sid) const {
+  const unsigned num_edges =
+      from_sid > to_sid ? from_sid - to_sid : to_sid - from_sid;
+  // a single edge (or none) cannot be shortcut
+  if (num_edges < 2) return true;
+  // the search uses unit weights, so it takes any privileged path to to_sid
+  // with fewer edges, e.g. a loop closure or the same vertex seen twice
+  auto priv_eval =
+      std::make_shared<eval::mask::privileged::Eval<Graph>>(*this->graph_);
+  const auto nearby = this->graph_->getSubgraph(
+      this->sequence_[from_sid], double(num_edges - 1), priv_eval);
+  return !nearby->contains(this->sequence_[to_sid]);
+}
+
 }  // namespace pose_graph
 }  // namespace vtr
\ No newline at end of file
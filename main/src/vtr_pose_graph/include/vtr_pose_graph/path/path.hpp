@@ -60,6 +60,8 @@ class Path {
   EdgeTransform pose(const Iterator& it) const { return pose(unsigned(it)); }
   /** \brief Vertex id implicitly converts to unsigned */
   EdgeTransform pose(VertexId vtx_id) const = delete;
+  /** \brief Get the pose at a sequence index without its covariance */
+  Eigen::Matrix4d poseMatrix(unsigned seq_id) const;
 
   /** \brief Gets the cumu. distance along the path at a sequence index */
   double dist(unsigned seq_id) const;
@@ -182,6 +184,19 @@ EdgeTransform Path<GraphT>::pose(unsigned seq_id) const {
   return poses_[seq_id];
 }
 
+template <class GraphT>
+Eigen::Matrix4d Path<GraphT>::poseMatrix(unsigned seq_id) const {
+  LockGuard lock(mutex_);
+  if (seq_id >= sequence_.size()) {
+    std::string err{"[Path][poseMatrix] id out of range."};
+    CLOG(ERROR, "pose_graph") << err;
+    throw std::range_error(err);
+  }
+  // cheating so we can JIT expand
+  const_cast<Path<GraphT>*>(this)->expand(seq_id);
+  return poses_[seq_id].matrix();
+}
+
 template <class GraphT>
 double Path<GraphT>::dist(unsigned seq_id) const {
   LockGuard lock(mutex_);
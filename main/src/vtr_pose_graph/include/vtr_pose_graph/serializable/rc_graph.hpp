@@ -46,6 +46,7 @@ class RCGraph : public Graph<RCVertex, RCEdge> {
 
   using Callback = GraphCallbackInterface<RCVertex, RCEdge>;
   using CallbackPtr = typename Callback::Ptr;
+  using CallbackGroup = GraphCallbackGroup<RCVertex, RCEdge>;
 
   using GraphMsg = vtr_pose_graph_msgs::msg::Graph;
   using MapInfoMsg = vtr_pose_graph_msgs::msg::MapInfo;
@@ -199,6 +199,69 @@ TEST_F(ChainTest, simulate_localization_skipped_frames) {
   print(chain_);
 }
 
+TEST(ChainLoopTest, branch_to_trunk_takes_privileged_shortcut) {
+  /**
+   * R0: 0 --- 1 --- ... --- 9, plus a privileged loop closure 0 --- 9
+   * R1: 0
+   * The path follows 0 ... 9, so along the sequence vertex 9 is 9 edges away
+   * from vertex 0 but the loop closure connects them directly.
+   */
+  BasicGraph::Ptr graph(new BasicGraph());
+  graph->addRun();
+  graph->addVertex();
+  for (unsigned i = 0; i < 9; ++i) {
+    graph->addVertex();
+    Eigen::Matrix4d transform = Eigen::Matrix4d::Identity();
+    transform(2, 3) = -1;
+    EdgeTransform edge_transform(transform);
+    edge_transform.setZeroCovariance();
+    graph->addEdge(VertexId(0, i), VertexId(0, i + 1), EdgeType::Temporal,
+                   true, edge_transform);
+  }
+  {
+    // inconsistent with the path on purpose, 2 instead of 9 meters
+    Eigen::Matrix4d transform = Eigen::Matrix4d::Identity();
+    transform(2, 3) = -2;
+    EdgeTransform edge_transform(transform);
+    edge_transform.setZeroCovariance();
+    graph->addEdge(VertexId(0, 0), VertexId(0, 9), EdgeType::Spatial, true,
+                   edge_transform);
+  }
+  graph->addRun();
+  graph->addVertex();
+
+  LocalizationChain<BasicGraph> chain(graph);
+  VertexId::Vector sequence;
+  for (unsigned i = 0; i < 10; ++i) sequence.push_back(VertexId(0, i));
+  chain.setSequence(sequence);
+  chain.expand();
+  chain.setPetiole(VertexId(1, 0));
+
+  const auto distance = [&]() {
+    return chain.T_branch_trunk().matrix().block<3, 1>(0, 3).norm();
+  };
+
+  // branch and trunk on vertex 0
+  chain.updateBranchToTwigTransform(VertexId(1, 0), VertexId(0, 0), 0,
+                                    EdgeTransform(true), false, false);
+  EXPECT_EQ(chain.trunkVertexId(), VertexId(0, 0));
+  EXPECT_NEAR(distance(), 0.0, 1e-6);
+
+  // branch on vertex 3, the sequence is the shortest privileged path
+  chain.updateBranchToTwigTransform(VertexId(1, 0), VertexId(0, 3), 3,
+                                    EdgeTransform(true), false, false);
+  EXPECT_EQ(chain.trunkVertexId(), VertexId(0, 0));
+  EXPECT_NEAR(distance(), 3.0, 1e-6);
+
+  // branch on vertex 9, the privileged search goes 3 - 2 - 1 - 0 - 9 instead
+  // of along the sequence, so T_branch_trunk is the loop closure
+  chain.updateBranchToTwigTransform(VertexId(1, 0), VertexId(0, 9), 9,
+                                    EdgeTransform(true), false, false);
+  EXPECT_EQ(chain.trunkVertexId(), VertexId(0, 0));
+  EXPECT_NEAR(distance(), 2.0, 1e-6);
+  print(chain);
+}
+
 int main(int argc, char** argv) {
   configureLogging("", true);
   testing::InitGoogleTest(&argc, argv);
@@ -0,0 +1,174 @@
+// Copyright 2021, Autonomous Space Robotics Lab (ASRL)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+/**
+ * \file pointmap_delta.inl
+ * \author Autonomous Space Robotics Lab (ASRL)
+ */
+#pragma once
+
+#include <unordered_set>
+
+#include "vtr_radar/data_types/pointmap_delta.hpp"
+
+#include "pcl_conversions/pcl_conversions.h"
+
+#include "vtr_common/conversions/ros_lgmath.hpp"
+
+namespace vtr {
+namespace radar {
+
+template <class PointT>
+auto PointMapDelta<PointT>::fromStorable(const PointMapDeltaMsg& storable)
+    -> Ptr {
+  // construct with dl, base vertex id and version
+  auto data = std::make_shared<PointMapDelta<PointT>>(
+      storable.dl, tactic::VertexId(storable.base_vertex_id), storable.version);
+  // load point cloud data
+  pcl::fromROSMsg(storable.point_cloud, data->point_cloud_);
+  // load removed voxels
+  const auto& removed = storable.removed_voxels;
+  data->removed_voxels_.reserve(removed.size() / 3);
+  for (size_t i = 0; i + 2 < removed.size(); i += 3)
+    data->removed_voxels_.emplace_back(removed[i], removed[i + 1],
+                                       removed[i + 2]);
+  // load vertex id
+  data->vertex_id_ = tactic::VertexId(storable.vertex_id);
+  // load transform
+  using namespace vtr::common;
+  conversions::fromROSMsg(storable.t_vertex_this, data->T_vertex_this_);
+  // build voxel map
+  data->samples_.clear();
+  data->samples_.reserve(data->point_cloud_.size());
+  size_t i = 0;
+  for (const auto& p : data->point_cloud_) {
+    auto result = data->samples_.emplace(data->getKey(p), i);
+    if (!result.second)
+      throw std::runtime_error{
+          "PointMapDelta fromStorable detects points with same key. This "
+          "should never happen."};
+    i++;
+  }
+  return data;
+}
+
+template <class PointT>
+auto PointMapDelta<PointT>::toStorable() const -> PointMapDeltaMsg {
+  PointMapDeltaMsg storable;
+  // save point cloud data
+  pcl::toROSMsg(this->point_cloud_, storable.point_cloud);
+  // save removed voxels
+  storable.removed_voxels.reserve(3 * removed_voxels_.size());
+  for (const auto& key : removed_voxels_) {
+    storable.removed_voxels.push_back(key.x);
+    storable.removed_voxels.push_back(key.y);
+    storable.removed_voxels.push_back(key.z);
+  }
+  // save base vertex id
+  storable.base_vertex_id = base_vertex_id_;
+  // save vertex id
+  storable.vertex_id = this->vertex_id_;
+  // save transform
+  using namespace vtr::common;
+  conversions::toROSMsg(this->T_vertex_this_, storable.t_vertex_this);
+  // save version
+  storable.version = this->version_;
+  // save voxel size
+  storable.dl = this->dl_;
+  return storable;
+}
+
+template <class PointT>
+template <class Callback>
+auto PointMapDelta<PointT>::fromMaps(const PointMap<PointT>& base,
+                                     const tactic::VertexId& base_vid,
+                                     const PointMap<PointT>& map,
+                                     const Callback& equal) -> Ptr {
+  if (base.dl() != map.dl())
+    throw std::invalid_argument{
+        "PointMapDelta requires maps with the same voxel size."};
+
+  auto data =
+      std::make_shared<PointMapDelta<PointT>>(map.dl(), base_vid, map.version());
+  data->vertex_id_ = map.vertex_id();
+  data->T_vertex_this_ = map.T_vertex_this();
+
+  // voxels of the base map
+  const auto& base_cloud = base.point_cloud();
+  std::unordered_map<VoxKey, size_t> base_samples;
+  base_samples.reserve(base_cloud.size());
+  for (size_t i = 0; i < base_cloud.size(); ++i)
+    base_samples.emplace(data->getKey(base_cloud[i]), i);
+
+  // voxels added or changed since the base map
+  std::unordered_set<VoxKey> map_keys;
+  map_keys.reserve(map.size());
+  for (const auto& p : map.point_cloud()) {
+    const auto key = data->getKey(p);
+    map_keys.emplace(key);
+    const auto base_sample = base_samples.find(key);
+    if (base_sample != base_samples.end() &&
+        equal(base_cloud[base_sample->second], p))
+      continue;
+    data->samples_.emplace(key, data->point_cloud_.size());
+    data->point_cloud_.push_back(p);
+  }
+
+  // voxels removed since the base map
+  for (const auto& p : base_cloud) {
+    const auto key = data->getKey(p);
+    if (map_keys.count(key) == 0) data->removed_voxels_.push_back(key);
+  }
+
+  return data;
+}
+
+template <class PointT>
+auto PointMapDelta<PointT>::apply(const PointMap<PointT>& base) const ->
+    typename PointMap<PointT>::Ptr {
+  if (base.dl() != this->dl_)
+    throw std::invalid_argument{
+        "PointMapDelta applied to a map with a different voxel size."};
+
+  const std::unordered_set<VoxKey> removed(removed_voxels_.begin(),
+                                           removed_voxels_.end());
+
+  // voxels of the base map that are kept, with their changes applied
+  PointCloudType point_cloud;
+  point_cloud.reserve(base.size() + this->size());
+  std::vector<char> applied(this->size(), 0);
+  for (const auto& p : base.point_cloud()) {
+    const auto key = this->getKey(p);
+    if (removed.count(key) > 0) continue;
+    const auto sample = this->samples_.find(key);
+    if (sample == this->samples_.end()) {
+      point_cloud.push_back(p);
+    } else {
+      point_cloud.push_back(this->point_cloud_[sample->second]);
+      applied[sample->second] = 1;
+    }
+  }
+  // voxels added since the base map
+  for (size_t i = 0; i < this->size(); ++i)
+    if (!applied[i]) point_cloud.push_back(this->point_cloud_[i]);
+
+  auto map = std::make_shared<PointMap<PointT>>(this->dl_, this->version_);
+  map->update(point_cloud);
+  map->vertex_id() = this->vertex_id_;
+  map->T_vertex_this() = this->T_vertex_this_;
+  return map;
+}
+
+}  // namespace radar
+}  // namespace vtr
@@ -0,0 +1,134 @@
+// Copyright 2021, Autonomous Space Robotics Lab (ASRL)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+/**
+ * \file pointmap_versions.hpp
+ * \brief Copy-on-write storage of the submap versions of a vertex.
+ * \details The latest submap of a vertex is stored in the <stream> stream
+ * ("pointmap" by default, "radar_pointmap" in the radar-lidar pipeline). A
+ * version is only stored again, as "<stream>_v<version>", right before it is
+ * replaced by a newer one, so a version that is still the latest is never
+ * stored twice. The initial submap may instead be stored in "<stream>_delta"
+ * as a PointMapDelta of the previous submap. Same layout as vtr_lidar's
+ * pointmap_versions.hpp.
+ *
+ * \author Autonomous Space Robotics Lab (ASRL)
+ */
+#pragma once
+
+#include "vtr_radar/data_types/pointmap.hpp"
+#include "vtr_radar/data_types/pointmap_delta.hpp"
+#include "vtr_tactic/types.hpp"
+
+namespace vtr {
+namespace radar {
+
+/**
+ * \brief Returns a copy of the given version of the vertex submap.
+ * \return nullptr if this version is not available
+ */
+template <class PointT>
+std::shared_ptr<PointMap<PointT>> retrievePointMapVersion(
+    const tactic::Graph::Ptr &graph, const tactic::Vertex::Ptr &vertex,
+    const unsigned &version, const std::string &stream = "pointmap") {
+  const auto version_stream = stream + "_v" + std::to_string(version);
+  // already replaced by a newer version
+  if (const auto msg = vertex->retrieve<PointMap<PointT>>(
+          version_stream, "vtr_radar_msgs/msg/PointMap")) {
+    return std::make_shared<PointMap<PointT>>(msg->sharedLocked().get().getData());
+  }
+  // otherwise it may still be the latest version
+  if (const auto msg = vertex->retrieve<PointMap<PointT>>(
+          stream, "vtr_radar_msgs/msg/PointMap")) {
+    auto locked_msg = msg->sharedLocked();
+    const auto &pointmap = locked_msg.get().getData();
+    if (pointmap.version() == version)
+      return std::make_shared<PointMap<PointT>>(pointmap);
+  }
+  // replaced in the meantime, the snapshot is stored before the replacement
+  if (const auto msg = vertex->retrieve<PointMap<PointT>>(
+          version_stream, "vtr_radar_msgs/msg/PointMap")) {
+    return std::make_shared<PointMap<PointT>>(msg->sharedLocked().get().getData());
+  }
+  // or stored as a delta of the previous submap, which is never replaced
+  if (const auto msg = vertex->retrieve<PointMapDelta<PointT>>(
+          stream + "_delta", "vtr_radar_msgs/msg/PointMapDelta")) {
+    const auto delta = msg->sharedLocked().get().getData();
+    if (delta.version() != version) return nullptr;
+    const auto base = retrievePointMapVersion<PointT>(
+        graph, graph->at(delta.base_vertex_id()), PointMap<PointT>::INITIAL,
+        stream);
+    if (base == nullptr) return nullptr;
+    return delta.apply(*base);
+  }
+  return nullptr;
+}
+
+/**
+ * \brief Returns a copy of the latest version of the vertex submap.
+ * \return nullptr if the vertex has no submap
+ */
+template <class PointT>
+std::shared_ptr<PointMap<PointT>> retrievePointMap(
+    const tactic::Graph::Ptr &graph, const tactic::Vertex::Ptr &vertex,
+    const std::string &stream = "pointmap") {
+  if (const auto msg = vertex->retrieve<PointMap<PointT>>(
+          stream, "vtr_radar_msgs/msg/PointMap")) {
+    return std::make_shared<PointMap<PointT>>(msg->sharedLocked().get().getData());
+  }
+  // the initial version is the latest until it gets replaced
+  return retrievePointMapVersion<PointT>(graph, vertex,
+                                         PointMap<PointT>::INITIAL, stream);
+}
+
+/**
+ * \brief Replaces the latest submap of the vertex with updated_map. The
+ * replaced version is stored as "<stream>_v<version>" first.
+ */
+template <class PointT>
+void replacePointMap(const tactic::Vertex::Ptr &vertex,
+                     const PointMap<PointT> &updated_map,
+                     const std::string &stream = "pointmap") {
+  using PointMapLM = storage::LockableMessage<PointMap<PointT>>;
+  const auto map_msg = vertex->retrieve<PointMap<PointT>>(
+      stream, "vtr_radar_msgs/msg/PointMap");
+  // the initial version is stored as a delta and is kept there
+  if (map_msg == nullptr) {
+    auto updated_map_msg = std::make_shared<PointMapLM>(
+        std::make_shared<PointMap<PointT>>(updated_map), vertex->vertexTime());
+    vertex->insert<PointMap<PointT>>(stream, "vtr_radar_msgs/msg/PointMap",
+                                     updated_map_msg);
+    return;
+  }
+  auto locked_map_msg_ref = map_msg->locked();  // lock the msg
+  auto &locked_map_msg = locked_map_msg_ref.get();
+
+  const auto &curr_map = locked_map_msg.getData();
+  const auto version_stream =
+      stream + "_v" + std::to_string(curr_map.version());
+  if (curr_map.version() != updated_map.version() &&
+      vertex->retrieve<PointMap<PointT>>(
+          version_stream, "vtr_radar_msgs/msg/PointMap") == nullptr) {
+    auto snapshot = std::make_shared<PointMap<PointT>>(curr_map);
+    auto snapshot_msg =
+        std::make_shared<PointMapLM>(snapshot, vertex->vertexTime());
+    vertex->insert<PointMap<PointT>>(
+        version_stream, "vtr_radar_msgs/msg/PointMap", snapshot_msg);
+  }
+
+  locked_map_msg.setData(updated_map);
+}
+
+}  // namespace radar
+}  // namespace vtr
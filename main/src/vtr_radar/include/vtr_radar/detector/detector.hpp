@@ -44,13 +44,14 @@ class KStrongest : public Detector<PointT> {
  public:
   KStrongest() = default;
   KStrongest(int kstrong, double threshold2, double threshold3, double minr,
-             double maxr, double range_offset)
+             double maxr, double range_offset, int num_threads = 4)
       : kstrong_(kstrong),
         threshold2_(threshold2),
         threshold3_(threshold3),
         minr_(minr),
         maxr_(maxr),
-        range_offset_(range_offset) {}
+        range_offset_(range_offset),
+        num_threads_(num_threads) {}
 
   void run(const cv::Mat &raw_scan, const float &res,
            const std::vector<int64_t> &azimuth_times,
@@ -64,18 +65,21 @@ class KStrongest : public Detector<PointT> {
   double minr_ = 2.0;
   double maxr_ = 100.0;
   double range_offset_ = -0.31;
+  int num_threads_ = 4;
 };
 
 template <class PointT>
 class Cen2018 : public Detector<PointT> {
  public:
   Cen2018() = default;
-  Cen2018(double zq, int sigma, double minr, double maxr, double range_offset)
+  Cen2018(double zq, int sigma, double minr, double maxr, double range_offset,
+          int num_threads = 4)
       : zq_(zq),
         sigma_(sigma),
         minr_(minr),
         maxr_(maxr),
-        range_offset_(range_offset) {}
+        range_offset_(range_offset),
+        num_threads_(num_threads) {}
 
   void run(const cv::Mat &raw_scan, const float &res,
            const std::vector<int64_t> &azimuth_times,
@@ -88,6 +92,7 @@ class Cen2018 : public Detector<PointT> {
   double minr_ = 2.0;
   double maxr_ = 100.0;
   double range_offset_ = -0.31;
+  int num_threads_ = 4;
 };
 
 template <class PointT>
@@ -95,7 +100,8 @@ class CACFAR : public Detector<PointT> {
  public:
   CACFAR() = default;
   CACFAR(int width, int guard, double threshold, double threshold2,
-         double threshold3, double minr, double maxr, double range_offset)
+         double threshold3, double minr, double maxr, double range_offset,
+         int num_threads = 4)
       : width_(width),
         guard_(guard),
         threshold_(threshold),
@@ -103,7 +109,8 @@ class CACFAR : public Detector<PointT> {
         threshold3_(threshold3),
         minr_(minr),
         maxr_(maxr),
-        range_offset_(range_offset) {}
+        range_offset_(range_offset),
+        num_threads_(num_threads) {}
 
   void run(const cv::Mat &raw_scan, const float &res,
            const std::vector<int64_t> &azimuth_times,
@@ -119,6 +126,7 @@ class CACFAR : public Detector<PointT> {
   double minr_ = 2.0;
   double maxr_ = 100.0;
   double range_offset_ = -0.31;
+  int num_threads_ = 4;
 };
 
 template <class PointT>
@@ -126,7 +134,8 @@ class OSCFAR : public Detector<PointT> {
  public:
   OSCFAR() = default;
   OSCFAR(int width, int guard, int kstat, double threshold, double threshold2,
-         double threshold3, double minr, double maxr, double range_offset)
+         double threshold3, double minr, double maxr, double range_offset,
+         int num_threads = 4)
       : width_(width),
         guard_(guard),
         kstat_(kstat),
@@ -135,7 +144,8 @@ class OSCFAR : public Detector<PointT> {
         threshold3_(threshold3),
         minr_(minr),
         maxr_(maxr),
-        range_offset_(range_offset) {}
+        range_offset_(range_offset),
+        num_threads_(num_threads) {}
 
   void run(const cv::Mat &raw_scan, const float &res,
            const std::vector<int64_t> &azimuth_times,
@@ -152,6 +162,7 @@ class OSCFAR : public Detector<PointT> {
   double minr_ = 2.0;
   double maxr_ = 100.0;
   double range_offset_ = -0.31;
+  int num_threads_ = 4;
 };
 
 template <class PointT>
@@ -160,7 +171,7 @@ class ModifiedCACFAR : public Detector<PointT> {
   ModifiedCACFAR() = default;
   ModifiedCACFAR(int width, int guard, double threshold, double threshold2,
                  double threshold3, double minr, double maxr,
-                 double range_offset)
+                 double range_offset, int num_threads = 4)
       : width_(width),
         guard_(guard),
         threshold_(threshold),
@@ -168,7 +179,8 @@ class ModifiedCACFAR : public Detector<PointT> {
         threshold3_(threshold3),
         minr_(minr),
         maxr_(maxr),
-        range_offset_(range_offset) {}
+        range_offset_(range_offset),
+        num_threads_(num_threads) {}
 
   void run(const cv::Mat &raw_scan, const float &res,
            const std::vector<int64_t> &azimuth_times,
@@ -184,6 +196,7 @@ class ModifiedCACFAR : public Detector<PointT> {
   double minr_ = 2.0;
   double maxr_ = 100.0;
   double range_offset_ = -0.31;
+  int num_threads_ = 4;
 };
 
 }  // namespace radar
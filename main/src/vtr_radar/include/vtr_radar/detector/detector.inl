@@ -25,13 +25,58 @@ namespace vtr {
 namespace radar {
 
 namespace {
-bool sort_desc_by_first(const std::pair<int, float> &a,
-                        const std::pair<int, float> &b) {
-  return (a.first > b.first);
+
+/// [first, last) column range of a detector, clamped to the scan
+struct ColumnRange {
+  ColumnRange(const double &mincol, const double &maxcol, const int &cols,
+              const int &margin = 0)
+      : first(std::max((int)mincol, margin)),
+        last(std::min((int)std::ceil(maxcol), cols - margin)) {}
+  int size() const { return std::max(last - first, 0); }
+  int first;
+  int last;
+};
+
+/// sliding window sums over a row through its prefix sum
+class RowPrefixSum {
+ public:
+  void compute(const float *row, const int &cols) {
+    sums_.resize(cols + 1);
+    sums_[0] = 0;
+    for (int j = 0; j < cols; ++j) sums_[j + 1] = sums_[j] + row[j];
+  }
+  /// sum of row[first, last), out of bound cells are zero
+  double sum(int first, int last) const {
+    const int cols = (int)sums_.size() - 1;
+    first = std::clamp(first, 0, cols);
+    last = std::clamp(last, 0, cols);
+    return last > first ? sums_[last] - sums_[first] : 0.0;
+  }
+
+ private:
+  std::vector<double> sums_;
+};
+
+template <class PointT>
+PointT makePolarPoint(const float &rho, const double &azimuth,
+                      const int64_t &time) {
+  PointT p;
+  p.rho = rho;
+  p.phi = azimuth;
+  p.theta = 0;
+  p.timestamp = time;
+  return p;
 }
-bool sort_asc_by_second(const std::pair<int, float> &a,
-                        const std::pair<int, float> &b) {
-  return (a.second < b.second);
+
+/// gathers per-azimuth detections in azimuth order
+template <class PointT>
+void concatenateAzimuths(const std::vector<pcl::PointCloud<PointT>> &polar_time,
+                         pcl::PointCloud<PointT> &pointcloud) {
+  size_t num_points = 0;
+  for (const auto &row : polar_time) num_points += row.size();
+  pointcloud.reserve(num_points);
+  for (const auto &row : polar_time)
+    pointcloud.insert(pointcloud.end(), row.begin(), row.end());
 }
 
 }  // namespace
@@ -49,40 +94,33 @@ void KStrongest<PointT>::run(const cv::Mat &raw_scan, const float &res,
   auto maxcol = maxr_ / res;
   if (maxcol > cols || maxcol < 0) maxcol = cols;
   const auto N = maxcol - mincol;
+  const ColumnRange range(mincol, maxcol, cols);
 
-  // #pragma omp parallel for
+  std::vector<pcl::PointCloud<PointT>> polar_time(rows);
+#pragma omp parallel for schedule(dynamic, 10) num_threads(num_threads_)
   for (int i = 0; i < rows; ++i) {
-    std::vector<std::pair<float, int>> intens;
-    intens.reserve(N / 2);
+    const float *row = raw_scan.ptr<float>(i);
     double mean = 0;
-    for (int j = mincol; j < maxcol; ++j) {
-      mean += raw_scan.at<float>(i, j);
-    }
+    for (int j = range.first; j < range.last; ++j) mean += row[j];
     mean /= N;
     const double thres = mean * threshold2_ + threshold3_;
-    for (int j = mincol; j < maxcol; ++j) {
-      if (raw_scan.at<float>(i, j) >= thres)
-        intens.emplace_back(raw_scan.at<float>(i, j), j);
-    }
-    // sort intensities in descending order
-    std::sort(intens.begin(), intens.end(), sort_desc_by_first);
-    const double azimuth = azimuth_angles[i];
-    const int64_t time = azimuth_times[i];
-    pcl::PointCloud<PointT> polar_time;
-    for (int j = 0; j < kstrong_; ++j) {
-      if (intens[j].first < thres) break;
-      PointT p;
-      p.rho = float(intens[j].second) * res + range_offset_;
-      p.phi = azimuth;
-      p.theta = 0;
-      p.timestamp = time;
-      polar_time.push_back(p);
-    }
-    // #pragma omp critical
-    {
-      pointcloud.insert(pointcloud.end(), polar_time.begin(), polar_time.end());
-    }
+
+    std::vector<std::pair<float, int>> intens;
+    intens.reserve(range.size() / 2);
+    for (int j = range.first; j < range.last; ++j)
+      if (row[j] >= thres) intens.emplace_back(row[j], j);
+
+    // only the k strongest returns are needed, no need to sort all of them
+    const int k = std::min<int>(kstrong_, intens.size());
+    std::nth_element(intens.begin(), intens.begin() + k, intens.end(),
+                     std::greater<std::pair<float, int>>());
+    polar_time[i].reserve(k);
+    for (int j = 0; j < k; ++j)
+      polar_time[i].push_back(makePolarPoint<PointT>(
+          float(intens[j].second) * res + range_offset_, azimuth_angles[i],
+          azimuth_times[i]));
   }
+  concatenateAzimuths(polar_time, pointcloud);
 }
 
 template <class PointT>
@@ -98,20 +136,20 @@ void Cen2018<PointT>::run(const cv::Mat &raw_scan, const float &res,
   auto maxcol = maxr_ / res;
   if (maxcol > cols || maxcol < 0) maxcol = cols;
   const auto N = maxcol - mincol;
+  const ColumnRange range(mincol, maxcol, cols);
 
   std::vector<float> sigma_q(rows, 0);
   // TODO: try implementing an efficient median filter
   // Estimate the bias and subtract it from the signal
   cv::Mat q = raw_scan.clone();
+#pragma omp parallel for schedule(dynamic, 10) num_threads(num_threads_)
   for (int i = 0; i < rows; ++i) {
+    const float *row = raw_scan.ptr<float>(i);
+    float *q_row = q.ptr<float>(i);
     float mean = 0;
-    for (int j = mincol; j < maxcol; ++j) {
-      mean += raw_scan.at<float>(i, j);
-    }
+    for (int j = range.first; j < range.last; ++j) mean += row[j];
     mean /= N;
-    for (int j = mincol; j < maxcol; ++j) {
-      q.at<float>(i, j) = raw_scan.at<float>(i, j) - mean;
-    }
+    for (int j = range.first; j < range.last; ++j) q_row[j] = row[j] - mean;
   }
 
   // Create 1D Gaussian Filter
@@ -130,11 +168,16 @@ void Cen2018<PointT>::run(const cv::Mat &raw_scan, const float &res,
   cv::Mat p;
   cv::filter2D(q, p, -1, filter, cv::Point(-1, -1), 0, cv::BORDER_REFLECT101);
 
-  // Estimate variance of noise at each azimuth
+  std::vector<pcl::PointCloud<PointT>> polar_time(rows);
+#pragma omp parallel for schedule(dynamic, 10) num_threads(num_threads_)
   for (int i = 0; i < rows; ++i) {
+    const float *q_row = q.ptr<float>(i);
+    const float *p_row = p.ptr<float>(i);
+
+    // Estimate variance of noise at this azimuth
     int nonzero = 0;
-    for (int j = mincol; j < maxcol; ++j) {
-      float n = q.at<float>(i, j);
+    for (int j = range.first; j < range.last; ++j) {
+      const float n = q_row[j];
       if (n < 0) {
         sigma_q[i] += 2 * (n * n);
         nonzero++;
@@ -144,51 +187,37 @@ void Cen2018<PointT>::run(const cv::Mat &raw_scan, const float &res,
       sigma_q[i] = sqrt(sigma_q[i] / nonzero);
     else
       sigma_q[i] = 0.034;
-  }
-  // Extract peak centers from each azimuth
-  // #pragma omp parallel for
-  for (int i = 0; i < rows; ++i) {
-    pcl::PointCloud<PointT> polar_time;
+
+    // Extract peak centers from this azimuth
     float peak_points = 0;
     int num_peak_points = 0;
     const float thres = zq_ * sigma_q[i];
     const double azimuth = azimuth_angles[i];
     const int64_t time = azimuth_times[i];
-    for (int j = mincol; j < maxcol; ++j) {
-      const float nqp = exp(
-          -0.5 * pow((q.at<float>(i, j) - p.at<float>(i, j)) / sigma_q[i], 2));
-      const float npp = exp(-0.5 * pow(p.at<float>(i, j) / sigma_q[i], 2));
+    for (int j = range.first; j < range.last; ++j) {
+      const float nqp =
+          exp(-0.5 * pow((q_row[j] - p_row[j]) / sigma_q[i], 2));
+      const float npp = exp(-0.5 * pow(p_row[j] / sigma_q[i], 2));
       const float b = nqp - npp;
-      const float y = q.at<float>(i, j) * (1 - nqp) + p.at<float>(i, j) * b;
+      const float y = q_row[j] * (1 - nqp) + p_row[j] * b;
       if (y > thres) {
         peak_points += j;
         num_peak_points += 1;
       } else if (num_peak_points > 0) {
-        PointT p;
-        p.rho = res * peak_points / num_peak_points + range_offset_;
-        p.phi = azimuth;
-        p.theta = 0;
-        p.timestamp = time;
-        polar_time.push_back(p);
+        polar_time[i].push_back(makePolarPoint<PointT>(
+            res * peak_points / num_peak_points + range_offset_, azimuth,
+            time));
         peak_points = 0;
         num_peak_points = 0;
       }
     }
     if (num_peak_points > 0) {
-      const double azimuth = azimuth_angles[rows - 1];
-      const int64_t time = azimuth_times[rows - 1];
-      PointT p;
-      p.rho = res * peak_points / num_peak_points + range_offset_;
-      p.phi = azimuth;
-      p.theta = 0;
-      p.timestamp = time;
-      polar_time.push_back(p);
-    }
-    // #pragma omp critical
-    {
-      pointcloud.insert(pointcloud.end(), polar_time.begin(), polar_time.end());
+      polar_time[i].push_back(makePolarPoint<PointT>(
+          res * peak_points / num_peak_points + range_offset_,
+          azimuth_angles[rows - 1], azimuth_times[rows - 1]));
     }
   }
+  concatenateAzimuths(polar_time, pointcloud);
 }
 
 template <class PointT>
@@ -207,49 +236,32 @@ void CACFAR<PointT>::run(const cv::Mat &raw_scan, const float &res,
   auto maxcol = maxr_ / res - w2 - guard_;
   if (maxcol > cols || maxcol < 0) maxcol = cols;
   const int N = maxcol - mincol;
+  const ColumnRange range(mincol, maxcol, cols);
 
-  // #pragma omp parallel for
-  for (int i = 0; i < rows; ++i) {
-    const double azimuth = azimuth_angles[i];
-    const int64_t time = azimuth_times[i];
-    pcl::PointCloud<PointT> polar_time;
-    double mean = 0;
-    for (int j = mincol; j < maxcol; ++j) {
-      mean += raw_scan.at<float>(i, j);
-    }
-    mean /= N;
+  std::vector<pcl::PointCloud<PointT>> polar_time(rows);
+#pragma omp parallel num_threads(num_threads_)
+  {
+    RowPrefixSum prefix;
+#pragma omp for schedule(dynamic, 10)
+    for (int i = 0; i < rows; ++i) {
+      const float *row = raw_scan.ptr<float>(i);
+      prefix.compute(row, cols);
+      const double mean = prefix.sum(range.first, range.last) / N;
 
-    for (int j = mincol; j < maxcol; ++j) {
-      double stat = 0;  // (statistic) estimate of clutter power
-      double left = 0;
-      double right = 0;
-      // for (int k = -w2 - guard_; k <= w2 + guard_; ++k) {
-      //   if (k < -guard_ || k > guard_)
-      //     stat += raw_scan.at<float>(i, j + k);
-      // }
-      for (int k = -w2 - guard_; k < -guard_; ++k) {
-        left += raw_scan.at<float>(i, j + k);
-      }
-      for (int k = guard_ + 1; k <= w2 + guard_; ++k) {
-        right += raw_scan.at<float>(i, j + k);
+      for (int j = range.first; j < range.last; ++j) {
+        // (statistic) estimate of clutter power
+        const double left = prefix.sum(j - w2 - guard_, j - guard_);
+        const double right = prefix.sum(j + guard_ + 1, j + w2 + guard_ + 1);
+        const double stat = std::max(left, right);
+        const float thres =
+            threshold_ * stat / (window / 2) + threshold2_ * mean + threshold3_;
+        if (row[j] > thres)
+          polar_time[i].push_back(makePolarPoint<PointT>(
+              j * res + range_offset_, azimuth_angles[i], azimuth_times[i]));
       }
-      stat = std::max(left, right);
-      const float thres =
-          threshold_ * stat / (window / 2) + threshold2_ * mean + threshold3_;
-      if (raw_scan.at<float>(i, j) > thres) {
-        PointT p;
-        p.rho = j * res + range_offset_;
-        p.phi = azimuth;
-        p.theta = 0;
-        p.timestamp = time;
-        polar_time.push_back(p);
-      }
-    }
-    // #pragma omp critical
-    {
-      pointcloud.insert(pointcloud.end(), polar_time.begin(), polar_time.end());
     }
   }
+  concatenateAzimuths(polar_time, pointcloud);
 }
 
 template <class PointT>
@@ -267,79 +279,69 @@ void OSCFAR<PointT>::run(const cv::Mat &raw_scan, const float &res,
   auto maxcol = maxr_ / res - w2;
   if (maxcol > cols || maxcol < 0) maxcol = cols;
   const int N = maxcol - mincol;
+  // the window must stay within the scan
+  const ColumnRange range(mincol, maxcol, cols, w2 + 1);
+  const int kstat = std::clamp(kstat_, 0, 2 * w2 - 1);
 
-  // #pragma omp parallel for
-  for (int i = 0; i < rows; ++i) {
-    const double azimuth = azimuth_angles[i];
-    const int64_t time = azimuth_times[i];
-    pcl::PointCloud<PointT> polar_time;
-    double mean = 0;
-    for (int j = mincol; j < maxcol; ++j) {
-      mean += raw_scan.at<float>(i, j);
-    }
-    mean /= N;
+  std::vector<pcl::PointCloud<PointT>> polar_time(rows);
+#pragma omp parallel num_threads(num_threads_)
+  {
+    // sorted training cells, updated incrementally as the window slides
+    std::vector<float> window;
+    window.reserve(2 * w2 + 1);
+    const auto remove = [&window](const float &value) {
+      window.erase(std::lower_bound(window.begin(), window.end(), value));
+    };
+    const auto insert = [&window](const float &value) {
+      window.insert(std::upper_bound(window.begin(), window.end(), value),
+                    value);
+    };
 
-    std::vector<std::pair<int, float>> window;
-    window.reserve(width_ - 1);
-    int j = mincol - 1;
-    for (int k = -w2; k < 0; ++k) {
-      window.emplace_back(j + k, raw_scan.at<float>(i, j + k));
-    }
-    for (int k = 1; k <= w2; ++k) {
-      window.emplace_back(j + k, raw_scan.at<float>(i, j + k));
-    }
-    std::sort(window.begin(), window.end(), sort_asc_by_second);
+#pragma omp for schedule(dynamic, 10)
+    for (int i = 0; i < rows; ++i) {
+      const float *row = raw_scan.ptr<float>(i);
+      const double azimuth = azimuth_angles[i];
+      const int64_t time = azimuth_times[i];
+      double mean = 0;
+      for (int j = range.first; j < range.last; ++j) mean += row[j];
+      mean /= N;
 
-    float peak_points = 0;
-    int num_peak_points = 0;
+      if (range.size() == 0) continue;
 
-    for (j = mincol; j < maxcol; ++j) {
-      // remove cell under test and left-most cell
-      window.erase(std::remove_if(window.begin(), window.end(),
-                                  [&](const std::pair<float, int> &p) -> bool {
-                                    return p.first == j ||
-                                           p.first == j - w2 - 1;
-                                  }),
-                   window.end());
-      // insert prev CUT and right-most cell
-      auto prevcut = std::make_pair(j - 1, raw_scan.at<float>(i, j - 1));
-      auto it = std::lower_bound(window.begin(), window.end(), prevcut,
-                                 sort_asc_by_second);
-      window.insert(it, prevcut);
-      auto newentry = std::make_pair(j + w2, raw_scan.at<float>(i, j + w2));
-      it = std::lower_bound(window.begin(), window.end(), newentry,
-                            sort_asc_by_second);
-      window.insert(it, newentry);
-
-      // DEBUG: check that the window is indeed sorted:
-      // assert(window.size() == width_ - 1);
-      // for (size_t k = 1; k < window.size(); ++k) {
-      //   if (window[k - 1].second > window[k].second) {
-      //     throw std::runtime_error("window not sorted.");
-      //   }
-      // }
-      // (statistic) estimate of clutter power
-      double stat = window[kstat_].second;
-      const float thres = threshold_ * stat + threshold2_ * mean + threshold3_;
-      if (raw_scan.at<float>(i, j) > thres) {
-        peak_points += j;
-        num_peak_points += 1;
-      } else if (num_peak_points > 0) {
-        PointT p;
-        p.rho = res * peak_points / num_peak_points + range_offset_;
-        p.phi = azimuth;
-        p.theta = 0;
-        p.timestamp = time;
-        polar_time.push_back(p);
-        peak_points = 0;
-        num_peak_points = 0;
+      int j = range.first - 1;
+      window.assign(row + j - w2, row + j);
+      window.insert(window.end(), row + j + 1, row + j + w2 + 1);
+      std::sort(window.begin(), window.end());
+
+      float peak_points = 0;
+      int num_peak_points = 0;
+
+      for (j = range.first; j < range.last; ++j) {
+        // remove cell under test and left-most cell
+        remove(row[j]);
+        remove(row[j - w2 - 1]);
+        // insert prev CUT and right-most cell
+        insert(row[j - 1]);
+        insert(row[j + w2]);
+
+        // (statistic) estimate of clutter power
+        const double stat = window[kstat];
+        const float thres =
+            threshold_ * stat + threshold2_ * mean + threshold3_;
+        if (row[j] > thres) {
+          peak_points += j;
+          num_peak_points += 1;
+        } else if (num_peak_points > 0) {
+          polar_time[i].push_back(makePolarPoint<PointT>(
+              res * peak_points / num_peak_points + range_offset_, azimuth,
+              time));
+          peak_points = 0;
+          num_peak_points = 0;
+        }
       }
     }
-    // #pragma omp critical
-    {
-      pointcloud.insert(pointcloud.end(), polar_time.begin(), polar_time.end());
-    }
   }
+  concatenateAzimuths(polar_time, pointcloud);
 }
 
 template <class PointT>
@@ -357,48 +359,46 @@ void ModifiedCACFAR<PointT>::run(const cv::Mat &raw_scan, const float &res,
   auto maxcol = maxr_ / res - w2 - guard_;
   if (maxcol > cols || maxcol < 0) maxcol = cols;
   const int N = maxcol - mincol;
+  const ColumnRange range(mincol, maxcol, cols);
 
-  for (int i = 0; i < rows; ++i) {
-    const double azimuth = azimuth_angles[i];
-    const int64_t time = azimuth_times[i];
-    pcl::PointCloud<PointT> polar_time;
-    double mean = 0;
-    for (int j = mincol; j < maxcol; ++j) {
-      mean += raw_scan.at<float>(i, j);
-    }
-    mean /= N;
+  std::vector<pcl::PointCloud<PointT>> polar_time(rows);
+#pragma omp parallel num_threads(num_threads_)
+  {
+    RowPrefixSum prefix;
+#pragma omp for schedule(dynamic, 10)
+    for (int i = 0; i < rows; ++i) {
+      const float *row = raw_scan.ptr<float>(i);
+      const double azimuth = azimuth_angles[i];
+      const int64_t time = azimuth_times[i];
+      prefix.compute(row, cols);
+      const double mean = prefix.sum(range.first, range.last) / N;
 
-    float peak_points = 0;
-    int num_peak_points = 0;
+      float peak_points = 0;
+      int num_peak_points = 0;
 
-    for (int j = mincol; j < maxcol; ++j) {
-      double left = 0;
-      double right = 0;
-      for (int k = -w2 - guard_; k < -guard_; ++k)
-        left += raw_scan.at<float>(i, j + k);
-      for (int k = guard_ + 1; k <= w2 + guard_; ++k)
-        right += raw_scan.at<float>(i, j + k);
-      // (statistic) estimate of clutter power
-      // const double stat = (left + right) / (2 * w2);
-      const double stat = std::max(left, right) / w2;  // GO-CFAR
-      const float thres = threshold_ * stat + threshold2_ * mean + threshold3_;
-      if (raw_scan.at<float>(i, j) > thres) {
-        peak_points += j;
-        num_peak_points += 1;
-      } else if (num_peak_points > 0) {
-        PointT p;
-        p.rho = res * peak_points / num_peak_points + range_offset_;
-        p.phi = azimuth;
-        p.theta = 0;
-        p.timestamp = time;
-        polar_time.push_back(p);
-        peak_points = 0;
-        num_peak_points = 0;
+      for (int j = range.first; j < range.last; ++j) {
+        const double left = prefix.sum(j - w2 - guard_, j - guard_);
+        const double right = prefix.sum(j + guard_ + 1, j + w2 + guard_ + 1);
+        // (statistic) estimate of clutter power
+        // const double stat = (left + right) / (2 * w2);
+        const double stat = std::max(left, right) / w2;  // GO-CFAR
+        const float thres =
+            threshold_ * stat + threshold2_ * mean + threshold3_;
+        if (row[j] > thres) {
+          peak_points += j;
+          num_peak_points += 1;
+        } else if (num_peak_points > 0) {
+          polar_time[i].push_back(makePolarPoint<PointT>(
+              res * peak_points / num_peak_points + range_offset_, azimuth,
+              time));
+          peak_points = 0;
+          num_peak_points = 0;
+        }
       }
     }
-    pointcloud.insert(pointcloud.end(), polar_time.begin(), polar_time.end());
   }
+  concatenateAzimuths(polar_time, pointcloud);
 }
 
 }  // namespace radar
-}  // namespace vtr
\ No newline at end of file
+}  // namespace vtr
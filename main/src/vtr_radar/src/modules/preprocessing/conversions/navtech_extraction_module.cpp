@@ -87,6 +87,7 @@ auto NavtechExtractionModule::Config::fromROS(
   // Doppler stuff
   config->beta = node->declare_parameter<double>(param_prefix + ".beta", config->beta);
   config->chirp_type = node->declare_parameter<std::string>(param_prefix + ".chirp_type", config->chirp_type);
+  config->num_threads = node->declare_parameter<int>(param_prefix + ".num_threads", config->num_threads);
 
   config->visualize = node->declare_parameter<bool>(param_prefix + ".visualize", config->visualize);
   // clang-format on
@@ -218,21 +219,21 @@ void NavtechExtractionModule::run_(QueryCache &qdata0, OutputCache &,
   if (config_->detector == "cen2018") {
     Cen2018 detector = Cen2018<PointWithInfo>(
         config_->cen2018.zq, config_->cen2018.sigma, config_->minr,
-        config_->maxr, config_->range_offset);
+        config_->maxr, config_->range_offset, config_->num_threads);
     detector.run(fft_scan, radar_resolution, azimuth_times, azimuth_angles,
                  raw_point_cloud);
   } else if (config_->detector == "kstrongest") {
     KStrongest detector = KStrongest<PointWithInfo>(
         config_->kstrong.kstrong, config_->kstrong.threshold2,
         config_->kstrong.threshold3, config_->minr, config_->maxr,
-        config_->range_offset);
+        config_->range_offset, config_->num_threads);
     detector.run(fft_scan, radar_resolution, azimuth_times, azimuth_angles,
                  raw_point_cloud);
   } else if (config_->detector == "cacfar") {
     CACFAR detector = CACFAR<PointWithInfo>(
         config_->cacfar.width, config_->cacfar.guard, config_->cacfar.threshold,
         config_->cacfar.threshold2, config_->cacfar.threshold3, config_->minr,
-        config_->maxr, config_->range_offset);
+        config_->maxr, config_->range_offset, config_->num_threads);
     detector.run(fft_scan, radar_resolution, azimuth_times, azimuth_angles,
                  raw_point_cloud);
   } else if (config_->detector == "oscfar") {
@@ -240,7 +241,7 @@ void NavtechExtractionModule::run_(QueryCache &qdata0, OutputCache &,
         config_->oscfar.width, config_->oscfar.guard, config_->oscfar.kstat,
         config_->oscfar.threshold, config_->oscfar.threshold2,
         config_->oscfar.threshold3, config_->minr, config_->maxr,
-        config_->range_offset);
+        config_->range_offset, config_->num_threads);
     detector.run(fft_scan, radar_resolution, azimuth_times, azimuth_angles,
                  raw_point_cloud);
   } else if (config_->detector == "modified_cacfar") {
@@ -248,7 +249,7 @@ void NavtechExtractionModule::run_(QueryCache &qdata0, OutputCache &,
         config_->modified_cacfar.width, config_->modified_cacfar.guard,
         config_->modified_cacfar.threshold, config_->modified_cacfar.threshold2,
         config_->modified_cacfar.threshold3, config_->minr, config_->maxr,
-        config_->range_offset);
+        config_->range_offset, config_->num_threads);
     detector.run(fft_scan, radar_resolution, azimuth_times, azimuth_angles,
                  raw_point_cloud);
   } else {
@@ -19,6 +19,8 @@
  */
 #include "vtr_radar/utils/utils.hpp"
 
+#include <mutex>
+
 namespace vtr {
 namespace radar {
 
@@ -84,69 +86,114 @@ double get_azimuth_index(const std::vector<double> &azimuths,
 }
 // clang-format on
 
-void radar_polar_to_cartesian(const cv::Mat &fft_data,
-                              const std::vector<double> &azimuths,
-                              cv::Mat &cartesian, const float radar_resolution,
-                              const float cart_resolution,
-                              const int cart_pixel_width,
-                              const bool interpolate_crossover,
-                              const int output_type) {
-  cv::Mat fft = fft_data.clone();
-  float cart_min_range = (cart_pixel_width / 2) * cart_resolution;
-  if (cart_pixel_width % 2 == 0)
-    cart_min_range = (cart_pixel_width / 2 - 0.5) * cart_resolution;
+namespace {
 
-  cv::Mat map_x = cv::Mat::zeros(cart_pixel_width, cart_pixel_width, CV_32F);
-  cv::Mat map_y = cv::Mat::zeros(cart_pixel_width, cart_pixel_width, CV_32F);
+/// remap tables from the cartesian image to the polar scan
+struct PolarToCartesianMap {
+  float radar_resolution;
+  float cart_resolution;
+  int cart_pixel_width;
+  bool interpolate_crossover;
+  std::vector<double> azimuths;
+  /// CV_32FC1 maps, kept in floating point to not change the interpolation
+  cv::Mat range;
+  cv::Mat angle;
 
-  // #pragma omp parallel for collapse(2)
-  for (int j = 0; j < map_y.cols; ++j) {
-    for (int i = 0; i < map_y.rows; ++i) {
-      map_y.at<float>(i, j) = -1 * cart_min_range + j * cart_resolution;
-    }
-  }
-  // #pragma omp parallel for collapse(2)
-  for (int i = 0; i < map_x.rows; ++i) {
-    for (int j = 0; j < map_x.cols; ++j) {
-      map_x.at<float>(i, j) = cart_min_range - i * cart_resolution;
-    }
+  bool matches(const std::vector<double> &azimuths_, const float radar_resolution_,
+               const float cart_resolution_, const int cart_pixel_width_,
+               const bool interpolate_crossover_) const {
+    return radar_resolution == radar_resolution_ &&
+           cart_resolution == cart_resolution_ &&
+           cart_pixel_width == cart_pixel_width_ &&
+           interpolate_crossover == interpolate_crossover_ &&
+           azimuths == azimuths_;
   }
+};
+
+std::shared_ptr<const PolarToCartesianMap> computePolarToCartesianMap(
+    const std::vector<double> &azimuths, const float radar_resolution,
+    const float cart_resolution, const int cart_pixel_width,
+    const bool interpolate_crossover) {
+  auto map = std::make_shared<PolarToCartesianMap>();
+  map->radar_resolution = radar_resolution;
+  map->cart_resolution = cart_resolution;
+  map->cart_pixel_width = cart_pixel_width;
+  map->interpolate_crossover = interpolate_crossover;
+  map->azimuths = azimuths;
+
+  float cart_min_range = (cart_pixel_width / 2) * cart_resolution;
+  if (cart_pixel_width % 2 == 0)
+    cart_min_range = (cart_pixel_width / 2 - 0.5) * cart_resolution;
 
-  cv::Mat range = cv::Mat::zeros(cart_pixel_width, cart_pixel_width, CV_32F);
-  cv::Mat angle = cv::Mat::zeros(cart_pixel_width, cart_pixel_width, CV_32F);
+  cv::Mat &range = map->range;
+  cv::Mat &angle = map->angle;
+  range = cv::Mat::zeros(cart_pixel_width, cart_pixel_width, CV_32F);
+  angle = cv::Mat::zeros(cart_pixel_width, cart_pixel_width, CV_32F);
   // double azimuth_step = azimuths[1] - azimuths[0];
-  // #pragma omp parallel for collapse(2)
+#pragma omp parallel for schedule(dynamic, 10)
   for (int i = 0; i < range.rows; ++i) {
+    float *range_row = range.ptr<float>(i);
+    float *angle_row = angle.ptr<float>(i);
+    const float x = cart_min_range - i * cart_resolution;
     for (int j = 0; j < range.cols; ++j) {
-      float x = map_x.at<float>(i, j);
-      float y = map_y.at<float>(i, j);
+      const float y = -1 * cart_min_range + j * cart_resolution;
       float r = (sqrt(pow(x, 2) + pow(y, 2)) - radar_resolution / 2) /
                 radar_resolution;
       if (r < 0) r = 0;
-      range.at<float>(i, j) = r;
+      range_row[j] = r;
       float theta = atan2f(y, x);
       if (theta < 0) theta += 2 * M_PI;
       // if (navtech_version == CIR204) {
-      angle.at<float>(i, j) = get_azimuth_index(azimuths, theta);
+      angle_row[j] = get_azimuth_index(azimuths, theta);
       // } else {
-      // angle.at<float>(i, j) = (theta - azimuths[0]) / azimuth_step;
+      // angle_row[j] = (theta - azimuths[0]) / azimuth_step;
       // }
+      // account for the wrapped row prepended to the scan
+      if (interpolate_crossover) angle_row[j] += 1;
     }
   }
-  if (interpolate_crossover) {
-    cv::Mat a0 = cv::Mat::zeros(1, fft.cols, CV_32F);
-    cv::Mat aN_1 = cv::Mat::zeros(1, fft.cols, CV_32F);
-    for (int j = 0; j < fft.cols; ++j) {
-      a0.at<float>(0, j) = fft.at<float>(0, j);
-      aN_1.at<float>(0, j) = fft.at<float>(fft.rows - 1, j);
-    }
-    cv::vconcat(aN_1, fft, fft);
-    cv::vconcat(fft, a0, fft);
-    angle = angle + 1;
+
+  return map;
+}
+
+}  // namespace
+
+void radar_polar_to_cartesian(const cv::Mat &fft_data,
+                              const std::vector<double> &azimuths,
+                              cv::Mat &cartesian, const float radar_resolution,
+                              const float cart_resolution,
+                              const int cart_pixel_width,
+                              const bool interpolate_crossover,
+                              const int output_type) {
+  // remap tables only depend on the scan layout, so they are computed once and
+  // reused as long as resolution, width and azimuths do not change
+  static std::mutex mutex;
+  static std::shared_ptr<const PolarToCartesianMap> cached_map;
+  std::shared_ptr<const PolarToCartesianMap> map;
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    map = cached_map;
+  }
+  if (map == nullptr ||
+      !map->matches(azimuths, radar_resolution, cart_resolution,
+                    cart_pixel_width, interpolate_crossover)) {
+    map = computePolarToCartesianMap(azimuths, radar_resolution,
+                                     cart_resolution, cart_pixel_width,
+                                     interpolate_crossover);
+    std::lock_guard<std::mutex> lock(mutex);
+    cached_map = map;
   }
 
-  cv::remap(fft, cartesian, range, angle, cv::INTER_LINEAR, cv::BORDER_CONSTANT,
-            cv::Scalar(0, 0, 0));
+  if (interpolate_crossover) {
+    // wrap the last azimuth before the first one and vice versa
+    cv::Mat fft;
+    cv::copyMakeBorder(fft_data, fft, 1, 1, 0, 0, cv::BORDER_WRAP);
+    cv::remap(fft, cartesian, map->range, map->angle, cv::INTER_LINEAR,
+              cv::BORDER_CONSTANT, cv::Scalar(0, 0, 0));
+  } else {
+    cv::remap(fft_data, cartesian, map->range, map->angle, cv::INTER_LINEAR,
+              cv::BORDER_CONSTANT, cv::Scalar(0, 0, 0));
+  }
   if (output_type != CV_32F) {
     cartesian.convertTo(cartesian, output_type, 255.0);
   }
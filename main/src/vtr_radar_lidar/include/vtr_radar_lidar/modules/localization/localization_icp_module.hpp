@@ -20,6 +20,7 @@
 
 #include "steam.hpp"
 
+#include "vtr_lidar/utils/nanoflann_utils.hpp"
 #include "vtr_radar_lidar/cache.hpp"
 #include "vtr_tactic/modules/base_module.hpp"
 #include "vtr_tactic/task_queue.hpp"
@@ -46,6 +47,10 @@ class LocalizationICPModule : public tactic::BaseModule {
     /// Point cloud map projection parameters
     float elevation_threshold = 0.05;
     float normal_threshold = 0.5;
+    // the filtered and projected map is reused until the sensor moves more
+    // than these thresholds w.r.t. the map (or the map changes)
+    double map_update_trans_thresh = 0.2;
+    double map_update_rot_thresh = 1.0 * M_PI / 180.0;
 
     /// ICP parameters
     // number of threads for nearest neighbor search
@@ -89,8 +94,23 @@ class LocalizationICPModule : public tactic::BaseModule {
             const tactic::Graph::Ptr &graph,
             const tactic::TaskExecutor::Ptr &executor) override;
 
+  using SubmapPtr = std::shared_ptr<const lidar::PointMap<lidar::PointWithInfo>>;
+  /** \brief whether the cached map has to be filtered and projected again */
+  bool needsMapUpdate(const SubmapPtr &submap,
+                      const Eigen::Matrix4d &T_s_m) const;
+  /** \brief filters and projects the submap to 2D and rebuilds the kd-tree */
+  void updateMap(const SubmapPtr &submap, const Eigen::Matrix4d &T_s_m);
+
   Config::ConstPtr config_;
 
+  /** \brief filtered and 2D-projected submap with its kd-tree */
+  SubmapPtr cached_submap_ = nullptr;
+  unsigned cached_version_ = 0;
+  Eigen::Matrix4d cached_T_s_m_ = Eigen::Matrix4d::Identity();
+  pcl::PointCloud<lidar::PointWithInfo> point_map_;
+  std::unique_ptr<lidar::NanoFLANNAdapter<lidar::PointWithInfo>> adapter_;
+  std::unique_ptr<lidar::KDTree<lidar::PointWithInfo>> kdtree_;
+
   /** \brief for visualization only */
   bool publisher_initialized_ = false;
   rclcpp::Publisher<PointCloudMsg>::SharedPtr tmp_scan_pub_;
@@ -45,6 +45,9 @@ class RadarLidarPipeline : public tactic::BasePipeline {
     // submap creation thresholds
     double submap_translation_threshold = 0.0;  // in meters
     double submap_rotation_threshold = 0.0;     // in degrees
+    // every n-th submap is stored in full, the ones in between as deltas of
+    // the previous submap (1 stores all of them in full)
+    int full_submap_interval = 10;
 
     bool save_raw_point_cloud = false;
 
@@ -103,6 +106,10 @@ class RadarLidarPipeline : public tactic::BasePipeline {
   tactic::VertexId submap_vid_odo_ = tactic::VertexId::Invalid();
   /** \brief transformation from latest submap vertex to robot */
   tactic::EdgeTransform T_sv_m_odo_ = tactic::EdgeTransform(true);
+  /** \brief latest submap, base of the next submap delta */
+  std::shared_ptr<const radar::PointMap<radar::PointWithInfo>> submap_odo_;
+  /** \brief number of submaps stored as deltas since the last full one */
+  int num_submap_deltas_odo_ = 0;
 
   /// localization cached data
   /** \brief Current submap for localization */
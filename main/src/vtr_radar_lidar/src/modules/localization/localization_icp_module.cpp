@@ -18,8 +18,6 @@
  */
 #include "vtr_radar_lidar/modules/localization/localization_icp_module.hpp"
 
-#include "vtr_lidar/utils/nanoflann_utils.hpp"
-
 namespace vtr {
 namespace radar_lidar {
 
@@ -36,6 +34,8 @@ auto LocalizationICPModule::Config::fromROS(const rclcpp::Node::SharedPtr &node,
 
   config->elevation_threshold = node->declare_parameter<float>(param_prefix + ".elevation_threshold", config->elevation_threshold);
   config->normal_threshold = node->declare_parameter<float>(param_prefix + ".normal_threshold", config->normal_threshold);
+  config->map_update_trans_thresh = node->declare_parameter<double>(param_prefix + ".map_update_trans_thresh", config->map_update_trans_thresh);
+  config->map_update_rot_thresh = node->declare_parameter<double>(param_prefix + ".map_update_rot_thresh", config->map_update_rot_thresh);
 
   // icp params
   config->num_threads = node->declare_parameter<int>(param_prefix + ".num_threads", config->num_threads);
@@ -83,7 +83,6 @@ void LocalizationICPModule::run_(QueryCache &qdata0, OutputCache &,
   auto T_r_v = *radar_qdata.T_r_v_loc;  // used as a prior (after projected)
   const auto &T_v_m = *lidar_qdata.T_v_m_loc;
   // const auto &map_version = lidar_qdata.submap_loc->version();
-  auto &lidar_point_map = lidar_qdata.submap_loc->point_cloud();
 
   // se3 projection
   {
@@ -106,73 +105,15 @@ void LocalizationICPModule::run_(QueryCache &qdata0, OutputCache &,
                                                 << T_v_r;
     T_r_v = T_v_r.inverse();
   }
-  // find points that are within the radar scan FOV
-  std::vector<int> indices;
-  {
-    const auto T_s_m = (T_s_r * T_r_v * T_v_m).matrix();
-    Eigen::Matrix3f C_s_m = (T_s_m.block<3, 3>(0, 0)).cast<float>();
-    Eigen::Vector3f r_m_s_in_s = (T_s_m.block<3, 1>(0, 3)).cast<float>();
-    for (int i = 0; i < (int)lidar_point_map.size(); ++i) {
-      const auto &point = lidar_point_map.at(i);
-      // point and normal in radar frame
-      Eigen::Vector3f p_in_s = C_s_m * point.getVector3fMap() + r_m_s_in_s;
-      Eigen::Vector3f n_in_s = C_s_m * point.getNormalVector3fMap();
-      // filter by elevation
-      // xy = np.sqrt(np.sum(xyz[:, :2] ** 2, axis=1))
-      // ele = np.arctan2(xyz[:, 2], xy)
-      // mask = np.abs(ele) < thres
-      const auto elev = std::atan2(
-          p_in_s(2), std::sqrt(p_in_s(0) * p_in_s(0) + p_in_s(1) * p_in_s(1)));
-      if (std::abs(elev) > config_->elevation_threshold) continue;
-
-      // filter by normal vector
-      if (std::abs(n_in_s(2)) > config_->normal_threshold) continue;
-
-      // // filter by z value
-      // if (p_in_s(2) < -0.5 || p_in_s(2) > 0.5) continue;
-
-      indices.emplace_back(i);
-    }
-  }
-  pcl::PointCloud<lidar::PointWithInfo> point_map(lidar_point_map, indices);
-
-  // project points to 2D
-  {
-    auto aligned_point_map = point_map;
-    // clang-format off
-    auto map_mat = point_map.getMatrixXfMap(4, lidar::PointWithInfo::size(), lidar::PointWithInfo::cartesian_offset());
-    auto map_normals_mat = point_map.getMatrixXfMap(4, lidar::PointWithInfo::size(), lidar::PointWithInfo::normal_offset());
-    auto aligned_map_mat = aligned_point_map.getMatrixXfMap(4, lidar::PointWithInfo::size(), lidar::PointWithInfo::cartesian_offset());
-    auto aligned_map_normals_mat = aligned_point_map.getMatrixXfMap(4, lidar::PointWithInfo::size(), lidar::PointWithInfo::normal_offset());
-
-    // convert to sensor frame
-    const auto T_s_m = (T_s_r * T_r_v * T_v_m).matrix().cast<float>();
-    aligned_map_mat = T_s_m * map_mat;
-    aligned_map_normals_mat = T_s_m * map_normals_mat;
-
-    // project to 2D
-    for (uint j = 0; j < aligned_map_mat.cols(); ++j) {
-        const double px = aligned_map_mat(0, j);
-        const double py = aligned_map_mat(1, j);
-        const double pz = aligned_map_mat(2, j);
-        const double rho = std::sqrt(px * px + py * py + pz * pz);
-        const double phi = std::atan2(py, px);
-        aligned_map_mat(0, j) = rho * std::cos(phi);
-        aligned_map_mat(1, j) = rho * std::sin(phi);
-        aligned_map_mat(2, j) = 0.0;
-    }
-    aligned_map_normals_mat.row(2).setZero();
-    // \todo double check correctness of this normal projection
-    Eigen::MatrixXf aligned_map_norms_mat = aligned_map_normals_mat.colwise().norm();
-    aligned_map_normals_mat.row(0).array() /= aligned_map_norms_mat.array();
-    aligned_map_normals_mat.row(1).array() /= aligned_map_norms_mat.array();
-
-    // convert back to point map frame
-    const auto T_m_s = T_s_m.inverse();
-    map_mat = T_m_s * aligned_map_mat;
-    map_normals_mat = T_m_s * aligned_map_normals_mat;
-    // clang-format on
+  // filter and project the submap, reusing the previous result if neither
+  // the submap nor the sensor-map transform changed much
+  const auto T_s_m = (T_s_r * T_r_v * T_v_m).matrix();
+  if (needsMapUpdate(lidar_qdata.submap_loc.ptr(), T_s_m)) {
+    CLOG(DEBUG, "radar_lidar.localization_icp")
+        << "Filtering and projecting the lidar submap.";
+    updateMap(lidar_qdata.submap_loc.ptr(), T_s_m);
   }
+  const auto &point_map = point_map_;
 
   if (config_->visualize) {
     // clang-format off
@@ -229,12 +170,8 @@ void LocalizationICPModule::run_(QueryCache &qdata0, OutputCache &,
   auto aligned_mat = aligned_points.getMatrixXfMap(4, radar::PointWithInfo::size(), radar::PointWithInfo::cartesian_offset());
   auto aligned_norms_mat = aligned_points.getMatrixXfMap(4, radar::PointWithInfo::size(), radar::PointWithInfo::normal_offset());
 
-  /// create kd-tree of the map
-  CLOG(DEBUG, "radar_lidar.localization_icp") << "Start building a kd-tree of the map.";
-  lidar::NanoFLANNAdapter<lidar::PointWithInfo> adapter(point_map);
-  lidar::KDTreeParams tree_params(/* max leaf */ 10);
-  auto kdtree = std::make_unique<lidar::KDTree<lidar::PointWithInfo>>(3, adapter, tree_params);
-  kdtree->buildIndex();
+  /// kd-tree of the map, rebuilt together with the projected map
+  const auto &kdtree = kdtree_;
 
   /// perform initial alignment
   {
@@ -474,5 +411,91 @@ void LocalizationICPModule::run_(QueryCache &qdata0, OutputCache &,
   // clang-format on
 }
 
+bool LocalizationICPModule::needsMapUpdate(const SubmapPtr &submap,
+                                           const Eigen::Matrix4d &T_s_m) const {
+  if (kdtree_ == nullptr) return true;
+  if (submap != cached_submap_ || submap->version() != cached_version_)
+    return true;
+  // the filter and projection depend on the sensor pose w.r.t. the map
+  const Eigen::Matrix<double, 6, 1> dT_vec =
+      lgmath::se3::tran2vec(T_s_m * cached_T_s_m_.inverse());
+  return dT_vec.head<3>().norm() > config_->map_update_trans_thresh ||
+         dT_vec.tail<3>().norm() > config_->map_update_rot_thresh;
+}
+
+void LocalizationICPModule::updateMap(const SubmapPtr &submap,
+                                      const Eigen::Matrix4d &T_s_m_d) {
+  const auto &lidar_point_map = submap->point_cloud();
+  const Eigen::Matrix4f T_s_m = T_s_m_d.cast<float>();
+
+  // find points that are within the radar scan FOV
+  std::vector<int> indices;
+  indices.reserve(lidar_point_map.size());
+  {
+    const Eigen::Matrix3f C_s_m = T_s_m.block<3, 3>(0, 0);
+    const Eigen::Vector3f r_m_s_in_s = T_s_m.block<3, 1>(0, 3);
+    // |atan2(z, xy)| > thres  <=>  |z| > tan(thres) * xy, for thres < pi / 2
+    const float tan_elev = std::tan(config_->elevation_threshold);
+    for (int i = 0; i < (int)lidar_point_map.size(); ++i) {
+      const auto &point = lidar_point_map[i];
+      // point and normal in radar frame
+      const Eigen::Vector3f p_in_s = C_s_m * point.getVector3fMap() + r_m_s_in_s;
+      const float n_in_s_z = C_s_m.row(2).dot(point.getNormalVector3fMap());
+      // filter by elevation
+      const float xy2 = p_in_s(0) * p_in_s(0) + p_in_s(1) * p_in_s(1);
+      const float z = std::abs(p_in_s(2));
+      if (z * z > tan_elev * tan_elev * xy2) continue;
+      // filter by normal vector
+      if (std::abs(n_in_s_z) > config_->normal_threshold) continue;
+      indices.emplace_back(i);
+    }
+  }
+  point_map_ = pcl::PointCloud<lidar::PointWithInfo>(lidar_point_map, indices);
+
+  // project points to 2D in the sensor frame, then convert back to map frame
+  {
+    // clang-format off
+    auto map_mat = point_map_.getMatrixXfMap(4, lidar::PointWithInfo::size(), lidar::PointWithInfo::cartesian_offset());
+    auto map_normals_mat = point_map_.getMatrixXfMap(4, lidar::PointWithInfo::size(), lidar::PointWithInfo::normal_offset());
+
+    Eigen::Matrix4Xf aligned_map_mat = T_s_m * map_mat;
+    Eigen::Matrix4Xf aligned_map_normals_mat = T_s_m * map_normals_mat;
+
+    // (x, y, z) -> rho / rho_xy * (x, y, 0), which keeps the range and the
+    // azimuth, same as rho * (cos(phi), sin(phi), 0) with phi = atan2(y, x)
+    using RowArrayXf = Eigen::Array<float, 1, Eigen::Dynamic>;
+    const RowArrayXf x = aligned_map_mat.row(0).array();
+    const RowArrayXf y = aligned_map_mat.row(1).array();
+    const RowArrayXf rho2_xy = x.square() + y.square();
+    const RowArrayXf rho = (rho2_xy + aligned_map_mat.row(2).array().square()).sqrt();
+    const RowArrayXf scale = rho / rho2_xy.sqrt();
+    aligned_map_mat.row(0).array() = (rho2_xy > 0.0f).select(x * scale, rho);
+    aligned_map_mat.row(1).array() = (rho2_xy > 0.0f).select(y * scale, 0.0f);
+    aligned_map_mat.row(2).setZero();
+
+    aligned_map_normals_mat.row(2).setZero();
+    // \todo double check correctness of this normal projection
+    const RowArrayXf aligned_map_norms = aligned_map_normals_mat.colwise().norm().array();
+    aligned_map_normals_mat.row(0).array() /= aligned_map_norms;
+    aligned_map_normals_mat.row(1).array() /= aligned_map_norms;
+
+    // convert back to point map frame
+    const Eigen::Matrix4f T_m_s = T_s_m.inverse();
+    map_mat = T_m_s * aligned_map_mat;
+    map_normals_mat = T_m_s * aligned_map_normals_mat;
+    // clang-format on
+  }
+
+  // rebuild the kd-tree of the map
+  adapter_ = std::make_unique<lidar::NanoFLANNAdapter<lidar::PointWithInfo>>(point_map_);
+  lidar::KDTreeParams tree_params(/* max leaf */ 10);
+  kdtree_ = std::make_unique<lidar::KDTree<lidar::PointWithInfo>>(3, *adapter_, tree_params);
+  kdtree_->buildIndex();
+
+  cached_submap_ = submap;
+  cached_version_ = submap->version();
+  cached_T_s_m_ = T_s_m_d;
+}
+
 }  // namespace radar_lidar
 }  // namespace vtr
\ No newline at end of file
@@ -18,6 +18,9 @@
  */
 #include "vtr_radar_lidar/pipeline.hpp"
 
+#include <algorithm>
+
+#include "vtr_radar/data_types/pointmap_delta.hpp"
 #include "vtr_radar/data_types/pointmap_pointer.hpp"
 #include "vtr_tactic/modules/factory.hpp"
 
@@ -38,6 +41,7 @@ auto RadarLidarPipeline::Config::fromROS(const rclcpp::Node::SharedPtr &node,
   // submap creation thresholds
   config->submap_translation_threshold = node->declare_parameter<double>(param_prefix + ".submap_translation_threshold", config->submap_translation_threshold);
   config->submap_rotation_threshold = node->declare_parameter<double>(param_prefix + ".submap_rotation_threshold", config->submap_rotation_threshold);
+  config->full_submap_interval = node->declare_parameter<int>(param_prefix + ".full_submap_interval", config->full_submap_interval);
   
   config->save_raw_point_cloud = node->declare_parameter<bool>(param_prefix + ".save_raw_point_cloud", config->save_raw_point_cloud);
   // clang-format on
@@ -76,6 +80,8 @@ void RadarLidarPipeline::reset() {
   w_m_r_in_r_odo_ = nullptr;
   submap_vid_odo_ = tactic::VertexId::Invalid();
   T_sv_m_odo_ = tactic::EdgeTransform(true);
+  submap_odo_ = nullptr;
+  num_submap_deltas_odo_ = 0;
   // localization cached data
   submap_loc_ = nullptr;
 }
@@ -197,17 +203,57 @@ void RadarLidarPipeline::onVertexCreation_(const QueryCache::Ptr &qdata0,
     // copy the current sliding map
     auto submap_odo = std::make_shared<radar::PointMap<radar::PointWithInfo>>(
         *sliding_map_odo_);
-    // save the submap
-    using PointMapLM =
-        storage::LockableMessage<radar::PointMap<radar::PointWithInfo>>;
-    auto submap_msg = std::make_shared<PointMapLM>(submap_odo, *qdata->stamp);
-    vertex->insert<radar::PointMap<radar::PointWithInfo>>(
-        "radar_pointmap", "vtr_radar_msgs/msg/PointMap", submap_msg);
-    // save a copy
-    auto submap2_msg = std::make_shared<PointMapLM>(submap_odo, *qdata->stamp);
-    vertex->insert<radar::PointMap<radar::PointWithInfo>>(
-        "radar_pointmap_v" + std::to_string(submap_odo->version()),
-        "vtr_radar_msgs/msg/PointMap", submap2_msg);
+    // store it as a delta of the previous submap if that is smaller, the
+    // complete submap is reconstructed when loaded (see
+    // vtr_radar/data_types/pointmap_versions.hpp)
+    using PointMapDelta = radar::PointMapDelta<radar::PointWithInfo>;
+    const auto submap_delta = [&]() -> PointMapDelta::Ptr {
+      if (submap_odo_ == nullptr || submap_odo_->dl() != submap_odo->dl() ||
+          num_submap_deltas_odo_ + 1 >= config_->full_submap_interval)
+        return nullptr;
+      // life time only matters to the sliding map, not to the stored submap
+      const auto equal_cb = [](const radar::PointWithInfo &base_pt,
+                               const radar::PointWithInfo &curr_pt) {
+        return std::equal(base_pt.data, base_pt.data + 4, curr_pt.data) &&
+               std::equal(base_pt.data_n, base_pt.data_n + 4, curr_pt.data_n) &&
+               base_pt.dynamic_obs == curr_pt.dynamic_obs &&
+               base_pt.total_obs == curr_pt.total_obs &&
+               base_pt.static_score == curr_pt.static_score &&
+               base_pt.raw_flex2 == curr_pt.raw_flex2;
+      };
+      auto delta = PointMapDelta::fromMaps(
+          *submap_odo_, submap_vid_odo_, *submap_odo, equal_cb);
+      if (delta->size() + delta->removed_voxels().size() >= submap_odo->size())
+        return nullptr;
+      return delta;
+    }();
+    if (submap_delta != nullptr) {
+      CLOG(DEBUG, "radar.pipeline")
+          << "Saving submap as a delta of vertex " << submap_vid_odo_ << ": "
+          << submap_delta->size() << " of " << submap_odo->size()
+          << " voxels changed, " << submap_delta->removed_voxels().size()
+          << " removed";
+      using PointMapDeltaLM = storage::LockableMessage<PointMapDelta>;
+      auto submap_msg =
+          std::make_shared<PointMapDeltaLM>(submap_delta, *qdata->stamp);
+      vertex->insert<PointMapDelta>("radar_pointmap_delta",
+                                    "vtr_radar_msgs/msg/PointMapDelta",
+                                    submap_msg);
+      ++num_submap_deltas_odo_;
+      submap_odo_ = submap_odo;
+    } else {
+      // save the submap, "radar_pointmap_v0" is only stored once this version
+      // gets replaced (see vtr_radar/data_types/pointmap_versions.hpp)
+      using PointMapLM =
+          storage::LockableMessage<radar::PointMap<radar::PointWithInfo>>;
+      auto submap_msg = std::make_shared<PointMapLM>(submap_odo, *qdata->stamp);
+      vertex->insert<radar::PointMap<radar::PointWithInfo>>(
+          "radar_pointmap", "vtr_radar_msgs/msg/PointMap", submap_msg);
+      num_submap_deltas_odo_ = 0;
+      // newer versions replace the stored submap in place, so keep a copy
+      submap_odo_ = std::make_shared<radar::PointMap<radar::PointWithInfo>>(
+          *submap_odo);
+    }
 
     // save the submap vertex id and transform
     submap_vid_odo_ = *qdata->vid_odo;
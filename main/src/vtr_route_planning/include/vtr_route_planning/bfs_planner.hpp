@@ -18,18 +18,36 @@
  */
 #pragma once
 
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
 #include "vtr_route_planning/route_planner_interface.hpp"
 
 namespace vtr {
 namespace route_planning {
 
-class BFSPlanner : public RoutePlannerInterface {
+/**
+ * \brief Route planner on the privileged (teach) graph.
+ * \details Keeps a compact adjacency of the pose graph that is updated
+ * incrementally through the graph callbacks, so that a route query does not
+ * need to extract the privileged subgraph. Routes minimize the driven distance
+ * and are found with A* using the straight-line distance between vertex
+ * positions (obtained by composing edge transforms) as heuristic.
+ * \note Register the planner to the graph through a GraphCallbackGroup to keep
+ * the index in sync. Otherwise it is rebuilt whenever the number of edges in
+ * the graph has changed since the last query.
+ */
+class BFSPlanner : public RoutePlannerInterface,
+                   public tactic::Graph::Callback {
  public:
   PTR_TYPEDEFS(BFSPlanner);
 
   using GraphPtr = tactic::Graph::Ptr;
   using GraphWeakPtr = tactic::Graph::WeakPtr;
   using GraphBasePtr = tactic::GraphBase::Ptr;
+  using VertexPtr = tactic::Graph::VertexPtr;
+  using EdgePtr = tactic::Graph::EdgePtr;
 
   BFSPlanner(const GraphPtr &graph) : graph_(graph) {}
 
@@ -37,16 +55,65 @@ class BFSPlanner : public RoutePlannerInterface {
   PathType path(const VertexId &from, const VertexId::List &to,
                 std::list<uint64_t> &idx) override;
 
+  /// graph callbacks, called with graph change mutex locked
+  void vertexAdded(const VertexPtr &v) override;
+  void edgeAdded(const EdgePtr &e) override;
+
  private:
+  struct Adjacent {
+    size_t idx;
+    double length;
+    /** \brief transform from the adjacent vertex to this vertex */
+    Eigen::Matrix4d T_this_adj;
+  };
+
+  struct Node {
+    VertexId id;
+    /** \brief has at least one manual edge, i.e. belongs to a teach route */
+    bool privileged = false;
+    /** \brief position in the frame of the first vertex of its component */
+    bool has_pose = false;
+    Eigen::Matrix4d T_ref_this = Eigen::Matrix4d::Identity();
+    std::vector<Adjacent> adjacent;
+    /// search scratch, valid only if stamp equals the current search stamp
+    size_t stamp = 0;
+    bool closed = false;
+    double cost = 0.0;
+    size_t parent = 0;
+  };
+
   /** \brief Helper to get a shared pointer to the graph */
   GraphPtr getGraph() const;
-  /** \brief Returns a privileged graph (only contains teach routes) */
-  GraphBasePtr getPrivilegedGraph() const;
-  /** \brief Computes path from -> to given the privileged graph */
-  PathType path(const GraphBasePtr &priv_graph, const VertexId &from,
-                const VertexId &to);
+  /** \brief Rebuilds the routing index from the graph if it is out of sync */
+  void syncIndex(const GraphPtr &graph);
+  /** \brief Returns the index of a vertex, adding it if necessary */
+  size_t addNode(const VertexId &vid);
+  void addEdge(const VertexId &from, const VertexId &to, const bool manual,
+               const tactic::EdgeTransform &T_to_from);
+  /** \brief Assigns poses to all vertices connected to the given vertex */
+  void propagatePoses(const size_t &root);
+  /** \brief Makes the heuristic consistent w.r.t. the edge between a and b */
+  void updateHeuristicScale(const size_t &a, const size_t &b,
+                            const double &length);
+  /** \brief Computes path from -> to on the privileged part of the index */
+  PathType path(const size_t &from, const size_t &to);
 
   GraphWeakPtr graph_;
+
+  /** \brief protects all members below */
+  std::mutex mutex_;
+  std::unordered_map<VertexId, size_t> vid2idx_;
+  std::vector<Node> nodes_;
+  size_t num_edges_ = 0;
+  /** \brief whether the index has been built from the graph */
+  bool initialized_ = false;
+  /**
+   * \brief Straight-line distances are divided by this scale so that the
+   * heuristic never overestimates the remaining distance, even if poses of a
+   * loop are inconsistent due to odometry drift.
+   */
+  double heuristic_scale_ = 1.0;
+  size_t search_stamp_ = 0;
 };
 
 }  // namespace route_planning
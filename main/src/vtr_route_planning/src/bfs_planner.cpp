@@ -18,6 +18,10 @@
  */
 #include "vtr_route_planning/bfs_planner.hpp"
 
+#include <algorithm>
+#include <limits>
+#include <queue>
+
 namespace vtr {
 namespace route_planning {
 
@@ -30,15 +34,23 @@ auto BFSPlanner::path(const VertexId &from, const VertexId::List &to,
   }
   idx.clear();
 
-  const auto priv_graph = getPrivilegedGraph();
+  const auto graph = getGraph();
+  auto graph_lock = graph->guard();  // lock graph then internal lock
+  std::lock_guard<std::mutex> lock(mutex_);
+  syncIndex(graph);
+
+  const auto get_idx = [this](const VertexId &vid) {
+    const auto it = vid2idx_.find(vid);
+    return it == vid2idx_.end() ? nodes_.size() : it->second;
+  };
 
-  auto rval = path(priv_graph, from, to.front());
+  auto rval = path(get_idx(from), get_idx(to.front()));
   idx.push_back(rval.empty() ? 0 : (rval.size() - 1));
 
   auto from_iter = to.begin();
   auto to_iter = std::next(from_iter);
   for (; to_iter != to.end(); ++from_iter, ++to_iter) {
-    const auto segment = path(priv_graph, *from_iter, *to_iter);
+    const auto segment = path(get_idx(*from_iter), get_idx(*to_iter));
     if (segment.size() > 0){
       rval.insert(rval.end(), std::next(segment.begin()), segment.end());
       idx.push_back(rval.empty() ? 0 : (rval.size() - 1));
@@ -49,7 +61,42 @@ auto BFSPlanner::path(const VertexId &from, const VertexId::List &to,
 }
 
 auto BFSPlanner::path(const VertexId &from, const VertexId &to) -> PathType {
-  return path(getPrivilegedGraph(), from, to);
+  const auto graph = getGraph();
+  auto graph_lock = graph->guard();  // lock graph then internal lock
+  std::lock_guard<std::mutex> lock(mutex_);
+  syncIndex(graph);
+
+  const auto from_it = vid2idx_.find(from);
+  const auto to_it = vid2idx_.find(to);
+  return path(from_it == vid2idx_.end() ? nodes_.size() : from_it->second,
+              to_it == vid2idx_.end() ? nodes_.size() : to_it->second);
+}
+
+void BFSPlanner::vertexAdded(const VertexPtr &v) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (!initialized_) return;  // will be added when the index is built
+  addNode(v->id());
+}
+
+void BFSPlanner::edgeAdded(const EdgePtr &e) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (!initialized_) return;  // will be added when the index is built
+  addEdge(e->from(), e->to(), e->isManual(), e->T());
+
+  const auto from = vid2idx_.at(e->from());
+  const auto to = vid2idx_.at(e->to());
+  if (!nodes_[from].has_pose && !nodes_[to].has_pose) {
+    // first edge of a new component, which defines its reference frame
+    nodes_[from].has_pose = true;
+    nodes_[from].T_ref_this = Eigen::Matrix4d::Identity();
+    propagatePoses(from);
+  } else if (!nodes_[to].has_pose) {
+    propagatePoses(from);
+  } else if (!nodes_[from].has_pose) {
+    propagatePoses(to);
+  } else {
+    updateHeuristicScale(from, to, e->T().r_ab_inb().norm());
+  }
 }
 
 auto BFSPlanner::getGraph() const -> GraphPtr {
@@ -63,25 +110,153 @@ auto BFSPlanner::getGraph() const -> GraphPtr {
   return nullptr;
 }
 
-auto BFSPlanner::getPrivilegedGraph() const -> GraphBasePtr {
-  // get the current privileged graph
-  const auto graph = getGraph();
-  using PrivEval = tactic::PrivilegedEvaluator<tactic::GraphBase>;
-  auto priv_eval = std::make_shared<PrivEval>(*graph);
-  return graph->getSubgraph(priv_eval);
+void BFSPlanner::syncIndex(const GraphPtr &graph) {
+  if (initialized_ && num_edges_ == graph->numberOfEdges()) return;
+
+  vid2idx_.clear();
+  nodes_.clear();
+  num_edges_ = 0;
+  heuristic_scale_ = 1.0;
+
+  nodes_.reserve(graph->numberOfVertices());
+  for (auto it = graph->beginVertex(); it != graph->endVertex(); ++it)
+    addNode(it->id());
+  for (auto it = graph->beginEdge(); it != graph->endEdge(); ++it)
+    addEdge(it->from(), it->to(), it->isManual(), it->T());
+
+  for (size_t i = 0; i < nodes_.size(); ++i) {
+    if (nodes_[i].has_pose || nodes_[i].adjacent.empty()) continue;
+    nodes_[i].has_pose = true;
+    nodes_[i].T_ref_this = Eigen::Matrix4d::Identity();
+    propagatePoses(i);
+  }
+
+  initialized_ = true;
+  CLOG(DEBUG, "route_planning.bfs")
+      << "Built routing index with " << nodes_.size() << " vertices and "
+      << num_edges_ << " edges, heuristic scale " << heuristic_scale_;
 }
 
-auto BFSPlanner::path(const GraphBasePtr &priv_graph, const VertexId &from,
-                      const VertexId &to) -> PathType {
-  const auto computed_path = priv_graph->dijkstraSearch(from, to);
-  //
+size_t BFSPlanner::addNode(const VertexId &vid) {
+  const auto res = vid2idx_.try_emplace(vid, nodes_.size());
+  if (res.second) nodes_.emplace_back().id = vid;
+  return res.first->second;
+}
+
+void BFSPlanner::addEdge(const VertexId &from, const VertexId &to,
+                         const bool manual,
+                         const tactic::EdgeTransform &T_to_from) {
+  const auto from_idx = addNode(from);
+  const auto to_idx = addNode(to);
+  const double length = T_to_from.r_ab_inb().norm();
+  const Eigen::Matrix4d T_to_from_mat = T_to_from.matrix();
+  nodes_[from_idx].adjacent.push_back(
+      Adjacent{to_idx, length, T_to_from.inverse().matrix()});
+  nodes_[to_idx].adjacent.push_back(
+      Adjacent{from_idx, length, T_to_from_mat});
+  // privileged graph: vertices with a manual edge and edges between them
+  if (manual) nodes_[from_idx].privileged = nodes_[to_idx].privileged = true;
+  ++num_edges_;
+}
+
+void BFSPlanner::propagatePoses(const size_t &root) {
+  std::vector<size_t> stack{root};
+  while (!stack.empty()) {
+    const auto curr = stack.back();
+    stack.pop_back();
+    for (const auto &adj : nodes_[curr].adjacent) {
+      auto &node = nodes_[adj.idx];
+      if (node.has_pose) {
+        updateHeuristicScale(curr, adj.idx, adj.length);
+        continue;
+      }
+      node.has_pose = true;
+      node.T_ref_this = nodes_[curr].T_ref_this * adj.T_this_adj;
+      stack.push_back(adj.idx);
+    }
+  }
+}
+
+void BFSPlanner::updateHeuristicScale(const size_t &a, const size_t &b,
+                                      const double &length) {
+  const double dist = (nodes_[a].T_ref_this.block<3, 1>(0, 3) -
+                       nodes_[b].T_ref_this.block<3, 1>(0, 3))
+                          .norm();
+  if (dist <= length * heuristic_scale_) return;
+  heuristic_scale_ = dist / std::max(length, 1e-6);
+}
+
+auto BFSPlanner::path(const size_t &from, const size_t &to) -> PathType {
+  if (from >= nodes_.size() || !nodes_[from].privileged) {
+    std::string err{"Root node did not exist in the privileged graph."};
+    CLOG(ERROR, "route_planning.bfs") << err;
+    throw std::invalid_argument(err);
+  }
+  if (from == to) return PathType{nodes_[from].id};
+  if (to >= nodes_.size() || !nodes_[to].privileged) {
+    std::string err{"Did not find all nodes."};
+    CLOG(ERROR, "route_planning.bfs") << err;
+    throw std::runtime_error(err);
+  }
+
+  // A* with the (scaled) straight-line distance to the goal as a consistent
+  // heuristic, so that every vertex is expanded at most once
+  const Eigen::Vector3d goal = nodes_[to].T_ref_this.block<3, 1>(0, 3);
+  const auto heuristic = [&](const Node &node) {
+    if (!node.has_pose) return 0.0;
+    return (node.T_ref_this.block<3, 1>(0, 3) - goal).norm() /
+           heuristic_scale_;
+  };
+
+  const auto stamp = ++search_stamp_;
+  const auto visit = [&](Node &node) {
+    if (node.stamp == stamp) return;
+    node.stamp = stamp;
+    node.closed = false;
+    node.cost = std::numeric_limits<double>::infinity();
+  };
+
+  using CostIdx = std::pair<double, size_t>;
+  std::priority_queue<CostIdx, std::vector<CostIdx>, std::greater<CostIdx>>
+      queue;
+  visit(nodes_[from]);
+  nodes_[from].cost = 0.0;
+  queue.emplace(heuristic(nodes_[from]), from);
+
+  while (!queue.empty()) {
+    const auto curr = queue.top().second;
+    queue.pop();
+    auto &curr_node = nodes_[curr];
+    if (curr_node.closed) continue;
+    curr_node.closed = true;
+    if (curr == to) break;
+
+    for (const auto &adj : curr_node.adjacent) {
+      auto &node = nodes_[adj.idx];
+      if (!node.privileged) continue;
+      visit(node);
+      if (node.closed) continue;
+      const double cost = curr_node.cost + adj.length;
+      if (cost >= node.cost) continue;
+      node.cost = cost;
+      node.parent = curr;
+      queue.emplace(cost + heuristic(node), adj.idx);
+    }
+  }
+
+  if (nodes_[to].stamp != stamp || !nodes_[to].closed) {
+    std::string err{"Did not find all nodes."};
+    CLOG(ERROR, "route_planning.bfs") << err;
+    throw std::runtime_error(err);
+  }
+
   PathType rval;
-  rval.reserve(computed_path->numberOfVertices());
-  for (auto it = computed_path->begin(from), ite = computed_path->end();
-       it != ite; ++it)
-    rval.push_back(*it);
+  for (auto curr = to; curr != from; curr = nodes_[curr].parent)
+    rval.push_back(nodes_[curr].id);
+  rval.push_back(nodes_[from].id);
+  std::reverse(rval.begin(), rval.end());
   return rval;
 }
 
 }  // namespace route_planning
-}  // namespace vtr
\ No newline at end of file
+}  // namespace vtr
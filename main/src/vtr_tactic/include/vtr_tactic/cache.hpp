@@ -18,6 +18,9 @@
  */
 #pragma once
 
+#include <memory>
+#include <mutex>
+
 #include "rclcpp/rclcpp.hpp"
 
 #include "steam.hpp"
@@ -106,6 +109,29 @@ class Cache {
 template <class DataType>
 using LockableCache = common::SharedLockable<Cache<DataType>>;
 
+/**
+ * \brief Shared pointer to data produced by one module and read
+ * asynchronously by others (e.g. costmaps), loaded and stored atomically.
+ * Readers keep the datum they got alive while a newer one is published.
+ */
+template <class DataType>
+class AtomicCache {
+ public:
+  using DataPtr = std::shared_ptr<const DataType>;
+
+  bool valid() const { return read() != nullptr; }
+  explicit operator bool() const { return valid(); }
+
+  /** \brief Makes datum visible to subsequent reads. */
+  void publish(const DataPtr& datum) { std::atomic_store(&datum_, datum); }
+
+  /** \brief Returns the latest published datum, nullptr if none. */
+  DataPtr read() const { return std::atomic_load(&datum_); }
+
+ private:
+  DataPtr datum_ = nullptr;
+};
+
 struct QueryCache : std::enable_shared_from_this<QueryCache> {
   using Ptr = std::shared_ptr<QueryCache>;
 
@@ -115,6 +141,8 @@ struct QueryCache : std::enable_shared_from_this<QueryCache> {
   Cache<rclcpp::Node> node;
   Cache<Timestamp> stamp;
   Cache<EnvInfo> env_info;
+  /// compute budget of this frame, 0 is full quality, see QualityController
+  Cache<const unsigned> quality_level;
 
   // preprocessing
   Cache<const PipelineMode> pipeline_mode;
@@ -0,0 +1,59 @@
+// Copyright 2021, Autonomous Space Robotics Lab (ASRL)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+/**
+ * \file module_profiler.hpp
+ * \brief ModuleProfiler class definition
+ * \details Process-wide record of every module run latency, disabled by
+ * default. Used by offline benchmarks that need latency distributions rather
+ * than the per-module averages summarized at module destruction.
+ *
+ * \author Autonomous Space Robotics Lab (ASRL)
+ */
+#pragma once
+
+#include <string>
+#include <vector>
+
+namespace vtr {
+namespace tactic {
+
+class ModuleProfiler {
+ public:
+  struct Summary {
+    /** \brief runtime name of the module, e.g. odometry.icp */
+    std::string name;
+    size_t count = 0;
+    /** \brief latencies [ms] */
+    double mean = 0.0;
+    double p50 = 0.0;
+    double p99 = 0.0;
+    double max = 0.0;
+  };
+
+  static void enable(const bool enable = true);
+  static bool enabled();
+
+  /** \brief records one run of a module, no-op unless enabled */
+  static void record(const std::string& name, const double& latency);
+
+  /** \brief latency statistics of every recorded module, sorted by name */
+  static std::vector<Summary> summarize();
+
+  /** \brief discards all recorded latencies */
+  static void reset();
+};
+
+}  // namespace tactic
+}  // namespace vtr
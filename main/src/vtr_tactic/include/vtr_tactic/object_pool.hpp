@@ -0,0 +1,112 @@
+// Copyright 2021, Autonomous Space Robotics Lab (ASRL)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+/**
+ * \file object_pool.hpp
+ * \brief ObjectPool class definition
+ * \details Recycles the large per-frame objects (point clouds, buffers) that
+ * are handed from module to module through the QueryCache. An acquired object
+ * goes back to the pool when its last shared_ptr is released, typically when
+ * the query cache of its frame is destroyed, so that the next frame reuses the
+ * memory instead of going through the allocator again.
+ *
+ * \author Autonomous Space Robotics Lab (ASRL)
+ */
+#pragma once
+
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "vtr_common/utils/macros.hpp"
+
+namespace vtr {
+namespace tactic {
+
+template <class T>
+class ObjectPool : public std::enable_shared_from_this<ObjectPool<T>> {
+ public:
+  PTR_TYPEDEFS(ObjectPool);
+
+  using ResetFunc = std::function<void(T &)>;
+
+  /**
+   * \param max_size maximum number of idle objects kept for reuse
+   * \param reset applied to a released object before it is kept, e.g. a
+   * clear() that keeps the allocated capacity
+   */
+  static Ptr MakeShared(const size_t &max_size = 16,
+                        const ResetFunc &reset = nullptr) {
+    return std::make_shared<ObjectPool>(max_size, reset);
+  }
+
+  ObjectPool(const size_t &max_size, const ResetFunc &reset)
+      : reset_(reset), max_size_(max_size) {}
+
+  /**
+   * \brief Returns an idle object if any, otherwise a default constructed one.
+   * \note Released objects outlive the pool, they are deleted instead of being
+   * recycled once the pool is gone.
+   */
+  std::shared_ptr<T> acquire() {
+    std::unique_ptr<T> object;
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      if (!idle_.empty()) {
+        object = std::move(idle_.back());
+        idle_.pop_back();
+      }
+    }
+    if (object == nullptr) object = std::make_unique<T>();
+
+    std::weak_ptr<ObjectPool> pool = this->shared_from_this();
+    return std::shared_ptr<T>(object.release(), [pool](T *ptr) {
+      if (const auto pool_acquired = pool.lock())
+        pool_acquired->release(ptr);
+      else
+        delete ptr;
+    });
+  }
+
+  /** \brief Changes the number of idle objects kept, dropping the extra ones */
+  void setMaxSize(const size_t &max_size) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    max_size_ = max_size;
+    if (idle_.size() > max_size_) idle_.resize(max_size_);
+  }
+
+  /** \brief number of objects ready for reuse */
+  size_t idle() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return idle_.size();
+  }
+
+ private:
+  void release(T *ptr) {
+    std::unique_ptr<T> object(ptr);
+    if (reset_) reset_(*object);
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (idle_.size() < max_size_) idle_.push_back(std::move(object));
+  }
+
+  const ResetFunc reset_;
+
+  mutable std::mutex mutex_;
+  size_t max_size_;
+  std::vector<std::unique_ptr<T>> idle_;
+};
+
+}  // namespace tactic
+}  // namespace vtr
@@ -21,6 +21,7 @@
 #include "rclcpp/rclcpp.hpp"
 
 #include "vtr_tactic/cache.hpp"
+#include "vtr_tactic/quality_controller.hpp"
 #include "vtr_tactic/task_queue.hpp"
 #include "vtr_tactic/types.hpp"
 
@@ -202,7 +203,9 @@ class PipelineInterface {
                     const size_t& num_async_threads,
                     const size_t& async_queue_size,
                     const TaskQueueCallback::Ptr& task_queue_callback =
-                        std::make_shared<TaskQueueCallback>());
+                        std::make_shared<TaskQueueCallback>(),
+                    const QualityController::Config& quality_config =
+                        QualityController::Config());
 
   /** \brief Subclass must call join due to inheritance. */
   virtual ~PipelineInterface() { join(); }
@@ -229,6 +232,11 @@ class PipelineInterface {
   /** \brief Localization thread, odomtry&mapping->localization */
   void runLocalization();
 
+  /** \brief Runs one stage and reports its latency to the controller */
+  using Stage = QualityController::Stage;
+  template <typename StageFunc>
+  void runStage(const Stage& stage, const StageFunc& func);
+
   /** \brief Accepts the input data */
   virtual bool input_(const QueryCache::Ptr& qdata) = 0;
   /** \brief Performs the actual preprocessing task */
@@ -244,12 +252,19 @@ class PipelineInterface {
  private:
   const bool enable_parallelization_;
 
+  /** \brief degrades per-frame quality instead of dropping frames */
+  QualityController quality_controller_;
+
   PipelineMutex pipeline_mutex_;
   common::joinable_semaphore pipeline_semaphore_{0};
 
-  QueryBuffer<QueryCache::Ptr> preprocessing_buffer_{0};
-  QueryBuffer<QueryCache::Ptr> odometry_mapping_buffer_{0};
-  QueryBuffer<QueryCache::Ptr> localization_buffer_{0};
+  /**
+   * \brief hand-over buffers between stages, hold one frame when the quality
+   * controller is enabled so that a frame waits instead of being dropped
+   */
+  QueryBuffer<QueryCache::Ptr> preprocessing_buffer_;
+  QueryBuffer<QueryCache::Ptr> odometry_mapping_buffer_;
+  QueryBuffer<QueryCache::Ptr> localization_buffer_;
 
   std::thread preprocessing_thread_;
   std::thread odometry_mapping_thread_;
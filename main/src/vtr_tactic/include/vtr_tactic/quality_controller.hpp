@@ -0,0 +1,102 @@
+// Copyright 2021, Autonomous Space Robotics Lab (ASRL)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+/**
+ * \file quality_controller.hpp
+ * \brief QualityController class definition
+ * \details Closed-loop control of the per-frame compute budget. Stage
+ * latencies are compared against a frame deadline; when the pipeline falls
+ * behind, a higher quality level is handed to every new frame through the
+ * QueryCache so that modules can run a cheaper version of themselves instead
+ * of the frame being dropped.
+ *
+ * \author Autonomous Space Robotics Lab (ASRL)
+ */
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cmath>
+#include <mutex>
+
+#include "vtr_tactic/cache.hpp"
+
+namespace vtr {
+namespace tactic {
+
+class QualityController {
+ public:
+  enum class Stage { PREPROCESSING = 0, ODOMETRY_MAPPING, LOCALIZATION };
+
+  struct Config {
+    bool enabled = false;
+    /** \brief per-frame compute budget [ms], usually the sensor period */
+    double frame_deadline = 100.0;
+    /** \brief cheapest quality level, 0 is full quality */
+    int max_level = 3;
+    /** \brief degrade when the load exceeds this fraction of the deadline */
+    double degrade_ratio = 0.9;
+    /** \brief recover when the load drops below this fraction */
+    double recover_ratio = 0.6;
+    /** \brief weight of the newest latency sample in the moving average */
+    double smoothing = 0.3;
+    /** \brief minimum number of frames between two level changes */
+    int hold_frames = 5;
+  };
+
+  /**
+   * \param parallel whether stages run in their own threads; the load is then
+   * the slowest stage, otherwise the sum of all stages
+   */
+  QualityController(const Config& config, const bool& parallel)
+      : config_(config), parallel_(parallel) {}
+
+  bool enabled() const { return config_.enabled; }
+
+  /** \brief quality level to be used by the next frame */
+  unsigned level() const { return level_; }
+
+  /** \brief reports the latency [ms] of one stage for one frame */
+  void report(const Stage& stage, const double& latency);
+
+  /** \brief smoothed latency [ms] of a stage */
+  double latency(const Stage& stage) const;
+
+ private:
+  const Config config_;
+  const bool parallel_;
+
+  std::atomic<unsigned> level_{0};
+
+  mutable std::mutex mutex_;
+  std::array<double, 3> latencies_{0.0, 0.0, 0.0};
+  std::array<bool, 3> initialized_{false, false, false};
+  int frames_since_change_ = 0;
+};
+
+/** \brief quality level of this frame, 0 (full quality) if not set */
+inline unsigned qualityLevel(const QueryCache& qdata) {
+  return qdata.quality_level.valid() ? *qdata.quality_level : 0;
+}
+
+/**
+ * \brief factor^level for scaling a module parameter with the quality level,
+ * e.g. a factor of 1.25 on a voxel size or of 0.75 on an iteration cap
+ */
+inline double qualityScale(const QueryCache& qdata, const double& factor) {
+  return std::pow(factor, qualityLevel(qdata));
+}
+
+}  // namespace tactic
+}  // namespace vtr
@@ -55,6 +55,9 @@ class Tactic : public PipelineInterface, public TacticInterface {
     /** \brief Maximum number of queued tasks in task queue */
     int task_queue_size = -1;
 
+    /** \brief Per-frame compute budget control */
+    QualityController::Config quality_config;
+
     /** \brief */
     double route_completion_translation_threshold = 0.5;
     double route_completion_angle_threshold = 0.26;
@@ -18,6 +18,8 @@
  */
 #include "vtr_tactic/modules/base_module.hpp"
 
+#include "vtr_tactic/modules/module_profiler.hpp"
+
 namespace vtr {
 namespace tactic {
 
@@ -46,6 +48,9 @@ void BaseModule::run(QueryCache &qdata, OutputCache &output,
   timer_.start();
   run_(qdata, output, graph, executor);
   timer_.stop();
+  if (ModuleProfiler::enabled())
+    ModuleProfiler::record(name(),
+                           timer.count<std::chrono::microseconds>() / 1000.0);
   CLOG(DEBUG, "tactic.module")
       << "Finished running module: " << name() << ", which takes "
       << thread_timer << " / " << timer;
@@ -63,6 +68,9 @@ void BaseModule::runAsync(QueryCache &qdata, OutputCache &output,
   timer_.start();
   runAsync_(qdata, output, graph, executor, priority, dep_id);
   timer_.stop();
+  if (ModuleProfiler::enabled())
+    ModuleProfiler::record(name() + ".async",
+                           timer.count<std::chrono::microseconds>() / 1000.0);
   CLOG(DEBUG, "tactic.module")
       << "Finished running module (async): " << name() << ", which takes "
       << thread_timer << " / " << timer;
@@ -0,0 +1,82 @@
+// Copyright 2021, Autonomous Space Robotics Lab (ASRL)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+/**
+ * \file module_profiler.cpp
+ * \author Autonomous Space Robotics Lab (ASRL)
+ */
+#include "vtr_tactic/modules/module_profiler.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <map>
+#include <mutex>
+#include <numeric>
+
+namespace vtr {
+namespace tactic {
+
+namespace {
+
+std::atomic<bool> enabled_{false};
+std::mutex mutex_;
+std::map<std::string, std::vector<double>> latencies_;
+
+/** \brief nearest-rank percentile of sorted values */
+double percentile(const std::vector<double>& sorted, const double& p) {
+  const auto rank = static_cast<size_t>(std::ceil(p * sorted.size()));
+  return sorted[std::clamp<size_t>(rank, 1, sorted.size()) - 1];
+}
+
+}  // namespace
+
+void ModuleProfiler::enable(const bool enable) { enabled_ = enable; }
+
+bool ModuleProfiler::enabled() { return enabled_; }
+
+void ModuleProfiler::record(const std::string& name, const double& latency) {
+  if (!enabled_) return;
+  std::lock_guard<std::mutex> lock(mutex_);
+  latencies_[name].push_back(latency);
+}
+
+auto ModuleProfiler::summarize() -> std::vector<Summary> {
+  std::vector<Summary> summaries;
+  std::lock_guard<std::mutex> lock(mutex_);
+  summaries.reserve(latencies_.size());
+  for (const auto& [name, latencies] : latencies_) {
+    if (latencies.empty()) continue;
+    auto sorted = latencies;
+    std::sort(sorted.begin(), sorted.end());
+    Summary summary;
+    summary.name = name;
+    summary.count = sorted.size();
+    summary.mean = std::accumulate(sorted.begin(), sorted.end(), 0.0) /
+                   (double)sorted.size();
+    summary.p50 = percentile(sorted, 0.50);
+    summary.p99 = percentile(sorted, 0.99);
+    summary.max = sorted.back();
+    summaries.push_back(summary);
+  }
+  return summaries;
+}
+
+void ModuleProfiler::reset() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  latencies_.clear();
+}
+
+}  // namespace tactic
+}  // namespace vtr
@@ -18,6 +18,7 @@
  */
 #include "vtr_tactic/pipeline_interface.hpp"
 
+#include "vtr_common/timing/stopwatch.hpp"
 #include "vtr_tactic/storables.hpp"
 
 namespace vtr {
@@ -27,11 +28,16 @@ PipelineInterface::PipelineInterface(
     const bool& enable_parallelization, const OutputCache::Ptr& output,
     const Graph::Ptr& graph, const size_t& num_async_threads,
     const size_t& async_queue_size,
-    const TaskQueueCallback::Ptr& task_queue_callback)
+    const TaskQueueCallback::Ptr& task_queue_callback,
+    const QualityController::Config& quality_config)
     : task_queue_(std::make_shared<TaskExecutor>(
           output, graph, num_async_threads, async_queue_size,
           task_queue_callback)),
-      enable_parallelization_(enable_parallelization) {
+      enable_parallelization_(enable_parallelization),
+      quality_controller_(quality_config, enable_parallelization),
+      preprocessing_buffer_(quality_controller_.enabled() ? 1 : 0),
+      odometry_mapping_buffer_(quality_controller_.enabled() ? 1 : 0),
+      localization_buffer_(quality_controller_.enabled() ? 1 : 0) {
   // clang-format off
   preprocessing_thread_ = std::thread(&PipelineInterface::preprocess, this);
   odometry_mapping_thread_ = std::thread(&PipelineInterface::runOdometryMapping, this);
@@ -84,21 +90,22 @@ void PipelineInterface::inputSequential(const QueryCache::Ptr& qdata) {
   pipeline_semaphore_.release();
 
   CLOG(DEBUG, "tactic") << "Accepting a new frame: " << *qdata->stamp;
+  qdata->quality_level.emplace(quality_controller_.level());
   input_(qdata);
 
   CLOG(DEBUG, "tactic") << "Start running preprocessing: " << *qdata->stamp;
-  preprocess_(qdata);
+  runStage(Stage::PREPROCESSING, [&] { preprocess_(qdata); });
   CLOG(DEBUG, "tactic") << "Finish running preprocessing: " << *qdata->stamp;
 
   CLOG(DEBUG, "tactic") << "Start running odometry mapping, timestamp: "
                         << *qdata->stamp;
-  runOdometryMapping_(qdata);
+  runStage(Stage::ODOMETRY_MAPPING, [&] { runOdometryMapping_(qdata); });
   CLOG(DEBUG, "tactic") << "Finish running odometry mapping, timestamp: "
                         << *qdata->stamp;
 
   CLOG(DEBUG, "tactic") << "Start running localization, timestamp: "
                         << *qdata->stamp;
-  runLocalization_(qdata);
+  runStage(Stage::LOCALIZATION, [&] { runLocalization_(qdata); });
   CLOG(DEBUG, "tactic") << "Finish running localization, timestamp: "
                         << *qdata->stamp;
 
@@ -108,6 +115,7 @@ void PipelineInterface::inputSequential(const QueryCache::Ptr& qdata) {
 void PipelineInterface::inputParallel(const QueryCache::Ptr& qdata) {
   pipeline_semaphore_.release();
   CLOG(DEBUG, "tactic") << "Accepting a new frame: " << *qdata->stamp;
+  qdata->quality_level.emplace(quality_controller_.level());
   const bool discardable = input_(qdata);
   const bool discarded = preprocessing_buffer_.push(qdata, discardable);
   CLOG_IF(discarded, WARNING, "tactic")
@@ -122,7 +130,9 @@ void PipelineInterface::preprocess() {
     if (qdata == nullptr) return;
     CLOG(DEBUG, "tactic") << "Start running preprocessing, timestamp: "
                           << *qdata->stamp;
-    const bool discardable = preprocess_(qdata);
+    bool discardable;
+    runStage(Stage::PREPROCESSING,
+             [&] { discardable = preprocess_(qdata); });
     const bool discarded = odometry_mapping_buffer_.push(qdata, discardable);
     CLOG_IF(discarded, WARNING, "tactic")
         << "[preprocess] Buffer is full, one frame discarded.";
@@ -140,7 +150,9 @@ void PipelineInterface::runOdometryMapping() {
     if (qdata == nullptr) return;
     CLOG(DEBUG, "tactic") << "Start running odometry mapping, timestamp: "
                           << *qdata->stamp;
-    const bool discardable = runOdometryMapping_(qdata);
+    bool discardable;
+    runStage(Stage::ODOMETRY_MAPPING,
+             [&] { discardable = runOdometryMapping_(qdata); });
     const bool discarded = localization_buffer_.push(qdata, discardable);
     CLOG_IF(discarded, WARNING, "tactic")
         << "[odometry_mapping] Buffer is full, one frame discarded.";
@@ -158,12 +170,21 @@ void PipelineInterface::runLocalization() {
     if (qdata == nullptr) return;
     CLOG(DEBUG, "tactic") << "Start running localization, timestamp: "
                           << *qdata->stamp;
-    runLocalization_(qdata);
+    runStage(Stage::LOCALIZATION, [&] { runLocalization_(qdata); });
     CLOG(DEBUG, "tactic") << "Finish running localization, timestamp: "
                           << *qdata->stamp;
     pipeline_semaphore_.acquire();
   }
 }
 
+template <typename StageFunc>
+void PipelineInterface::runStage(const Stage& stage, const StageFunc& func) {
+  common::timing::Stopwatch timer;
+  func();
+  timer.stop();
+  quality_controller_.report(
+      stage, timer.count<std::chrono::microseconds>() / 1000.0);
+}
+
 }  // namespace tactic
 }  // namespace vtr
\ No newline at end of file
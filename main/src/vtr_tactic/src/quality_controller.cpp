@@ -0,0 +1,71 @@
+// Copyright 2021, Autonomous Space Robotics Lab (ASRL)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+/**
+ * \file quality_controller.cpp
+ * \author Autonomous Space Robotics Lab (ASRL)
+ */
+#include "vtr_tactic/quality_controller.hpp"
+
+#include <algorithm>
+#include <numeric>
+
+namespace vtr {
+namespace tactic {
+
+void QualityController::report(const Stage& stage, const double& latency) {
+  if (!config_.enabled) return;
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  const auto idx = static_cast<size_t>(stage);
+  if (initialized_[idx]) {
+    latencies_[idx] += config_.smoothing * (latency - latencies_[idx]);
+  } else {
+    latencies_[idx] = latency;
+    initialized_[idx] = true;
+  }
+
+  // decide once per frame, every frame that is kept goes through odometry
+  if (stage != Stage::ODOMETRY_MAPPING) return;
+  if (++frames_since_change_ < config_.hold_frames) return;
+
+  const double load =
+      parallel_ ? *std::max_element(latencies_.begin(), latencies_.end())
+                : std::accumulate(latencies_.begin(), latencies_.end(), 0.0);
+
+  const unsigned curr_level = level_;
+  unsigned new_level = curr_level;
+  if (load > config_.degrade_ratio * config_.frame_deadline &&
+      curr_level < (unsigned)config_.max_level)
+    new_level = curr_level + 1;
+  else if (load < config_.recover_ratio * config_.frame_deadline &&
+           curr_level > 0)
+    new_level = curr_level - 1;
+
+  if (new_level == curr_level) return;
+  level_ = new_level;
+  frames_since_change_ = 0;
+  CLOG(INFO, "tactic.quality")
+      << "Pipeline load " << load << "ms against a deadline of "
+      << config_.frame_deadline << "ms, quality level changed from "
+      << curr_level << " to " << new_level;
+}
+
+double QualityController::latency(const Stage& stage) const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return latencies_[static_cast<size_t>(stage)];
+}
+
+}  // namespace tactic
+}  // namespace vtr
@@ -36,6 +36,15 @@ auto Tactic::Config::fromROS(const rclcpp::Node::SharedPtr& node,
   config->task_queue_num_threads = node->declare_parameter<int>(prefix+".task_queue_num_threads", 1);
   config->task_queue_size = node->declare_parameter<int>(prefix+".task_queue_size", -1);
 
+  /// setup quality controller
+  config->quality_config.enabled = node->declare_parameter<bool>(prefix+".quality.enabled", false);
+  config->quality_config.frame_deadline = node->declare_parameter<double>(prefix+".quality.frame_deadline", 100.0);
+  config->quality_config.max_level = node->declare_parameter<int>(prefix+".quality.max_level", 3);
+  config->quality_config.degrade_ratio = node->declare_parameter<double>(prefix+".quality.degrade_ratio", 0.9);
+  config->quality_config.recover_ratio = node->declare_parameter<double>(prefix+".quality.recover_ratio", 0.6);
+  config->quality_config.smoothing = node->declare_parameter<double>(prefix+".quality.smoothing", 0.3);
+  config->quality_config.hold_frames = node->declare_parameter<int>(prefix+".quality.hold_frames", 5);
+
   config->route_completion_translation_threshold = node->declare_parameter<double>(prefix+".route_completion_translation_threshold", 0.5);
   config->route_completion_angle_threshold = node->declare_parameter<double>(prefix+".route_completion_angle_threshold", 0.26);
 
@@ -61,7 +70,7 @@ Tactic::Tactic(Config::UniquePtr config, const BasePipeline::Ptr& pipeline,
                const TaskQueueCallback::Ptr& task_queue_callback)
     : PipelineInterface(config->enable_parallelization, output, graph,
                         config->task_queue_num_threads, config->task_queue_size,
-                        task_queue_callback),
+                        task_queue_callback, config->quality_config),
       config_(std::move(config)),
       pipeline_(pipeline),
       output_(output),
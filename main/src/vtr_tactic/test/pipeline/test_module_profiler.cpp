@@ -0,0 +1,81 @@
+// Copyright 2021, Autonomous Space Robotics Lab (ASRL)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+/**
+ * \file test_module_profiler.cpp
+ * \author Autonomous Space Robotics Lab (ASRL)
+ */
+#include <gtest/gtest.h>
+
+#include "vtr_tactic/modules/factory.hpp"
+#include "vtr_tactic/modules/module_profiler.hpp"
+#include "vtr_tactic/modules/template_module.hpp"
+
+using namespace ::testing;
+using namespace vtr;
+using namespace vtr::tactic;
+
+class ModuleProfilerTest : public Test {
+ protected:
+  void SetUp() override { ModuleProfiler::reset(); }
+  void TearDown() override {
+    ModuleProfiler::enable(false);
+    ModuleProfiler::reset();
+  }
+};
+
+TEST_F(ModuleProfilerTest, disabled_by_default) {
+  ModuleProfiler::record("module", 1.0);
+  EXPECT_TRUE(ModuleProfiler::summarize().empty());
+}
+
+TEST_F(ModuleProfilerTest, percentiles) {
+  ModuleProfiler::enable();
+  // 1, 2, ..., 100 in reverse order
+  for (int i = 100; i > 0; --i) ModuleProfiler::record("b", (double)i);
+  ModuleProfiler::record("a", 5.0);
+
+  const auto summaries = ModuleProfiler::summarize();
+  ASSERT_EQ(summaries.size(), (size_t)2);
+
+  EXPECT_EQ(summaries[0].name, "a");
+  EXPECT_EQ(summaries[0].count, (size_t)1);
+  EXPECT_DOUBLE_EQ(summaries[0].p50, 5.0);
+  EXPECT_DOUBLE_EQ(summaries[0].p99, 5.0);
+
+  EXPECT_EQ(summaries[1].name, "b");
+  EXPECT_EQ(summaries[1].count, (size_t)100);
+  EXPECT_DOUBLE_EQ(summaries[1].mean, 50.5);
+  EXPECT_DOUBLE_EQ(summaries[1].p50, 50.0);
+  EXPECT_DOUBLE_EQ(summaries[1].p99, 99.0);
+  EXPECT_DOUBLE_EQ(summaries[1].max, 100.0);
+
+  ModuleProfiler::reset();
+  EXPECT_TRUE(ModuleProfiler::summarize().empty());
+}
+
+TEST_F(ModuleProfilerTest, module_runs_are_recorded) {
+  ModuleProfiler::enable();
+  auto module_factory = std::make_shared<ModuleFactory>();
+  auto module = module_factory->make("template");
+
+  QueryCache qdata;
+  OutputCache output;
+  for (int i = 0; i < 3; ++i) module->run(qdata, output, nullptr, nullptr);
+
+  const auto summaries = ModuleProfiler::summarize();
+  ASSERT_EQ(summaries.size(), (size_t)1);
+  EXPECT_EQ(summaries[0].name, module->name());
+  EXPECT_EQ(summaries[0].count, (size_t)3);
+}
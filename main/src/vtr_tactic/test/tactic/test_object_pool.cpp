@@ -0,0 +1,80 @@
+// Copyright 2021, Autonomous Space Robotics Lab (ASRL)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+/**
+ * \file test_object_pool.cpp
+ * \author Autonomous Space Robotics Lab (ASRL)
+ */
+#include <gtest/gtest.h>
+
+#include "vtr_tactic/object_pool.hpp"
+
+using namespace ::testing;
+using namespace vtr;
+using namespace vtr::tactic;
+
+TEST(ObjectPool, released_object_is_reused) {
+  auto pool = ObjectPool<std::vector<int>>::MakeShared(
+      2, [](std::vector<int> &v) { v.clear(); });
+
+  const std::vector<int> *address = nullptr;
+  size_t capacity = 0;
+  {
+    auto object = pool->acquire();
+    object->resize(1000);
+    address = object.get();
+    capacity = object->capacity();
+    EXPECT_EQ(pool->idle(), (size_t)0);
+  }
+  EXPECT_EQ(pool->idle(), (size_t)1);
+
+  auto object = pool->acquire();
+  EXPECT_EQ(object.get(), address);
+  EXPECT_TRUE(object->empty());
+  EXPECT_EQ(object->capacity(), capacity);
+  EXPECT_EQ(pool->idle(), (size_t)0);
+}
+
+TEST(ObjectPool, idle_objects_are_bounded) {
+  auto pool = ObjectPool<std::vector<int>>::MakeShared(2);
+  {
+    std::vector<std::shared_ptr<std::vector<int>>> objects;
+    for (int i = 0; i < 5; ++i) objects.emplace_back(pool->acquire());
+  }
+  EXPECT_EQ(pool->idle(), (size_t)2);
+}
+
+TEST(ObjectPool, shrinking_max_size_drops_idle_objects) {
+  auto pool = ObjectPool<std::vector<int>>::MakeShared(4);
+  {
+    std::vector<std::shared_ptr<std::vector<int>>> objects;
+    for (int i = 0; i < 4; ++i) objects.emplace_back(pool->acquire());
+  }
+  EXPECT_EQ(pool->idle(), (size_t)4);
+  pool->setMaxSize(1);
+  EXPECT_EQ(pool->idle(), (size_t)1);
+  {
+    auto object1 = pool->acquire();
+    auto object2 = pool->acquire();
+  }
+  EXPECT_EQ(pool->idle(), (size_t)1);
+}
+
+TEST(ObjectPool, object_outlives_pool) {
+  auto pool = ObjectPool<std::vector<int>>::MakeShared();
+  auto object = pool->acquire();
+  pool.reset();
+  object->push_back(1);
+  object.reset();  // deleted instead of recycled
+}
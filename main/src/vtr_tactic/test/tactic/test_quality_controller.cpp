@@ -0,0 +1,83 @@
+// Copyright 2021, Autonomous Space Robotics Lab (ASRL)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+/**
+ * \file test_quality_controller.cpp
+ * \author Autonomous Space Robotics Lab (ASRL)
+ */
+#include <gtest/gtest.h>
+
+#include "vtr_tactic/quality_controller.hpp"
+
+using namespace vtr;
+using namespace vtr::tactic;
+
+namespace {
+
+using Stage = QualityController::Stage;
+
+QualityController::Config config() {
+  QualityController::Config config;
+  config.enabled = true;
+  config.frame_deadline = 100.0;
+  config.max_level = 2;
+  config.hold_frames = 2;
+  return config;
+}
+
+void frame(QualityController& controller, const double& preprocessing,
+           const double& odometry, const double& localization) {
+  controller.report(Stage::PREPROCESSING, preprocessing);
+  controller.report(Stage::ODOMETRY_MAPPING, odometry);
+  controller.report(Stage::LOCALIZATION, localization);
+}
+
+}  // namespace
+
+TEST(QualityController, disabled_stays_at_full_quality) {
+  QualityController controller(QualityController::Config(), true);
+  for (int i = 0; i < 20; ++i) frame(controller, 500.0, 500.0, 500.0);
+  EXPECT_EQ(controller.level(), 0u);
+}
+
+TEST(QualityController, degrade_and_recover) {
+  QualityController controller(config(), true);
+  // slowest stage over the deadline
+  for (int i = 0; i < 20; ++i) frame(controller, 10.0, 150.0, 10.0);
+  EXPECT_EQ(controller.level(), 2u);  // capped at max level
+  // load drops
+  for (int i = 0; i < 40; ++i) frame(controller, 10.0, 20.0, 10.0);
+  EXPECT_EQ(controller.level(), 0u);
+}
+
+TEST(QualityController, sequential_load_is_the_sum_of_stages) {
+  // each stage is within the deadline, but not all of them together
+  QualityController parallel(config(), true);
+  QualityController sequential(config(), false);
+  for (int i = 0; i < 20; ++i) {
+    frame(parallel, 40.0, 40.0, 40.0);
+    frame(sequential, 40.0, 40.0, 40.0);
+  }
+  EXPECT_EQ(parallel.level(), 0u);
+  EXPECT_GT(sequential.level(), 0u);
+}
+
+TEST(QualityController, quality_level_from_query_cache) {
+  QueryCache qdata;
+  EXPECT_EQ(qualityLevel(qdata), 0u);
+  EXPECT_DOUBLE_EQ(qualityScale(qdata, 0.5), 1.0);
+  qdata.quality_level.emplace(2);
+  EXPECT_EQ(qualityLevel(qdata), 2u);
+  EXPECT_DOUBLE_EQ(qualityScale(qdata, 0.5), 0.25);
+}
@@ -18,6 +18,8 @@
  */
 #include <gtest/gtest.h>
 
+#include <thread>
+
 #include "vtr_tactic/cache.hpp"
 
 using namespace vtr;
@@ -99,4 +101,43 @@ TEST(QueryCache, query_cache_copy_move) {
   EXPECT_EQ(*qdata->stamp, *stamp);
   EXPECT_EQ(*qdata2->stamp, *stamp2);
   EXPECT_NE(*qdata->stamp, *qdata2->stamp);
-}
\ No newline at end of file
+}
+
+TEST(QueryCache, atomic_cache_publish_read) {
+  AtomicCache<int> cache;
+  EXPECT_FALSE(cache.valid());
+  EXPECT_EQ(cache.read(), nullptr);
+
+  cache.publish(std::make_shared<const int>(1));
+  EXPECT_TRUE(cache.valid());
+  EXPECT_EQ(*cache.read(), 1);
+
+  cache.publish(std::make_shared<const int>(2));
+  EXPECT_EQ(*cache.read(), 2);
+}
+
+TEST(QueryCache, atomic_cache_concurrent_readers) {
+  AtomicCache<int> cache;
+  cache.publish(std::make_shared<const int>(0));
+
+  constexpr int num_writes = 10000;
+  std::atomic<bool> done = false;
+  std::vector<std::thread> readers;
+  for (int i = 0; i < 4; ++i) {
+    readers.emplace_back([&]() {
+      int last = 0;
+      while (!done) {
+        const auto datum = cache.read();
+        ASSERT_NE(datum, nullptr);
+        EXPECT_GE(*datum, last);  // never goes back to an older datum
+        last = *datum;
+      }
+    });
+  }
+  for (int i = 1; i <= num_writes; ++i)
+    cache.publish(std::make_shared<const int>(i));
+  done = true;
+  for (auto &reader : readers) reader.join();
+
+  EXPECT_EQ(*cache.read(), num_writes);
+}
@@ -0,0 +1,151 @@
+// Copyright 2023, Autonomous Space Robotics Lab (ASRL)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+/**
+ * \file inference_service.hpp
+ * \brief InferenceService class definition
+ * \details Owns a loaded TorchScript model and serves forward passes to any
+ * number of modules. Concurrent requests with the same per-sample shape are
+ * coalesced into one batched forward pass; input and output tensors are
+ * allocated once and reused across calls.
+ *
+ * \author Autonomous Space Robotics Lab (ASRL)
+ */
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <future>
+#include <map>
+#include <mutex>
+#include <thread>
+#include <tuple>
+#include <vector>
+
+#include <torch/script.h>
+
+#include "vtr_common/utils/macros.hpp"
+#include "vtr_torch/types.hpp"
+
+namespace vtr {
+namespace nn {
+
+class InferenceService {
+ public:
+  PTR_TYPEDEFS(InferenceService);
+
+  struct Options {
+    std::string model_filepath;
+    bool use_gpu = false;
+    /**
+     * \brief intra-op threads of torch, 0 keeps the torch default
+     * \note at::set_num_threads is process wide, the last service created
+     * with a non-zero value sets it for every model in the process.
+     */
+    int num_threads = 0;
+    /** \brief freeze and optimize the model for inference at load */
+    bool optimize_for_inference = true;
+    /** \brief input shape for warm-up passes at load, empty to skip */
+    std::vector<int64_t> warmup_shape;
+    int warmup_iterations = 3;
+    /**
+     * \brief max samples per forward pass, 1 disables micro-batching
+     * \note with 1, the forward passes of all modules sharing this service
+     * are serialized on one mutex since the buffers are reused.
+     */
+    int64_t max_batch_size = 1;
+    /** \brief how long to wait for more requests before running a batch */
+    int batch_timeout_us = 500;
+  };
+
+  /**
+   * \brief Returns the service of the given model, creating it if needed.
+   * Modules loading the same model with the same options share one service
+   * so that their requests can be batched together.
+   */
+  static Ptr get(const Options &options);
+
+  InferenceService(const Options &options);
+  ~InferenceService();
+
+  bool loaded() const { return loaded_; }
+  const torch::Device &device() const { return device_; }
+
+  /**
+   * \brief Runs the model on inputs of the given shape, blocks until done.
+   * \details The first dimension of shape is the batch dimension; requests
+   * are concatenated along it. data is only read during the call.
+   * \return the output of this request on CPU
+   */
+  torch::Tensor evaluate(const void *data, const torch::ScalarType &dtype,
+                         const Shape &shape);
+
+  template <typename DataType>
+  torch::Tensor evaluate(const std::vector<DataType> &inputs,
+                         const Shape &shape) {
+    return evaluate(inputs.data(), c10::CppTypeToScalarType<DataType>::value,
+                    shape);
+  }
+
+ private:
+  struct Request {
+    /** \brief view of the caller's data, valid until result is set */
+    torch::Tensor input;
+    std::promise<torch::Tensor> result;
+  };
+  using Batch = std::vector<std::shared_ptr<Request>>;
+
+  void load();
+  void warmup();
+  /** \brief pops requests compatible with the front one, mutex_ held */
+  Batch popBatch();
+  void process();
+  /** \brief one forward pass over all requests in batch */
+  void run(const Batch &batch);
+  /** \brief reusable buffer with at least num_samples rows */
+  torch::Tensor buffer(torch::Tensor &buffer, const int64_t &num_samples,
+                       const torch::IntArrayRef &sample_shape,
+                       const torch::TensorOptions &options);
+
+  const Options options_;
+  torch::Device device_ = torch::kCPU;
+  /** \brief pin host buffers when copying to a cuda device */
+  bool pin_memory_ = false;
+  bool loaded_ = false;
+  Module network_;
+
+  /** \brief protects the buffers and the network when running a batch */
+  std::mutex run_mutex_;
+  torch::Tensor input_buffer_;
+  torch::Tensor device_input_buffer_;
+  torch::Tensor output_buffer_;
+
+  /** \brief micro-batching queue, only used if max_batch_size > 1 */
+  std::mutex mutex_;
+  std::condition_variable cv_;
+  std::deque<std::shared_ptr<Request>> queue_;
+  bool stop_ = false;
+  std::thread thread_;
+
+  /** \brief all options, services only differing in them are not shared */
+  using Key = std::tuple<std::string, bool, int, bool, std::vector<int64_t>,
+                         int, int64_t, int>;
+  static Key key(const Options &options);
+
+  static std::mutex registry_mutex_;
+  static std::map<Key, WeakPtr> registry_;
+};
+
+}  // namespace nn
+}  // namespace vtr
@@ -23,6 +23,7 @@
 #include "vtr_tactic/task_queue.hpp"
 #include <torch/script.h> 
 #include "vtr_torch/types.hpp"
+#include "vtr_torch/inference_service.hpp"
 #include <vector>
 
 namespace vtr {
@@ -43,6 +44,16 @@ class TorchModule : public tactic::BaseModule {
     bool use_gpu = false;
     bool abs_filepath = true;
 
+    /** \brief intra-op threads of torch, 0 keeps the torch default */
+    int num_threads = 0;
+    bool optimize_for_inference = true;
+    /** \brief input shape for warm-up passes at load, empty to skip */
+    std::vector<int64_t> warmup_shape;
+    int warmup_iterations = 3;
+    /** \brief max samples per forward pass, 1 disables micro-batching */
+    int max_batch_size = 1;
+    int batch_timeout_us = 500;
+
     static ConstPtr fromROS(const rclcpp::Node::SharedPtr &node,
                             const std::string &param_prefix);
     
@@ -55,25 +66,17 @@ class TorchModule : public tactic::BaseModule {
       const std::shared_ptr<tactic::ModuleFactory> &module_factory = nullptr,
       const std::string &name = static_name)
       : tactic::BaseModule{module_factory, name}, config_(config) {
-
-        //Load the model
-        //Should the system crash out if the model is loaded incorrectly?
-        try {
-          // Deserialize the ScriptModule from a file using torch::jit::load().
-          network = torch::jit::load(config_->model_filepath);
-        } catch (const c10::Error& e) {
-          CLOG(ERROR, "torch") << "error loading the model\n" << "Tried to load " << config_->model_filepath;
-        }
-
-        if (config_->use_gpu){
-          if (torch::cuda::is_available()) {
-            device = torch::kCUDA;  
-            network.to(device);
-          } else {
-            CLOG(ERROR, "torch") << "Device cuda requested but torch.cuda.is_available() is false. Using CPU!";
-          }
-        }
-        CLOG(INFO, "torch") << "Using device " << device << std::endl;
+        InferenceService::Options options;
+        options.model_filepath = config_->model_filepath;
+        options.use_gpu = config_->use_gpu;
+        options.num_threads = config_->num_threads;
+        options.optimize_for_inference = config_->optimize_for_inference;
+        options.warmup_shape = config_->warmup_shape;
+        options.warmup_iterations = config_->warmup_iterations;
+        options.max_batch_size = config_->max_batch_size;
+        options.batch_timeout_us = config_->batch_timeout_us;
+        // modules using the same model share one service
+        service_ = InferenceService::get(options);
       }
 
   
@@ -85,14 +88,14 @@ class TorchModule : public tactic::BaseModule {
             const tactic::TaskExecutor::Ptr &executor) = 0;
 
   Config::ConstPtr config_;
-  torch::Device device = torch::kCPU;
 
 
  protected:
-  Module network;
+  InferenceService::Ptr service_;
 
   template <typename DataType>
-  torch::Tensor evaluateModel(std::vector<DataType> inputs, const Shape shape);
+  torch::Tensor evaluateModel(const std::vector<DataType> &inputs,
+                              const Shape shape);
 
 };
 
@@ -8,17 +8,10 @@ namespace vtr {
 namespace nn {
 
   template <typename DataType>
-  torch::Tensor TorchModule::evaluateModel(std::vector<DataType> inputs, const Shape shape){
-    torch::NoGradGuard no_grad;
-    std::vector<torch::jit::IValue> jit_inputs;
-
-    auto t_input = torch::from_blob(inputs.data(), shape).to(device);
-    jit_inputs.push_back(t_input);
-
-
-    auto output = network(jit_inputs);
-
-    return output.toTensor().cpu();
+  torch::Tensor TorchModule::evaluateModel(const std::vector<DataType> &inputs,
+                                           const Shape shape){
+    // may be batched with concurrent requests of other modules
+    return service_->evaluate<DataType>(inputs, shape);
   }
     
 } // namespace nn 
@@ -0,0 +1,296 @@
+// Copyright 2023, Autonomous Space Robotics Lab (ASRL)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+/**
+ * \file inference_service.cpp
+ * \author Autonomous Space Robotics Lab (ASRL)
+ */
+#include "vtr_torch/inference_service.hpp"
+
+#include "vtr_logging/logging.hpp"
+
+namespace vtr {
+namespace nn {
+
+std::mutex InferenceService::registry_mutex_;
+std::map<InferenceService::Key, InferenceService::WeakPtr>
+    InferenceService::registry_;
+
+auto InferenceService::key(const Options &options) -> Key {
+  return Key{options.model_filepath, options.use_gpu,
+             options.num_threads,    options.optimize_for_inference,
+             options.warmup_shape,   options.warmup_iterations,
+             options.max_batch_size, options.batch_timeout_us};
+}
+
+auto InferenceService::get(const Options &options) -> Ptr {
+  std::lock_guard<std::mutex> lock(registry_mutex_);
+  auto &entry = registry_[key(options)];
+  if (auto service = entry.lock()) {
+    CLOG(DEBUG, "torch") << "Sharing the inference service of "
+                         << options.model_filepath;
+    return service;
+  }
+  for (const auto &[other_key, other] : registry_) {
+    if (std::get<0>(other_key) != options.model_filepath || other.expired())
+      continue;
+    CLOG(WARNING, "torch")
+        << "Loading " << options.model_filepath
+        << " again since its options differ from an existing service; "
+           "requests are not batched across the two.";
+    break;
+  }
+  auto service = std::make_shared<InferenceService>(options);
+  entry = service;
+  return service;
+}
+
+InferenceService::InferenceService(const Options &options)
+    : options_(options) {
+  // intra-op parallelism is process wide in torch
+  if (options_.num_threads > 0) at::set_num_threads(options_.num_threads);
+
+  load();
+  if (loaded_) warmup();
+
+  if (options_.max_batch_size > 1)
+    thread_ = std::thread(&InferenceService::process, this);
+}
+
+InferenceService::~InferenceService() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stop_ = true;
+  }
+  cv_.notify_all();
+  if (thread_.joinable()) thread_.join();
+}
+
+void InferenceService::load() {
+  //Should the system crash out if the model is loaded incorrectly?
+  try {
+    // Deserialize the ScriptModule from a file using torch::jit::load().
+    network_ = torch::jit::load(options_.model_filepath);
+    loaded_ = true;
+  } catch (const c10::Error &e) {
+    CLOG(ERROR, "torch") << "error loading the model\n"
+                         << "Tried to load " << options_.model_filepath;
+    return;
+  }
+
+  if (options_.use_gpu) {
+    if (torch::cuda::is_available()) {
+      device_ = torch::kCUDA;
+      pin_memory_ = true;
+      network_.to(device_);
+    } else {
+      CLOG(ERROR, "torch") << "Device cuda requested but "
+                              "torch.cuda.is_available() is false. Using CPU!";
+    }
+  }
+  CLOG(INFO, "torch") << "Using device " << device_;
+
+  network_.eval();
+  if (options_.optimize_for_inference) {
+    try {
+      // freezes the parameters and fuses ops (e.g. conv-bn) where possible
+      network_ = torch::jit::optimize_for_inference(network_);
+    } catch (const c10::Error &e) {
+      CLOG(WARNING, "torch") << "Could not optimize the model for inference, "
+                                "using it as loaded: "
+                             << e.what_without_backtrace();
+    }
+  }
+}
+
+void InferenceService::warmup() {
+  if (options_.warmup_shape.empty()) return;
+  // the first passes run the JIT profiling and allocate the reused buffers
+  auto request = std::make_shared<Request>();
+  request->input = torch::zeros(options_.warmup_shape);
+  std::lock_guard<std::mutex> lock(run_mutex_);
+  for (int i = 0; i < options_.warmup_iterations; ++i) {
+    request->result = std::promise<torch::Tensor>();
+    run({request});
+  }
+  CLOG(INFO, "torch") << "Warmed up " << options_.model_filepath << " with "
+                      << options_.warmup_iterations << " passes.";
+}
+
+torch::Tensor InferenceService::evaluate(const void *data,
+                                         const torch::ScalarType &dtype,
+                                         const Shape &shape) {
+  if (!loaded_)
+    throw std::runtime_error("Model " + options_.model_filepath +
+                             " is not loaded.");
+
+  auto request = std::make_shared<Request>();
+  // only read from while the caller is waiting below
+  request->input = torch::from_blob(const_cast<void *>(data), shape,
+                                    torch::TensorOptions().dtype(dtype));
+  auto result = request->result.get_future();
+
+  if (options_.max_batch_size > 1) {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      queue_.push_back(request);
+    }
+    cv_.notify_all();
+  } else {
+    std::lock_guard<std::mutex> lock(run_mutex_);
+    run({request});
+  }
+
+  return result.get();
+}
+
+auto InferenceService::popBatch() -> Batch {
+  Batch batch;
+  // copied, the front request is erased below
+  const auto front = queue_.front()->input;
+  const auto sample_shape = front.sizes().slice(1);
+  int64_t num_samples = 0;
+  for (auto it = queue_.begin(); it != queue_.end();) {
+    const auto &input = (*it)->input;
+    const bool compatible = input.scalar_type() == front.scalar_type() &&
+                            input.sizes().slice(1) == sample_shape;
+    // the front request is always taken, even if larger than a batch
+    if (!compatible || (!batch.empty() && num_samples + input.size(0) >
+                                              options_.max_batch_size)) {
+      ++it;
+      continue;
+    }
+    num_samples += input.size(0);
+    batch.push_back(*it);
+    it = queue_.erase(it);
+  }
+  return batch;
+}
+
+void InferenceService::process() {
+  // the torch thread setting is not inherited by new threads with OpenMP
+  if (options_.num_threads > 0) at::set_num_threads(options_.num_threads);
+
+  const auto timeout = std::chrono::microseconds(options_.batch_timeout_us);
+  while (true) {
+    Batch batch;
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      cv_.wait(lock, [this] { return stop_ || !queue_.empty(); });
+      if (queue_.empty()) return;  // stopped and drained
+      // give concurrent callers a chance to join this batch
+      const auto deadline = std::chrono::steady_clock::now() + timeout;
+      cv_.wait_until(lock, deadline, [this] {
+        return stop_ || int64_t(queue_.size()) >= options_.max_batch_size;
+      });
+      batch = popBatch();
+    }
+    std::lock_guard<std::mutex> lock(run_mutex_);
+    run(batch);
+  }
+}
+
+void InferenceService::run(const Batch &batch) {
+  try {
+    torch::NoGradGuard no_grad;
+
+    const auto &front = batch.front()->input;
+    const auto sample_shape = front.sizes().slice(1);
+    int64_t num_samples = 0;
+    for (const auto &request : batch) num_samples += request->input.size(0);
+
+    // gather the requests into the reused input buffer
+    const auto host_options =
+        torch::TensorOptions().dtype(front.scalar_type()).pinned_memory(
+            pin_memory_);
+    auto input =
+        buffer(input_buffer_, num_samples, sample_shape, host_options);
+    int64_t offset = 0;
+    for (const auto &request : batch) {
+      const auto size = request->input.size(0);
+      input.narrow(0, offset, size).copy_(request->input);
+      offset += size;
+    }
+
+    if (device_ != torch::kCPU) {
+      auto device_input = buffer(device_input_buffer_, num_samples,
+                                 sample_shape, host_options.device(device_)
+                                                   .pinned_memory(false));
+      device_input.copy_(input, /* non_blocking */ true);
+      input = device_input;
+    }
+
+    auto output = network_.forward({input}).toTensor();
+
+    // results must not alias a buffer that is reused by the next batch
+    bool copy_results = output.is_alias_of(input);
+    if (output.device() != torch::kCPU) {
+      auto host_output = buffer(
+          output_buffer_, output.size(0), output.sizes().slice(1),
+          torch::TensorOptions().dtype(output.scalar_type()).pinned_memory(
+              pin_memory_));
+      host_output.copy_(output);
+      output = host_output;
+      copy_results = true;
+    }
+
+    if (batch.size() == 1) {
+      batch.front()->result.set_value(copy_results ? output.clone() : output);
+      return;
+    }
+
+    if (output.dim() == 0 || output.size(0) != num_samples)
+      throw std::runtime_error(
+          "Batched output does not match the number of input samples.");
+    offset = 0;
+    for (const auto &request : batch) {
+      const auto size = request->input.size(0);
+      auto result = output.narrow(0, offset, size);
+      request->result.set_value(copy_results ? result.clone() : result);
+      offset += size;
+    }
+  } catch (const std::exception &e) {
+    CLOG(ERROR, "torch") << "Inference failed: " << e.what();
+    for (const auto &request : batch) {
+      try {
+        request->result.set_exception(std::current_exception());
+      } catch (const std::future_error &) {
+        // result already set
+      }
+    }
+  }
+}
+
+torch::Tensor InferenceService::buffer(torch::Tensor &buffer,
+                                       const int64_t &num_samples,
+                                       const torch::IntArrayRef &sample_shape,
+                                       const torch::TensorOptions &options) {
+  const bool reusable = buffer.defined() &&
+                        buffer.dtype() == options.dtype() &&
+                        buffer.device().type() == options.device().type() &&
+                        buffer.sizes().slice(1) == sample_shape &&
+                        buffer.size(0) >= num_samples;
+  if (!reusable) {
+    // grow to the largest batch seen so far
+    std::vector<int64_t> shape{
+        std::max(num_samples, buffer.defined() ? buffer.size(0) : 0)};
+    shape.insert(shape.end(), sample_shape.begin(), sample_shape.end());
+    buffer = torch::empty(shape, options);
+  }
+  // a view of the rows in use, shares the buffer storage
+  return buffer.narrow(0, 0, num_samples);
+}
+
+}  // namespace nn
+}  // namespace vtr
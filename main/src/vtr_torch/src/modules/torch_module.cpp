@@ -32,6 +32,12 @@ auto TorchModule::Config::fromROS(const rclcpp::Node::SharedPtr &node,
 
   config->use_gpu = node->declare_parameter<bool>(param_prefix + ".use_gpu", config->use_gpu);
   config->abs_filepath = node->declare_parameter<bool>(param_prefix + ".abs_filepath", config->abs_filepath);
+  config->num_threads = node->declare_parameter<int>(param_prefix + ".num_threads", config->num_threads);
+  config->optimize_for_inference = node->declare_parameter<bool>(param_prefix + ".optimize_for_inference", config->optimize_for_inference);
+  config->warmup_shape = node->declare_parameter<std::vector<int64_t>>(param_prefix + ".warmup_shape", config->warmup_shape);
+  config->warmup_iterations = node->declare_parameter<int>(param_prefix + ".warmup_iterations", config->warmup_iterations);
+  config->max_batch_size = node->declare_parameter<int>(param_prefix + ".max_batch_size", config->max_batch_size);
+  config->batch_timeout_us = node->declare_parameter<int>(param_prefix + ".batch_timeout_us", config->batch_timeout_us);
 
   auto model_dir = node->declare_parameter<std::string>("model_dir", "defalut2");
   model_dir = common::utils::expand_user(common::utils::expand_env(model_dir));
@@ -25,6 +25,7 @@
 
 #include <vtr_tactic/cache.hpp>
 #include <vtr_tactic/types.hpp>
+#include <vtr_vision/landmark_cache.hpp>
 #include <vtr_vision/types.hpp>
 #include <vtr_vision_msgs/msg/localization_status.hpp>
 
@@ -57,6 +58,8 @@ struct CameraQueryCache : public tactic::QueryCache {
   tactic::Cache<std::vector<vision::RigMatches>> raw_matches;
   tactic::Cache<std::map<tactic::VertexId, lgmath::se3::TransformationWithCovariance>> T_sensor_vehicle_map;
   tactic::Cache<std::vector<LandmarkFrame>> map_landmarks;
+  // landmark messages of recently used vertices, owned by the pipeline
+  tactic::Cache<VertexLandmarkCache> landmark_cache;
   tactic::Cache<std::vector<vision::RigMatches>> ransac_matches;
   tactic::Cache<std::mutex> steam_mutex;
 
@@ -22,11 +22,13 @@
 #pragma once
 
 #include <future>
+#include <memory>
 #include <queue>
 
 #include <Eigen/Core>
 #include <opencv2/opencv.hpp>
 
+#include <vtr_common/utils/thread_pool.hpp>
 #include <vtr_logging/logging.hpp>
 #include <vtr_vision/types.hpp>
 
@@ -35,9 +37,9 @@ namespace vision {
 
 /**
  * The base class for the visual feature extractors.
- * The extractor runs in parallel when processing multiple images in a request.
+ * The extractor runs in parallel when processing multiple images in a request,
+ * as jobs on the thread pool given by setThreadPool (serially without one).
  * This behaviour can be disabled by derived classes by locking a static mutex.
- * You can use vtr_vision::common::thread_pool for asynchronous requests
  */
 class BaseFeatureExtractor {
   using My_t = BaseFeatureExtractor;
@@ -160,10 +162,57 @@ class BaseFeatureExtractor {
    */
   RigFeatures extractRigFeatures(const RigImages &rig, bool fully_matched);
 
+  /**
+   * \brief Queues the extraction of an vtr_vision rig channel image on the
+   * thread pool, one job per camera. Stereo pairs are matched on the caller
+   * at get(), or extracted in a single job if the extractor cannot match
+   * them separately.
+   * \param[in] channel referenced by the jobs, must outlive the future.
+   * \param[in] fully_matched will remove all non-stereo matching features,
+   *            aligning the features so matches share indices (2 cams only).
+   */
+  std::future<ChannelFeatures> dispatchChannelFeatures(
+      const ChannelImages &channel, bool fully_matched);
+
   void setRigCalibration(const RigCalibration &calib) { calib_ = calib; }
 
+  /** \brief Sets the pool that camera and channel extraction jobs run on. */
+  void setThreadPool(const std::shared_ptr<common::thread_pool> &pool) {
+    extraction_pool_ = pool;
+  }
+
+  /**
+   * \brief Keeps the features of a stereo pair that match, index aligned.
+   * Only implemented by extractors for which matchesStereoSeparately is true.
+   */
+  virtual ChannelFeatures matchStereoFeatures(const Features &left,
+                                              const Features &right);
+
   // the rig calibration to use for guided matching in the stereo case
   RigCalibration calib_;
+
+ protected:
+  /**
+   * \brief Whether a stereo pair can be extracted as two camera jobs followed
+   * by matchStereoFeatures, instead of one extractStereoFeatures job.
+   */
+  virtual bool matchesStereoSeparately() const { return false; }
+
+  /** \brief Queues func on the pool, or defers it to get() without a pool. */
+  template <class Func>
+  auto dispatch(Func &&func) -> std::future<std::invoke_result_t<Func>> {
+    if (extraction_pool_ == nullptr)
+      return std::async(std::launch::deferred, std::forward<Func>(func));
+    return extraction_pool_->dispatch(std::forward<Func>(func));
+  }
+
+  /** \brief Queues the extraction of each camera of the channel. */
+  std::vector<std::future<Features>> dispatchCameraFeatures(
+      const ChannelImages &channel);
+
+ private:
+  /** \brief Persistent workers, so that no thread is created per image. */
+  std::shared_ptr<common::thread_pool> extraction_pool_;
 };
 
 }  // namespace vision
@@ -32,6 +32,7 @@
 #include <opencv2/core/core.hpp>
 #include <opencv2/imgproc/imgproc.hpp>
 
+#include <vtr_common/utils/thread_pool.hpp>
 #include <vtr_vision/features/extractor/base_feature_extractor.hpp>
 #include <vtr_vision/features/extractor/orb_configuration.hpp>
 
@@ -108,18 +109,48 @@ class OrbFeatureExtractor : public BaseFeatureExtractor {
   /// @return the extracted features (keypoints, descriptors, info)
   virtual ChannelExtra extractFeaturesExtra(const cv::Mat &image);
 
+  /////////////////////////////////////////////////////////////////////////
+  /// @brief Keeps the features of a rectified stereo pair that match, index
+  ///        aligned, so that the two images can be extracted as separate jobs.
+  /// @param[in] left the features of the left image.
+  /// @param[in] right the features of the right image.
+  /// @return the matched, index-aligned features of both images.
+  ChannelFeatures matchStereoFeatures(const Features &left,
+                                      const Features &right) override;
+
+ protected:
+  bool matchesStereoSeparately() const override { return true; }
 
  private:
   /////////////////////////////////////////////////////////////////////////
-  /// @brief Detect features on an image pyramid using STAR
-  void detectOnPyramid(const uMat& image, Keypoints& keypoints,
-                       const cv::Mat& mask);
+  /// @brief Build the image pyramid used by both STAR and the descriptors
+  void buildPyramid(const cv::Mat& image, std::vector<cv::Mat>& pyramid) const;
+
+  /////////////////////////////////////////////////////////////////////////
+  /// @brief Detect features on an image pyramid using STAR, one tile per bin
+  /// on the thread pool
+  void detectOnPyramid(const std::vector<cv::Mat>& pyramid,
+                       Keypoints& keypoints, const cv::Mat& mask);
+
+  /////////////////////////////////////////////////////////////////////////
+  /// @brief Detect features on the (tx, ty) tile of every pyramid level and
+  /// keep the strongest ones of the tile
+  Keypoints detectOnTile(const std::vector<cv::Mat>& pyramid,
+                         const std::vector<cv::Mat>& masks,
+                         const cv::Mat& mask, const int tx,
+                         const int ty) const;
 
   /////////////////////////////////////////////////////////////////////////
   /// @brief Compute the orientation independently if using STAR using the ORB
   /// moments method:
   ///        https://gilscvblog.com/2013/10/04/a-tutorial-on-binary-descriptors-part-3-the-orb-descriptor/
-  void computeAngles(const uMat& image, Keypoints& keypoints);
+  void computeAngles(const cv::Mat& image, Keypoints& keypoints) const;
+
+  /////////////////////////////////////////////////////////////////////////
+  /// @brief Compute the ORB descriptors of STAR keypoints on the pyramid they
+  /// were detected on
+  void describeOnPyramid(const std::vector<cv::Mat>& pyramid,
+                         Keypoints& keypoints, cv::Mat& descriptors);
 
   /////////////////////////////////////////////////////////////////////////
   /// @brief Detect features on an image using the default ORB Harris/FAST
@@ -129,7 +160,7 @@ class OrbFeatureExtractor : public BaseFeatureExtractor {
 
   /////////////////////////////////////////////////////////////////////////
   /// @brief Bin keypoints
-  void binKeypoints(const cv::Size& size, Keypoints& keypoints);
+  void binKeypoints(const cv::Size& size, Keypoints& keypoints) const;
 
   /////////////////////////////////////////////////////////////////////////
   /// @brief The ORB configuration.
@@ -142,6 +173,9 @@ class OrbFeatureExtractor : public BaseFeatureExtractor {
 #if defined(HAVE_OPENCV_CUDAFEATURES2D) && CV_MINOR_VERSION > 1
   cv::Ptr<cv::cuda::ORB> cudadetector_;
 #endif  // defined(HAVE_OPENCV_CUDAFEATURES2D)
+
+  /// \brief Persistent workers for the detection tiles and pyramid levels
+  std::shared_ptr<common::thread_pool> pool_;
 };
 
 }  // namespace vision
@@ -0,0 +1,95 @@
+// Copyright 2021, Autonomous Space Robotics Lab (ASRL)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+/**
+ * \file landmark_cache.hpp
+ * \brief VertexLandmarkCache class definition
+ *
+ * \author Autonomous Space Robotics Lab (ASRL)
+ */
+#pragma once
+
+#include <list>
+#include <mutex>
+#include <unordered_map>
+
+#include <vtr_tactic/types.hpp>
+#include <vtr_vision_msgs/msg/rig_landmarks.hpp>
+
+namespace vtr {
+namespace vision {
+
+/**
+ * \brief Bounded LRU of the deserialized landmark messages of recently used
+ * vertices. Shared by landmark recall, migration and matching across frames so
+ * that the localization window is not retrieved from the graph every frame.
+ * Access is thread safe.
+ * \note The cached pointers keep the landmark messages of up to capacity()
+ * vertices alive, even after the graph memory manager unloads those vertices.
+ */
+class VertexLandmarkCache {
+ public:
+  PTR_TYPEDEFS(VertexLandmarkCache);
+
+  using RigLandmarksMsg = vtr_vision_msgs::msg::RigLandmarks;
+  using MsgPtr = std::shared_ptr<RigLandmarksMsg>;
+
+  VertexLandmarkCache(const size_t &capacity) : capacity_(capacity) {}
+
+  /**
+   * \brief Returns the landmarks of rig_name stored at vertex, retrieving them
+   * from the graph on a miss.
+   * \return nullptr if the vertex has no landmarks for this rig
+   */
+  MsgPtr get(const tactic::Vertex::Ptr &vertex, const std::string &rig_name);
+
+  /**
+   * \brief Drops the cached landmarks, e.g. after they have been replaced.
+   * A get of the same landmarks that is retrieving them from the graph at the
+   * same time returns what it retrieved but does not cache it.
+   */
+  void erase(const tactic::VertexId &vid, const std::string &rig_name);
+  void clear();
+
+  size_t size() const;
+  size_t capacity() const { return capacity_; }
+
+ private:
+  using Key = std::pair<tactic::VertexId, std::string>;
+  struct KeyHash {
+    size_t operator()(const Key &key) const {
+      return key.first.hash() ^ (std::hash<std::string>()(key.second) << 1);
+    }
+  };
+  using Entry = std::pair<Key, MsgPtr>;
+  /** \brief a key being retrieved from the graph outside of the lock */
+  struct Pending {
+    /** \brief incremented by every erase of the key */
+    size_t generation = 0;
+    /** \brief number of get calls retrieving the key */
+    size_t readers = 0;
+  };
+
+  const size_t capacity_;
+
+  mutable std::mutex mutex_;
+  /** \brief most recently used entry at the front */
+  std::list<Entry> entries_;
+  std::unordered_map<Key, std::list<Entry>::iterator, KeyHash> index_;
+  /** \brief only the keys that are being retrieved, so it stays small */
+  std::unordered_map<Key, Pending, KeyHash> pending_;
+};
+
+}  // namespace vision
+}  // namespace vtr
@@ -0,0 +1,88 @@
+// Copyright 2021, Autonomous Space Robotics Lab (ASRL)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+/**
+ * \file landmark_view.hpp
+ * \brief Read-only views over stored landmark messages
+ * \details The views wrap the deserialized message buffers and expose points,
+ * covariances and descriptors as Eigen/OpenCV types without copying. A view
+ * is only valid as long as the message it was created from.
+ *
+ * \author Autonomous Space Robotics Lab (ASRL)
+ */
+#pragma once
+
+#include <vtr_vision/messages/bridge.hpp>
+
+namespace vtr {
+namespace messages {
+
+class ChannelLandmarksView {
+ public:
+  using Msg = vtr_vision_msgs::msg::ChannelLandmarks;
+
+  explicit ChannelLandmarksView(const Msg &msg)
+      : msg_(msg), feat_type_(copyDescriptorType(msg.desc_type)) {}
+
+  const Msg &msg() const { return msg_; }
+  const std::string &name() const { return msg_.name; }
+  size_t size() const { return msg_.points.size(); }
+
+  /** \brief the landmark position in the frame of its vertex */
+  Eigen::Vector3d point(const size_t &idx) const {
+    const auto &p = msg_.points[idx];
+    return Eigen::Vector3d(p.x, p.y, p.z);
+  }
+
+  /** \brief whether the landmark has a stored 3x3 covariance */
+  bool hasCovariance(const size_t &idx) const {
+    return 9 * (idx + 1) <= msg_.covariance.size();
+  }
+  Eigen::Map<const Eigen::Matrix3f> covariance(const size_t &idx) const {
+    return Eigen::Map<const Eigen::Matrix3f>(&msg_.covariance[9 * idx]);
+  }
+
+  /** \brief size check for backwards compatibility, valid if not stored */
+  bool valid(const size_t &idx) const {
+    return idx < msg_.valid.size() ? msg_.valid[idx] : true;
+  }
+
+  const vision::FeatureType &featureType() const { return feat_type_; }
+  size_t descriptorSize() const { return feat_type_.bytes_per_desc; }
+  bool hasDescriptor(const size_t &idx) const {
+    return descriptorSize() * (idx + 1) <= msg_.descriptors.size();
+  }
+  const uint8_t *descriptor(const size_t &idx) const {
+    return &msg_.descriptors[descriptorSize() * idx];
+  }
+
+  /**
+   * \brief All descriptors as a (num landmarks x dims) matrix header over the
+   * message buffer. Must not be written to.
+   */
+  cv::Mat descriptors() const {
+    if (msg_.descriptors.empty()) return cv::Mat();
+    const auto cv_type = std::get<0>(featureCvType(feat_type_.impl));
+    return cv::Mat(size(), feat_type_.dims, cv_type,
+                   const_cast<uint8_t *>(msg_.descriptors.data()),
+                   descriptorSize());
+  }
+
+ private:
+  const Msg &msg_;
+  const vision::FeatureType feat_type_;
+};
+
+}  // namespace messages
+}  // namespace vtr
@@ -189,6 +189,9 @@ class LandmarkRecallModule : public tactic::BaseModule {
   std::map<tactic::VertexId, std::shared_ptr<vtr_vision_msgs::msg::RigLandmarks>>
       vertex_landmarks_;
 
+  /** \brief the pipeline's landmark cache for the current frame, if any */
+  VertexLandmarkCache::Ptr landmark_cache_;
+
   /**
    * \brief a map that keeps track of vehicle-frame transforms between vertex
    * ids.
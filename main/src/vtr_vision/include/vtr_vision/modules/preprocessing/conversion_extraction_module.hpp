@@ -94,6 +94,9 @@ class ConversionExtractionModule : public tactic::BaseModule {
 
     /** \brief Flag to determine whether feature matches should be displayed*/
     bool visualize = false;
+
+    /** \brief Number of threads extracting cameras and channels in parallel */
+    int num_threads = 4;
   };
 
 
@@ -123,6 +126,9 @@ class ConversionExtractionModule : public tactic::BaseModule {
   std::shared_ptr<BaseFeatureExtractor> extractor_;
   std::shared_ptr<BaseFeatureExtractor> extractor_learned_;
 
+  /** \brief Extraction workers, kept across frames */
+  std::shared_ptr<common::thread_pool> pool_;
+
   VTR_REGISTER_MODULE_DEC_TYPE(ConversionExtractionModule);
 
 };
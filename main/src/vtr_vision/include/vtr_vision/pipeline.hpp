@@ -65,6 +65,8 @@ class StereoPipeline : public tactic::BasePipeline {
     std::vector<std::string> odometry;
     std::vector<std::string> localization;
     std::vector<std::string> bundle_adjustment;
+    /** \brief number of vertices whose landmarks are kept across frames */
+    int landmark_cache_size = 256;
 
 
     static ConstPtr fromROS(const rclcpp::Node::SharedPtr &node,
@@ -240,6 +242,9 @@ tactic::EdgeTransform estimateTransformFromKeyframe(
   std::vector<tactic::BaseModule::Ptr> localization_;
   std::vector<tactic::BaseModule::Ptr> bundle_adjustment_;
 
+  /** \brief landmarks shared by recall, migration and matching modules */
+  VertexLandmarkCache::Ptr landmark_cache_;
+
 
   std::mutex bundle_adjustment_mutex_ = std::mutex();
   std::future<void> bundle_adjustment_thread_future_;
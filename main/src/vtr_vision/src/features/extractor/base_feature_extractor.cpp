@@ -19,8 +19,6 @@
  *
  * \author Autonomous Space Robotics Lab (ASRL)
  */
-#include <list>
-
 #include <vtr_logging/logging.hpp>
 #include <vtr_vision/features/extractor/base_feature_extractor.hpp>
 
@@ -145,8 +143,29 @@ ChannelExtra BFE::extractFeaturesExtra(const ChannelImages &channel) {
 
 ChannelFeatures BFE::extractChannelFeatures(const ChannelImages &channel,
                                             bool fully_matched = false) {
-  if (fully_matched && channel.cameras.size() == 2)
-    return extractStereoFeatures(channel);
+  return dispatchChannelFeatures(channel, fully_matched).get();
+}
+
+std::future<ChannelFeatures> BFE::dispatchChannelFeatures(
+    const ChannelImages &channel, bool fully_matched) {
+  if (fully_matched && channel.cameras.size() == 2) {
+    if (!matchesStereoSeparately())
+      return dispatch(
+          [this, &channel]() { return extractStereoFeatures(channel); });
+    // both cameras run on the pool, the matching runs on the caller
+    return std::async(
+        std::launch::deferred,
+        [this, &channel, futures = dispatchCameraFeatures(channel)]() mutable {
+          const auto left = futures[0].get();
+          const auto right = futures[1].get();
+          auto features = matchStereoFeatures(left, right);
+          features.name = channel.name;
+          features.fully_matched = true;
+          features.cameras[0].name = left.name;
+          features.cameras[1].name = right.name;
+          return features;
+        });
+  }
 
   ChannelFeatures features;
   features.name = channel.name;
@@ -154,17 +173,35 @@ ChannelFeatures BFE::extractChannelFeatures(const ChannelImages &channel,
 
   // If this is not an 8-bit grayscale image, then return an empty feature list.
   if (!channel.cameras.empty() && channel.cameras[0].data.type() != CV_8UC1) {
-    return features;
+    std::promise<ChannelFeatures> empty;
+    empty.set_value(features);
+    return empty.get_future();
   }
 
-  features.cameras.reserve(channel.cameras.size());
-  std::list<std::future<Features>> futures;
-  Features (My_t::*doit)(const Image &) = &My_t::extractFeatures;
-  for (auto &cam : channel.cameras)
-    futures.emplace_back(std::async(std::launch::async, doit, this, cam));
-  for (auto &fut : futures) features.cameras.push_back(fut.get());
+  // the cameras are collected by the caller, the pool jobs never wait
+  return std::async(
+      std::launch::deferred,
+      [features, futures = dispatchCameraFeatures(channel)]() mutable {
+        features.cameras.reserve(futures.size());
+        for (auto &fut : futures) features.cameras.push_back(fut.get());
+        return features;
+      });
+}
 
-  return features;
+ChannelFeatures BFE::matchStereoFeatures(const Features &,
+                                         const Features &) {
+  throw std::logic_error(
+      "This feature extractor does not match stereo features separately.");
+}
+
+std::vector<std::future<Features>> BFE::dispatchCameraFeatures(
+    const ChannelImages &channel) {
+  std::vector<std::future<Features>> futures;
+  futures.reserve(channel.cameras.size());
+  for (auto &cam : channel.cameras)
+    futures.emplace_back(
+        dispatch([this, &cam]() { return extractFeatures(cam); }));
+  return futures;
 }
 
 ChannelFeatures BFE::extractChannelFeaturesDisp(
@@ -184,12 +221,8 @@ ChannelFeatures BFE::extractChannelFeaturesDisp(
   }
 
   features.cameras.reserve(channel.cameras.size());
-  std::list<std::future<Features>> futures;
-  Features (My_t::*doit)(const Image &) =
-      &My_t::extractFeatures;
-  for (auto &cam : channel.cameras)
-    futures.emplace_back(std::async(std::launch::async, doit, this, cam));
-  for (auto &fut : futures) features.cameras.push_back(fut.get());
+  for (auto &fut : dispatchCameraFeatures(channel))
+    features.cameras.push_back(fut.get());
 
   return features;
 }
@@ -210,12 +243,8 @@ ChannelFeatures BFE::extractChannelFeaturesDispExtra(
   }
 
   features.cameras.reserve(channel.cameras.size());
-  std::list<std::future<Features>> futures;
-  Features (My_t::*doit)(const Image &) =
-      &My_t::extractFeatures;
-  for (auto &cam : channel.cameras)
-    futures.emplace_back(std::async(std::launch::async, doit, this, cam));
-  for (auto &fut : futures) features.cameras.push_back(fut.get());
+  for (auto &fut : dispatchCameraFeatures(channel))
+    features.cameras.push_back(fut.get());
 
   return features;
 }
@@ -232,12 +261,11 @@ RigFeatures BFE::extractRigFeatures(const RigImages &rig,
   features.name = rig.name;
   features.channels.reserve(rig.channels.size());
 
-  std::list<std::future<ChannelFeatures>> futures;
-  ChannelFeatures (My_t::*doit)(const ChannelImages &, bool) =
-      &My_t::extractChannelFeatures;
+  // queue every channel before waiting, so that all cameras run together
+  std::vector<std::future<ChannelFeatures>> futures;
+  futures.reserve(rig.channels.size());
   for (auto &chan : rig.channels)
-    futures.emplace_back(
-        std::async(std::launch::async, doit, this, chan, fully_matched));
+    futures.emplace_back(dispatchChannelFeatures(chan, fully_matched));
   for (auto &fut : futures) features.channels.push_back(fut.get());
 
   return features;
@@ -19,6 +19,8 @@
  *
  * \author Autonomous Space Robotics Lab (ASRL)
  */
+#include <algorithm>
+#include <array>
 #include <cmath>
 
 #include <vtr_logging/logging.hpp>
@@ -30,9 +32,27 @@ namespace vision {
 
 using OFE = OrbFeatureExtractor;
 
+namespace {
+
+/// \brief keeps the n strongest keypoints, in no particular order
+void retainStrongest(Keypoints &keypoints, const size_t n) {
+  if (keypoints.size() <= n) return;
+  std::nth_element(keypoints.begin(), keypoints.begin() + n, keypoints.end(),
+                   [](const cv::KeyPoint &k1, const cv::KeyPoint &k2) {
+                     return k1.response > k2.response;
+                   });
+  keypoints.resize(n);
+}
+
+}  // namespace
+
 void OFE::initialize(const ORBConfiguration &config) {
   config_ = config;
 
+  // sanity check
+  config_.x_bins_ = std::max(1, config_.x_bins_);
+  config_.y_bins_ = std::max(1, config_.y_bins_);
+
   detector_ = cv::ORB::create(
       config_.num_detector_features_, config_.scaleFactor_, config_.nlevels_,
       config_.edgeThreshold_, config_.firstLevel_, config_.WTA_K_,
@@ -50,32 +70,98 @@ void OFE::initialize(const ORBConfiguration &config) {
       config_.edgeThreshold_, config_.firstLevel_, config_.WTA_K_,
       config_.scoreType_, config_.patchSize_, config_.fastThreshold_, true);
 #endif  // defined(HAVE_OPENCV_CUDAFEATURES2D)
+
+  pool_ = std::make_shared<common::thread_pool>(config_.num_threads_);
 }
 
 /////////////////////////////////////////////////////////////////////////
-/// @brief Detect features on an image pyramid using STAR
-void OFE::detectOnPyramid(const uMat &image, Keypoints &keypoints,
-                          const cv::Mat &mask) {
-  int &maxLevel = config_.nlevels_;
-
-  // set up a temporary keypoints storage
-  keypoints.reserve(config_.num_detector_features_);
-
-  uMat src = image;
-  cv::Mat src_mask = mask;
-  cv::Mat dilated_mask;
+/// @brief Build the image pyramid used by both STAR and the descriptors
+void OFE::buildPyramid(const cv::Mat &image,
+                       std::vector<cv::Mat> &pyramid) const {
+  pyramid.resize(config_.nlevels_ + 1);
+  pyramid[0] = image;
+  for (size_t l = 1; l < pyramid.size(); ++l)
+    cv::pyrDown(pyramid[l - 1], pyramid[l]);
+}
 
+/////////////////////////////////////////////////////////////////////////
+/// @brief Detect features on an image pyramid using STAR
+void OFE::detectOnPyramid(const std::vector<cv::Mat> &pyramid,
+                          Keypoints &keypoints, const cv::Mat &mask) {
+  // mask of every level, the bottom one is used as is
+  std::vector<cv::Mat> masks;
   if (!mask.empty()) {
+    cv::Mat dilated_mask;
     dilate(mask, dilated_mask, cv::Mat());
     cv::Mat mask255(mask.size(), CV_8UC1, cv::Scalar(0));
     mask255.setTo(cv::Scalar(255), dilated_mask != 0);
-    dilated_mask = mask255;
+    masks.resize(pyramid.size());
+    masks[0] = mask;
+    for (size_t l = 1; l < pyramid.size(); ++l)
+      cv::resize(mask255, masks[l], pyramid[l].size(), 0, 0,
+                 cv::INTER_AREA);  // vtr3 change: opencv 4+
   }
-  // for each pyramid level...
-  for (int l = 0, multiplier = 1; l <= maxLevel; ++l, multiplier *= 2) {
-    std::vector<cv::KeyPoint> new_pts;
+
+  // one tile per bin, each keeps its own strongest keypoints
+  std::vector<std::future<Keypoints>> tiles;
+  tiles.reserve(config_.x_bins_ * config_.y_bins_);
+  for (int ty = 0; ty < config_.y_bins_; ++ty)
+    for (int tx = 0; tx < config_.x_bins_; ++tx)
+      tiles.emplace_back(pool_->dispatch([&, tx, ty] {
+        return detectOnTile(pyramid, masks, mask, tx, ty);
+      }));
+
+  keypoints.reserve(config_.num_detector_features_);
+  for (auto &tile : tiles) {
+    const auto tile_keypoints = tile.get();
+    keypoints.insert(keypoints.end(), tile_keypoints.begin(),
+                     tile_keypoints.end());
+  }
+
+  // now place the upper cap on the number of features
+  retainStrongest(keypoints, config_.num_binned_features_);
+}
+
+/////////////////////////////////////////////////////////////////////////
+/// @brief Detect features on one tile of every pyramid level using STAR
+Keypoints OFE::detectOnTile(const std::vector<cv::Mat> &pyramid,
+                            const std::vector<cv::Mat> &masks,
+                            const cv::Mat &mask, const int tx,
+                            const int ty) const {
+  // extra pixels around the tile so that the STAR filters and non-max
+  // suppression see the same neighborhood as on the whole image
+  const int margin =
+      2 * (config_.STAR_maxSize_ + config_.STAR_suppressNonmaxSize_);
+
+  Keypoints keypoints;
+  for (size_t l = 0, multiplier = 1; l < pyramid.size(); ++l, multiplier *= 2) {
+    const auto &src = pyramid[l];
+
+    // the part of this level owned by the tile
+    const int x0 = tx * src.cols / config_.x_bins_;
+    const int x1 = (tx + 1) * src.cols / config_.x_bins_;
+    const int y0 = ty * src.rows / config_.y_bins_;
+    const int y1 = (ty + 1) * src.rows / config_.y_bins_;
+    const cv::Rect roi = cv::Rect(x0 - margin, y0 - margin,
+                                  x1 - x0 + 2 * margin, y1 - y0 + 2 * margin) &
+                         cv::Rect(0, 0, src.cols, src.rows);
+    if (roi.empty()) continue;
+
     // detect on current level of the pyramid
-    stardetector_->detect(src, new_pts, src_mask);
+    std::vector<cv::KeyPoint> new_pts;
+    stardetector_->detect(src(roi), new_pts,
+                          masks.empty() ? cv::Mat() : masks[l](roi));
+
+    // back to level coordinates, dropping the ones owned by other tiles
+    auto it = new_pts.begin();
+    for (auto &pt : new_pts) {
+      pt.pt.x += roi.x;
+      pt.pt.y += roi.y;
+      if (pt.pt.x < x0 || pt.pt.x >= x1 || pt.pt.y < y0 || pt.pt.y >= y1)
+        continue;
+      *it++ = pt;
+    }
+    new_pts.erase(it, new_pts.end());
 
     // filter by the patch size
     cv::KeyPointsFilter::runByImageBorder(new_pts, src.size(),
@@ -87,58 +173,92 @@ void OFE::detectOnPyramid(const uMat &image, Keypoints &keypoints,
     }
     // ensure the keypoint is placed in the correct position at the bottom level
     // of the pyramid
-    std::vector<cv::KeyPoint>::iterator it = new_pts.begin(),
-                                        end = new_pts.end();
-    for (; it != end; ++it) {
-      it->pt.x *= multiplier;
-      it->pt.y *= multiplier;
-      it->size *= multiplier;
-      it->octave = l;
+    for (auto &pt : new_pts) {
+      pt.pt.x *= multiplier;
+      pt.pt.y *= multiplier;
+      pt.size *= multiplier;
+      pt.octave = l;
     }
 
     // append to the list of keypoints
     keypoints.insert(keypoints.end(), new_pts.begin(), new_pts.end());
-
-    // downsample the image using the pyramid
-    if (l < maxLevel) {
-      uMat dst;
-      cv::pyrDown(src, dst);
-      src = dst;
-
-      if (!mask.empty()) {
-        cv::resize(dilated_mask, src_mask, src.size(), 0, 0,
-                   cv::INTER_AREA);  // vtr3 change: opencv 4+
-      }
-    }
   }
   if (!mask.empty()) {
     cv::KeyPointsFilter::runByPixelsMask(keypoints, mask);
   }
 
-  // bin the keypoints
-  binKeypoints(image.size(), keypoints);
-}
+  // slightly inflate the number per bucket that we need
+  const size_t desired_num_per_bucket = 1.2 * config_.num_binned_features_ /
+                                        (config_.x_bins_ * config_.y_bins_);
+  retainStrongest(keypoints, desired_num_per_bucket);
+
+  // force keypoints to be upright if the config calls for it
+  if (config_.upright_)
+    for (auto &keypoint : keypoints) keypoint.angle = -1;
 
-void OFE::computeAngles(const uMat &image, Keypoints &keypoints) {
-  cv::Mat accessor = image.getMat(cv::ACCESS_READ);
+  return keypoints;
+}
 
+void OFE::computeAngles(const cv::Mat &image, Keypoints &keypoints) const {
   const int halfPatchSize = 9;  // maximum allowable size by STAR detector
-  size_t ptidx, ptsize = keypoints.size();
   // for each keypoint, sum up the moments
-#pragma omp parallel for num_threads(config_.num_threads_)
-  for (ptidx = 0; ptidx < ptsize; ptidx++) {
+  for (auto &keypoint : keypoints) {
     int m_01 = 0, m_10 = 0;
     for (int u = -halfPatchSize; u <= halfPatchSize; ++u) {
       for (int v = -halfPatchSize; v <= halfPatchSize; ++v) {
-        m_10 += u * accessor.at<uchar>(keypoints[ptidx].pt.y + v,
-                                       keypoints[ptidx].pt.x + u);
-        m_01 += v * accessor.at<uchar>(keypoints[ptidx].pt.y + v,
-                                       keypoints[ptidx].pt.x + u);
+        m_10 += u * image.at<uchar>(keypoint.pt.y + v, keypoint.pt.x + u);
+        m_01 += v * image.at<uchar>(keypoint.pt.y + v, keypoint.pt.x + u);
       }
     }
     // calculate the orientation from the moments
-    keypoints[ptidx].angle = cv::fastAtan2((float)m_01, (float)m_10);
+    keypoint.angle = cv::fastAtan2((float)m_01, (float)m_10);
+  }
+}
+
+/////////////////////////////////////////////////////////////////////////
+/// @brief Compute the ORB descriptors of STAR keypoints on the pyramid they
+/// were detected on
+void OFE::describeOnPyramid(const std::vector<cv::Mat> &pyramid,
+                            Keypoints &keypoints, cv::Mat &descriptors) {
+  // split the keypoints by octave, in the coordinates of their own level. ORB
+  // only builds the levels up to the largest octave it is given, so with
+  // octave 0 it describes directly on the level we hand it
+  std::vector<Keypoints> level_keypoints(pyramid.size());
+  for (const auto &keypoint : keypoints) {
+    auto &level = level_keypoints[keypoint.octave].emplace_back(keypoint);
+    const float scale = 1.f / (1 << keypoint.octave);
+    level.pt *= scale;
+    level.size *= scale;
+    level.octave = 0;
+  }
+
+  std::vector<cv::Mat> level_descriptors(pyramid.size());
+  std::vector<std::future<void>> levels;
+  for (size_t l = 0; l < pyramid.size(); ++l) {
+    if (level_keypoints[l].empty()) continue;
+    levels.emplace_back(pool_->dispatch([&, l] {
+      detector_->compute(pyramid[l], level_keypoints[l], level_descriptors[l]);
+    }));
+  }
+  for (auto &level : levels) level.get();
+
+  // some keypoints may be removed by the descriptor computation
+  keypoints.clear();
+  std::vector<cv::Mat> nonempty_descriptors;
+  for (size_t l = 0, multiplier = 1; l < pyramid.size(); ++l, multiplier *= 2) {
+    for (auto &keypoint : level_keypoints[l]) {
+      keypoint.pt *= (float)multiplier;
+      keypoint.size *= multiplier;
+      keypoint.octave = l;
+      keypoints.push_back(keypoint);
+    }
+    if (!level_descriptors[l].empty())
+      nonempty_descriptors.push_back(level_descriptors[l]);
   }
+  if (nonempty_descriptors.empty())
+    descriptors.release();
+  else
+    cv::vconcat(nonempty_descriptors, descriptors);
 }
 
 /////////////////////////////////////////////////////////////////////////
@@ -158,78 +278,58 @@ void OFE::detectWithORB(const uMat &image, Keypoints &keypoints,
   binKeypoints(image.size(), keypoints);
 }
 
-void OFE::binKeypoints(const cv::Size &size, Keypoints &keypoints) {
-  // sanity check
-  config_.x_bins_ = std::max(1, config_.x_bins_);
-  config_.y_bins_ = std::max(1, config_.y_bins_);
-
+void OFE::binKeypoints(const cv::Size &size, Keypoints &keypoints) const {
   // figure out the number of buckets we need
-  unsigned num_buckets = config_.x_bins_ * config_.y_bins_;
+  const int num_buckets = config_.x_bins_ * config_.y_bins_;
 
   // slightly inflate the number per bucket that we need
-  unsigned desired_num_per_bucket =
+  const size_t desired_num_per_bucket =
       1.2 * config_.num_binned_features_ / num_buckets;
 
   // determine how many pixels there are in each bin
-  float pixels_per_bin_x = float(size.width) / config_.x_bins_;
-  float pixels_per_bin_y = float(size.height) / config_.y_bins_;
-
-  // keep a record of the keypoints we bin
-  std::map<std::pair<unsigned, unsigned>, std::vector<cv::KeyPoint *> >
-      binned_keypoints;
-
-  // make a new keypoints container
-  Keypoints keypoints_new;
-  keypoints_new.reserve(keypoints.size());
-
-  for (auto &keypoint : keypoints) {
-    unsigned bx = std::floor(keypoint.pt.x / pixels_per_bin_x);
-    unsigned by = std::floor(keypoint.pt.y / pixels_per_bin_y);
-    std::pair<unsigned, unsigned> pair(bx, by);
-    binned_keypoints[pair].reserve(config_.num_detector_features_ /
-                                   num_buckets);
-    binned_keypoints[pair].push_back(&keypoint);
+  const float pixels_per_bin_x = float(size.width) / config_.x_bins_;
+  const float pixels_per_bin_y = float(size.height) / config_.y_bins_;
+
+  // counting sort of the keypoints by bucket
+  std::vector<int> buckets(keypoints.size());
+  std::vector<size_t> offsets(num_buckets + 1, 0);
+  for (size_t i = 0; i < keypoints.size(); ++i) {
+    const int bx = std::clamp<int>(keypoints[i].pt.x / pixels_per_bin_x, 0,
+                                   config_.x_bins_ - 1);
+    const int by = std::clamp<int>(keypoints[i].pt.y / pixels_per_bin_y, 0,
+                                   config_.y_bins_ - 1);
+    buckets[i] = by * config_.x_bins_ + bx;
+    ++offsets[buckets[i] + 1];
   }
+  for (int b = 0; b < num_buckets; ++b) offsets[b + 1] += offsets[b];
 
-  for (int ii = 0; ii < config_.x_bins_; ii++) {
-    for (int jj = 0; jj < config_.y_bins_; jj++) {
-      std::pair<unsigned, unsigned> pair(ii, jj);
-      if (binned_keypoints[pair].size() > desired_num_per_bucket) {
-        std::sort(binned_keypoints[pair].begin(), binned_keypoints[pair].end(),
-                  [&](const cv::KeyPoint *k1, const cv::KeyPoint *k2) {
-                    return k1->response > k2->response;
-                  });
-        binned_keypoints[pair].resize(desired_num_per_bucket);
-      }
-      for (unsigned kk = 0; kk < binned_keypoints[pair].size(); kk++) {
-        // force keypoints to be upright if the config calls for it
-        if (config_.upright_) {
-          binned_keypoints[pair][kk]->angle = -1;
-        }
-        keypoints_new.push_back(*binned_keypoints[pair][kk]);
-      }
-    }
+  Keypoints binned_keypoints(keypoints.size());
+  {
+    auto next = offsets;
+    for (size_t i = 0; i < keypoints.size(); ++i)
+      binned_keypoints[next[buckets[i]]++] = keypoints[i];
   }
 
-  // now place the upper cap on the number of features
-  std::sort(keypoints_new.begin(), keypoints_new.end(),
-            [&](const cv::KeyPoint &k1, const cv::KeyPoint &k2) {
-              return k1.response > k2.response;
-            });
-  if ((int)keypoints_new.size() > config_.num_binned_features_) {
-    keypoints_new.resize(config_.num_binned_features_);
+  // keep the strongest of each bucket
+  keypoints.clear();
+  for (int b = 0; b < num_buckets; ++b) {
+    Keypoints bucket(binned_keypoints.begin() + offsets[b],
+                     binned_keypoints.begin() + offsets[b + 1]);
+    retainStrongest(bucket, desired_num_per_bucket);
+    keypoints.insert(keypoints.end(), bucket.begin(), bucket.end());
   }
 
-  // clear out and copy new keypoints
-  keypoints.clear();
-  keypoints = keypoints_new;
+  // force keypoints to be upright if the config calls for it
+  if (config_.upright_)
+    for (auto &keypoint : keypoints) keypoint.angle = -1;
+
+  // now place the upper cap on the number of features
+  retainStrongest(keypoints, config_.num_binned_features_);
 }
 
 ////////////////////////////////////////////////////////////////////////////////
 /// @brief Extracts a list of descriptors and keypoints from a single image.
 Features OFE::extractFeatures(const cv::Mat &image) {
-  uMat uimage;
-  image.copyTo(uimage);
   // create a new empty frame
   Features frame;
   frame.keypoints.reserve(config_.num_detector_features_);
@@ -241,11 +341,16 @@ Features OFE::extractFeatures(const cv::Mat &image) {
   cv::Mat mask;
 
   // do the detection
+  std::vector<cv::Mat> pyramid;
+  uMat uimage;
   if (config_.use_STAR_detector_) {
-    // use the STAR detector on a pyramid
-    detectOnPyramid(uimage, frame.keypoints, mask);
+    // use the STAR detector on a pyramid, kept for the descriptors
+    buildPyramid(image, pyramid);
+    detectOnPyramid(pyramid, frame.keypoints, mask);
   } else {
-    // use ORB's default HARRIS or FAST detectors
+    // use ORB's default HARRIS or FAST detectors, the UMat shares the image
+    // buffer instead of copying it
+    uimage = image.getUMat(cv::ACCESS_READ);
     detectWithORB(uimage, frame.keypoints, mask);
   }
 
@@ -271,6 +376,8 @@ Features OFE::extractFeatures(const cv::Mat &image) {
            "use the GPU for descriptor generation, but OpenCV wasn't built "
            "with this support configured!";
 #endif  // defined(HAVE_OPENCV_CUDAFEATURES2D)
+  } else if (config_.use_STAR_detector_) {
+    describeOnPyramid(pyramid, frame.keypoints, frame.descriptors);
   } else {
     detector_->compute(uimage, frame.keypoints, frame.descriptors);
   }
@@ -304,19 +411,18 @@ Features OFE::extractFeatures(const cv::Mat &image) {
 /// rectified stereo images.
 ChannelFeatures OFE::extractStereoFeatures(const cv::Mat &left_img,
                                            const cv::Mat &right_img) {
-  // create a new empty frame
-  ChannelFeatures features_temp;
-  features_temp.cameras.reserve(2);
-
-  // make two asynchronous calls to extract the features
-  Features (BaseFeatureExtractor::*extract_func)(const cv::Mat &) =
-      &BaseFeatureExtractor::extractFeatures;
-  auto handle_left =
-      std::async(std::launch::async, extract_func, this, left_img);
-  auto handle_right =
-      std::async(std::launch::async, extract_func, this, right_img);
-  features_temp.cameras.push_back(handle_left.get());
-  features_temp.cameras.push_back(handle_right.get());
+  // both images are extracted on the extraction pool
+  auto left = dispatch([&] { return extractFeatures(left_img); });
+  auto right = dispatch([&] { return extractFeatures(right_img); });
+  return matchStereoFeatures(left.get(), right.get());
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Keeps the features of a rectified stereo pair that match, index
+/// aligned.
+ChannelFeatures OFE::matchStereoFeatures(const Features &left,
+                                         const Features &right) {
+  const std::array<const Features *, 2> features_temp{&left, &right};
 
   // We need to match for the stereo case
   vtr::vision::ASRLFeatureMatcher::Config matcher_config =
@@ -332,14 +438,13 @@ ChannelFeatures OFE::extractStereoFeatures(const cv::Mat &left_img,
   features.cameras.resize(2);
   auto cam_rng = {0, 1};
   for (auto &i : cam_rng)
-    features.cameras[i].feat_type = features_temp.cameras[i].feat_type;
+    features.cameras[i].feat_type = features_temp[i]->feat_type;
 
   // perform matching
   SimpleMatches matches;
   if (calib_.rectified || calib_.extrinsics.size() < 2) {
     // if the rig is rectified or not set, just do regular stereo matching
-    matches = matcher.matchStereoFeatures(features_temp.cameras[0],
-                                          features_temp.cameras[1]);
+    matches = matcher.matchStereoFeatures(left, right);
   } else {
     // if not rectified, we need to do epipolar matching
     auto tf = calib_.extrinsics[0].inverse() * calib_.extrinsics[1];
@@ -359,8 +464,7 @@ ChannelFeatures OFE::extractStereoFeatures(const cv::Mat &left_img,
     Eigen::Matrix3d F = K1it * tf.C_ba() * K0.transpose() * KrtTcross;
 
     // do matching
-    matches = matcher.matchFeatures(features_temp.cameras[0],
-                                    features_temp.cameras[1], F,
+    matches = matcher.matchFeatures(left, right, F,
                                     matcher_config.stereo_x_tolerance_min_,
                                     matcher_config.stereo_x_tolerance_max_,
                                     matcher_config.stereo_y_tolerance_,
@@ -368,8 +472,8 @@ ChannelFeatures OFE::extractStereoFeatures(const cv::Mat &left_img,
   }
 
   // reserve the corresponding vectors to match
-  const auto &desc_cols = features_temp.cameras[0].descriptors.cols;
-  const auto &desc_cvtype = features_temp.cameras[0].descriptors.type();
+  const auto &desc_cols = left.descriptors.cols;
+  const auto &desc_cvtype = left.descriptors.type();
   for (unsigned j : cam_rng) {
     Features &j_feat = features.cameras[j];
     j_feat.keypoints.reserve(matches.size());
@@ -383,7 +487,7 @@ ChannelFeatures OFE::extractStereoFeatures(const cv::Mat &left_img,
     for (unsigned j : cam_rng) {
       const auto &temp_idx = j == 0 ? matches[i].first : matches[i].second;
       Features &j_feat = features.cameras[j];
-      Features &j_temp_feat = features_temp.cameras[j];
+      const Features &j_temp_feat = *features_temp[j];
       j_feat.keypoints.push_back(j_temp_feat.keypoints[temp_idx]);
       j_feat.feat_infos.push_back(j_temp_feat.feat_infos[temp_idx]);
       j_temp_feat.descriptors.row(temp_idx).copyTo(j_feat.descriptors.row(i));
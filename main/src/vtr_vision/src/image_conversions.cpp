@@ -88,7 +88,7 @@ ChannelImages RGB2Grayscale(const ChannelImages &src) {
   std::list<std::future<Image>> futures;
   auto func = static_cast<Image (*)(const Image &)>(&RGB2Grayscale);
   for (const auto &image : src.cameras) {
-    futures.emplace_back(std::async(std::launch::async, func, image));
+    futures.emplace_back(std::async(std::launch::async, func, std::ref(image)));
   }
 
   // Wait until completion and add to the destination channel.
@@ -0,0 +1,100 @@
+// Copyright 2021, Autonomous Space Robotics Lab (ASRL)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+/**
+ * \file landmark_cache.cpp
+ * \brief VertexLandmarkCache class methods definition
+ *
+ * \author Autonomous Space Robotics Lab (ASRL)
+ */
+#include <vtr_vision/landmark_cache.hpp>
+
+namespace vtr {
+namespace vision {
+
+auto VertexLandmarkCache::get(const tactic::Vertex::Ptr &vertex,
+                              const std::string &rig_name) -> MsgPtr {
+  const Key key{vertex->id(), rig_name};
+  size_t generation = 0;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    const auto it = index_.find(key);
+    if (it != index_.end()) {
+      entries_.splice(entries_.begin(), entries_, it->second);
+      return it->second->second;
+    }
+    // record the generation so that an erase during retrieval is noticed
+    auto &pending = pending_[key];
+    ++pending.readers;
+    generation = pending.generation;
+  }
+
+  // retrieve outside of the lock, may load from disk
+  MsgPtr landmarks;
+  auto locked_landmark_msg = vertex->retrieve<RigLandmarksMsg>(
+      rig_name + "_landmarks", "vtr_vision_msgs/msg/RigLandmarks");
+  if (locked_landmark_msg != nullptr) {
+    auto locked_msg = locked_landmark_msg->sharedLocked();
+    landmarks = locked_msg.get().getDataPtr();
+  }
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  const auto pending = pending_.find(key);
+  const bool erased = pending->second.generation != generation;
+  if (--pending->second.readers == 0) pending_.erase(pending);
+  // the landmarks may have been replaced (e.g. by bundle adjustment) after we
+  // retrieved them, so do not pin a possibly stale message in the cache
+  if (landmarks == nullptr || capacity_ == 0 || erased) return landmarks;
+
+  const auto it = index_.find(key);
+  if (it != index_.end()) {
+    // inserted by another thread in the meantime
+    entries_.splice(entries_.begin(), entries_, it->second);
+    return it->second->second;
+  }
+  entries_.emplace_front(key, landmarks);
+  index_.emplace(key, entries_.begin());
+  if (entries_.size() > capacity_) {
+    index_.erase(entries_.back().first);
+    entries_.pop_back();
+  }
+  return landmarks;
+}
+
+void VertexLandmarkCache::erase(const tactic::VertexId &vid,
+                                const std::string &rig_name) {
+  const Key key{vid, rig_name};
+  std::lock_guard<std::mutex> lock(mutex_);
+  const auto pending = pending_.find(key);
+  if (pending != pending_.end()) ++pending->second.generation;
+  const auto it = index_.find(key);
+  if (it == index_.end()) return;
+  entries_.erase(it->second);
+  index_.erase(it);
+}
+
+void VertexLandmarkCache::clear() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  for (auto &pending : pending_) ++pending.second.generation;
+  entries_.clear();
+  index_.clear();
+}
+
+size_t VertexLandmarkCache::size() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return entries_.size();
+}
+
+}  // namespace vision
+}  // namespace vtr
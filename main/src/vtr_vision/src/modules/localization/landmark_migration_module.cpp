@@ -25,6 +25,7 @@
 #include <vtr_common/timing/stopwatch.hpp>
 #include <vtr_pose_graph/evaluator/evaluators.hpp>
 #include <vtr_pose_graph/path/pose_cache.hpp>
+#include <vtr_vision/messages/landmark_view.hpp>
 #include <vtr_vision/types.hpp>
 #include <vtr_vision/modules/localization/landmark_migration_module.hpp>
 
@@ -154,10 +155,17 @@ void LandmarkMigrationModule::run_(tactic::QueryCache &qdata0, tactic::OutputCac
     auto curr_vertex = graph->at(curr_vid);
 
     //curr_vertex->load(lm_stream_name);
-    auto locked_landmark_msg = curr_vertex->retrieve<vtr_vision_msgs::msg::RigLandmarks>(
-            lm_stream_name, "vtr_vision_msgs/msg/RigLandmarks");
-    auto locked_msg = locked_landmark_msg->sharedLocked();
-    auto landmarks = locked_msg.get().getDataPtr();
+    std::shared_ptr<vtr_vision_msgs::msg::RigLandmarks> landmarks;
+    if (qdata.landmark_cache.valid()) {
+      landmarks = qdata.landmark_cache->get(curr_vertex, rig_name);
+    } else {
+      auto locked_landmark_msg = curr_vertex->retrieve<vtr_vision_msgs::msg::RigLandmarks>(
+              lm_stream_name, "vtr_vision_msgs/msg/RigLandmarks");
+      if (locked_landmark_msg != nullptr) {
+        auto locked_msg = locked_landmark_msg->sharedLocked();
+        landmarks = locked_msg.get().getDataPtr();
+      }
+    }
     if (landmarks == nullptr) {
       std::stringstream err;
       err << "Landmarks at " << curr_vertex->id() << " for " << rig_name
@@ -247,40 +255,38 @@ void LandmarkMigrationModule::migrate(
   // 3. Iterate through each set of landmarks and transform the points.
   for (unsigned channel_idx = 0; channel_idx < landmarks->channels.size();
        ++channel_idx) {
-    auto channel_landmarks = landmarks->channels[channel_idx];
+    // read the points and covariances directly from the message
+    const messages::ChannelLandmarksView channel_landmarks(
+        landmarks->channels[channel_idx]);
+    const auto num_landmarks = channel_landmarks.size();
 
     int matrix_offset = migrated_points.cols();
     // resize the matrix of migrated points to accomidate this batch of
     // landmarks.
-    migrated_points.conservativeResize(
-        Eigen::NoChange, matrix_offset + channel_landmarks.points.size());
-    migrated_covariance.conservativeResize(
-        Eigen::NoChange, matrix_offset + channel_landmarks.points.size());
-
-    for (unsigned lm_idx = 0; lm_idx < channel_landmarks.points.size();
-         ++lm_idx) {
-      bool validity = true;
-      if (channel_landmarks.valid.size() > 0) {
-        // get the validity
-        validity = channel_landmarks.valid[lm_idx];
-      }
+    migrated_points.conservativeResize(Eigen::NoChange,
+                                       matrix_offset + num_landmarks);
+    migrated_covariance.conservativeResize(Eigen::NoChange,
+                                           matrix_offset + num_landmarks);
+
+    for (unsigned lm_idx = 0; lm_idx < num_landmarks; ++lm_idx) {
+      // get the validity
+      const bool validity = channel_landmarks.valid(lm_idx);
 
       // placeholder for migrated point
       Eigen::Vector4d migrated_point = Eigen::Vector3d::Zero().homogeneous();
       if (validity) {
         // Transform the point
-        const auto &point_msg = channel_landmarks.points[lm_idx];
-        Eigen::Vector3d point(point_msg.x, point_msg.y, point_msg.z);
-        migrated_point = T_root_curr * point.homogeneous();
+        migrated_point =
+            T_root_curr * channel_landmarks.point(lm_idx).homogeneous();
       } else {
-        CLOG(WARNING, "stereo.migration") << "Point: " << lm_idx << " in " << channel_landmarks.name << " is invalid.";
+        CLOG(WARNING, "stereo.migration") << "Point: " << lm_idx << " in " << channel_landmarks.name() << " is invalid.";
       }
 
       // insert the migrated point
       migrated_points.col(lm_idx + matrix_offset) = migrated_point;
 
       // record the ID and validity
-      migrated_landmark_ids.emplace_back(channel_landmarks.matches[lm_idx]);
+      migrated_landmark_ids.emplace_back(channel_landmarks.msg().matches[lm_idx]);
       migrated_validity.push_back(validity);
 
       // TODO: (old) Move this into keyframe opt.
@@ -288,11 +294,10 @@ void LandmarkMigrationModule::migrate(
       namespace lgr3 = lgmath::r3;
       Eigen::Map<lgr3::CovarianceMatrix> migrated_cov(
           migrated_covariance.col(lm_idx + matrix_offset).data());
-      if (validity && lm_idx * 9 < channel_landmarks.covariance.size()) {
-        Eigen::Map<const Eigen::Matrix3f> covariance(
-            &channel_landmarks.covariance[lm_idx * 9]);
+      if (validity && channel_landmarks.hasCovariance(lm_idx)) {
         migrated_cov = lgr3::transformCovariance(
-            T_root_curr, covariance.cast<double>(), migrated_point);
+            T_root_curr, channel_landmarks.covariance(lm_idx).cast<double>(),
+            migrated_point);
       } else {
         // note: this is only happening for vertex <0,0>. potential bug in VO.
         migrated_cov = Eigen::Matrix<double, 3, 3>::Identity();
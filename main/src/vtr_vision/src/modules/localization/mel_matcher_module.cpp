@@ -185,14 +185,22 @@ void MelMatcherModule::matchVertex(CameraQueryCache &qdata,
     const std::string &rig_name = rig_names[rig_idx];
 
 
-    auto locked_landmark_msg = vertex->retrieve<vtr_vision_msgs::msg::RigLandmarks>(
-            rig_name + "_landmarks", "vtr_vision_msgs/msg/RigLandmarks");
-    if (locked_landmark_msg == nullptr) {
+    // shared with landmark migration, which has just used the same vertices
+    std::shared_ptr<vtr_vision_msgs::msg::RigLandmarks> map_rig_landmarks;
+    if (qdata.landmark_cache.valid()) {
+      map_rig_landmarks = qdata.landmark_cache->get(vertex, rig_name);
+    } else {
+      auto locked_landmark_msg = vertex->retrieve<vtr_vision_msgs::msg::RigLandmarks>(
+              rig_name + "_landmarks", "vtr_vision_msgs/msg/RigLandmarks");
+      if (locked_landmark_msg != nullptr) {
+        auto locked_msg = locked_landmark_msg->sharedLocked();
+        map_rig_landmarks = locked_msg.get().getDataPtr();
+      }
+    }
+    if (map_rig_landmarks == nullptr) {
       CLOG(ERROR, "stereo.mel_matcher") << "landmarks at " << vertex->id() << " could not be loaded";
       return;
     }
-    auto locked_msg = locked_landmark_msg->sharedLocked();
-    auto map_rig_landmarks = locked_msg.get().getDataPtr();
     
     for (uint32_t channel_idx = 0;
          channel_idx < query_rig_landmarks.channels.size(); ++channel_idx) {
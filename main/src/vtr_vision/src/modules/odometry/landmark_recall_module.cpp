@@ -67,6 +67,9 @@ void LandmarkRecallModule::run_(tactic::QueryCache &qdata0, tactic::OutputCache
   T_s_v_ = *qdata.T_s_r;
 
   auto &query_features = *qdata.rig_features;
+  // landmark messages are shared across frames through the pipeline's cache,
+  // the map below only avoids locking it for every recalled landmark
+  landmark_cache_ = qdata.landmark_cache.valid() ? qdata.landmark_cache.ptr() : nullptr;
   vertex_landmarks_.clear();
   T_map_i_cache_.clear();
   T_map_i_s_cache_.clear();
@@ -138,13 +141,18 @@ void LandmarkRecallModule::recallLandmark(
   auto landmark_vertex = graph->at(vid);
 
   if (vertex_landmarks_.find(vid) == vertex_landmarks_.end()) {
-    //const auto msg = target_vertex->retrieve<PointMapPointer>(
-      //  "pointmap_ptr", "vtr_lidar_msgs/msg/PointMapPointer");
-    
-    auto locked_landmark_msg = landmark_vertex->retrieve<vtr_vision_msgs::msg::RigLandmarks>(
-            rig_name + "_landmarks", "vtr_vision_msgs/msg/RigLandmarks");
-    auto locked_msg = locked_landmark_msg->sharedLocked();
-    vertex_landmarks_[vid] = locked_msg.get().getDataPtr();
+    if (landmark_cache_ != nullptr) {
+      vertex_landmarks_[vid] = landmark_cache_->get(landmark_vertex, rig_name);
+    } else {
+      auto locked_landmark_msg = landmark_vertex->retrieve<vtr_vision_msgs::msg::RigLandmarks>(
+              rig_name + "_landmarks", "vtr_vision_msgs/msg/RigLandmarks");
+      if (locked_landmark_msg != nullptr) {
+        auto locked_msg = locked_landmark_msg->sharedLocked();
+        vertex_landmarks_[vid] = locked_msg.get().getDataPtr();
+      } else {
+        vertex_landmarks_[vid] = nullptr;
+      }
+    }
   }
 
   auto landmarks = vertex_landmarks_[landmark_vertex->id()];
@@ -771,6 +771,8 @@ void StereoWindowOptimizationModule::updateGraphImpl(QueryCache &qdata0,
     auto lm_msg =
         std::make_shared<LM_Msg>(msg.second, v->vertexTime());
     v->insert<RigLandmarksMsg>(lm_str, "vtr_vision_msgs/msg/RigLandmarks", lm_msg);
+    // the next recall should see the replaced message
+    if (qdata.landmark_cache.valid()) qdata.landmark_cache->erase(msg.first, "stereo");
       
 
 
@@ -110,14 +110,15 @@ if (config_->target_width > 0){
   CLOG(INFO, "preprocessing") << "Right image size: " << right_im.data.size();
 
   
-  // channel_images
+  // channel_images, moved so that the cameras keep sharing the message buffers
+  // (copying an Image clones its data)
   channel_images.name = qdata.right_image->encoding;
-  channel_images.cameras.push_back(left_im);
-  channel_images.cameras.push_back(right_im);
+  channel_images.cameras.push_back(std::move(left_im));
+  channel_images.cameras.push_back(std::move(right_im));
 
   rig_images.name = config_->rig_name;
-  rig_images.channels.push_back(channel_images);
-  qdata.rig_images->push_back(rig_images);
+  rig_images.channels.push_back(std::move(channel_images));
+  qdata.rig_images->push_back(std::move(rig_images));
 
 
 }
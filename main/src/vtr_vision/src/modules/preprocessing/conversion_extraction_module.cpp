@@ -176,10 +176,15 @@ auto ConversionExtractionModule::Config::fromROS(
   config->feature_type = node->declare_parameter<std::string>(param_prefix + ".extractor.type", config->feature_type);
   config->visualize_disparity = node->declare_parameter<bool>(param_prefix + ".extractor.visualize_disparity", config->visualize_disparity);
   config->visualize = node->declare_parameter<bool>(param_prefix + ".visualize", config->visualize);
+  config->num_threads = node->declare_parameter<int>(param_prefix + ".num_threads", config->num_threads);
 
   #ifdef VTR_VISION_LEARNED 
   config->use_learned = node->declare_parameter<bool>(param_prefix + ".extractor.use_learned", config->use_learned);
   #endif
+  if (config->num_threads < 1)
+    throw std::invalid_argument(
+        "ConversionExtractionModule: num_threads must be at least 1, got " +
+        std::to_string(config->num_threads));
   // configure the detector
   if (config->feature_type == "OPENCV_ORB") {
     configureORBDetector(node, config->opencv_orb_params, param_prefix);
@@ -217,8 +222,10 @@ auto ConversionExtractionModule::Config::fromROS(
 }
 
 void ConversionExtractionModule::createExtractor() {
+  pool_ = std::make_shared<common::thread_pool>(config_->num_threads);
   extractor_ =
       vision::FeatureExtractorFactory::createExtractor(config_->feature_type);
+  extractor_->setThreadPool(pool_);
   if (config_->feature_type == "ASRL_GPU_SURF") {
 #ifdef VTR_ENABLE_GPUSURF
     vision::GpuSurfFeatureExtractor *dextractor =
@@ -284,17 +291,11 @@ void ConversionExtractionModule::run_(tactic::QueryCache &qdata0, tactic::Output
     auto &rig_extra = rig_extra_list->back();
     rig_extra.name = rig.name;
     
-    vision::ChannelFeatures (vision::BaseFeatureExtractor::*extract)(
-        const vision::ChannelImages &, bool) =
-        &vision::BaseFeatureExtractor::extractChannelFeatures;
-
-    vision::ChannelFeatures (vision::BaseFeatureExtractor::*doit_learned)(
-        const vision::ChannelImages &, const vision::ChannelImages &, bool) =
-        &vision::BaseFeatureExtractor::extractChannelFeaturesDisp;
-
-    // // vision::ChannelExtra (vision::BaseFeatureExtractor::*doit_extra)(
-    // //     const vision::ChannelImages &) =
-    // //     &vision::BaseFeatureExtractor::extractChannelFeaturesExtra;
+    // The extraction jobs reference the channels instead of copying them, so
+    // make room for the converted (and disparity) channels up front.
+    rig.channels.reserve(num_input_channels *
+                         (1 + config_->conversions.size() +
+                          (config_->use_learned ? 1 : 0)));
 
     for (unsigned channel_idx = 0; channel_idx < num_input_channels;
          ++channel_idx) {
@@ -332,9 +333,8 @@ void ConversionExtractionModule::run_(tactic::QueryCache &qdata0, tactic::Output
         }
 
         // extract
-        feature_futures.emplace_back(std::async(std::launch::async, extract,
-                                                extractor_.get(),
-                                                rig.channels.back(), true));
+        feature_futures.emplace_back(
+            extractor_->dispatchChannelFeatures(rig.channels.back(), true));
         
       }  // finish the conversions
 
@@ -359,11 +359,16 @@ void ConversionExtractionModule::run_(tactic::QueryCache &qdata0, tactic::Output
         //                                    rig.channels[channel_idx], 
         //                                    rig.channels.back(), extra, true));
 
-        feature_futures.emplace(feature_futures.begin(),
-                                std::async(std::launch::async, doit_learned,
-                                           extractor_learned_.get(),
-                                           rig.channels[channel_idx], 
-                                           rig.channels.back(), true));
+        // the learned extractor has no pool of its own, so this job never
+        // waits on other jobs of pool_
+        const auto &channel = rig.channels[channel_idx];
+        const auto &channel_disp = rig.channels.back();
+        feature_futures.emplace(
+            feature_futures.begin(),
+            pool_->dispatch([this, &channel, &channel_disp]() {
+              return extractor_learned_->extractChannelFeaturesDisp(
+                  channel, channel_disp, true);
+            }));
 
 
       }
@@ -16,6 +16,7 @@ auto StereoPipeline::Config::fromROS(const rclcpp::Node::SharedPtr &node,
   config->odometry = node->declare_parameter<std::vector<std::string>>(param_prefix + ".odometry", config->odometry);
   config->bundle_adjustment = node->declare_parameter<std::vector<std::string>>(param_prefix + ".bundle_adjustment", config->bundle_adjustment);
   config->localization = node->declare_parameter<std::vector<std::string>>(param_prefix + ".localization", config->localization);
+  config->landmark_cache_size = node->declare_parameter<int>(param_prefix + ".landmark_cache_size", config->landmark_cache_size);
   // clang-format on
   return config;
 }
@@ -44,6 +45,9 @@ StereoPipeline::StereoPipeline(
     bundle_adjustment_.push_back(factory()->get("bundle_adjustment." + module));
 
   w_v_r_in_r_odo_.setZero();
+
+  landmark_cache_ = std::make_shared<VertexLandmarkCache>(
+      std::max(config_->landmark_cache_size, 0));
 }
 
 StereoPipeline::~StereoPipeline() {}
@@ -61,6 +65,7 @@ void StereoPipeline::preprocess_(const tactic::QueryCache::Ptr &qdata0, const ta
   if (!qdata->vis_mutex.valid()) {
     qdata->vis_mutex.emplace();
   }
+  qdata->landmark_cache = landmark_cache_;
   
   for (auto module : preprocessing_) module->run(*qdata0, *output0, graph, executor);
   